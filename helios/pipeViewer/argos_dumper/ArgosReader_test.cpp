@@ -0,0 +1,301 @@
+// <ArgosReader_test> -*- C++ -*-
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+#include "sparta/collection/Collectable.hpp"
+#include "sparta/collection/PipelineCollector.hpp"
+
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/simulation/ClockManager.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/StartupEvent.hpp"
+#include "sparta/pairs/SpartaKeyPairs.hpp"
+
+#include "transactiondb/src/Reader.hpp"
+
+/*!
+ * \file ArgosReader_test.cpp
+ * \brief Reading an Argos database through pipeViewer::Reader
+ *
+ * Collects a database and reads it back through the memory-mapped reader.
+ * Every pair and annotation record must come back once, a window of one
+ * heartbeat must only hold records of that heartbeat, and windows read
+ * from several threads at once, each with its own callback, must equal the
+ * same windows read from one thread.
+ */
+
+TEST_INIT;
+
+namespace
+{
+    constexpr uint64_t NUM_CYCLES = 20000;
+    constexpr uint64_t HEARTBEAT = 100;
+    constexpr uint32_t NUM_WINDOWS = 500;
+    constexpr uint32_t NUM_THREADS = 4;
+
+    const char * const MNEMONICS[] = {"add", "sub", "lw", "sw", "beq", "jal", "mul", "div"};
+
+    class InstPairDef;
+    class Inst
+    {
+    public:
+        using SpartaPairDefinitionType = InstPairDef;
+
+        enum class Unit : std::uint8_t {
+            ALU,
+            LSU,
+            BR
+        };
+
+        explicit Inst(uint64_t uid) :
+            uid_(uid),
+            pc_(0x80000000 + uid * 4),
+            mnemonic_(MNEMONICS[uid % 8]),
+            unit_(static_cast<Unit>(uid % 3))
+        { }
+
+        uint64_t getUid() const { return uid_; }
+        uint64_t getPC() const { return pc_; }
+        std::string getMnemonic() const { return mnemonic_; }
+        const Unit & getUnit() const { return unit_; }
+
+    private:
+        uint64_t uid_;
+        uint64_t pc_;
+        std::string mnemonic_;
+        Unit unit_;
+    };
+
+    inline std::ostream & operator<<(std::ostream & os, const Inst::Unit & unit) {
+        switch(unit)
+        {
+            case Inst::Unit::ALU:
+            os << "ALU";
+            break;
+            case Inst::Unit::LSU:
+            os << "LSU";
+            break;
+            case Inst::Unit::BR:
+            os << "BR";
+            break;
+        }
+        return os;
+    }
+
+    class InstPairDef : public sparta::PairDefinition<Inst>
+    {
+    public:
+        InstPairDef() : sparta::PairDefinition<Inst>()
+        {
+            addPair("uid", &Inst::getUid);
+            addPair("pc", &Inst::getPC, std::ios::hex);
+            addPair("mnemonic", &Inst::getMnemonic);
+            addPair("unit", &Inst::getUnit);
+        }
+    };
+
+    //! Retires an instruction every cycle, and counts them with an annotation
+    class Core : public sparta::TreeNode
+    {
+    public:
+        explicit Core(sparta::TreeNode * parent) :
+            sparta::TreeNode(parent, "core0", "A core retiring an instruction every cycle"),
+            retire_(this, "retire"),
+            retired_(this, "retired"),
+            es_(this),
+            ev_retire_(&es_, "retire", CREATE_SPARTA_HANDLER(Core, retire_inst_))
+        {
+            sparta::StartupEvent(this, CREATE_SPARTA_HANDLER(Core, startup_));
+        }
+
+    private:
+        void startup_() {
+            ev_retire_.schedule(1);
+        }
+
+        void retire_inst_() {
+            // Some instructions are still being retired at a heartbeat
+            retire_.collectWithDuration(Inst(uid_), uid_ % 3 + 1);
+            ++uid_;
+            if(uid_ % 5 == 0) {
+                retired_.collect(uid_);
+            }
+            ev_retire_.schedule(1);
+        }
+
+        sparta::collection::Collectable<Inst> retire_;
+        sparta::collection::Collectable<uint64_t> retired_;
+        sparta::EventSet es_;
+        sparta::Event<sparta::SchedulingPhase::Update> ev_retire_;
+        uint64_t uid_ = 0;
+    };
+
+    //! Keeps a description of every record found
+    class RecordList : public sparta::pipeViewer::PipelineDataCallback
+    {
+    public:
+        void foundInstRecord(const instruction_t*) override {
+            records.emplace_back("unexpected instruction record");
+        }
+
+        void foundMemRecord(const memoryoperation_t*) override {
+            records.emplace_back("unexpected memory operation record");
+        }
+
+        void foundAnnotationRecord(const annotation_t* r) override {
+            add_(r, r->annt);
+        }
+
+        void foundPairRecord(const pair_t* r) override {
+            std::string content;
+            for(const auto & str : r->stringVector) {
+                content += str + " ";
+            }
+            add_(r, content);
+            if(r->nameVector[1] == "uid") {
+                uids.insert(r->valueVector[1].first);
+            }
+        }
+
+        std::vector<std::string> records;
+        std::set<uint64_t> uids;
+        uint64_t num_outside = 0;
+        uint64_t window_start = 0;
+        uint64_t window_end = std::numeric_limits<uint64_t>::max();
+
+    private:
+        void add_(const transaction_t* r, const std::string & content) {
+            if(r->time_Start < window_start || r->time_End > window_end) {
+                ++num_outside;
+            }
+            records.emplace_back(std::to_string(r->location_ID) + " " +
+                                 std::to_string(r->time_Start) + "-" +
+                                 std::to_string(r->time_End) + " " + content);
+        }
+    };
+}
+
+void collectDatabase()
+{
+    sparta::Scheduler sched;
+    sparta::ClockManager cm(&sched);
+    sparta::RootTreeNode root_node("root");
+    sparta::Clock::Handle root_clk = cm.makeRoot(&root_node, "root_clk");
+    cm.normalize();
+    root_node.setClock(root_clk.get());
+
+    Core core(&root_node);
+
+    root_node.enterConfiguring();
+    root_node.enterFinalized();
+
+    sparta::collection::PipelineCollector pc("readerPipe", HEARTBEAT, root_clk.get(), &root_node);
+
+    sched.finalize();
+    pc.startCollection(&root_node);
+    sched.run(NUM_CYCLES);
+    pc.stopCollection(&root_node);
+    pc.destroy();
+
+    root_node.enterTeardown();
+}
+
+void testReadBack()
+{
+    auto reader = sparta::pipeViewer::Reader::construct<RecordList>("readerPipe");
+    EXPECT_EQUAL(reader.getChunkSize(), HEARTBEAT);
+    EXPECT_TRUE(reader.getCycleLast() > NUM_CYCLES - HEARTBEAT);
+
+    // Everything at once
+    reader.getWindow(reader.getCycleFirst(), reader.getCycleLast());
+    const RecordList & all = reader.getCallbackAs<RecordList>();
+    // Instruction uid is retired on cycle uid + 1. The one retired on the
+    // last cycle is not written
+    EXPECT_EQUAL(all.uids.size(), NUM_CYCLES - 2);
+    EXPECT_EQUAL(*all.uids.rbegin(), NUM_CYCLES - 3);
+
+    // One heartbeat at a time, with a callback of our own
+    std::vector<std::string> records;
+    uint64_t num_outside = 0;
+    for(uint64_t tick = 0; tick <= reader.getCycleLast(); tick += HEARTBEAT) {
+        RecordList heartbeat;
+        heartbeat.window_start = tick;
+        heartbeat.window_end = tick + HEARTBEAT;
+        reader.getWindow(tick, tick + HEARTBEAT - 1, heartbeat);
+        records.insert(records.end(), heartbeat.records.begin(), heartbeat.records.end());
+        num_outside += heartbeat.num_outside;
+    }
+    EXPECT_EQUAL(num_outside, 0);
+    EXPECT_TRUE(records == all.records);
+}
+
+void testConcurrentWindows()
+{
+    const auto reader = sparta::pipeViewer::Reader::construct<RecordList>("readerPipe");
+
+    std::mt19937_64 rng(0xa2605);
+    std::vector<std::pair<uint64_t, uint64_t>> windows;
+    for(uint32_t i = 0; i < NUM_WINDOWS; ++i) {
+        const uint64_t start = rng() % NUM_CYCLES;
+        windows.emplace_back(start, start + rng() % (20 * HEARTBEAT));
+    }
+
+    std::vector<RecordList> serial(NUM_WINDOWS);
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < NUM_WINDOWS; ++i) {
+        reader.getWindow(windows[i].first, windows[i].second, serial[i]);
+    }
+    const double serial_time = sparta::perf::secondsSince(start);
+
+    std::vector<RecordList> concurrent(NUM_WINDOWS);
+    std::vector<std::thread> threads;
+    start = std::chrono::steady_clock::now();
+    for(uint32_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&, t]() {
+            for(uint32_t i = t; i < NUM_WINDOWS; i += NUM_THREADS) {
+                reader.getWindow(windows[i].first, windows[i].second, concurrent[i]);
+            }
+        });
+    }
+    for(auto & thread : threads) {
+        thread.join();
+    }
+    const double concurrent_time = sparta::perf::secondsSince(start);
+
+    uint32_t num_different = 0;
+    for(uint32_t i = 0; i < NUM_WINDOWS; ++i) {
+        if(serial[i].records != concurrent[i].records) {
+            ++num_different;
+        }
+    }
+    EXPECT_EQUAL(num_different, 0);
+    EXPECT_FALSE(serial[0].records.empty());
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Reading " << NUM_WINDOWS << " random windows:"
+                  << "\n\tone thread : " << serial_time << " s"
+                  << "\n\t" << NUM_THREADS << " threads  : " << concurrent_time << " s" << std::endl;
+    }
+}
+
+int main()
+{
+    collectDatabase();
+    testReadBack();
+    testConcurrentWindows();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
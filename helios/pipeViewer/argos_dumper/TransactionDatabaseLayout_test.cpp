@@ -0,0 +1,274 @@
+// <TransactionDatabaseLayout_test> -*- C++ -*-
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+#include "sparta/collection/Collectable.hpp"
+#include "sparta/collection/PipelineCollector.hpp"
+
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/simulation/ClockManager.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/StartupEvent.hpp"
+
+#include "transactiondb/src/TransactionDatabaseInterface.hpp"
+
+/*!
+ * \file TransactionDatabaseLayout_test.cpp
+ * \brief TICK_DATA and COLUMNAR node layouts of TransactionDatabaseInterface
+ *
+ * Loads a database with many never-collected locations in each layout and
+ * compares the transaction found at every checked location and tick, which
+ * must also hold that tick and location.  Point lookups must agree with
+ * the queries, COLUMNAR nodes must be smaller, and TICK_DATA must remain
+ * the default.  Query and lookup latencies are printed with
+ * SPARTA_PERF_TESTS.
+ */
+
+TEST_INIT;
+
+namespace
+{
+    using TDBI = sparta::pipeViewer::TransactionDatabaseInterface;
+
+    constexpr uint64_t NUM_CYCLES = 2000;
+    constexpr uint64_t HEARTBEAT = 1000;
+    constexpr uint32_t NUM_UNITS = 40;
+    constexpr uint32_t NUM_LOCATIONS = 20000;  //!< Locations of the tree, most never collected
+    constexpr uint32_t NUM_CHECKED_LOCATIONS = 256; //!< Holds the location IDs of all units
+    constexpr uint64_t NO_TRANSACTION_ID = std::numeric_limits<uint64_t>::max();
+
+    class StatePairDef;
+    class State
+    {
+    public:
+        using SpartaPairDefinitionType = StatePairDef;
+
+        enum class Mode : std::uint8_t {
+            FETCH,
+            EXECUTE,
+            STALL
+        };
+
+        explicit State(uint64_t value) :
+            value_(value),
+            mode_(static_cast<Mode>(value % 3))
+        { }
+
+        uint64_t getValue() const { return value_; }
+        const Mode & getMode() const { return mode_; }
+
+    private:
+        uint64_t value_;
+        Mode mode_;
+    };
+
+    inline std::ostream & operator<<(std::ostream & os, const State::Mode & mode) {
+        switch(mode)
+        {
+            case State::Mode::FETCH:
+            os << "FETCH";
+            break;
+            case State::Mode::EXECUTE:
+            os << "EXECUTE";
+            break;
+            case State::Mode::STALL:
+            os << "STALL";
+            break;
+        }
+        return os;
+    }
+
+    class StatePairDef : public sparta::PairDefinition<State>
+    {
+    public:
+        StatePairDef() : sparta::PairDefinition<State>()
+        {
+            addPair("value", &State::getValue);
+            addPair("mode", &State::getMode);
+        }
+    };
+
+    //! Changes its state every few cycles and is sometimes idle
+    class Unit : public sparta::TreeNode
+    {
+    public:
+        Unit(sparta::TreeNode * parent, uint32_t id) :
+            sparta::TreeNode(parent, "unit" + std::to_string(id), "A unit changing state"),
+            state_(this, "state"),
+            es_(this),
+            ev_update_(&es_, "update", CREATE_SPARTA_HANDLER(Unit, update_)),
+            rng_(id)
+        {
+            sparta::StartupEvent(this, CREATE_SPARTA_HANDLER(Unit, startup_));
+        }
+
+    private:
+        void startup_() {
+            ev_update_.schedule(1);
+        }
+
+        void update_() {
+            const uint32_t r = rng_() % 64;
+            if(r < 2) {
+                state_.closeRecord();
+            }
+            else if(r < 8) {
+                state_.collect(State(++value_));
+            }
+            ev_update_.schedule(1);
+        }
+
+        sparta::collection::Collectable<State> state_;
+        sparta::EventSet es_;
+        sparta::Event<sparta::SchedulingPhase::Update> ev_update_;
+        std::mt19937 rng_;
+        uint64_t value_ = 0;
+    };
+
+    //! Transaction ID at each checked location and tick of a query
+    struct QueryResult
+    {
+        std::vector<uint64_t> ids;
+        uint32_t num_wrong = 0; //!< Transactions not holding their tick and location
+    };
+
+    void recordTick(void * user_data,
+                    uint64_t tick,
+                    TDBI::const_interval_idx * location_contents,
+                    const TDBI::Transaction * transactions,
+                    uint32_t num_locations)
+    {
+        QueryResult & result = *static_cast<QueryResult*>(user_data);
+        for(uint32_t loc = 0; loc < NUM_CHECKED_LOCATIONS; ++loc) {
+            if(location_contents == nullptr || location_contents[loc] == TDBI::NO_TRANSACTION) {
+                result.ids.push_back(NO_TRANSACTION_ID);
+                continue;
+            }
+            const TDBI::Transaction & trans = transactions[location_contents[loc]];
+            if(trans.getLeft() > tick || trans.getRight() <= tick || trans.location_ID != loc) {
+                ++result.num_wrong;
+            }
+            result.ids.push_back(trans.transaction_ID);
+        }
+    }
+
+    void ignoreTick(void *, uint64_t, TDBI::const_interval_idx *, const TDBI::Transaction *, uint32_t)
+    {
+    }
+}
+
+void collectDatabase()
+{
+    sparta::Scheduler sched;
+    sparta::ClockManager cm(&sched);
+    sparta::RootTreeNode root_node("root");
+    sparta::Clock::Handle root_clk = cm.makeRoot(&root_node, "root_clk");
+    cm.normalize();
+    root_node.setClock(root_clk.get());
+
+    std::vector<std::unique_ptr<Unit>> units;
+    for(uint32_t i = 0; i < NUM_UNITS; ++i) {
+        units.emplace_back(new Unit(&root_node, i));
+    }
+
+    root_node.enterConfiguring();
+    root_node.enterFinalized();
+
+    sparta::collection::PipelineCollector pc("layoutPipe", HEARTBEAT, root_clk.get(), &root_node);
+
+    sched.finalize();
+    pc.startCollection(&root_node);
+    sched.run(NUM_CYCLES);
+    pc.stopCollection(&root_node);
+    pc.destroy();
+
+    root_node.enterTeardown();
+}
+
+void testLayouts()
+{
+    QueryResult results[2];
+    uint64_t sizes[2];
+    double query_times[2];
+    double lookup_times[2];
+    uint32_t lookup_mismatches[2] = {0, 0};
+    const uint32_t num_queries = sparta::perf::problemSize(5u, 1u);
+    const uint32_t num_lookups = sparta::perf::problemSize(200000u, 2000u);
+    const TDBI::NodeLayout layouts[2] = {TDBI::NodeLayout::TICK_DATA, TDBI::NodeLayout::COLUMNAR};
+
+    {
+        TDBI db("layoutPipe", NUM_LOCATIONS);
+        EXPECT_TRUE(db.getNodeLayout() == TDBI::NodeLayout::TICK_DATA);
+    }
+
+    for(uint32_t l = 0; l < 2; ++l) {
+        TDBI db("layoutPipe", NUM_LOCATIONS, false, layouts[l]);
+        EXPECT_TRUE(db.getNodeLayout() == layouts[l]);
+        const uint64_t first = db.getFileStart();
+        const uint64_t last = db.getFileEnd() - 1;
+
+        // Load everything and check the content
+        db.query(first, last, &recordTick, &results[l]);
+        EXPECT_EQUAL(results[l].num_wrong, 0);
+        sizes[l] = db.getSizeInBytes();
+
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num_queries; ++i) {
+            db.query(first, last, &ignoreTick);
+        }
+        query_times[l] = sparta::perf::secondsSince(start) / num_queries;
+
+        // "transaction at (location, tick)"
+        std::mt19937_64 rng(0x1a7001);
+        start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num_lookups; ++i) {
+            const uint64_t tick = first + rng() % (last - first + 1);
+            const uint32_t loc = rng() % NUM_CHECKED_LOCATIONS;
+            const TDBI::Transaction * trans = db.getLoadedTransaction(loc, tick);
+            const uint64_t id = trans ? trans->transaction_ID : NO_TRANSACTION_ID;
+            if(id != results[l].ids[(tick - first) * NUM_CHECKED_LOCATIONS + loc]) {
+                ++lookup_mismatches[l];
+            }
+        }
+        lookup_times[l] = sparta::perf::secondsSince(start);
+    }
+
+    EXPECT_EQUAL(lookup_mismatches[0], 0);
+    EXPECT_EQUAL(lookup_mismatches[1], 0);
+    EXPECT_EQUAL(results[0].ids.size(), results[1].ids.size());
+    EXPECT_TRUE(results[0].ids == results[1].ids);
+    uint64_t num_transactions = 0;
+    for(const uint64_t id : results[1].ids) {
+        num_transactions += (id != NO_TRANSACTION_ID);
+    }
+    EXPECT_TRUE(num_transactions > 0);
+    EXPECT_TRUE(sizes[1] < sizes[0]);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Nodes of " << NUM_CYCLES << " ticks of " << NUM_UNITS << " collected units in "
+                  << NUM_LOCATIONS << " locations:"
+                  << "\n\tTICK_DATA: " << sizes[0] / 1000000.0 << " MB, query " << query_times[0]
+                  << " s, " << num_lookups << " lookups " << lookup_times[0] << " s"
+                  << "\n\tCOLUMNAR : " << sizes[1] / 1000000.0 << " MB, query " << query_times[1]
+                  << " s, " << num_lookups << " lookups " << lookup_times[1] << " s" << std::endl;
+    }
+}
+
+int main()
+{
+    collectDatabase();
+    testLayouts();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
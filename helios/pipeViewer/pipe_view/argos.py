@@ -153,6 +153,13 @@ def main() -> None:
         action='store_true',
         help='Update Argos if the database file changes'
     )
+    parser.add_argument(
+        '--node-layout',
+        choices=('tick_data', 'columnar'),
+        default='tick_data',
+        help='How the transaction database stores the transactions it loads. '
+             'columnar uses less memory for databases with many locations'
+    )
     parser.add_argument(
         '--title-prefix',
         metavar='TITLE_PREFIX',
@@ -284,7 +291,7 @@ def main() -> None:
 
     # Open the Database
     try:
-        db = Database(database_prefix, args.poll)
+        db = Database(database_prefix, args.poll, args.node_layout)
     except IOError as ex:
         error('Error opening pipeout database (prefix) "%s"', database_prefix)
         error(ex)
@@ -37,7 +37,12 @@ class Database:
     #  @param prefix Argos transaction database prefix to open.
     #  Transaction database file extensions will be appended to determine the
     #  actual filenames to open
-    def __init__(self, prefix: str, update_enabled: bool) -> None:
+    #  @param node_layout Layout of the query API nodes, one of
+    #  transactiondb.TransactionDatabase.NODE_LAYOUTS
+    def __init__(self,
+                 prefix: str,
+                 update_enabled: bool,
+                 node_layout: str = 'tick_data') -> None:
 
         self.__filename = prefix
         self.__loc_mgr = LocationManager(prefix, update_enabled)
@@ -57,7 +62,8 @@ class Database:
         self.__dbapi = transactiondb.TransactionDatabase(
             self.filename,
             1 + self.location_manager.getMaxLocationID(),
-            update_enabled
+            update_enabled,
+            node_layout
         )
         logging.getLogger('Database').debug(
             'Database opened with node length %s, heartbeat size %s',
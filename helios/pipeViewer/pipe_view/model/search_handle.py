@@ -115,6 +115,11 @@ class SearchHandle:
         else:
             arglist.append('')
 
+        # Index annotation tokens on the first search of a database so that
+        # later searches only read the parts of it holding the query
+        if os.environ.get('TRANSACTIONSEARCH_INDEX'):
+            arglist.append('--index')
+
         # print 'Search Arglist = ', arglist
 
         process = subprocess.Popen(arglist,
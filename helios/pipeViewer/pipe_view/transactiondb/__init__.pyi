@@ -1,7 +1,7 @@
 # Stub definitions for the transactiondb library
 # Cython isn't very good at generating these automatically yet
 
-from typing import Callable, ClassVar, List, Optional, Union
+from typing import Callable, ClassVar, List, Optional, Tuple, Union
 
 class Transaction:
     ANNOTATION_TYPE_STR: ClassVar[str] = ...
@@ -35,8 +35,9 @@ class Transaction:
     def makeRealCopy(self) -> Transaction: ...
 
 class TransactionDatabase:
+    NODE_LAYOUTS: ClassVar[Tuple[str, ...]] = ...
     OBJECT_DESTROYED_ERROR: ClassVar[str] = ...
-    def __init__(self, filename: str, num_locs: int, update_enabled: bool) -> None: ...
+    def __init__(self, filename: str, num_locs: int, update_enabled: bool, node_layout: str = 'tick_data') -> None: ...
     def ackUpdate(self) -> None: ...
     def clearCurrentTickContent(self) -> None: ...
     def disableUpdate(self) -> None: ...
@@ -50,6 +51,7 @@ class TransactionDatabase:
     def getFileVersion(self) -> int: ...
     def getLocationMap(self) -> List[Union[int, str]]: ...
     def getNodeDump(self, node_idx: int, loc_start: int = 0, loc_end: int = 0, tick_entry_limit: int = 0) -> str: ...
+    def getNodeLayout(self) -> str: ...
     def getNodeLength(self) -> int: ...
     def getNodeStates(self) -> str: ...
     def getNumCachedAnnotations(self) -> int: ...
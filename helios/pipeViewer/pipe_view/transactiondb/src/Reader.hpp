@@ -8,17 +8,29 @@
 
 #pragma once
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
+#include <limits>
 #include <locale>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "PipelineDataCallback.hpp"
 #include "sparta/utils/SpartaException.hpp"
@@ -101,6 +113,11 @@ namespace sparta::pipeViewer {
      * The Reader will return the records found on disk by calling
      * methods in PipelineDataCallback, passing pointers to the read
      * transactions.
+     *
+     * The record and index files are memory-mapped and records are parsed
+     * in place, so jumping to any window only touches the pages of that
+     * window. getWindow with an explicit callback may be called from
+     * several threads at once.
      */
     class Reader
     {
@@ -198,6 +215,105 @@ namespace sparta::pipeViewer {
                     }
             };
 
+            /**
+             * \class MappedFile
+             * \brief Read-only memory mapping of a binary database file
+             */
+            class MappedFile {
+                private:
+                    std::string filename_;
+                    const char* data_ = nullptr;
+                    size_t size_ = 0;
+
+                    inline void map_() {
+                        const int fd = open(filename_.c_str(), O_RDONLY);
+                        sparta_assert(fd != -1, "Failed to open file " << filename_);
+                        struct stat stat_result;
+                        const bool stat_ok = (fstat(fd, &stat_result) == 0);
+                        size_ = stat_ok ? stat_result.st_size : 0;
+                        void* addr = MAP_FAILED;
+                        if(size_ != 0) {
+                            addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+                        }
+                        // The mapping stays valid after the file is closed
+                        close(fd);
+                        sparta_assert(stat_ok, "Failed to stat file " << filename_);
+                        sparta_assert(size_ != 0,
+                                      filename_ << " is empty. Did Argos database collection complete?");
+                        sparta_assert(addr != MAP_FAILED, "Failed to map file " << filename_);
+                        data_ = static_cast<const char*>(addr);
+                    }
+
+                    inline void unmap_() {
+                        if(data_ != nullptr) {
+                            munmap(const_cast<char*>(data_), size_);
+                            data_ = nullptr;
+                            size_ = 0;
+                        }
+                    }
+
+                public:
+                    explicit MappedFile(std::string&& filename) :
+                        filename_(std::move(filename))
+                    {
+                        map_();
+                    }
+
+                    MappedFile(MappedFile&& rhs) :
+                        filename_(std::move(rhs.filename_)),
+                        data_(std::exchange(rhs.data_, nullptr)),
+                        size_(std::exchange(rhs.size_, 0))
+                    {
+                    }
+
+                    MappedFile(const MappedFile&) = delete;
+                    MappedFile& operator=(const MappedFile&) = delete;
+
+                    ~MappedFile() {
+                        unmap_();
+                    }
+
+                    inline const auto& getFilename() const {
+                        return filename_;
+                    }
+
+                    /**
+                     * \brief Copy num_bytes at pos into buf and advance pos past them
+                     * \return false, leaving pos unchanged, if the mapping ends before
+                     * num_bytes
+                     */
+                    template<typename T>
+                    inline bool read(uint64_t& pos, T& buf, const size_t num_bytes = sizeof(T)) const {
+                        if(pos > size_ || size_ - pos < num_bytes) {
+                            return false;
+                        }
+                        std::memcpy(&buf, data_ + pos, num_bytes);
+                        pos += num_bytes;
+                        return true;
+                    }
+
+                    /**
+                     * \brief Map the file again, e.g. after it grew. Pointers into the
+                     * old mapping are invalidated
+                     */
+                    inline void remap() {
+                        unmap_();
+                        map_();
+                    }
+
+                    //! Size of the mapped part of the file
+                    inline uint64_t size() const {
+                        return size_;
+                    }
+
+                    //! Current size of the file, which grows while the database is written
+                    inline int64_t sizeOnDisk() const {
+                        struct stat stat_result;
+                        stat(filename_.c_str(), &stat_result);
+                        return stat_result.st_size;
+                    }
+            };
+
             /**
              * \class ColonDelimitedFile
              * \brief Class that knows how to read ':'-delimited files used by the Argos pair format
@@ -428,33 +544,22 @@ namespace sparta::pipeViewer {
              * to the start cycle.
              * \param start The cycle number to start reading records from.
              */
-            inline uint64_t findRecordReadPos_(const uint64_t start)
+            inline uint64_t findRecordReadPos_(const uint64_t start) const
             {
-                //Figure out how far we need to seek into our index file.
-                const uint64_t step = first_index_ + (start/heartbeat_ * sizeof(uint64_t));
-
-                //Now read the pointer from this location.
-                if(!index_file_.seekg(step)) {
-                    sparta_assert(!"Could not seekg in for the given position.  Please report bug");
-                }
+                //Figure out which entry of our index file holds the pointer.
+                //Entries are one per heartbeat, so this is a direct lookup.
+                uint64_t step = first_index_ + (start/heartbeat_ * sizeof(uint64_t));
                 uint64_t pos = size_of_record_file_;
 
                 //It might be the case that our index file is too small
                 //to represent an end time that the user is requesting.
-                //in the above algorythm either reached the end of the index file.
 
-                //notice we look too see if the index file seeker has passed
+                //notice we look too see if the entry is past
                 //size_of_index_file_ - 8 bytes b/c a special last index is written to the index file
                 //to point to only the start of the last transaction.
-                const int64_t filepos = index_file_.tellg();
-                if(filepos >= size_of_index_file_ - 8 || filepos == -1)
-                {
-                    //We need to reset end of file reach flags for the index file.
-                    index_file_.clear();
-                }
-                else
+                if(static_cast<int64_t>(step) < size_of_index_file_ - 8)
                 {
-                    index_file_.read(pos);
+                    index_file_.read(step, pos);
                 }
                 return pos;
             }
@@ -464,16 +569,29 @@ namespace sparta::pipeViewer {
              * interval values.
              * example 4600 rounds to 5000 when the interval is "1000"
              */
-            inline uint64_t roundUp_(const uint64_t num)
+            inline uint64_t roundUp_(const uint64_t num) const
             {
                 const auto sub_sum = num + heartbeat_ - 1;
                 return sub_sum - (sub_sum % heartbeat_);
             }
 
-            inline std::string readAnnotation_(const uint16_t length) {
-                std::string annt_buf(length, '\0');
-                record_file_.read(annt_buf.data(), length);
-                return annt_buf;
+            /**
+             * \brief Copy num_bytes of a record at pos into buf and advance pos
+             * past them
+             */
+            template<typename T>
+            inline void readRecordData_(uint64_t& pos, T& buf, const size_t num_bytes = sizeof(T)) const {
+                const bool read = record_file_.read(pos, buf, num_bytes);
+                sparta_assert(read, "Previous read of the argos DB failed: "
+                              << record_file_.getFilename() << " ends in the middle of a record at byte " << pos);
+            }
+
+            inline std::string readRecordString_(uint64_t& pos, const uint16_t length) const {
+                std::string str(length, '\0');
+                if(length != 0) {
+                    readRecordData_(pos, str[0], length);
+                }
+                return str;
             }
 
             inline void acquireLock_() {
@@ -486,14 +604,11 @@ namespace sparta::pipeViewer {
             /**
              * \brief Return the start time in the file.
              */
-            inline uint64_t findCycleFirst_()
+            inline uint64_t findCycleFirst_() const
             {
-                //Make sure the user is not abusing our NON thread safe method.
-                acquireLock_();
-                record_file_.seekg(0, std::ios::beg);
+                uint64_t pos = 0;
                 transaction_t transaction;
-                record_file_.read(transaction);
-                clearLock();
+                readRecordData_(pos, transaction);
                 return transaction.time_Start;
             }
 
@@ -502,24 +617,15 @@ namespace sparta::pipeViewer {
              * Our output saved the last index to point to
              * the start of last record.
              */
-            inline uint64_t findCycleLast_()
+            inline uint64_t findCycleLast_() const
             {
-                //Make sure the user is not abusing our NON thread safe method.
-                acquireLock_();
-                //Notice that we reset the index file, b/c if
-                //we had already read to the end of the file, we need to reset
-                //end of file flags.
-                index_file_.clear();
-                //seek one entry back from the end of the index file
-                index_file_.seekg(size_of_index_file_-sizeof(uint64_t));
+                //read the last entry of the index file
+                uint64_t index_pos = size_of_index_file_ - sizeof(uint64_t);
                 uint64_t pos = 0;
-                index_file_.read(pos);
+                index_file_.read(index_pos, pos);
                 //read the transaction at the appropriate location.
-                record_file_.seekg(pos, std::ios::beg);
                 transaction_t transaction;
-                record_file_.read(transaction);
-                clearLock();
-                if(record_file_.gcount() != sizeof(transaction_t))
+                if(!record_file_.read(pos, transaction))
                 {
                     return highest_cycle_;
                 }
@@ -528,15 +634,18 @@ namespace sparta::pipeViewer {
             }
 
             template<bool CountRecords>
-            inline size_t readRecordVersion_(const std::fstream::pos_type end_pos,
+            inline size_t readRecordVersion_(uint64_t& pos,
+                                             const uint64_t end_pos,
                                              const uint64_t start,
-                                             const uint64_t end)
+                                             const uint64_t end,
+                                             PipelineDataCallback& data_callback) const
             {
                 size_t recsread = 0;
-                for(auto pos = record_file_.tellg(); pos < end_pos && pos != -1; pos = record_file_.tellg())
+                //Stop at end_pos or at the end of the file
+                while(pos < end_pos && pos < record_file_.size())
                 {
                     // Read, checking for chunk_end
-                    readRecord_(start, end);
+                    readRecord_(pos, start, end, data_callback);
                     if constexpr(CountRecords) {
                         ++recsread;
                     }
@@ -548,26 +657,33 @@ namespace sparta::pipeViewer {
              * \brief Read a record of any format. Older formats are upconverted to new format.
              */
             template<bool CountRecords = false>
-            inline size_t readRecords_(const std::fstream::pos_type end_pos, const uint64_t start, const uint64_t end) {
+            inline size_t readRecords_(uint64_t& pos,
+                                       const uint64_t end_pos,
+                                       const uint64_t start,
+                                       const uint64_t end,
+                                       PipelineDataCallback& data_callback) const {
                 sparta_assert(version_ == 2, "Only version 2 is currenly supported");
-                return readRecordVersion_<CountRecords>(end_pos, start, end);
+                return readRecordVersion_<CountRecords>(pos, end_pos, start, end, data_callback);
             }
 
             /**
              * \brief Read a single record at \a pos and increment pos
              */
-            inline void readRecord_(const uint64_t start, const uint64_t end) {
+            inline void readRecord_(uint64_t& pos,
+                                    const uint64_t start,
+                                    const uint64_t end,
+                                    PipelineDataCallback& data_callback) const {
+                const uint64_t record_pos = pos;
                 transaction_t transaction;
-                record_file_.read(transaction);
-                sparta_assert(record_file_.good(), "Previous read of the argos DB failed");
+                readRecordData_(pos, transaction);
 
                 switch (transaction.flags & TYPE_MASK)
                 {
                     case is_Annotation :
                     {
                         annotation_t annot(std::move(transaction));
-                        record_file_.read(annot.length);
-                        annot.annt = readAnnotation_(annot.length);
+                        readRecordData_(pos, annot.length);
+                        annot.annt = readRecordString_(pos, annot.length);
 
                         //// Sanity check the transactions coming out
                         //if(start % heartbeat_ == 0 // Only try this sanity checking if start is a multiple of heartbeat_
@@ -583,7 +699,6 @@ namespace sparta::pipeViewer {
                         // Only send along transaction in the query range
                         if(transaction.time_End < start || transaction.time_Start > end){
                             // Skip transactions by not sending them along to the callback.
-                            // read is faster than seekg aparently. This DOES help performance
                             READER_DBG_MSG("skipped transaction outside of window [" << start << ", "
                                            << end << "). start: " << transaction.time_Start << " end: "
                                            << transaction.time_End
@@ -592,30 +707,30 @@ namespace sparta::pipeViewer {
                             READER_DBG_MSG("found annt. " << "loc: " << annot.location_ID << " start: "
                                            << annot.time_Start << " end: " << annot.time_End
                                            << " parent: " << annot.parent_ID);
-                            data_callback_->foundAnnotationRecord(&annot);
+                            data_callback.foundAnnotationRecord(&annot);
                         }
                     } break;
 
                     case is_Instruction:
                     {
                         instruction_t inst;
-                        record_file_.seekg(-sizeof(transaction_t), std::ios::cur);
-                        record_file_.read(inst);
+                        pos = record_pos;
+                        readRecordData_(pos, inst);
 
                         READER_DBG_MSG("found inst. start: " << inst.time_Start << " end: " << inst.time_End);
 
-                        data_callback_->foundInstRecord(&inst);
+                        data_callback.foundInstRecord(&inst);
                     } break;
 
                     case is_MemoryOperation:
                     {
                         memoryoperation_t memop;
-                        record_file_.seekg(-sizeof(transaction_t), std::ios::cur);
-                        record_file_.read(memop);
+                        pos = record_pos;
+                        readRecordData_(pos, memop);
 
                         READER_DBG_MSG("found inst. start: " << memop.time_Start << " end: " << memop.time_End);
 
-                        data_callback_->foundMemRecord(&memop);
+                        data_callback.foundMemRecord(&memop);
                     } break;
 
                     // If we have found a record which is of Pair Type,
@@ -668,7 +783,7 @@ namespace sparta::pipeViewer {
                                 sparta_assert(item_size <= sizeof(pair_t::IntT),
                                               "Data Type not supported for reading/writing.");
                                 pair_t::IntT tmp = 0;
-                                record_file_.read(&tmp, item_size);
+                                readRecordData_(pos, tmp, item_size);
                                 pairt.valueVector.emplace_back(std::make_pair(tmp, true));
 
                                 // Finally for a certain field "i", we check if there is a string
@@ -694,34 +809,32 @@ namespace sparta::pipeViewer {
                                     } else {
                                         const auto& format_str = pairt.delimVector[i];
 
-                                        std::ios_base::fmtflags format_flags = std::ios::dec;
+                                        int base = 10;
                                         std::string_view fmt_prefix = "";
 
                                         if(format_str == PairFormatter::HEX) {
-                                            format_flags = std::ios::hex;
+                                            base = 16;
                                             fmt_prefix = "0x";
                                         }
                                         else if(format_str == PairFormatter::OCTAL) {
-                                            format_flags = std::ios::oct;
+                                            base = 8;
                                             fmt_prefix = "0";
                                         }
 
-                                        std::ostringstream int_str;
-                                        int_str << fmt_prefix;
-                                        int_str.setf(format_flags, std::ios::basefield);
-                                        int_str << int_value;
-                                        pairt.stringVector.emplace_back(int_str.str());
+                                        // Formatted without a stream, which would take the
+                                        // global locale lock for every value
+                                        char int_str[2 + std::numeric_limits<pair_t::IntT>::digits];
+                                        char* const digits = std::copy(fmt_prefix.begin(), fmt_prefix.end(), int_str);
+                                        const auto result = std::to_chars(digits, std::end(int_str), int_value, base);
+                                        pairt.stringVector.emplace_back(int_str, result.ptr);
                                     }
                                 }
                             }
                             else if(st.types[i] == 1){
                                 // Type 1 = string
                                 uint16_t annotationLength;
-                                record_file_.read(annotationLength);
-
-                                std::string annot_str(annotationLength, '\0');
-                                record_file_.read(annot_str.data(), annotationLength);
-                                pairt.stringVector.emplace_back(std::move(annot_str));
+                                readRecordData_(pos, annotationLength);
+                                pairt.stringVector.emplace_back(readRecordString_(pos, annotationLength));
 
                                 // This bool value describes if this field has a string-only value.
                                 // String only values are those values which are stored in database as
@@ -741,7 +854,7 @@ namespace sparta::pipeViewer {
 
                         READER_DBG_MSG("found pair. start: " << pairt.time_Start << " end: " << pairt.time_End);
 
-                        data_callback_->foundPairRecord(&pairt);
+                        data_callback.foundPairRecord(&pairt);
                     } break;
 
                     default:
@@ -753,8 +866,8 @@ namespace sparta::pipeViewer {
 
             inline void checkIndexUpdates_()
             {
-                const auto index_size = index_file_.size();
-                const auto record_size = record_file_.size();
+                const auto index_size = index_file_.sizeOnDisk();
+                const auto record_size = record_file_.sizeOnDisk();
 
                 if(index_size != size_of_index_file_ && record_size != size_of_record_file_)
                 {
@@ -765,8 +878,12 @@ namespace sparta::pipeViewer {
                         return;
                     }
 
-                    record_file_.reopen();
-                    index_file_.reopen();
+                    // Threads reading windows must not see the files
+                    // being remapped
+                    std::unique_lock<std::shared_mutex> lock(*mapping_mutex_);
+
+                    record_file_.remap();
+                    index_file_.remap();
                     map_file_.reopen();
                     data_file_.reopen();
 
@@ -794,13 +911,14 @@ namespace sparta::pipeViewer {
              */
             Reader(std::string filepath, std::unique_ptr<PipelineDataCallback>&& data_callback) :
                 filepath_(std::move(filepath)),
-                record_file_(filepath_ + "record.bin", std::fstream::in | std::fstream::binary ),
-                index_file_(filepath_ + "index.bin", std::fstream::in | std::fstream::binary),
+                record_file_(filepath_ + "record.bin"),
+                index_file_(filepath_ + "index.bin"),
                 map_file_(filepath_ + "map.dat", std::fstream::in),
                 data_file_(filepath_ + "data.dat", std::fstream::in),
                 string_file_(filepath_ + "string_map.dat", std::fstream::in),
                 display_file_(filepath_ + "display_format.dat", std::fstream::in),
                 data_callback_(std::move(data_callback)),
+                mapping_mutex_(std::make_unique<std::shared_mutex>()),
                 size_of_index_file_(0),
                 size_of_record_file_(0),
                 lowest_cycle_(0),
@@ -816,21 +934,19 @@ namespace sparta::pipeViewer {
                 READER_LOG_MSG("pipeViewer reader opened: " << record_file_.getFilename());
 
                 // Read header from index file
+                uint64_t index_pos = 0;
                 char header_buf[HEADER_SIZE];
-                index_file_.read(header_buf, HEADER_SIZE);
                 // Assuming older version until header proves otherwise
                 version_ = 1;
-                if(static_cast<size_t>(index_file_.gcount()) != HEADER_SIZE) {
+                if(!index_file_.read(index_pos, header_buf)) {
                     // Assume old version because the file is too small to have a header
-                    index_file_.clear(); // Clear error flags after failing to read enough data
-                    index_file_.seekg(0, std::ios::beg); // Restore
                 }
                 else if(HEADER_PREFIX.compare(0,
                                               HEADER_PREFIX.size(),
                                               header_buf,
                                               HEADER_PREFIX.size())) {
                     // Header prefix did not match. Assume old version
-                    index_file_.seekg(0, std::ios::beg); // Restore
+                    index_pos = 0; // Restore
                 }
                 else {
                     // Header prefix matched. Read version
@@ -841,19 +957,16 @@ namespace sparta::pipeViewer {
                               "pipeout file " << filepath_ << " determined to be format "
                               << version_ << " which is not known by this version of SPARTA. Version "
                               "expected to be in range [1, " << Outputter::FILE_VERSION << "]");
-                sparta_assert(index_file_.good(),
-                              "Finished reading index file header for " << filepath_ << " but "
-                              "ended up with non-good file handle somehow. This is a bug in the "
-                              "header-reading logic");
 
                 // Read the heartbeat size from our index file.
                 // This will be the first integer in the file except for the header if there is one
-                // Warning: this must be called while the index_file_ is already seeked to the
-                // start of file, which it is after opening.
-                index_file_.read(heartbeat_);
+                const bool read_heartbeat = index_file_.read(index_pos, heartbeat_);
+                sparta_assert(read_heartbeat,
+                              "Index file of pipeout database \"" << filepath_ << "\" ends "
+                              "before its heartbeat");
 
                 // Save the first index entry position
-                first_index_ = index_file_.tellg();
+                first_index_ = index_pos;
 
                 READER_LOG_MSG("Heartbeat is: " << heartbeat_);
 
@@ -862,11 +975,9 @@ namespace sparta::pipeViewer {
                               "would be too slow to actually load");
 
                 //Determine the size of our index file
-                index_file_.seekg(0, std::fstream::end);
-                size_of_index_file_ = index_file_.tellg();
+                size_of_index_file_ = index_file_.size();
                 //Determine the size of our record file.
-                record_file_.seekg(0, std::ios::end);
-                size_of_record_file_ = record_file_.tellg();
+                size_of_record_file_ = record_file_.size();
 
                 //cache the earliest start and stop of the record file
                 lowest_cycle_ = findCycleFirst_();
@@ -956,109 +1067,109 @@ namespace sparta::pipeViewer {
              * [3000, 5000)
              *
              * \warning start must be GREATER than end.
-             * \warning This method IS NOT thread safe.
+             * \warning This method IS NOT thread safe. Use the overload
+             * taking a callback to read windows from several threads.
              */
             inline void getWindow(const uint64_t start, const uint64_t end)
             {
-                READER_LOG_MSG("returning window. START: " << start << " END: " << end);
-                // sparta_assert(//start < end, "Cannot return a window where the start value is greater than the end value");
-
                 //Make sure the user is not abusing our NON thread safe method.
                 acquireLock_();
+                getWindow(start, end, *data_callback_);
+                //unlock our assertion test.
+                sparta_assert(lock_);
+                clearLock();
+            }
+
+            /**
+             * \brief Pass all of the transactions found in a given interval of
+             * cycles to \a data_callback instead of our own callback.
+             *
+             * The window is the same as for getWindow(start, end). Records
+             * are parsed in place from the mapped record file, so several
+             * threads may call this method at the same time as long as each
+             * one uses its own callback.
+             */
+            inline void getWindow(const uint64_t start,
+                                  const uint64_t end,
+                                  PipelineDataCallback& data_callback) const
+            {
+                READER_LOG_MSG("returning window. START: " << start << " END: " << end);
+
+                std::shared_lock<std::shared_mutex> lock(*mapping_mutex_);
+
                 //round the end up to the nearest interval.
                 const uint64_t chunk_end = roundUp_(end);
 
                 READER_LOG_MSG("end rounded to: " << chunk_end);
 
-                //First we will want to make sure we are ready to read at the correct
-                //position in the record file.
-                record_file_.seekg(findRecordReadPos_(start));
-
-                const auto read_pos = record_file_.tellg();
-                //what space does this interval span in the record file.
-                const std::fstream::pos_type full_data_size = findRecordReadPos_(chunk_end) - read_pos;
-                //Now start processing the chunk.
-                const std::fstream::pos_type end_pos = read_pos + full_data_size;
+                //What space does this interval span in the record file.
+                uint64_t read_pos = findRecordReadPos_(start);
+                const uint64_t end_pos = findRecordReadPos_(chunk_end);
 
                 READER_LOG_MSG("start_pos: " << read_pos << " end_pos: " << end_pos);
 
-                //Make sure we have not passed the end position, also make sure we
-                //are not at -1 bc that means we reached the end of the file!
                 //As we read records. Read each as a transaction.
-                //check the flags, seek back and then read it as the proper type,
+                //check the flags, then read it as the proper type,
                 //then pass the a pointer to the struct to the appropriate callback.
 
-
 #if READER_LOG == 1
-                READER_LOG_MSG("read " << std::dec << readRecords_<true>(end_pos, start, end) << " records");
+                READER_LOG_MSG("read " << std::dec
+                               << readRecords_<true>(read_pos, end_pos, start, end, data_callback)
+                               << " records");
 #else
-                readRecords_<false>(end_pos, start, end);
+                readRecords_<false>(read_pos, end_pos, start, end, data_callback);
 #endif
-                //unlock our assertion test.
-                sparta_assert(lock_);
-                clearLock();
             }
 
             /**
              * \brief Reads transactions afer each index in the entire file
              */
-            inline void dumpIndexTransactions() {
-                auto prev_cb = std::move(data_callback_);
-                try{
-                    uint64_t tick = 0;
-                    index_file_.seekg(0, std::ios::beg);
-                    while(tick <= getCycleLast() + (heartbeat_-1)){
-                        int64_t pos;
-
-                        // Set up a record checker to ensure all transactions fall
-                        // within the range being queried
-                        data_callback_ = std::make_unique<RecordChecker>(tick, tick + heartbeat_);
-
-                        pos = findRecordReadPos_(tick);
-
-                        std::cout << "Heartbeat at t=" << std::setw(10) <<  tick << " @ filepos " << std::setw(9)
-                                  << pos << " first transaction:" << std::endl;
-
-
-                        const uint64_t chunk_end = roundUp_(tick + heartbeat_);
-                        std::cout << "chunk end rounded to: " << chunk_end << std::endl
-                                  << "record file pos before: " << record_file_.tellg() << std::endl;
-                        record_file_.seekg(pos, std::ios::beg);
-                        const auto read_pos = record_file_.tellg();
-                        std::cout << "record file pos after:  " << read_pos << std::endl;
-                        if(read_pos == EOF) {
-                            std::cerr << "TellG says EOF!" << std::endl;
-                        }
-                        else {
-
-                            //what space does this interval span in the record file.
-                            const uint64_t full_data_size = findRecordReadPos_(chunk_end) - read_pos;
-
-                            //Now start processing the chunk.
-                            const int64_t end_pos = pos + full_data_size;
-                            std::cout << "pos = " << pos << ", end_pos = " << end_pos << std::endl;
-
+            inline void dumpIndexTransactions() const {
+                std::shared_lock<std::shared_mutex> lock(*mapping_mutex_);
+
+                uint64_t tick = 0;
+                uint64_t record_pos = 0;
+                uint64_t chunk_end = 0;
+                while(tick <= getCycleLast() + (heartbeat_-1)){
+                    // Set up a record checker to ensure all transactions fall
+                    // within the range being queried
+                    RecordChecker checker(tick, tick + heartbeat_);
+
+                    const uint64_t pos = findRecordReadPos_(tick);
+
+                    std::cout << "Heartbeat at t=" << std::setw(10) <<  tick << " @ filepos " << std::setw(9)
+                              << pos << " first transaction:" << std::endl;
+
+                    chunk_end = roundUp_(tick + heartbeat_);
+                    std::cout << "chunk end rounded to: " << chunk_end << std::endl
+                              << "record file pos before: " << record_pos << std::endl;
+                    record_pos = pos;
+                    std::cout << "record file pos after:  " << record_pos << std::endl;
+                    if(record_pos > record_file_.size()) {
+                        std::cerr << "Index entry is past the end of the record file!" << std::endl;
+                    }
+                    else {
+                        //what space does this interval span in the record file.
+                        const uint64_t end_pos = findRecordReadPos_(chunk_end);
+                        std::cout << "pos = " << pos << ", end_pos = " << end_pos << std::endl;
 
-                            const auto recsread = readRecords_<true>(end_pos, tick, chunk_end);
-                            std::cout << "Records: " << recsread << std::endl;
-                        }
-                        std::cout << "record file pos after read: " << record_file_.tellg() << std::endl;
-                        std::cout << "pos variable after read:    " << read_pos << std::endl;
-                        tick += heartbeat_;
-                        std::cout << "\n";
+                        const auto recsread = readRecords_<true>(record_pos, end_pos, tick, chunk_end, checker);
+                        std::cout << "Records: " << recsread << std::endl;
                     }
-                }catch(...){
-                    // Restore data callback before propogating exception
-                    data_callback_ = std::move(prev_cb);
-                    throw;
+                    std::cout << "record file pos after read: " << record_pos << std::endl;
+                    std::cout << "pos variable after read:    " << pos << std::endl;
+                    tick += heartbeat_;
+                    std::cout << "\n";
                 }
 
-                // Restore callback
-                data_callback_ = std::move(prev_cb);
-
-                if(uint64_t tmp; index_file_.read(tmp)) {
+                // Entries after the last one looked up
+                uint64_t index_pos = first_index_ + (chunk_end/heartbeat_ * sizeof(uint64_t));
+                if(static_cast<int64_t>(index_pos) < size_of_index_file_ - 8) {
+                    index_pos += sizeof(uint64_t);
+                }
+                if(uint64_t tmp; index_file_.read(index_pos, tmp)) {
                     std::cout << "Read junk at the end of the index file:\n  " << tmp;
-                    while(index_file_.read(tmp)) {
+                    while(index_file_.read(index_pos, tmp)) {
                         std::cout << "  " << tmp;
                     }
                 }
@@ -1127,13 +1238,14 @@ namespace sparta::pipeViewer {
 
         private:
             const std::string filepath_; /*!< Path to this file */
-            FileStream record_file_; /*!< The record file stream */
-            FileStream index_file_;  /*!< The index file stream */
+            MappedFile record_file_; /*!< The mapped record file */
+            MappedFile index_file_;  /*!< The mapped index file */
             ColonDelimitedFile map_file_;    /*!< The map file stream */
             ColonDelimitedFile data_file_;   /*!< The data file stream */
             ColonDelimitedFile string_file_; /*!< The string map file stream */
             ColonDelimitedFile display_file_;
             std::unique_ptr<PipelineDataCallback> data_callback_; /*<! A pointer to a callback to pass records too */
+            std::unique_ptr<std::shared_mutex> mapping_mutex_; /*!< Held exclusively while the files are remapped */
             uint64_t heartbeat_; /*!< The heartbeast-size in cycles of our indexes in the index file */
             uint64_t first_index_; /*!< Position in file of first index entry */
             uint32_t version_; /*!< Version of the file being read */
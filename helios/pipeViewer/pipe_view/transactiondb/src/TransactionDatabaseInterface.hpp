@@ -17,6 +17,9 @@
 #include <chrono>
 #include <functional>
 #include <list>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 #include <ctime>
 
 #include "TransactionInterval.hpp"
@@ -64,6 +67,25 @@ public:
      */
     static constexpr time_t DB_UPDATE_INTERVAL_S = 10;
 
+    /*!
+     * \brief How nodes store the transaction at each location and tick
+     */
+    enum class NodeLayout {
+        /*!
+         * \brief A row of num_locations transaction indices for every tick at which any
+         * location changes. Memory grows with the number of locations times the number of
+         * ticks with changes
+         */
+        TICK_DATA,
+
+        /*!
+         * \brief A sorted array of spans per location holding a transaction. Memory grows
+         * with the number of transactions only. Queries rebuild the row of a tick from the
+         * spans
+         */
+        COLUMNAR
+    };
+
 private:
 
     /*!
@@ -129,6 +151,25 @@ private:
             std::vector<interval_idx> data;
         };
 
+        /*!
+         * \brief Ticks [start, end), relative to the node start, during which a location
+         * holds a transaction (COLUMNAR layout)
+         */
+        struct Span {
+            uint32_t start;
+            uint32_t end;
+            interval_idx idx;
+        };
+
+        /*!
+         * \brief Transaction held by a location from a tick on (COLUMNAR layout)
+         */
+        struct Change {
+            uint32_t tick_offset;
+            uint32_t location;
+            interval_idx idx;
+        };
+
     private:
 
         /*!
@@ -141,14 +182,45 @@ private:
         const uint64_t start_inclusive;
         const uint64_t end_exclusive;
         const uint32_t num_locations;
+        const NodeLayout layout_;
         uint64_t transaction_bytes_; //!< Bytes used for transactions
         volatile bool complete_; //!< Has this node been completely populated
 
         /*!
-         * \brief Transaction pointers per location for each relevant tick
+         * \brief Transaction pointers per location for each relevant tick (TICK_DATA layout)
          */
         std::list<TickData> tick_content;
 
+        /*!
+         * \brief Spans of each location while the node is loading, sorted by tick (COLUMNAR
+         * layout). Moved into spans_ by markComplete
+         */
+        std::unordered_map<uint32_t, std::vector<Span>> loading_spans_;
+
+        /*!
+         * \brief Locations holding a transaction in this node, sorted (COLUMNAR layout)
+         */
+        std::vector<uint32_t> span_locations_;
+
+        /*!
+         * \brief Index in spans_ of the first span of each of span_locations_, followed by
+         * spans_.size() (COLUMNAR layout)
+         */
+        std::vector<uint32_t> span_begin_;
+
+        /*!
+         * \brief Spans of all locations, by location and then by tick (COLUMNAR layout)
+         */
+        std::vector<Span> spans_;
+
+        /*!
+         * \brief Every change of the transaction held by a location, by tick. Used to update
+         * rows while walking through ticks (COLUMNAR layout)
+         */
+        std::vector<Change> changes_;
+
+        uint64_t span_bytes_; //!< Bytes used for spans and changes (COLUMNAR layout)
+
         /*!
          * \brief How sparsely the node stores its content (e.g. how ticks are
          * skipped)
@@ -167,19 +239,132 @@ private:
          */
         mutable std::mutex loading_mutex_;
 
+        /*!
+         * \brief Place a transaction at a location for ticks [start, end) relative to the node
+         * start (COLUMNAR layout). It replaces any transaction added before at the same
+         * location and ticks
+         */
+        void addSpan_(const uint32_t location_ID,
+                      const uint32_t start,
+                      const uint32_t end,
+                      const interval_idx idx)
+        {
+            if(end <= start){
+                return; // Zero-length transactions are never shown
+            }
+
+            auto& spans = loading_spans_[location_ID];
+            if(spans.empty() || spans.back().end <= start){
+                // Transactions mostly arrive in order of their end ticks
+                spans.push_back({start, end, idx});
+                span_bytes_ += sizeof(Span);
+                return;
+            }
+
+            // First span ending after this one starts, and the first span starting after
+            // this one ends
+            const auto first = std::upper_bound(spans.begin(), spans.end(), start,
+                                                [](const uint32_t tick, const Span& s) { return tick < s.end; });
+            auto last = first;
+            while(last != spans.end() && last->start < end){
+                ++last;
+            }
+
+            // Keep the parts of overlapped spans outside of [start, end)
+            Span replacement[3];
+            uint32_t num_replacements = 0;
+            if(first != last){
+                overwrites++;
+                if(first->start < start){
+                    replacement[num_replacements++] = {first->start, start, first->idx};
+                }
+            }
+            replacement[num_replacements++] = {start, end, idx};
+            if(first != last && std::prev(last)->end > end){
+                replacement[num_replacements++] = {end, std::prev(last)->end, std::prev(last)->idx};
+            }
+
+            span_bytes_ -= (last - first) * sizeof(Span);
+            span_bytes_ += num_replacements * sizeof(Span);
+            const auto pos = spans.erase(first, last);
+            spans.insert(pos, replacement, replacement + num_replacements);
+        }
+
+        /*!
+         * \brief Move loading_spans_ into the sorted spans_ and build changes_ (COLUMNAR
+         * layout)
+         */
+        void compactSpans_()
+        {
+            size_t num_spans = 0;
+            span_locations_.reserve(loading_spans_.size());
+            for(const auto& column : loading_spans_){
+                span_locations_.push_back(column.first);
+                num_spans += column.second.size();
+            }
+            std::sort(span_locations_.begin(), span_locations_.end());
+
+            const uint64_t num_ticks = end_exclusive - start_inclusive;
+            span_begin_.reserve(span_locations_.size() + 1);
+            spans_.reserve(num_spans);
+            changes_.reserve(2 * num_spans);
+            for(const uint32_t loc : span_locations_){
+                const auto& column = loading_spans_[loc];
+                span_begin_.push_back(spans_.size());
+                for(size_t i = 0; i < column.size(); ++i){
+                    const Span& span = column[i];
+                    spans_.push_back(span);
+                    changes_.push_back({span.start, loc, span.idx});
+                    const bool followed = (i + 1 < column.size()) && (column[i + 1].start == span.end);
+                    if(span.end < num_ticks && !followed){
+                        changes_.push_back({span.end, loc, NO_TRANSACTION});
+                    }
+                }
+            }
+            span_begin_.push_back(spans_.size());
+            std::stable_sort(changes_.begin(), changes_.end(),
+                             [](const Change& a, const Change& b) { return a.tick_offset < b.tick_offset; });
+            changes_.shrink_to_fit();
+
+            std::unordered_map<uint32_t, std::vector<Span>>().swap(loading_spans_);
+            span_bytes_ = (span_locations_.capacity() + span_begin_.capacity()) * sizeof(uint32_t) +
+                spans_.capacity() * sizeof(Span) + changes_.capacity() * sizeof(Change);
+        }
+
+        /*!
+         * \brief Transaction held by span_locations_[loc_idx] at a tick offset (COLUMNAR
+         * layout)
+         */
+        interval_idx findSpan_(const size_t loc_idx, const uint64_t tick_offset) const
+        {
+            const auto begin = spans_.begin() + span_begin_[loc_idx];
+            const auto end = spans_.begin() + span_begin_[loc_idx + 1];
+            auto span = std::upper_bound(begin, end, tick_offset,
+                                         [](const uint64_t tick, const Span& s) { return tick < s.start; });
+            if(span == begin){
+                return NO_TRANSACTION;
+            }
+            --span;
+            return tick_offset < span->end ? span->idx : NO_TRANSACTION;
+        }
+
     public:
 
         /*!
          * \brief Constructor
          * \param num_locations Number of locations to support. Must be > 0
+         * \param layout How this node stores the transaction at each location and tick
          */
-        Node(const uint64_t start_inc, const uint64_t size, const uint32_t _num_locations) :
+        Node(const uint64_t start_inc, const uint64_t size, const uint32_t _num_locations,
+             const NodeLayout layout) :
             should_del_(false),
             start_inclusive(start_inc),
             end_exclusive(start_inc + size),
             num_locations(_num_locations),
+            layout_(layout),
             transaction_bytes_(0),
             complete_(false),
+            span_bytes_(0),
             sparseness(size),
             overwrites(0)
         {
@@ -187,11 +372,15 @@ private:
             loading_mutex_.lock();
             sparta_assert(num_locations > 0,
                               "A transaction database node requires a location count of 1 or more");
+            sparta_assert(layout_ != NodeLayout::COLUMNAR || size <= std::numeric_limits<uint32_t>::max(),
+                          "Nodes of " << size << " ticks cannot use the columnar layout");
             all_intervals_.reserve(512);
 
-            // Insert the first node at tick-offset = 0 so that there always data to walk.
-            tick_content.emplace_back(0, num_locations, nullptr, nullptr);
-            sparseness--;
+            if(layout_ == NodeLayout::TICK_DATA){
+                // Insert the first node at tick-offset = 0 so that there always data to walk.
+                tick_content.emplace_back(0, num_locations, nullptr, nullptr);
+                sparseness--;
+            }
         }
 
         /*!
@@ -233,6 +422,29 @@ private:
             uint32_t tick_entries = 0;
             const uint32_t real_loc_limit = std::min(num_locations,
                                                      location_end > 0 ? location_end : std::numeric_limits<uint32_t>::max());
+            if(layout_ == NodeLayout::COLUMNAR){
+                // One row per location with the spans of each transaction
+                for(size_t i = 0; i < span_locations_.size(); ++i){
+                    const uint32_t loc = span_locations_[i];
+                    if(loc < location_start || loc >= real_loc_limit){
+                        continue;
+                    }
+                    o << std::dec << std::setw(8) << loc << ": ";
+                    uint32_t span_entries = 0;
+                    for(uint32_t s = span_begin_[i]; s < span_begin_[i + 1]; ++s){
+                        if(tick_entry_limit != 0 && span_entries >= tick_entry_limit){
+                            o << "more...";
+                            break;
+                        }
+                        o << std::dec << '[' << spans_[s].start << ',' << spans_[s].end << ")="
+                          << std::hex << spans_[s].idx << ' ';
+                        span_entries++;
+                    }
+                    o << '\n';
+                }
+                dumpTransactions_(o);
+                return;
+            }
             o << std::setw(8) << "location: ";
             for(uint32_t loc = location_start; loc < real_loc_limit; ++loc){
                 o << std::dec << std::setw(4) << loc << ' ';
@@ -257,6 +469,13 @@ private:
                 o << "more...\n";
             }
 
+            dumpTransactions_(o);
+        }
+
+        /*!
+         * \brief Dumps the first transactions of this node
+         */
+        void dumpTransactions_(std::ostream& o) const {
             o << "Up to 20 transactions in location range\n";
             for(uint32_t tids = 0; tids < 20; ++tids){
                 if(tids >= all_intervals_.size()){
@@ -291,9 +510,17 @@ private:
             return sizeof(*this) +
                 //(end_exclusive - start_inclusive) * num_locations * sizeof(interval_idx) +
                 (tick_content.size() * (num_locations * sizeof(interval_idx) + sizeof(TickData))) +
+                span_bytes_ +
                 transaction_bytes_;
         }
 
+        /*!
+         * \brief How this node stores the transaction at each location and tick
+         */
+        NodeLayout getLayout() const {
+            return layout_;
+        }
+
         /*!
          * \brief Get low inclusive endpoint of this node
          */
@@ -313,6 +540,9 @@ private:
          * The thread that constructs this node must do this
          */
         void markComplete() {
+            if(layout_ == NodeLayout::COLUMNAR){
+                compactSpans_();
+            }
             complete_ = true;
             loading_mutex_.unlock();
         }
@@ -379,6 +609,11 @@ private:
             const uint64_t trans_end_exclusive = std::min<uint64_t>(transaction_exclusive_end, end_exclusive);
             const uint64_t end_entry_offset = trans_end_exclusive - start_inclusive;
 
+            if(layout_ == NodeLayout::COLUMNAR){
+                addSpan_(location_ID, start_cycle_offset, end_entry_offset, trans_pos);
+                return;
+            }
+
             // Insert the tick data
             static_assert(IS_TRANSACTION_END_INCLUSIVE == false,
                           "Some assumptions of the following routine assume exclusive endpoints");
@@ -556,8 +791,14 @@ private:
             if(false == complete_){
                 ss << " loading incomplete";
             }
-            ss << ' ' << "tdatas:" << tick_content.size();
-            ss << ' ' << "sparse:" << sparseness << "(" << std::setprecision(4) << 100.*float(sparseness)/(end_exclusive-start_inclusive) << "%)";
+            if(layout_ == NodeLayout::COLUMNAR){
+                ss << ' ' << "locs:" << span_locations_.size();
+                ss << ' ' << "spans:" << spans_.size();
+                ss << ' ' << "changes:" << changes_.size();
+            }else{
+                ss << ' ' << "tdatas:" << tick_content.size();
+                ss << ' ' << "sparse:" << sparseness << "(" << std::setprecision(4) << 100.*float(sparseness)/(end_exclusive-start_inclusive) << "%)";
+            }
             ss << ' ' << "overwr:" << overwrites;
             ss << ' ' << std::fixed << getSizeInBytes() / 1000000.0 << " MB>";
             return ss.str();
@@ -592,6 +833,8 @@ private:
          * construction.
          */
         std::list<TickData>::const_iterator getTickData(const uint64_t abstime) const {
+            sparta_assert(layout_ == NodeLayout::TICK_DATA,
+                          "Only nodes with the TICK_DATA layout have tick data");
             sparta_assert(abstime >= start_inclusive && abstime < end_exclusive,
                               "tick (" << abstime << ") being queried is not within range of node "
                               << stringize());
@@ -636,6 +879,103 @@ private:
         const std::vector<Transaction>& getIntervals() const {
             return all_intervals_;
         }
+
+        /*!
+         * \brief Gets the index in getIntervals of the transaction at a location and an
+         * absolute tick number, or NO_TRANSACTION
+         */
+        interval_idx getIntervalIdx(const uint32_t location, const uint64_t abstime) const {
+            sparta_assert(location < num_locations,
+                          "location " << location << " is not within the " << num_locations
+                          << " locations of node " << stringize());
+            if(layout_ == NodeLayout::TICK_DATA){
+                return getTickData(abstime)->data[location];
+            }
+
+            sparta_assert(abstime >= start_inclusive && abstime < end_exclusive,
+                          "tick (" << abstime << ") being queried is not within range of node "
+                          << stringize());
+            const auto loc_itr = std::lower_bound(span_locations_.begin(), span_locations_.end(), location);
+            if(loc_itr == span_locations_.end() || *loc_itr != location){
+                return NO_TRANSACTION;
+            }
+            return findSpan_(loc_itr - span_locations_.begin(), abstime - start_inclusive);
+        }
+
+        /*!
+         * \brief Calls cb(tick, row) for each absolute tick in [t, endpoint_exclusive) of
+         * this node
+         * \param row Buffer holding the rows of COLUMNAR nodes
+         * \param cb Callback given each tick and its row of num_locations indices into
+         * getIntervals, or nullptr if this node has no data at that tick
+         * \return The tick after the last callback
+         */
+        template<typename TickCallback>
+        uint64_t forEachTick(uint64_t t,
+                             const uint64_t endpoint_exclusive,
+                             std::vector<interval_idx>& row,
+                             TickCallback&& cb) const {
+            if(layout_ == NodeLayout::COLUMNAR){
+                // Find the row at t with a binary search per location, then update it
+                // with the changes at each following tick
+                const uint64_t first_offset = t - start_inclusive;
+                row.assign(num_locations, NO_TRANSACTION);
+                for(size_t i = 0; i < span_locations_.size(); ++i){
+                    row[span_locations_[i]] = findSpan_(i, first_offset);
+                }
+                auto change = std::upper_bound(changes_.begin(), changes_.end(), first_offset,
+                                               [](const uint64_t tick, const Change& c) { return tick < c.tick_offset; });
+                for(; t < endpoint_exclusive; ++t){
+                    const uint64_t tick_offset = t - start_inclusive;
+                    for(; change != changes_.end() && change->tick_offset <= tick_offset; ++change){
+                        row[change->location] = change->idx;
+                    }
+                    cb(t, row.data());
+                }
+                return t;
+            }
+
+            auto tick_itr = getTickData(t);
+            const auto tick_itr_end = getTickDataEnd();
+            sparta_assert(tick_itr != tick_itr_end);
+            const TickData* td = &(*tick_itr);
+            sparta_assert(td->tick_offset + start_inclusive <= t);
+            while(t < endpoint_exclusive && tick_itr != tick_itr_end){
+                if(t > tick_itr->tick_offset + start_inclusive){
+                    // Current callback tick has passed this tick iterator.
+                    tick_itr++;
+                }
+                if(tick_itr != tick_itr_end && tick_itr->tick_offset + start_inclusive <= t){
+                    // Current callback tick has caught up with the tick iterator. Point
+                    // "td" to the current iterator's TickData because it is at or before
+                    // the current callback time (t)
+                    td = &(*tick_itr);
+                }
+
+                // VERY SLOW SANITY CHECKING.
+                // Ensures all valid transactions for the current callback tick (t).
+                // Re-enable only for debugging.
+                //for(uint32_t loc = 0; loc < num_locations; loc++){
+                //    interval_idx idx = td->data[loc];
+                //    if(idx != NO_TRANSACTION){
+                //        const Transaction* trans = &all_intervals_[idx];
+                //        sparta_assert(trans->getLeft() <= t && trans->getRight() > t);
+                //    }
+                //}
+
+                cb(t, td->data.data());
+                ++t;
+            }
+
+            // Finish up callbacks with null data because there is no more tick data in this node
+            if(tick_itr == tick_itr_end){
+                while(t < endpoint_exclusive){
+                    cb(t, nullptr);
+                    ++t;
+                }
+            }
+            return t;
+        }
     };
 
 
@@ -833,6 +1173,13 @@ private:
 
     const uint32_t num_locations_; //!< Number of locations in the database
 
+    const NodeLayout node_layout_; //!< Layout of all nodes
+
+    /*!
+     * \brief Row given to query callbacks for ticks of COLUMNAR nodes
+     */
+    std::vector<interval_idx> query_row_;
+
     /*!
      * \brief Data nodes currently help in this class
      * \warning This must be a list type
@@ -922,13 +1269,16 @@ public:
      * \brief Constructor
      * \param file_prefix Path and prefix of database files
      * \param num_locations Number of locations in the tree
+     * \param node_layout How nodes store the transaction at each location and tick
      */
     TransactionDatabaseInterface(const std::string& file_prefix,
                                  const uint32_t num_locations,
-                                 const bool update_enabled = false) :
+                                 const bool update_enabled = false,
+                                 const NodeLayout node_layout = NodeLayout::TICK_DATA) :
         smart_reader_(file_prefix),
         file_prefix_(file_prefix),
         num_locations_(num_locations),
+        node_layout_(node_layout),
         in_query_(false),
         window_{0,0},
         last_query_{0,0},
@@ -1005,6 +1355,11 @@ public:
      */
     uint64_t getChunkSize() const { return chunk_size_; }
 
+    /*!
+     * \brief Gets how nodes store the transaction at each location and tick
+     */
+    NodeLayout getNodeLayout() const { return node_layout_; }
+
     /*!
      * \brief Resets any temporary query state.
      * \note this is mainly a debugging feature
@@ -1156,45 +1511,15 @@ public:
                     itr->getMutex().lock();
                 }
 
-                auto tick_itr = itr->getTickData(t);
-                const auto tick_itr_end = itr->getTickDataEnd();
-                sparta_assert(tick_itr != tick_itr_end);
-                const Node::TickData* td = &(*tick_itr);
-                sparta_assert(td->tick_offset + itr->getStartInclusive() <= t);
-                while(t < endpoint_exclusive && tick_itr != itr->getTickDataEnd()){
-                    if(t > tick_itr->tick_offset + itr->getStartInclusive()){
-                        // Current callback tick has passed this tick iterator.
-                        tick_itr++;
-                    }
-                    if(tick_itr != tick_itr_end && tick_itr->tick_offset + itr->getStartInclusive() <= t){
-                        // Current callback tick has caught up with the tick iterator. Point
-                        // "td" to the current iterator's TickData because it is at or before
-                        // the current callback time (t)
-                        td = &(*tick_itr);
-                    }
-
-                    // VERY SLOW SANITY CHECKING.
-                    // Ensures all valid transactions for the current callback tick (t).
-                    // Re-enable only for debugging.
-                    //for(uint32_t loc = 0; loc < num_locations_; loc++){
-                    //    interval_idx idx = td->data[loc];
-                    //    if(idx != NO_TRANSACTION){
-                    //        const Transaction* trans = &itr->getIntervals()[idx];
-                    //        sparta_assert(trans->getLeft() <= t && trans->getRight() > t);
-                    //    }
-                    //}
-
-                    cb(user_data, t, td->data.data(), &itr->getIntervals()[0], num_locations_);
-                    ++t;
-                }
-
-                // Finish up callbacks with null data because there is no more tick data in this node
-                if(tick_itr == itr->getTickDataEnd()){
-                    while(t < endpoint_exclusive){
-                        cb(user_data, t, nullptr, nullptr, 0);
-                        ++t;
-                    }
-                }
+                const Transaction* transactions = itr->getIntervals().data();
+                t = itr->forEachTick(t, endpoint_exclusive, query_row_,
+                                     [&](const uint64_t tick, const_interval_idx* row) {
+                                         if(row){
+                                             cb(user_data, tick, row, transactions, num_locations_);
+                                         }else{
+                                             cb(user_data, tick, nullptr, nullptr, 0);
+                                         }
+                                     });
 
                 itr->getMutex().unlock();
 
@@ -1273,6 +1598,28 @@ public:
         return window_.end;
     }
 
+    /*!
+     * \brief Get the transaction at a location and tick from the loaded nodes
+     * \return nullptr if there is no transaction there or no complete node holds the tick.
+     * Valid until the node is unloaded
+     * \pre Must not be called from within a query callback
+     */
+    const Transaction* getLoadedTransaction(const uint32_t location, const uint64_t tick) {
+        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+
+        const node_iterator_t itr = findNode(tick);
+        if(itr == nodes_.end() || itr->getStartInclusive() > tick || !itr->isComplete()){
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> node_lock(itr->getMutex());
+        const interval_idx idx = itr->getIntervalIdx(location, tick);
+        if(idx == NO_TRANSACTION){
+            return nullptr;
+        }
+        return &itr->getIntervals()[idx];
+    }
+
     uint32_t getFileVersion() const {
         return smart_reader_.reader.getVersion();
     }
@@ -1567,7 +1914,7 @@ private:
 
                         const node_iterator_t itr = findNode(load_node_pos);
 
-                        nodes_.emplace(itr, load_node_pos, node_size_, num_locations_);
+                        nodes_.emplace(itr, load_node_pos, node_size_, num_locations_, node_layout_);
                         Node& added = *std::prev(itr);
                         if(verbose_){
                             std::cout << "(background) inserting Node  @ " << load_node_pos << " size " << node_size_ << std::endl;
@@ -1724,7 +2071,7 @@ private:
                     // Assuming exclusive right endpoint of transactions
                     //nodes_.emplace(itr, Node(cur_pos, chunk_size_, num_locations_));
                     sparta_assert(cur_pos % node_size_ == 0);
-                    const auto new_itr = nodes_.emplace(itr, cur_pos, node_size_, num_locations_);
+                    const auto new_itr = nodes_.emplace(itr, cur_pos, node_size_, num_locations_, node_layout_);
                     added_nodes.push_back(&*(new_itr));
                     if(verbose_) {
                         std::cout << "(main)  Inserting Node  @ " << cur_pos << " size " << node_size_ << std::endl;
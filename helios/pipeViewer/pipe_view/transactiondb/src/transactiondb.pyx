@@ -22,8 +22,12 @@ cdef extern from "TransactionDatabaseInterface.hpp" namespace "sparta::pipeViewe
     ##                                    c_TransactionInterval_uint64_t* transactions, \
     ##                                    uint32_t content_len)
 
+    cdef enum c_NodeLayout "sparta::pipeViewer::TransactionDatabaseInterface::NodeLayout":
+        c_TICK_DATA "sparta::pipeViewer::TransactionDatabaseInterface::NodeLayout::TICK_DATA"
+        c_COLUMNAR "sparta::pipeViewer::TransactionDatabaseInterface::NodeLayout::COLUMNAR"
+
     cdef cppclass c_TransactionDatabaseInterface "sparta::pipeViewer::TransactionDatabaseInterface":
-        c_TransactionDatabaseInterface(string, uint32_t, bint) except +IOError # Can throw if file not opened
+        c_TransactionDatabaseInterface(string, uint32_t, bint, c_NodeLayout) except +IOError # Can throw if file not opened
 
         void unload()
         void resetQueryState()
@@ -46,6 +50,7 @@ cdef extern from "TransactionDatabaseInterface.hpp" namespace "sparta::pipeViewe
 
         uint32_t getNodeLength() # const
         uint64_t getChunkSize() # const
+        c_NodeLayout getNodeLayout() # const
 
         void setVerbose(bint verbose)
         bint getVerbose() # const
@@ -354,6 +359,12 @@ cdef class TransactionDatabase:
 
     OBJECT_DESTROYED_ERROR = 'Cannot operate on a TransactionDatabase once _destroy()\'ed'
 
+    # Names of the node layouts accepted by the constructor. 'tick_data' keeps
+    # a row of transactions for every tick with a change; 'columnar' keeps the
+    # spans of each location, using less memory for databases with many
+    # locations
+    NODE_LAYOUTS = ('tick_data', 'columnar')
+
     cdef c_TransactionDatabaseInterface * __window # C implementation. Freed at destruction
     cdef object __filename # Name of file/dir containing the transaction database
 
@@ -375,18 +386,22 @@ cdef class TransactionDatabase:
         self.__cached_annotations = {}
         self.__trans_proxy = Transaction(None, True) # Create a Proxy
 
-    def __init__(self, filename, num_locs, update_enabled):
+    def __init__(self, filename, num_locs, update_enabled, node_layout='tick_data'):
         """
         Create a c_TransactionDatabaseInterface* based on the chosen filename
+        and node layout (one of NODE_LAYOUTS)
         """
         if not isinstance(filename, (str, unicode)):
             raise TypeError('filename must be a str, is type {0}'.format(type(filename)))
+        if node_layout not in self.NODE_LAYOUTS:
+            raise ValueError('node_layout must be one of {0}, is {1}'.format(self.NODE_LAYOUTS, node_layout))
 
         self.__filename = filename
         cdef uint32_t c_num_locs = num_locs
         cdef char* c_str = <bytes><str>filename
         cdef string c_s = filename.encode('utf-8')
-        self.__window = new c_TransactionDatabaseInterface(c_s, num_locs, update_enabled)
+        cdef c_NodeLayout c_layout = c_COLUMNAR if node_layout == 'columnar' else c_TICK_DATA
+        self.__window = new c_TransactionDatabaseInterface(c_s, num_locs, update_enabled, c_layout)
 
     def __dealloc__(self):
         self._destroy()
@@ -455,6 +470,14 @@ cdef class TransactionDatabase:
 
         return self.__window.getChunkSize()
 
+    def getNodeLayout(self):
+        if self.__window == NULL:
+            raise RuntimeError(self.OBJECT_DESTROYED_ERROR)
+
+        if self.__window.getNodeLayout() == c_COLUMNAR:
+            return 'columnar'
+        return 'tick_data'
+
     def setVerbose(self, bint verbose):
         if self.__window == NULL:
             raise RuntimeError(self.OBJECT_DESTROYED_ERROR)
@@ -0,0 +1,906 @@
+// <TransactionSearch> -*- C++ -*-
+
+/**
+ * \file TransactionSearch.hpp
+ *
+ * \brief Searching the annotations of a transaction database, optionally through a saved index
+ * of the annotation tokens
+ */
+
+#pragma once
+
+#include "transactiondb/src/Reader.hpp"
+#include "transactiondb/src/PipelineDataCallback.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <regex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <sys/stat.h>
+
+namespace sparta {
+    namespace pipeViewer {
+
+        /*! \brief A search query and the test of annotation strings against it
+         */
+        class SearchQuery {
+            private:
+                /*! Search the query as a regular expression rather than as a substring */
+                const bool is_regex_;
+
+                /*! Invert search */
+                const bool invert_search_;
+
+                /*! Stores string query for comparison */
+                const std::string string_query_;
+
+                /*! Stores regular expression for comparison */
+                std::regex regular_expression_;
+
+                /*! A string that every match of the query contains. Empty if unknown */
+                std::string literal_;
+
+                /*!
+                 * \brief Index of the last character of the escape sequence at regex[start], which
+                 * is a backslash followed by a letter or digit: \xHH, \uHHHH, \cX, a back reference
+                 * of any number of digits, a name or property in braces (\N{...}, \p{...}) or a
+                 * single letter
+                 */
+                static size_t findEscapeEnd_(const std::string& regex, size_t start) {
+                    size_t end = start + 1;
+                    if(end >= regex.size()) {
+                        return regex.size() - 1;
+                    }
+
+                    const auto is_digit = [&](size_t idx) {
+                        return idx < regex.size() && std::isdigit(static_cast<unsigned char>(regex[idx]));
+                    };
+                    const auto skip_hex = [&](size_t count) {
+                        while(count-- > 0 && end + 1 < regex.size() &&
+                              std::isxdigit(static_cast<unsigned char>(regex[end + 1]))) {
+                            ++end;
+                        }
+                    };
+
+                    const char c = regex[end];
+                    if(std::isdigit(static_cast<unsigned char>(c))) {
+                        while(is_digit(end + 1)) {
+                            ++end;
+                        }
+                    }
+                    else if(c == 'x') {
+                        skip_hex(2);
+                    }
+                    else if(c == 'u') {
+                        skip_hex(4);
+                    }
+                    else if(c == 'c') {
+                        if(end + 1 < regex.size()) {
+                            ++end;
+                        }
+                    }
+                    else if(end + 1 < regex.size() && regex[end + 1] == '{') {
+                        const size_t close = regex.find('}', end + 1);
+                        end = (close == std::string::npos) ? regex.size() - 1 : close;
+                    }
+                    return end;
+                }
+
+            public:
+                /*!
+                 * \brief Find the longest string that every match of a regular expression must contain.
+                 *
+                 * Only literal characters outside of groups and character classes are considered, and
+                 * nothing is returned for expressions with alternatives. This is conservative: an
+                 * empty string only means that the annotation must be tested with the regex.
+                 */
+                static std::string findRequiredLiteral(const std::string& regex) {
+                    std::string longest;
+                    std::string current;
+                    uint32_t depth = 0;
+
+                    auto end_run = [&]() {
+                        if(current.size() > longest.size()) {
+                            longest = current;
+                        }
+                        current.clear();
+                    };
+
+                    for(size_t i = 0; i < regex.size(); ++i) {
+                        const char c = regex[i];
+                        bool is_literal = false;
+                        char literal = c;
+
+                        if(c == '|') {
+                            if(depth == 0) {
+                                return "";
+                            }
+                        }
+                        else if(c == '(') {
+                            ++depth;
+                            end_run();
+                        }
+                        else if(c == ')') {
+                            if(depth > 0) {
+                                --depth;
+                            }
+                        }
+                        else if(c == '[') {
+                            // Skip the character class. A ']' right after '[' or '[^' is literal
+                            size_t j = i + 1;
+                            if(j < regex.size() && regex[j] == '^') {
+                                ++j;
+                            }
+                            if(j < regex.size() && regex[j] == ']') {
+                                ++j;
+                            }
+                            while(j < regex.size() && regex[j] != ']') {
+                                j += (regex[j] == '\\') ? 2 : 1;
+                            }
+                            i = j;
+                            end_run();
+                        }
+                        else if(c == '\\') {
+                            // Escaped punctuation is literal. Escaped letters and digits are classes,
+                            // control characters, back references, etc.
+                            if(i + 1 < regex.size() && !std::isalnum(static_cast<unsigned char>(regex[i + 1]))) {
+                                is_literal = (depth == 0);
+                                literal = regex[i + 1];
+                                ++i;
+                            }
+                            else {
+                                i = findEscapeEnd_(regex, i);
+                                end_run();
+                            }
+                        }
+                        else if(std::strchr(".^$*+?{}", c) != nullptr) {
+                            end_run();
+                        }
+                        else {
+                            is_literal = (depth == 0);
+                        }
+
+                        if(!is_literal) {
+                            if(depth > 0) {
+                                end_run();
+                            }
+                            continue;
+                        }
+
+                        // A quantifier that allows zero repetitions makes the character optional
+                        const char next = (i + 1 < regex.size()) ? regex[i + 1] : '\0';
+                        if(next == '*' || next == '?' || next == '{') {
+                            end_run();
+                        }
+                        else {
+                            current += literal;
+                            if(next == '+') {
+                                end_run();
+                            }
+                        }
+                    }
+                    end_run();
+                    return longest;
+                }
+                SearchQuery(const char* type, std::string query, const char* invert_search_str) :
+                    is_regex_(strcmp(type, "regex") == 0),
+                    invert_search_(!!strtoull(invert_search_str, nullptr, 10)),
+                    string_query_(std::move(query))
+                {
+                    if(is_regex_) {
+                        regular_expression_ = std::regex(string_query_);
+                        literal_ = findRequiredLiteral(string_query_);
+                    }
+                    else {
+                        literal_ = string_query_;
+                    }
+                }
+
+                bool isInverted() const {
+                    return invert_search_;
+                }
+
+                /*!
+                 * \brief A string contained in every annotation that is a hit, or an empty string
+                 * if there is no such string
+                 */
+                std::string getRequiredLiteral() const {
+                    return invert_search_ ? std::string() : literal_;
+                }
+
+                /*!
+                 * \brief Is a non-empty annotation a hit.
+                 *
+                 * Annotations without the literal part of a regular expression are rejected
+                 * without running the regex
+                 */
+                bool matches(const std::string& annt_string) const {
+                    if(is_regex_) {
+                        if(!literal_.empty() && annt_string.find(literal_) == std::string::npos) {
+                            return invert_search_;
+                        }
+                        return (!invert_search_) == std::regex_search(annt_string, regular_expression_);
+                    }
+                    if(invert_search_) {
+                        // Inverted search for string keys is a FULL-STRING match
+                        return annt_string != string_query_;
+                    }
+                    return annt_string.find(string_query_) != std::string::npos;
+                }
+        };
+
+        /*! \brief Counts of the records seen by searches
+         */
+        struct SearchCounts {
+            uint64_t hits = 0;
+            uint64_t recs_viewed = 0;
+            uint64_t recs_with_annot = 0;
+            uint64_t recs_with_ins = 0;
+            uint64_t recs_with_mem = 0;
+            uint64_t recs_with_non_null_annot = 0;
+            uint64_t recs_with_pair = 0;
+
+            SearchCounts& operator+=(const SearchCounts& rhs) {
+                hits += rhs.hits;
+                recs_viewed += rhs.recs_viewed;
+                recs_with_annot += rhs.recs_with_annot;
+                recs_with_ins += rhs.recs_with_ins;
+                recs_with_mem += rhs.recs_with_mem;
+                recs_with_non_null_annot += rhs.recs_with_non_null_annot;
+                recs_with_pair += rhs.recs_with_pair;
+                return *this;
+            }
+        };
+
+        /*! \brief Tags and delimiters of the lines written to stdout
+         */
+        struct SearchOutput {
+            static constexpr char RESULT_TAG = 'r';
+            static constexpr char PROGRESS_TAG = 'p';
+            static constexpr char INFO_TAG = 'i';
+            static constexpr char START_DELIMITER = ':';
+        };
+
+        /*! \brief Callback that compares the annotations of one window of the search to a query
+         * and keeps the result lines to write
+         */
+        class SearchCallback : public PipelineDataCallback {
+            private:
+                const SearchQuery& query_;
+
+                /*! Location IDs to include in the search */
+                const std::set<uint32_t>& locations_;
+
+                const uint64_t search_start_;
+                const uint64_t search_end_;
+
+                /*! Result lines */
+                std::string results_;
+
+                SearchCounts counts_;
+
+                /*!
+                 * \brief Adds a result in the form:
+                 * "<result tag><start time>,<end time>@<location ID><annotation delimiter><annotation>\n"
+                 */
+                inline void addResult_(const transaction_t* transaction, const std::string& str) {
+                    results_ += SearchOutput::RESULT_TAG;
+                    results_ += std::to_string(transaction->time_Start);
+                    results_ += ',';
+                    results_ += std::to_string(transaction->time_End);
+                    results_ += '@';
+                    results_ += std::to_string(transaction->location_ID);
+                    results_ += SearchOutput::START_DELIMITER;
+
+                    for(auto c: str) {
+                        if(c == '\n' || c == '\r') {
+                            results_ += "\\n";
+                        }
+                        else {
+                            results_ += c;
+                        }
+                    }
+
+                    results_ += '\n';
+                }
+
+                inline bool isSearched_(const transaction_t* transaction) const {
+                    if (transaction->time_Start > search_end_ || transaction->time_End < search_start_) {
+                        return false;
+                    }
+                    return locations_.empty() || locations_.count(transaction->location_ID) != 0;
+                }
+
+                inline void search_(const transaction_t* transaction, const std::string& annt_string) {
+                    if (!annt_string.empty()) {
+                        ++counts_.recs_with_non_null_annot;
+                        if (query_.matches(annt_string)) {
+                            addResult_(transaction, annt_string);
+                            ++counts_.hits;
+                        }
+                    }
+                }
+
+            public:
+                SearchCallback(const SearchQuery& query,
+                               const std::set<uint32_t>& locations,
+                               const uint64_t search_start,
+                               const uint64_t search_end) :
+                    query_(query),
+                    locations_(locations),
+                    search_start_(search_start),
+                    search_end_(search_end)
+                {
+                }
+
+                const std::string& getResults() const {
+                    return results_;
+                }
+
+                const SearchCounts& getCounts() const {
+                    return counts_;
+                }
+
+                virtual void foundAnnotationRecord(const annotation_t* annotation) override {
+                    ++counts_.recs_viewed;
+                    ++counts_.recs_with_annot;
+                    if (isSearched_(annotation)) {
+                        search_(annotation, annotation->annt);
+                    }
+                }
+
+                virtual void foundInstRecord(const instruction_t*) override {
+                    ++counts_.recs_viewed;
+                    ++counts_.recs_with_ins;
+                }
+
+                virtual void foundMemRecord(const memoryoperation_t*) override {
+                    ++counts_.recs_viewed;
+                    ++counts_.recs_with_mem;
+                }
+
+                virtual void foundPairRecord(const pair_t* pair) override {
+                    ++counts_.recs_viewed;
+                    ++counts_.recs_with_pair;
+                    if (isSearched_(pair)) {
+                        search_(pair, formatPairAsAnnotation(pair));
+                    }
+                }
+        };
+
+        /*! \brief Annotation tokens: runs of letters, digits and underscores
+         */
+        struct SearchTokens {
+            static inline bool isTokenChar(const char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+            }
+
+            /*!
+             * \brief Calls func(begin, end) for every token of str
+             */
+            template<typename TokenFunc>
+            static inline void forEachToken(const std::string_view str, TokenFunc&& func) {
+                size_t pos = 0;
+                while(pos < str.size()) {
+                    if(!isTokenChar(str[pos])) {
+                        ++pos;
+                        continue;
+                    }
+                    const size_t begin = pos;
+                    while(pos < str.size() && isTokenChar(str[pos])) {
+                        ++pos;
+                    }
+                    func(begin, pos);
+                }
+            }
+        };
+
+        /*! \brief Callback that collects the tokens of every annotation in a window
+         */
+        class TokenCallback : public PipelineDataCallback {
+            private:
+                std::unordered_set<std::string> tokens_;
+
+                inline void addTokens_(const std::string& annt_string) {
+                    SearchTokens::forEachToken(annt_string, [&](const size_t begin, const size_t end) {
+                        tokens_.emplace(annt_string, begin, end - begin);
+                    });
+                }
+
+            public:
+                const std::unordered_set<std::string>& getTokens() const {
+                    return tokens_;
+                }
+
+                virtual void foundAnnotationRecord(const annotation_t* annotation) override {
+                    addTokens_(annotation->annt);
+                }
+
+                virtual void foundInstRecord(const instruction_t*) override {
+                }
+
+                virtual void foundMemRecord(const memoryoperation_t*) override {
+                }
+
+                virtual void foundPairRecord(const pair_t* pair) override {
+                    addTokens_(formatPairAsAnnotation(pair));
+                }
+        };
+
+        /*! \brief Size and modification time of the record file of a database, which identify the
+         * records a SearchIndex was built from
+         */
+        struct RecordFileStamp {
+            uint64_t size = 0;
+            uint64_t mtime_ns = 0;
+
+            /*!
+             * \brief Stamp of "<prefix>record.bin"
+             * \return false if the record file cannot be found
+             */
+            static bool get(const std::string& db_prefix, RecordFileStamp& stamp) {
+                struct stat stat_result;
+                const std::string record_filename = db_prefix + "record.bin";
+                if(stat(record_filename.c_str(), &stat_result) != 0) {
+                    return false;
+                }
+                stamp.size = stat_result.st_size;
+                stamp.mtime_ns = static_cast<uint64_t>(stat_result.st_mtim.tv_sec) * 1000000000ull +
+                                 stat_result.st_mtim.tv_nsec;
+                return true;
+            }
+
+            bool operator==(const RecordFileStamp& rhs) const {
+                return size == rhs.size && mtime_ns == rhs.mtime_ns;
+            }
+        };
+
+        /*! \brief Inverted index from annotation tokens to the blocks of the database containing them.
+         *
+         * A block is BLOCK_HEARTBEATS heartbeats of the database. The index is saved next to the
+         * database as "<prefix>search_index.bin" and used by later searches as long as the record
+         * file keeps its size and modification time. Searches for a string then only read the blocks
+         * that contain every token of the string.
+         *
+         * File layout: MAGIC, u32 VERSION, u64 ticks per block, u64 record file size, u64 record file
+         * modification time in nanoseconds, u64 number of tokens and, for every token in sorted order,
+         * u32 length, its characters, u32 number of blocks and the u32 block numbers in increasing
+         * order.
+         */
+        class SearchIndex {
+            public:
+                static constexpr char MAGIC[8] = {'T', 'S', 'I', 'N', 'D', 'E', 'X', '\0'};
+                static constexpr uint32_t VERSION = 2;
+                static constexpr uint64_t BLOCK_HEARTBEATS = 16;
+
+                using Blocks = std::vector<uint32_t>;
+
+                static std::string getFilename(const std::string& db_prefix) {
+                    return db_prefix + "search_index.bin";
+                }
+
+                SearchIndex(const uint64_t block_ticks, const RecordFileStamp& record_file) :
+                    block_ticks_(block_ticks),
+                    record_file_(record_file)
+                {
+                }
+
+                /*!
+                 * \brief Add the tokens of a block. Blocks must be added in increasing order
+                 */
+                void addBlock(const uint32_t block, const std::unordered_set<std::string>& tokens) {
+                    for(const auto& token : tokens) {
+                        auto& blocks = building_[token];
+                        if(blocks.empty() || blocks.back() != block) {
+                            blocks.push_back(block);
+                        }
+                    }
+                }
+
+                //! Sort the tokens once every block was added
+                void finalize() {
+                    tokens_.reserve(tokens_.size() + building_.size());
+                    for(auto& token : building_) {
+                        tokens_.emplace_back(token.first, std::move(token.second));
+                    }
+                    building_.clear();
+                    std::sort(tokens_.begin(), tokens_.end());
+                }
+
+                /*!
+                 * \brief Write the index through a temporary file, so that concurrent searches
+                 * never load a partial index
+                 * \return false if the file could not be written
+                 */
+                bool save(const std::string& filename) const {
+                    const std::string tmp_filename = filename + ".tmp";
+                    {
+                        std::ofstream out(tmp_filename, std::ios::binary | std::ios::trunc);
+                        if(!out) {
+                            return false;
+                        }
+                        auto write = [&](const auto& val) {
+                            out.write(reinterpret_cast<const char*>(&val), sizeof(val));
+                        };
+                        out.write(MAGIC, sizeof(MAGIC));
+                        write(VERSION);
+                        write(block_ticks_);
+                        write(record_file_.size);
+                        write(record_file_.mtime_ns);
+                        write(static_cast<uint64_t>(tokens_.size()));
+                        for(const auto& [token, blocks] : tokens_) {
+                            write(static_cast<uint32_t>(token.size()));
+                            out.write(token.data(), token.size());
+                            write(static_cast<uint32_t>(blocks.size()));
+                            out.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(uint32_t));
+                        }
+                        if(!out.flush()) {
+                            return false;
+                        }
+                    }
+                    return std::rename(tmp_filename.c_str(), filename.c_str()) == 0;
+                }
+
+                /*!
+                 * \brief Load an index written by save
+                 * \return nullptr if there is no index, it is malformed or it was built for another
+                 * block size or record file
+                 */
+                static std::unique_ptr<SearchIndex> load(const std::string& filename,
+                                                         const uint64_t block_ticks,
+                                                         const RecordFileStamp& record_file) {
+                    std::ifstream in(filename, std::ios::binary);
+                    if(!in) {
+                        return nullptr;
+                    }
+                    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                    size_t pos = 0;
+                    auto read = [&](auto& val) {
+                        if(data.size() - pos < sizeof(val)) {
+                            return false;
+                        }
+                        std::memcpy(&val, data.data() + pos, sizeof(val));
+                        pos += sizeof(val);
+                        return true;
+                    };
+
+                    char magic[sizeof(MAGIC)];
+                    uint32_t version;
+                    uint64_t file_block_ticks;
+                    RecordFileStamp file_record;
+                    uint64_t num_tokens;
+                    if(!read(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+                       !read(version) || version != VERSION ||
+                       !read(file_block_ticks) || file_block_ticks != block_ticks ||
+                       !read(file_record.size) || !read(file_record.mtime_ns) || !(file_record == record_file) ||
+                       !read(num_tokens)) {
+                        return nullptr;
+                    }
+
+                    auto index = std::make_unique<SearchIndex>(block_ticks, record_file);
+                    for(uint64_t i = 0; i < num_tokens; ++i) {
+                        uint32_t length;
+                        if(!read(length) || data.size() - pos < length) {
+                            return nullptr;
+                        }
+                        std::string token(data, pos, length);
+                        pos += length;
+                        uint32_t num_blocks;
+                        if(!read(num_blocks) || (data.size() - pos) / sizeof(uint32_t) < num_blocks) {
+                            return nullptr;
+                        }
+                        Blocks blocks(num_blocks);
+                        std::memcpy(blocks.data(), data.data() + pos, num_blocks * sizeof(uint32_t));
+                        pos += num_blocks * sizeof(uint32_t);
+                        index->tokens_.emplace_back(std::move(token), std::move(blocks));
+                    }
+                    return index;
+                }
+
+                uint64_t getBlockTicks() const {
+                    return block_ticks_;
+                }
+
+                /*!
+                 * \brief Blocks that may hold an annotation containing str, in increasing order
+                 * \return false if str has no tokens, in which case any block may hold it
+                 *
+                 * Tokens inside str must be tokens of the annotation. The first and last tokens of
+                 * str may be the end and the start of longer tokens.
+                 */
+                bool findBlocks(const std::string& str, Blocks& blocks) const {
+                    bool found_token = false;
+                    SearchTokens::forEachToken(str, [&](const size_t begin, const size_t end) {
+                        const std::string_view token(str.data() + begin, end - begin);
+                        const bool open_start = (begin == 0);
+                        const bool open_end = (end == str.size());
+
+                        Blocks token_blocks;
+                        auto add = [&](const Blocks& b) {
+                            token_blocks.insert(token_blocks.end(), b.begin(), b.end());
+                        };
+                        if(!open_start) {
+                            // Tokens equal to or starting with the token are adjacent in the sorted list
+                            auto it = std::lower_bound(tokens_.begin(), tokens_.end(), token,
+                                                       [](const auto& entry, const std::string_view t) {
+                                                           return std::string_view(entry.first) < t;
+                                                       });
+                            for(; it != tokens_.end() && std::string_view(it->first).substr(0, token.size()) == token; ++it) {
+                                if(open_end || it->first.size() == token.size()) {
+                                    add(it->second);
+                                }
+                            }
+                        }
+                        else {
+                            for(const auto& [candidate, b] : tokens_) {
+                                const std::string_view c(candidate);
+                                if(open_end ? (c.find(token) != std::string_view::npos)
+                                            : (c.size() >= token.size() && c.substr(c.size() - token.size()) == token)) {
+                                    add(b);
+                                }
+                            }
+                        }
+                        std::sort(token_blocks.begin(), token_blocks.end());
+                        token_blocks.erase(std::unique(token_blocks.begin(), token_blocks.end()), token_blocks.end());
+
+                        if(!found_token) {
+                            blocks = std::move(token_blocks);
+                            found_token = true;
+                        }
+                        else {
+                            Blocks both;
+                            std::set_intersection(blocks.begin(), blocks.end(),
+                                                  token_blocks.begin(), token_blocks.end(),
+                                                  std::back_inserter(both));
+                            blocks = std::move(both);
+                        }
+                    });
+                    return found_token;
+                }
+
+            private:
+                const uint64_t block_ticks_;
+                const RecordFileStamp record_file_;
+
+                /*! Blocks of every token, sorted by token */
+                std::vector<std::pair<std::string, Blocks>> tokens_;
+
+                /*! Blocks of every token while blocks are added */
+                std::unordered_map<std::string, Blocks> building_;
+        };
+
+        /*! \brief A window of the database read by one getWindow call of a search
+         */
+        struct SearchWindow {
+            uint64_t start;
+            uint64_t end;
+            uint32_t block; /*!< Block of SearchIndex::BLOCK_HEARTBEATS heartbeats holding the window */
+        };
+
+        /*!
+         * \brief Split the range [search_start, search_end] into one window per block of block_ticks.
+         * Reading every window reads the same records as reading the whole range with one
+         * getWindow call
+         * \param blocks If not null, only the windows of these blocks
+         */
+        inline std::vector<SearchWindow> splitSearchRange(const uint64_t search_start,
+                                                          const uint64_t search_end,
+                                                          const uint64_t heartbeat,
+                                                          const uint64_t block_ticks,
+                                                          const SearchIndex::Blocks* blocks = nullptr) {
+            std::vector<SearchWindow> windows;
+
+            // getWindow reads from the heartbeat holding the start to the heartbeat boundary at or
+            // after the end
+            const uint64_t read_start = search_start - search_start % heartbeat;
+            const uint64_t read_end = (search_end + heartbeat - 1) / heartbeat * heartbeat;
+            if(read_end <= read_start) {
+                windows.push_back({search_start, search_end, static_cast<uint32_t>(search_start / block_ticks)});
+                return windows;
+            }
+
+            auto add_block = [&](const uint64_t block) {
+                const uint64_t block_end = (block + 1) * block_ticks;
+                windows.push_back({std::max(search_start, block * block_ticks),
+                                   block_end >= read_end ? search_end : block_end,
+                                   static_cast<uint32_t>(block)});
+            };
+
+            const uint64_t first_block = read_start / block_ticks;
+            const uint64_t last_block = (read_end - 1) / block_ticks;
+            if(blocks) {
+                for(auto it = std::lower_bound(blocks->begin(), blocks->end(), first_block);
+                    it != blocks->end() && *it <= last_block; ++it) {
+                    add_block(*it);
+                }
+            }
+            else {
+                for(uint64_t block = first_block; block <= last_block; ++block) {
+                    add_block(block);
+                }
+            }
+            return windows;
+        }
+
+        /*!
+         * \brief Read windows of the database from several threads, each window with its own
+         * callback
+         * \param make_callback Returns a new callback for a window
+         * \param handle_window Called on the calling thread with each window and its callback, in
+         * window order, as soon as the window and every window before it were read
+         */
+        template<typename MakeCallback, typename HandleWindow>
+        void forEachWindow(const Reader& reader,
+                           const std::vector<SearchWindow>& windows,
+                           const uint32_t num_threads,
+                           MakeCallback&& make_callback,
+                           HandleWindow&& handle_window) {
+            using CallbackPtr = decltype(make_callback(windows.front()));
+
+            std::vector<CallbackPtr> callbacks(windows.size());
+            std::vector<bool> done(windows.size(), false);
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable window_done;
+            std::atomic<size_t> next_window(0);
+            std::atomic<bool> stop(false);
+
+            auto read_windows = [&]() {
+                for(size_t i = next_window++; i < windows.size() && !stop; i = next_window++) {
+                    try {
+                        auto callback = make_callback(windows[i]);
+                        reader.getWindow(windows[i].start, windows[i].end, *callback);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        callbacks[i] = std::move(callback);
+                        done[i] = true;
+                    }
+                    catch(...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if(!error) {
+                            error = std::current_exception();
+                        }
+                        stop = true;
+                    }
+                    window_done.notify_all();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for(uint32_t i = 0; i < num_threads; ++i) {
+                threads.emplace_back(read_windows);
+            }
+
+            try {
+                for(size_t i = 0; i < windows.size(); ++i) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    window_done.wait(lock, [&]() { return done[i] || error; });
+                    if(error) {
+                        break;
+                    }
+                    auto callback = std::move(callbacks[i]);
+                    lock.unlock();
+                    handle_window(windows[i], *callback);
+                }
+            }
+            catch(...) {
+                stop = true;
+                for(auto& thread : threads) {
+                    thread.join();
+                }
+                throw;
+            }
+
+            stop = true;
+            for(auto& thread : threads) {
+                thread.join();
+            }
+            if(error) {
+                std::rethrow_exception(error);
+            }
+        }
+        /*!
+         * \brief Load the search index of a database, building and saving it if there is none or it
+         * is out of date
+         * \param info Information lines are written to it
+         * \return nullptr if the record file of the database cannot be found
+         */
+        inline std::unique_ptr<SearchIndex> getSearchIndex(const Reader& reader,
+                                                           const std::string& db_prefix,
+                                                           const uint32_t num_threads,
+                                                           std::ostream& info) {
+            const uint64_t block_ticks = reader.getChunkSize() * SearchIndex::BLOCK_HEARTBEATS;
+            RecordFileStamp record_file;
+            if(!RecordFileStamp::get(db_prefix, record_file)) {
+                return nullptr;
+            }
+
+            const std::string filename = SearchIndex::getFilename(db_prefix);
+            if(auto index = SearchIndex::load(filename, block_ticks, record_file)) {
+                info << SearchOutput::INFO_TAG << "search index:  " << filename << std::endl;
+                return index;
+            }
+
+            auto index = std::make_unique<SearchIndex>(block_ticks, record_file);
+            const auto windows = splitSearchRange(0, reader.getCycleLast(), reader.getChunkSize(), block_ticks);
+            forEachWindow(reader, windows, num_threads,
+                          [](const SearchWindow&) {
+                              return std::make_unique<TokenCallback>();
+                          },
+                          [&](const SearchWindow& window, const TokenCallback& cb) {
+                              index->addBlock(window.block, cb.getTokens());
+                          });
+            index->finalize();
+
+            if(index->save(filename)) {
+                info << SearchOutput::INFO_TAG << "search index:  built " << filename << std::endl;
+            }
+            else {
+                info << SearchOutput::INFO_TAG << "search index:  built, but could not write " << filename << std::endl;
+            }
+            return index;
+        }
+
+        /*!
+         * \brief Windows read by a search of [search_start, search_end]
+         * \param index Search index of the database, or nullptr. Used if it can tell which blocks may
+         * hold the required literal of the query
+         * \param used_index Set to whether only the windows of the blocks found in index are returned
+         */
+        inline std::vector<SearchWindow> getSearchWindows(const Reader& reader,
+                                                          const SearchQuery& query,
+                                                          const uint64_t search_start,
+                                                          const uint64_t search_end,
+                                                          const SearchIndex* index,
+                                                          bool& used_index) {
+            const uint64_t block_ticks = reader.getChunkSize() * SearchIndex::BLOCK_HEARTBEATS;
+            const std::string literal = query.getRequiredLiteral();
+            SearchIndex::Blocks blocks;
+            used_index = index && !literal.empty() && index->findBlocks(literal, blocks);
+            return splitSearchRange(search_start, search_end, reader.getChunkSize(), block_ticks,
+                                    used_index ? &blocks : nullptr);
+        }
+
+        /*!
+         * \brief Search windows of the database from several threads
+         * \param results Result lines are written to it in window order, the same order as a search
+         * reading the whole range from one thread
+         * \param window_done Called with each window once its results were written
+         */
+        template<typename WindowDone>
+        SearchCounts searchWindows(const Reader& reader,
+                                   const SearchQuery& query,
+                                   const std::set<uint32_t>& locations,
+                                   const uint64_t search_start,
+                                   const uint64_t search_end,
+                                   const std::vector<SearchWindow>& windows,
+                                   const uint32_t num_threads,
+                                   std::ostream& results,
+                                   WindowDone&& window_done) {
+            SearchCounts counts;
+            forEachWindow(reader, windows, num_threads,
+                          [&](const SearchWindow&) {
+                              return std::make_unique<SearchCallback>(query, locations, search_start, search_end);
+                          },
+                          [&](const SearchWindow& window, const SearchCallback& cb) {
+                              results << cb.getResults();
+                              counts += cb.getCounts();
+                              window_done(window);
+                          });
+            return counts;
+        }
+    } //namespace pipeViewer
+} //namespace sparta
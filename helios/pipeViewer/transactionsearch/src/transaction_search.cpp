@@ -2,313 +2,53 @@
  */
 
 #include "transactiondb/src/Reader.hpp"
-#include "transactiondb/src/PipelineDataCallback.hpp"
+#include "TransactionSearch.hpp"
+#include <algorithm>
 #include <cstring>
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <set>
-#include <regex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
+/*!
+ * \brief Writes progress lines, at most NUMBER_OF_PROGRESS_UPDATES_ of them
+ */
+class SearchProgress {
+    private:
+        static constexpr uint64_t NUMBER_OF_PROGRESS_UPDATES_ = 50;
 
-namespace sparta {
-    namespace pipeViewer {
-
-        /*! \brief Base class for search callbacks that holds configuration parameters and common helper methods
-         */
-        class BaseSearchCallback : public PipelineDataCallback {
-            protected:
-                static constexpr char RESULT_TAG_ = 'r';
-                static constexpr char PROGRESS_TAG_ = 'p';
-                static constexpr char INFO_TAG_ = 'i';
-                static constexpr char START_DELIMITER_ = ':';
-                static constexpr uint64_t NUMBER_OF_PROGRESS_UPDATES_ = 50;
-
-                /*! Invert search */
-                const bool invert_search_;
-
-                /*! Location IDs to include in the search */
-                std::set<uint32_t> locations_;
-
-                /*! For update progress */
-                uint64_t last_step_number_ = 0;
-                uint64_t search_start_ = 0;
-                uint64_t search_end_ = 0;
-                uint64_t search_width_ = 0;
-                double search_update_stride_ = 0;
-
-                /*! Incremented by one every regular expression match */
-                uint64_t hits_ = 0;
-
-                uint64_t recs_viewed_ = 0;
-                uint64_t recs_with_annot_ = 0;
-                uint64_t recs_with_ins_ = 0;
-                uint64_t recs_with_mem_ = 0;
-                uint64_t recs_with_non_null_annot_ = 0;
-                uint64_t recs_with_pair_ = 0;
-
-                inline void handleProgressOutput_(const uint64_t current_time) {
-                    uint64_t step;
-                    if (search_update_stride_ != 0) {
-                        step = current_time / search_update_stride_;
-                    } else {
-                        // Step is small that the search doesn't really need progress indicators
-                        step = 100000000;
-                    }
-                    if (step > last_step_number_ && current_time > search_start_) {
-                        float fraction = (current_time - search_start_) / static_cast<float>(search_width_);
-                        std::cout << PROGRESS_TAG_ << fraction << std::endl;
-                        last_step_number_ = step;
-                    }
-                }
-
-                /*!
-                 * \brief Writes a result to stdout in the form:
-                 * "<result tag><start time>,<end time>@<location ID><annotation delimiter><annotation>\n"
-                 */
-                inline void handleResultOutput_(const uint64_t start_time,
-                                                const uint64_t end_time,
-                                                const uint64_t location_id,
-                                                const std::string& str) {
-                    std::cout << RESULT_TAG_
-                              << start_time << "," << end_time << "@" << location_id
-                              << START_DELIMITER_;
-
-                    if(!str.empty()) {
-                        for(auto c: str) {
-                            if(c == '\n' || c == '\r') {
-                                std::cout << "\\n";
-                            }
-                            else {
-                                std::cout << c;
-                            }
-                        }
-                    }
-
-                    std::cout << std::endl;
-                }
-
-                /*!
-                 * \brief Writes a result to stdout in the form:
-                 * "<result tag><start time>,<end time>@<location ID><annotation delimiter><annotation>\n"
-                 */
-                inline void handleResultOutput_(const annotation_t* annotation) {
-                    handleResultOutput_(annotation->time_Start,
-                                        annotation->time_End,
-                                        annotation->location_ID,
-                                        annotation->annt);
-                }
-
-                inline void handleResultOutput_(const pair_t* pairt, const std::string& formatted_pair) {
-                    handleResultOutput_(pairt->time_Start,
-                                        pairt->time_End,
-                                        pairt->location_ID,
-                                        formatted_pair);
-                }
-
-            public:
-                BaseSearchCallback(const char* invert_search_str, const char* location_str) :
-                    invert_search_(!!strtoull(invert_search_str, nullptr, 10))
-                {
-                    std::istringstream ss(location_str);
-                    uint32_t id;
-                    while (ss >> id) {
-                        locations_.insert(id);
-                        if (ss.peek() == ',') {
-                            ss.ignore();
-                        }
-                    }
-                }
-
-                void setSearchParams(const uint64_t search_start, const uint64_t search_end) {
-                    search_start_ = search_start;
-                    search_end_ = search_end;
-                    search_width_ = search_end - search_start;
-                    search_update_stride_ = double(search_width_) / NUMBER_OF_PROGRESS_UPDATES_;
-                }
-
-                void startProgress() const {
-                    std::cout << INFO_TAG_ << "search start:  " << search_start_ << std::endl
-                              << INFO_TAG_ << "search locs:   (" <<  locations_.size() << ") [";
-
-                    for (const auto& lid : locations_) {
-                        std::cout << lid << " ";
-                    }
-
-                    std::cout << "]" << std::endl
-                              << INFO_TAG_ << "search invert: " << invert_search_ << std::endl;
-                }
-
-                void finishedProgress() const {
-                    std::cout << PROGRESS_TAG_ << 1 << std::endl //finish off so progress bar doesn't hang
-                              << INFO_TAG_ << "Number of records: " << recs_viewed_ << std::endl
-                              << INFO_TAG_ << "Number of records with annotation: " << recs_with_annot_ << std::endl
-                              << INFO_TAG_ << "Number of records with instruction: " << recs_with_ins_ << std::endl
-                              << INFO_TAG_ << "Number of records with memory: " << recs_with_mem_ << std::endl
-                              << INFO_TAG_ << "Number of records  with pair: " << recs_with_pair_ << std::endl
-                              << INFO_TAG_ << "Number of non-null annotations (searched): " << recs_with_non_null_annot_ << std::endl
-                              << INFO_TAG_ << "Number of hits: " << hits_ << std::endl;
-                }
-        };
-
-        /*! \brief Callback that compares annotations to a string
-         */
-        class SearchStringCallback : public BaseSearchCallback {
-            private:
-                /*! Stores string query for comparison in callbacks */
-                std::string string_query_;
-
-            public:
-                SearchStringCallback(std::string query, const char* invert_search_str, const char* location_str) :
-                    BaseSearchCallback(invert_search_str, location_str),
-                    string_query_(std::move(query))
-                {
-                }
-
-                virtual void foundAnnotationRecord(const annotation_t* annotation) override {
-                    handleProgressOutput_(annotation->time_Start);
-                    ++recs_viewed_;
-                    ++recs_with_annot_;
-
-                    if (annotation->time_Start > search_end_ || annotation->time_End < search_start_) {
-                        return;
-                    }
-
-                    if (!locations_.empty() && locations_.count(annotation->location_ID) == 0) {
-                        return;
-                    }
-
-                    std::string_view annt_string(annotation->annt);
-                    if (!annt_string.empty()) {
-                        ++recs_with_non_null_annot_;
-                        if (invert_search_) {
-                            // Inverted search for string keys is a FULL-STRING match
-                            if (annt_string != string_query_) {
-                                handleResultOutput_(annotation);
-                                ++hits_;
-                            }
-                        }
-                        else {
-                            size_t position = annt_string.find(string_query_);
-                            if (position != std::string::npos) {
-                                handleResultOutput_(annotation);
-                                ++hits_;
-                            }
-                        }
-                    }
-                }
-
-                virtual void foundInstRecord(const instruction_t*) override {
-                    ++recs_viewed_;
-                    ++recs_with_ins_;
-                }
-
-                virtual void foundMemRecord(const memoryoperation_t*) override {
-                    ++recs_viewed_;
-                    ++recs_with_mem_;
-                }
-
-                virtual void foundPairRecord(const pair_t* pair) override {
-                    handleProgressOutput_(pair->time_Start);
-                    ++recs_viewed_;
-                    ++recs_with_pair_;
-
-                    if (pair->time_Start > search_end_ || pair->time_End < search_start_) {
-                        return;
-                    }
-
-                    if (!locations_.empty() && locations_.count(pair->location_ID) == 0) {
-                        return;
-                    }
-
-                    const auto annt_string = formatPairAsAnnotation(pair);
-                    if (!annt_string.empty()) {
-                        ++recs_with_non_null_annot_;
-                        if (invert_search_) {
-                            // Inverted search for string keys is a FULL-STRING match
-                            if (annt_string != string_query_) {
-                                handleResultOutput_(pair, annt_string);
-                                ++hits_;
-                            }
-                        }
-                        else {
-                            size_t position = annt_string.find(string_query_);
-                            if (position != std::string::npos) {
-                                handleResultOutput_(pair, annt_string);
-                                ++hits_;
-                            }
-                        }
-                    }
-                }
-        };
-
-        /*! \brief Callback that compares annotations to regex
-         */
-        class SearchRegexCallback : public BaseSearchCallback {
-            private:
-                /*! Stores regular expression for comparison in callbacks */
-                std::regex regular_expression_;
-
-            public:
-                SearchRegexCallback(const char* regex, const char* invert_search_str, const char* location_str) :
-                    BaseSearchCallback(invert_search_str, location_str),
-                    regular_expression_(regex)
-                {
-                }
-
-                virtual void foundAnnotationRecord(const annotation_t* annotation) override {
-                    handleProgressOutput_(annotation->time_Start);
-                    ++recs_viewed_;
-                    ++recs_with_annot_;
-                    if (!locations_.empty() && locations_.count(annotation->location_ID) == 0) {
-                        return;
-                    }
-                    if (annotation->time_Start > search_end_ || annotation->time_End < search_start_) {
-                        return;
-                    }
-                    if (!annotation->annt.empty()) {
-                        ++recs_with_non_null_annot_;
-                        if ((!invert_search_) == std::regex_search(annotation->annt, std::regex(regular_expression_))) {
-                            handleResultOutput_(annotation);
-                            ++hits_;
-                        }
-                    }
-                }
-
-                virtual void foundInstRecord(const instruction_t*) override {
-                    ++recs_viewed_;
-                    ++recs_with_ins_;
-                }
-
-                virtual void foundMemRecord(const memoryoperation_t*) override {
-                    ++recs_viewed_;
-                    ++recs_with_mem_;
-                }
-
-                virtual void foundPairRecord(const pair_t* pair) override {
-                    handleProgressOutput_(pair->time_Start);
-                    ++recs_viewed_;
-                    ++recs_with_pair_;
-
-                    if (pair->time_Start > search_end_ || pair->time_End < search_start_) {
-                        return;
-                    }
+        const uint64_t search_start_;
+        const uint64_t search_width_;
+        const double search_update_stride_;
+        uint64_t last_step_number_ = 0;
 
-                    if (!locations_.empty() && locations_.count(pair->location_ID) == 0) {
-                        return;
-                    }
+    public:
+        SearchProgress(const uint64_t search_start, const uint64_t search_end) :
+            search_start_(search_start),
+            search_width_(search_end - search_start),
+            search_update_stride_(double(search_width_) / NUMBER_OF_PROGRESS_UPDATES_)
+        {
+        }
 
-                    const auto annt_string = formatPairAsAnnotation(pair);
-                    if (!annt_string.empty()) {
-                        ++recs_with_non_null_annot_;
-                        if ((!invert_search_) == std::regex_search(annt_string, std::regex(regular_expression_))) {
-                            handleResultOutput_(pair, annt_string);
-                            ++hits_;
-                        }
-                    }
-                }
-        };
-    } //namespace pipeViewer
-} //namespace sparta
+        void update(const uint64_t current_time) {
+            uint64_t step;
+            if (search_update_stride_ != 0) {
+                step = current_time / search_update_stride_;
+            } else {
+                // Step is small that the search doesn't really need progress indicators
+                step = 100000000;
+            }
+            if (step > last_step_number_ && current_time > search_start_) {
+                const float fraction = std::min(1.0f, (current_time - search_start_) / static_cast<float>(search_width_));
+                std::cout << sparta::pipeViewer::SearchOutput::PROGRESS_TAG << fraction << std::endl;
+                last_step_number_ = step;
+            }
+        }
+};
 
 class ConstructReaderException : public std::exception {
     private:
@@ -326,19 +66,9 @@ class ConstructReaderException : public std::exception {
         }
 };
 
-static sparta::pipeViewer::Reader constructReader(char** argv) {
-    if (strcmp(argv[2], "string") == 0) {
-        return sparta::pipeViewer::Reader::construct<sparta::pipeViewer::SearchStringCallback>(argv[1],
-                                                                                               argv[3],
-                                                                                               argv[4],
-                                                                                               argv[7]);
-    }
-
-    if (strcmp(argv[2], "regex") == 0) {
-        return sparta::pipeViewer::Reader::construct<sparta::pipeViewer::SearchRegexCallback>(argv[1],
-                                                                                              argv[3],
-                                                                                              argv[4],
-                                                                                              argv[7]);
+static std::unique_ptr<sparta::pipeViewer::SearchQuery> constructQuery(char** argv) {
+    if (strcmp(argv[2], "string") == 0 || strcmp(argv[2], "regex") == 0) {
+        return std::make_unique<sparta::pipeViewer::SearchQuery>(argv[2], argv[3], argv[4]);
     }
 
     throw ConstructReaderException(argv[2]);
@@ -358,54 +88,127 @@ static sparta::pipeViewer::Reader constructReader(char** argv) {
  * \li 5: Search Start tick. -1 implies start of file
  * \li 6: Search End tick. -1 implies end of file
  * \li 7: Location filter. Comma-delimited list of location IDs. If empty, no filtering is done
+ *
+ * followed by the options
+ * \li --threads N: Number of threads reading the database. Defaults to the number of hardware
+ *     threads
+ * \li --index: Use the search index of the database (see SearchIndex), building it first if there
+ *     is none. Only non-inverted searches use the index
+ *
+ * The search range is read in blocks of heartbeats from several threads. Results are written in
+ * the same order as a search reading the range from one thread.
  */
 int main(int argc, char** argv) {
-    if (argc != 8) {
-        std::cout << "Usage: transactionsearch <transaction db> <string|regex> <query> <invert> <start tick> <end tick> <locations> " << std::endl;
+    if (argc < 8) {
+        std::cout << "Usage: transactionsearch <transaction db> <string|regex> <query> <invert> <start tick> <end tick> <locations> "
+                  << "[--threads N] [--index]" << std::endl;
         return 1;
     }
 
-    try {
-        sparta::pipeViewer::Reader reader = constructReader(argv);
-
-        uint64_t search_start;
-        uint64_t search_end;
-
-        int64_t tmp = std::strtoll(argv[5], nullptr, 10);
-        if (tmp < 0) {
-            search_start = reader.getCycleFirst();
+    uint32_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    bool use_index = false;
+    for (int i = 8; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
         }
-        else {
-            search_start = static_cast<uint64_t>(tmp);
-        }
-
-        tmp = std::strtoll(argv[6], nullptr, 10);
-        if (tmp < 0) {
-            search_end = reader.getCycleLast();
+        else if (strcmp(argv[i], "--index") == 0) {
+            use_index = true;
         }
         else {
-            search_end = static_cast<uint64_t>(tmp);
-        }
-
-        // Reject negative-length searches.
-        // Allow 0-length search or negative search if start is past eof-cycle
-        // because it is common for eof-cycle+1 to be used as search_start and
-        // end_cycle to be automatically computed as eof-cycle
-        if (search_start < reader.getCycleLast() && search_end < search_start) {
-            std::cerr << "negative search range [" << search_start << ", " << search_end << ")" << std::endl;
+            std::cerr << "unknown option " << argv[i] << std::endl;
             return 1;
         }
+    }
 
-        auto& cb = reader.getCallbackAs<sparta::pipeViewer::BaseSearchCallback>();
-        cb.setSearchParams(search_start, search_end);
-
-        cb.startProgress();
-        reader.getWindow(search_start, search_end);
-        cb.finishedProgress();
+    std::unique_ptr<sparta::pipeViewer::SearchQuery> query;
+    try {
+        query = constructQuery(argv);
     }
     catch(const ConstructReaderException& e) {
         std::cerr << e.what() << std::endl;
         return 1;
     }
+
+    using INFO = sparta::pipeViewer::SearchOutput;
+
+    const std::string db_prefix = argv[1];
+
+    std::set<uint32_t> locations;
+    {
+        std::istringstream ss(argv[7]);
+        uint32_t id;
+        while (ss >> id) {
+            locations.insert(id);
+            if (ss.peek() == ',') {
+                ss.ignore();
+            }
+        }
+    }
+
+    const auto reader = sparta::pipeViewer::Reader::construct<sparta::pipeViewer::TokenCallback>(db_prefix);
+
+    uint64_t search_start;
+    uint64_t search_end;
+
+    int64_t tmp = std::strtoll(argv[5], nullptr, 10);
+    if (tmp < 0) {
+        search_start = reader.getCycleFirst();
+    }
+    else {
+        search_start = static_cast<uint64_t>(tmp);
+    }
+
+    tmp = std::strtoll(argv[6], nullptr, 10);
+    if (tmp < 0) {
+        search_end = reader.getCycleLast();
+    }
+    else {
+        search_end = static_cast<uint64_t>(tmp);
+    }
+
+    // Reject negative-length searches.
+    // Allow 0-length search or negative search if start is past eof-cycle
+    // because it is common for eof-cycle+1 to be used as search_start and
+    // end_cycle to be automatically computed as eof-cycle
+    if (search_start < reader.getCycleLast() && search_end < search_start) {
+        std::cerr << "negative search range [" << search_start << ", " << search_end << ")" << std::endl;
+        return 1;
+    }
+
+    std::cout << INFO::INFO_TAG << "search start:  " << search_start << std::endl
+              << INFO::INFO_TAG << "search locs:   (" <<  locations.size() << ") [";
+    for (const auto& lid : locations) {
+        std::cout << lid << " ";
+    }
+    std::cout << "]" << std::endl
+              << INFO::INFO_TAG << "search invert: " << query->isInverted() << std::endl;
+
+    const std::string literal = query->getRequiredLiteral();
+    std::unique_ptr<sparta::pipeViewer::SearchIndex> index;
+    if (use_index && !literal.empty()) {
+        index = sparta::pipeViewer::getSearchIndex(reader, db_prefix, num_threads, std::cout);
+    }
+    bool used_index = false;
+    const auto windows = sparta::pipeViewer::getSearchWindows(reader, *query, search_start, search_end,
+                                                              index.get(), used_index);
+    if (used_index) {
+        std::cout << INFO::INFO_TAG << "search blocks: " << windows.size() << " with \"" << literal << "\"" << std::endl;
+    }
+
+    SearchProgress progress(search_start, search_end);
+    const auto counts = sparta::pipeViewer::searchWindows(reader, *query, locations, search_start, search_end,
+                                                          windows, num_threads, std::cout,
+                                                          [&](const sparta::pipeViewer::SearchWindow& window) {
+                                                              progress.update(window.end);
+                                                          });
+
+    std::cout << INFO::PROGRESS_TAG << 1 << std::endl //finish off so progress bar doesn't hang
+              << INFO::INFO_TAG << "Number of records: " << counts.recs_viewed << std::endl
+              << INFO::INFO_TAG << "Number of records with annotation: " << counts.recs_with_annot << std::endl
+              << INFO::INFO_TAG << "Number of records with instruction: " << counts.recs_with_ins << std::endl
+              << INFO::INFO_TAG << "Number of records with memory: " << counts.recs_with_mem << std::endl
+              << INFO::INFO_TAG << "Number of records  with pair: " << counts.recs_with_pair << std::endl
+              << INFO::INFO_TAG << "Number of non-null annotations (searched): " << counts.recs_with_non_null_annot << std::endl
+              << INFO::INFO_TAG << "Number of hits: " << counts.hits << std::endl;
     return 0;
 }
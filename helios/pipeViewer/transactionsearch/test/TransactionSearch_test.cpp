@@ -0,0 +1,336 @@
+// <TransactionSearch_test> -*- C++ -*-
+
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "sparta/utils/SpartaTester.hpp"
+
+#include "sparta/collection/Collectable.hpp"
+#include "sparta/collection/PipelineCollector.hpp"
+
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/simulation/ClockManager.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/StartupEvent.hpp"
+#include "sparta/pairs/SpartaKeyPairs.hpp"
+
+#include "transactiondb/src/Reader.hpp"
+#include "TransactionSearch.hpp"
+
+/*!
+ * \file TransactionSearch_test.cpp
+ * \brief Searching a transaction database as transactionsearch does
+ *
+ * Collects a database of pairs and annotations and searches it with
+ * string, regex and inverted queries over several ranges and locations.
+ * Searching from one thread, from several threads and through the search
+ * index must give the same results, in the same order, as a single
+ * getWindow over the whole range.  The search index must be reused until
+ * the record file changes.  Also checks the literals found in regular
+ * expressions, which decide whether the index can be used.
+ */
+
+TEST_INIT;
+
+namespace
+{
+    constexpr uint64_t NUM_CYCLES = 20000;
+    constexpr uint64_t HEARTBEAT = 100;
+    constexpr uint32_t NUM_THREADS = 4;
+    const char * const DB_PREFIX = "searchPipe";
+
+    const char * const MNEMONICS[] = {"add", "sub", "lw", "sw", "beq", "jal", "mul", "div"};
+
+    class InstPairDef;
+    class Inst
+    {
+    public:
+        using SpartaPairDefinitionType = InstPairDef;
+
+        enum class Unit : std::uint8_t {
+            ALU,
+            LSU
+        };
+
+        explicit Inst(uint64_t uid) :
+            uid_(uid),
+            pc_(0x80000000 + uid * 4),
+            mnemonic_(MNEMONICS[uid % 8]),
+            unit_(static_cast<Unit>(uid % 2))
+        { }
+
+        uint64_t getUid() const { return uid_; }
+        uint64_t getPC() const { return pc_; }
+        std::string getMnemonic() const { return mnemonic_; }
+        const Unit & getUnit() const { return unit_; }
+
+    private:
+        uint64_t uid_;
+        uint64_t pc_;
+        std::string mnemonic_;
+        Unit unit_;
+    };
+
+    inline std::ostream & operator<<(std::ostream & os, const Inst::Unit & unit) {
+        return os << (unit == Inst::Unit::ALU ? "ALU" : "LSU");
+    }
+
+    class InstPairDef : public sparta::PairDefinition<Inst>
+    {
+    public:
+        InstPairDef() : sparta::PairDefinition<Inst>()
+        {
+            addPair("uid", &Inst::getUid);
+            addPair("pc", &Inst::getPC, std::ios::hex);
+            addPair("mnemonic", &Inst::getMnemonic);
+            addPair("unit", &Inst::getUnit);
+        }
+    };
+
+    //! Retires an instruction every cycle. Rare events are annotated, so
+    //! that most blocks of the database do not hold them
+    class Core : public sparta::TreeNode
+    {
+    public:
+        explicit Core(sparta::TreeNode * parent) :
+            sparta::TreeNode(parent, "core0", "A core retiring an instruction every cycle"),
+            retire_(this, "retire"),
+            event_(this, "event"),
+            es_(this),
+            ev_retire_(&es_, "retire", CREATE_SPARTA_HANDLER(Core, retire_inst_))
+        {
+            sparta::StartupEvent(this, CREATE_SPARTA_HANDLER(Core, startup_));
+        }
+
+    private:
+        void startup_() {
+            ev_retire_.schedule(1);
+        }
+
+        void retire_inst_() {
+            retire_.collectWithDuration(Inst(uid_), uid_ % 3 + 1);
+            if(uid_ % 4000 == 1234) {
+                event_.collect("flush_pipeline after " + std::to_string(uid_));
+            }
+            else if(uid_ % 7 == 0) {
+                event_.collect("stall lsu " + std::to_string(uid_ % 50));
+            }
+            ++uid_;
+            ev_retire_.schedule(1);
+        }
+
+        sparta::collection::Collectable<Inst> retire_;
+        sparta::collection::Collectable<std::string> event_;
+        sparta::EventSet es_;
+        sparta::Event<sparta::SchedulingPhase::Update> ev_retire_;
+        uint64_t uid_ = 0;
+    };
+
+    //! Result lines and counts of a search
+    struct SearchResult
+    {
+        std::string results;
+        sparta::pipeViewer::SearchCounts counts;
+    };
+
+    //! Search as transactionsearch did before searches were split in windows
+    SearchResult searchOneWindow(const sparta::pipeViewer::Reader & reader,
+                                 const sparta::pipeViewer::SearchQuery & query,
+                                 const std::set<uint32_t> & locations,
+                                 uint64_t start, uint64_t end)
+    {
+        sparta::pipeViewer::SearchCallback cb(query, locations, start, end);
+        reader.getWindow(start, end, cb);
+        return {cb.getResults(), cb.getCounts()};
+    }
+
+    SearchResult search(const sparta::pipeViewer::Reader & reader,
+                        const sparta::pipeViewer::SearchQuery & query,
+                        const std::set<uint32_t> & locations,
+                        uint64_t start, uint64_t end,
+                        uint32_t num_threads,
+                        const sparta::pipeViewer::SearchIndex * index)
+    {
+        bool used_index = false;
+        const auto windows = sparta::pipeViewer::getSearchWindows(reader, query, start, end, index, used_index);
+        std::ostringstream results;
+        SearchResult result;
+        result.counts = sparta::pipeViewer::searchWindows(reader, query, locations, start, end, windows,
+                                                          num_threads, results,
+                                                          [](const sparta::pipeViewer::SearchWindow &) {});
+        result.results = results.str();
+        return result;
+    }
+
+    //! Number of result lines
+    uint64_t countLines(const std::string & results)
+    {
+        uint64_t lines = 0;
+        for(const char c : results) {
+            lines += (c == '\n');
+        }
+        return lines;
+    }
+}
+
+void collectDatabase()
+{
+    sparta::Scheduler sched;
+    sparta::ClockManager cm(&sched);
+    sparta::RootTreeNode root_node("root");
+    sparta::Clock::Handle root_clk = cm.makeRoot(&root_node, "root_clk");
+    cm.normalize();
+    root_node.setClock(root_clk.get());
+
+    Core core(&root_node);
+
+    root_node.enterConfiguring();
+    root_node.enterFinalized();
+
+    sparta::collection::PipelineCollector pc(DB_PREFIX, HEARTBEAT, root_clk.get(), &root_node);
+
+    sched.finalize();
+    pc.startCollection(&root_node);
+    sched.run(NUM_CYCLES);
+    pc.stopCollection(&root_node);
+    pc.destroy();
+
+    root_node.enterTeardown();
+}
+
+void testRequiredLiterals()
+{
+    const std::pair<const char*, const char*> cases[] = {
+        {"fetch", "fetch"},
+        {"uop fetch.*", "uop fetch"},
+        {"ld\\.w+ r1", "ld.w"},
+        {"a|b", ""},
+        {"(ld|st) x", " x"},
+        {"[abc]def", "def"},
+        {"\\d+ready", "ready"},
+        {"\\x41BCD", "BCD"},
+        {"\\u0041BC", "BC"},
+        {"\\cJabc", "abc"},
+        {"(a)(b)(c)(d)(e)(f)(g)(h)(i)(j)\\10xyz", "xyz"},
+        {"\\N{DIGIT ONE}23", "23"},
+        {"\\x4", ""},
+        {"abc\\", "abc"},
+    };
+    for(const auto & c : cases) {
+        EXPECT_EQUAL(sparta::pipeViewer::SearchQuery::findRequiredLiteral(c.first), c.second);
+    }
+    const sparta::pipeViewer::SearchQuery query("regex", "uop fetch.*", "0");
+    EXPECT_EQUAL(query.getRequiredLiteral(), "uop fetch");
+
+    // Inverted searches match annotations without the literal
+    const sparta::pipeViewer::SearchQuery inverted("regex", "fetch", "1");
+    EXPECT_EQUAL(inverted.getRequiredLiteral(), "");
+}
+
+void testSameResults()
+{
+    const auto reader = sparta::pipeViewer::Reader::construct<sparta::pipeViewer::TokenCallback>(DB_PREFIX);
+    std::remove(sparta::pipeViewer::SearchIndex::getFilename(DB_PREFIX).c_str());
+    std::ostringstream info;
+    const auto index = sparta::pipeViewer::getSearchIndex(reader, DB_PREFIX, NUM_THREADS, info);
+    EXPECT_TRUE(index != nullptr);
+
+    const std::vector<std::pair<const char*, const char*>> queries = {
+        {"string", "flush_pipeline"},
+        {"string", "lsu 4"},
+        {"string", "mnemonic(beq)"},
+        {"string", "not in the database"},
+        {"regex", "flush_pipeline after [0-9]+234"},
+        {"regex", "stall|flush"},
+        {"regex", "^stall lsu 1[0-9]$"},
+    };
+    const std::vector<std::pair<uint64_t, uint64_t>> ranges = {
+        {reader.getCycleFirst(), reader.getCycleLast()},
+        {0, 5 * HEARTBEAT},
+        {1234, 17777},
+        {NUM_CYCLES / 2, NUM_CYCLES / 2},
+    };
+
+    // The location of the annotations, and others
+    const sparta::pipeViewer::SearchQuery stall("string", "stall", "0");
+    const std::string stalls = searchOneWindow(reader, stall, {}, reader.getCycleFirst(), reader.getCycleLast()).results;
+    EXPECT_NOTEQUAL(stalls.find('@'), std::string::npos);
+    const uint32_t event_location = std::stoul(stalls.substr(stalls.find('@') + 1));
+    const std::vector<std::set<uint32_t>> location_sets = {{}, {event_location}, {0, event_location + 1}};
+
+    uint64_t num_hits = 0;
+    for(const auto & [type, query_str] : queries) {
+        for(const char * invert : {"0", "1"}) {
+            const sparta::pipeViewer::SearchQuery query(type, query_str, invert);
+            for(const auto & [start, end] : ranges) {
+                for(const auto & locations : location_sets) {
+                    const SearchResult expected = searchOneWindow(reader, query, locations, start, end);
+                    const SearchResult single = search(reader, query, locations, start, end, 1, nullptr);
+                    const SearchResult threaded = search(reader, query, locations, start, end, NUM_THREADS, nullptr);
+                    const SearchResult indexed = search(reader, query, locations, start, end, NUM_THREADS, index.get());
+
+                    EXPECT_EQUAL(countLines(expected.results), expected.counts.hits);
+                    EXPECT_TRUE(single.results == expected.results);
+                    EXPECT_TRUE(threaded.results == expected.results);
+                    EXPECT_TRUE(indexed.results == expected.results);
+                    EXPECT_EQUAL(single.counts.hits, expected.counts.hits);
+                    EXPECT_EQUAL(threaded.counts.hits, expected.counts.hits);
+                    EXPECT_EQUAL(indexed.counts.hits, expected.counts.hits);
+                    EXPECT_EQUAL(single.counts.recs_viewed, expected.counts.recs_viewed);
+                    EXPECT_EQUAL(threaded.counts.recs_viewed, expected.counts.recs_viewed);
+                    num_hits += expected.counts.hits;
+                }
+            }
+        }
+    }
+    EXPECT_TRUE(num_hits > 0);
+
+    // The index only reads the few blocks with a rare annotation
+    const sparta::pipeViewer::SearchQuery rare("string", "flush_pipeline", "0");
+    bool used_index = false;
+    const auto windows = sparta::pipeViewer::getSearchWindows(reader, rare, reader.getCycleFirst(),
+                                                              reader.getCycleLast(), index.get(), used_index);
+    EXPECT_TRUE(used_index);
+    EXPECT_EQUAL(windows.size(), NUM_CYCLES / 4000);
+}
+
+void testIndexInvalidation()
+{
+    const auto reader = sparta::pipeViewer::Reader::construct<sparta::pipeViewer::TokenCallback>(DB_PREFIX);
+    const std::string record_filename = std::string(DB_PREFIX) + "record.bin";
+    std::remove(sparta::pipeViewer::SearchIndex::getFilename(DB_PREFIX).c_str());
+
+    std::ostringstream built, loaded, rebuilt;
+    EXPECT_TRUE(sparta::pipeViewer::getSearchIndex(reader, DB_PREFIX, NUM_THREADS, built) != nullptr);
+    EXPECT_NOTEQUAL(built.str().find("built"), std::string::npos);
+    EXPECT_TRUE(sparta::pipeViewer::getSearchIndex(reader, DB_PREFIX, NUM_THREADS, loaded) != nullptr);
+    EXPECT_EQUAL(loaded.str().find("built"), std::string::npos);
+
+    // A record file rewritten with the same size has a new modification time
+    struct stat stat_result;
+    EXPECT_EQUAL(stat(record_filename.c_str(), &stat_result), 0);
+    struct timespec times[2] = {stat_result.st_atim, stat_result.st_mtim};
+    times[1].tv_sec -= 60;
+    EXPECT_EQUAL(utimensat(AT_FDCWD, record_filename.c_str(), times, 0), 0);
+    EXPECT_TRUE(sparta::pipeViewer::getSearchIndex(reader, DB_PREFIX, NUM_THREADS, rebuilt) != nullptr);
+    EXPECT_NOTEQUAL(rebuilt.str().find("built"), std::string::npos);
+}
+
+int main()
+{
+    collectDatabase();
+    testRequiredLiterals();
+    testSameResults();
+    testIndexInvalidation();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,163 @@
+// <BitMatrixLRUReplacement.hpp> -*- C++ -*-
+
+//!
+//! \file BitMatrixLRUReplacement.hpp
+//! \brief Provides a true LRU implementation using a bit matrix
+//!
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "ReplacementIF.hpp"
+
+namespace sparta::cache
+{
+    // This class models true LRU with an N x N bit matrix, one 64-bit row per way. Bit j of row i
+    // is set when way i was used more recently than way j. Touching way w as MRU sets row w and
+    // clears column w; touching it as LRU does the opposite. The LRU way is the one whose row is
+    // empty and the MRU way is the one whose row is full. Every operation is a handful of word
+    // operations over at most 64 rows with no pointer chasing, unlike the list-based
+    // LRUReplacement. The initial order matches LRUReplacement: way 0 is LRU and way N-1 is MRU.
+    //
+    // The way_order flavors consider only the ways in way_order: the LRU/MRU way among them is
+    // the one whose row, restricted to those ways, is empty/full.
+    class BitMatrixLRUReplacement : public ReplacementIF
+    {
+      public:
+        static constexpr uint32_t MAX_NUM_WAYS = 64;
+
+        explicit BitMatrixLRUReplacement(const uint32_t num_ways) :
+            ReplacementIF(num_ways),
+            all_ways_((num_ways == 64) ? ~uint64_t(0) : ((uint64_t(1) << num_ways) - 1))
+        {
+            sparta_assert(num_ways <= MAX_NUM_WAYS,
+                          "BitMatrixLRUReplacement supports up to " << MAX_NUM_WAYS << " ways");
+            BitMatrixLRUReplacement::reset();
+        }
+
+        void reset() override
+        {
+            // Way i is more recent than every way below it
+            for (uint32_t i = 0; i < num_ways_; ++i)
+            {
+                rows_[i] = (uint64_t(1) << i) - 1;
+            }
+        }
+
+        ReplacementIF* clone() const override
+        {
+            return new BitMatrixLRUReplacement(num_ways_);
+        }
+
+        void touchLRU(uint32_t way) override
+        {
+            sparta_assert(way < num_ways_);
+            const uint64_t way_bit = uint64_t(1) << way;
+            for (uint32_t i = 0; i < num_ways_; ++i)
+            {
+                rows_[i] |= way_bit;
+            }
+            rows_[way] = 0;
+        }
+
+        void touchLRU(uint32_t way, const std::vector<uint32_t> & way_order) override
+        {
+            sparta_assert((orderMask_(way_order) >> way) & 1, "Way " << way << " is not in way_order");
+            touchLRU(way);
+        }
+
+        void touchMRU(uint32_t way) override
+        {
+            sparta_assert(way < num_ways_);
+            const uint64_t way_bit = uint64_t(1) << way;
+            if (rows_[way] == (all_ways_ & ~way_bit)) {
+                return; // Already MRU (repeated hits)
+            }
+            for (uint32_t i = 0; i < num_ways_; ++i)
+            {
+                rows_[i] &= ~way_bit;
+            }
+            rows_[way] = all_ways_ & ~way_bit;
+        }
+
+        void touchMRU(uint32_t way, const std::vector<uint32_t> & way_order) override
+        {
+            sparta_assert((orderMask_(way_order) >> way) & 1, "Way " << way << " is not in way_order");
+            touchMRU(way);
+        }
+
+        uint32_t getLRUWay() const override
+        {
+            for (uint32_t i = 0; i < num_ways_; ++i)
+            {
+                if (rows_[i] == 0) {
+                    return i;
+                }
+            }
+            sparta_assert(false, "LRU bit matrix is inconsistent");
+            return 0;
+        }
+
+        uint32_t getLRUWay(const std::vector<uint32_t> & way_order) override
+        {
+            const uint64_t mask = orderMask_(way_order);
+            for (auto i : way_order)
+            {
+                if ((rows_[i] & mask) == 0) {
+                    return i;
+                }
+            }
+            sparta_assert(false, "LRU bit matrix is inconsistent");
+            return 0;
+        }
+
+        uint32_t getMRUWay() const override
+        {
+            for (uint32_t i = 0; i < num_ways_; ++i)
+            {
+                if (rows_[i] == (all_ways_ & ~(uint64_t(1) << i))) {
+                    return i;
+                }
+            }
+            sparta_assert(false, "LRU bit matrix is inconsistent");
+            return 0;
+        }
+
+        uint32_t getMRUWay(const std::vector<uint32_t> & way_order) override
+        {
+            const uint64_t mask = orderMask_(way_order);
+            for (auto i : way_order)
+            {
+                if ((rows_[i] & mask) == (mask & ~(uint64_t(1) << i))) {
+                    return i;
+                }
+            }
+            sparta_assert(false, "LRU bit matrix is inconsistent");
+            return 0;
+        }
+
+        void lockWay(uint32_t way) override
+        {
+            sparta_assert(way < num_ways_);
+            sparta_assert(false, "Not implemented");
+        }
+
+      private:
+        uint64_t orderMask_(const std::vector<uint32_t> & way_order) const
+        {
+            sparta_assert(!way_order.empty(), "way_order passed is empty");
+            uint64_t mask = 0;
+            for (auto i : way_order)
+            {
+                sparta_assert(i < num_ways_);
+                mask |= uint64_t(1) << i;
+            }
+            return mask;
+        }
+
+        const uint64_t all_ways_;
+        std::array<uint64_t, MAX_NUM_WAYS> rows_{};
+    };
+} // namespace sparta::cache
@@ -0,0 +1,346 @@
+
+#pragma once
+
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+#include "sparta/utils/MathUtils.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+#include "cache/BasicCacheItem.hpp"
+#include "cache/ReplacementIF.hpp"
+#include "cache/AddrDecoderIF.hpp"
+
+namespace sparta
+{
+
+    namespace cache {
+
+        // A cache set with the same interface as BasicCacheSet that
+        // keeps a packed copy of every way's tag and valid bit
+        // (structure-of-arrays) next to the items themselves.  Tag
+        // lookups compare the packed tags several ways at a time
+        // (AVX2 or SSE4.1 when the compiler targets them, otherwise a
+        // branch-free loop the compiler can vectorize) and produce a
+        // bitmask of hits.
+        //
+        // Usage:
+        //     Cache<LineT, PackedCacheSet<LineT>> cache(...);
+        //
+        // The items stay authoritative.  Every way handed out by
+        // reference (getItem, getItemAtWay, getLRUItem,
+        // getItemForReplacement, begin/end...) is marked unsynced, and
+        // the next lookup in the set (getItem, peekItem,
+        // findInvalidWay, hasOpenWay...) refreshes the packed copy of
+        // the unsynced ways before comparing tags.  A lookup therefore
+        // only reads the items handed out since the previous one.
+        //
+        // An item changed through a reference kept across a later
+        // lookup in the same set is not seen until it is handed out
+        // again or updateWay() is called for its way.
+        //
+        // Sets are limited to 64 ways.
+        template <class CacheItemT>
+        class PackedCacheSet
+        {
+        public:
+            typedef typename std::vector<CacheItemT>::iterator iterator;
+            typedef typename std::vector<CacheItemT>::const_iterator const_iterator;
+
+            static constexpr uint32_t MAX_NUM_WAYS = 64;
+
+            // constructor
+            PackedCacheSet( uint32_t set_idx,
+                            uint32_t num_ways,
+                            const CacheItemT &default_line,
+                            const AddrDecoderIF *addr_decoder,
+                            const ReplacementIF &rep) :
+                set_idx_(set_idx),
+                num_ways_( num_ways )
+            {
+                sparta_assert(num_ways > 0 && num_ways <= MAX_NUM_WAYS,
+                              "PackedCacheSet supports 1 to " << MAX_NUM_WAYS
+                              << " ways, not " << num_ways);
+                replacement_policy_ = rep.clone();
+
+                ways_.resize(num_ways, default_line);
+
+                for (uint32_t i=0; i<num_ways; ++i) {
+                    ways_[i].setSetIndex(set_idx_);
+                    ways_[i].setWayNum(i);
+                    ways_[i].setAddrDecoder(addr_decoder);
+                }
+
+                // Pad the tags to a whole number of vector compares.
+                // Padding ways are never valid.
+                tags_.resize((num_ways_ + TAGS_PER_COMPARE - 1) & ~(TAGS_PER_COMPARE - 1), 0);
+                all_ways_ = (num_ways_ == 64) ? ~uint64_t(0) : ((uint64_t(1) << num_ways_) - 1);
+                updateAllWays();
+            }
+
+            // copy constructor
+            PackedCacheSet(const PackedCacheSet &rhs) :
+                set_idx_(rhs.set_idx_),
+                num_ways_(rhs.num_ways_),
+                replacement_policy_(rhs.replacement_policy_->clone()),
+                ways_(rhs.ways_),
+                tags_(rhs.tags_),
+                valid_(rhs.valid_),
+                unsynced_ways_(rhs.unsynced_ways_),
+                all_ways_(rhs.all_ways_)
+            {
+            }
+
+            // assignment operator
+            PackedCacheSet<CacheItemT> &operator=(const PackedCacheSet<CacheItemT> &rhs)
+            {
+                if ( this != &rhs ) {
+                    set_idx_  = rhs.set_idx_;
+                    num_ways_ = rhs.num_ways_;
+                    delete replacement_policy_;
+                    replacement_policy_ = rhs.replacement_policy_->clone();
+                    ways_  = rhs.ways_;
+                    tags_  = rhs.tags_;
+                    valid_ = rhs.valid_;
+                    unsynced_ways_ = rhs.unsynced_ways_;
+                    all_ways_ = rhs.all_ways_;
+                }
+
+                return *this;
+            }
+
+            ~PackedCacheSet()
+            {
+                delete replacement_policy_;
+            }
+
+            // Get the set's set-index
+            uint32_t getSetIndex() const { return set_idx_; }
+
+            // Set the address decoder
+            void setAddrDecoder(const AddrDecoderIF *addr_decoder)
+            {
+                for (uint32_t i=0; i<num_ways_; ++i) {
+                    ways_[i].setAddrDecoder(addr_decoder);
+                }
+            }
+
+            // Get the replacement policy
+            // Use this method when the set's replacement policy is to be updated
+            ReplacementIF *getReplacementIF()
+            {
+                return replacement_policy_;
+            }
+
+            // Refresh the packed tag and valid bit of the given way
+            // from its item now.  Only needed for items changed
+            // through a reference kept across a lookup.
+            void updateWay(uint32_t way_idx)
+            {
+                assert(way_idx < num_ways_);
+                syncWay_(way_idx);
+            }
+
+            // Refresh the packed tags and valid bits of every way
+            void updateAllWays()
+            {
+                for (uint32_t i=0; i<num_ways_; ++i) {
+                    updateWay(i);
+                }
+            }
+
+            // Get the const pointer to the item in the cache set given
+            // the tag.  If no valid item with matching tag is found
+            // nullptr is returned.
+            const CacheItemT *peekItem(uint64_t tag) const
+            {
+                const uint64_t hits = findHits_(tag);
+                return (hits != 0) ? &ways_[utils::log2_lsb(hits)] : nullptr;
+            }
+
+            // Get the pointer to the item in the cache set given
+            // the tag.  If no valid item with matching tag is found
+            // nullptr is returned.
+            CacheItemT *getItem(uint64_t tag)
+            {
+                const uint64_t hits = findHits_(tag);
+                return (hits != 0) ? &handOut_(utils::log2_lsb(hits)) : nullptr;
+            }
+
+            // Similar to previous const version of getItem, except that this flavor
+            // also determines (for misses) whether it was cold i.e. cache had invalid line(s)
+            CacheItemT *getItem(uint64_t tag, bool &is_cold_miss)
+            {
+                CacheItemT *line = getItem(tag);
+                is_cold_miss = (line == nullptr) && hasOpenWay();
+                return line;
+            }
+
+            const CacheItemT &peekItemAtWay(uint32_t way_idx) const
+            {
+                assert(way_idx < num_ways_);
+                return ways_[way_idx];
+            }
+
+            CacheItemT &getItemAtWay(uint32_t way_idx)
+            {
+                assert(way_idx < num_ways_);
+                return handOut_(way_idx);
+            }
+
+            // Get the reference to the LRU cache item.  See
+            // BasicCacheSet::getLRUItem for usage
+            CacheItemT &getLRUItem()
+            {
+                uint32_t victim_way = replacement_policy_->getLRUWay();
+                return handOut_(victim_way);
+            }
+
+            const CacheItemT &peekLRUItem() const
+            {
+                uint32_t victim_way = replacement_policy_->getLRUWay();
+                return ways_[victim_way];
+            }
+
+            // XXX this method is deprecated
+            CacheItemT &getItemForReplacement()
+            {
+                return getItemForReplacementWithInvalidCheck();
+            }
+
+            CacheItemT &getItemForReplacementWithInvalidCheck()
+            {
+                // First Select from invalid items.  Pick the first item found
+                uint32_t victim_way = findInvalidWay();
+
+                if (victim_way >= num_ways_) {
+                    victim_way = replacement_policy_->getLRUWay();
+                }
+
+                return handOut_(victim_way);
+            }
+
+            uint32_t findInvalidWay() const
+            {
+                syncWays_();
+                const uint64_t invalid = ~valid_ & all_ways_;
+                return (invalid != 0) ? utils::log2_lsb(invalid) : num_ways_;
+            }
+
+            /**
+            * Search for invalid in user-defined way order.
+            */
+            uint32_t findInvalidWay(const std::vector<uint32_t> &way_order) const
+            {
+                sparta_assert(!way_order.empty(), "way_order passed is empty");
+
+                syncWays_();
+                for ( auto i:way_order ) {
+                    if ( (valid_ & (uint64_t(1) << i)) == 0 ) {
+                        return i;
+                    }
+                }
+                return num_ways_;
+            }
+
+            /**
+             * Determine if the cache set has any open ways.
+             */
+            bool hasOpenWay() const
+            {
+                syncWays_();
+                return valid_ != all_ways_;
+            }
+
+            // Iterating over mutable items marks every way unsynced
+            iterator       begin() { unsynced_ways_ = all_ways_; return ways_.begin(); }
+            iterator       end()   { unsynced_ways_ = all_ways_; return ways_.end(); }
+            const_iterator begin() const { return ways_.begin(); }
+            const_iterator end()   const { return ways_.end(); }
+        protected:
+#if defined(__AVX2__)
+            static constexpr uint32_t TAGS_PER_COMPARE = 4;
+#elif defined(__SSE4_1__)
+            static constexpr uint32_t TAGS_PER_COMPARE = 2;
+#else
+            static constexpr uint32_t TAGS_PER_COMPARE = 4;
+#endif
+
+            // Refresh the packed tag and valid bit of a way from its item
+            void syncWay_(uint32_t way_idx) const
+            {
+                const CacheItemT &item = ways_[way_idx];
+                tags_[way_idx] = item.getTag();
+                const uint64_t way_bit = uint64_t(1) << way_idx;
+                valid_ = item.isValid() ? (valid_ | way_bit) : (valid_ & ~way_bit);
+                unsynced_ways_ &= ~way_bit;
+            }
+
+            // Refresh the packed copy of every way handed out since
+            // the last lookup
+            void syncWays_() const
+            {
+                while (unsynced_ways_ != 0) {
+                    syncWay_(utils::log2_lsb(unsynced_ways_));
+                }
+            }
+
+            // Hand out a way's item by reference, which may change it
+            CacheItemT &handOut_(uint32_t way_idx)
+            {
+                unsynced_ways_ |= uint64_t(1) << way_idx;
+                return ways_[way_idx];
+            }
+
+            // Bitmask of the valid ways whose tag matches
+            uint64_t findHits_(uint64_t tag) const
+            {
+                syncWays_();
+                uint64_t hits = 0;
+                const uint32_t num_tags = tags_.size();
+                const uint64_t * tags = tags_.data();
+#if defined(__AVX2__)
+                const __m256i key = _mm256_set1_epi64x(static_cast<long long>(tag));
+                for (uint32_t i=0; i<num_tags; i+=4) {
+                    const __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+                    const __m256d eq = _mm256_castsi256_pd(_mm256_cmpeq_epi64(t, key));
+                    hits |= uint64_t(_mm256_movemask_pd(eq)) << i;
+                }
+#elif defined(__SSE4_1__)
+                const __m128i key = _mm_set1_epi64x(static_cast<long long>(tag));
+                for (uint32_t i=0; i<num_tags; i+=2) {
+                    const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+                    const __m128d eq = _mm_castsi128_pd(_mm_cmpeq_epi64(t, key));
+                    hits |= uint64_t(_mm_movemask_pd(eq)) << i;
+                }
+#else
+                for (uint32_t i=0; i<num_tags; ++i) {
+                    hits |= uint64_t(tags[i] == tag) << i;
+                }
+#endif
+                return hits & valid_;
+            }
+
+            uint32_t          set_idx_;
+            uint32_t          num_ways_;
+            ReplacementIF    *replacement_policy_;
+            std::vector<CacheItemT> ways_;
+
+            // Packed tags, one per way plus padding.  Mutable so that
+            // const lookups can refresh them
+            mutable std::vector<uint64_t> tags_;
+
+            // Bit i is set when way i is valid
+            mutable uint64_t  valid_ = 0;
+
+            // Bit i is set when way i was handed out by reference
+            // since its packed tag and valid bit were last refreshed
+            mutable uint64_t  unsynced_ways_ = 0;
+
+            // Bit i is set for every way i in the set
+            uint64_t          all_ways_ = 0;
+        }; // class PackedCacheSet
+
+    } // namespace cache
+
+} // namespace sparta
@@ -455,6 +455,12 @@ public:
      */
     std::string warnings_file{""};
 
+    /*!
+     * Write log files from a background thread in large blocks instead of
+     * flushing each message
+     */
+    bool async_logging = false;
+
     /*!
      * During simulation configuring, dump the contents of the DAG
      */
@@ -134,6 +134,18 @@ public:
     };
 
 private:
+    /// Where the value of a statistic is found in the ReportSnapshots of
+    /// a descriptor's reports
+    struct SnapshotIndex
+    {
+        uint32_t report;    // Index in simdb_stat_reports_, or NO_REPORT
+        uint32_t index;     // Index in that report's snapshot
+    };
+
+    static constexpr uint32_t NO_REPORT = ~uint32_t(0);
+
+    void indexSnapshots_(const ReportDescriptor* desc);
+
     void writeReportInfo_(const ReportDescriptor* desc);
 
     void writeReportInfo_(const ReportDescriptor* desc,
@@ -149,6 +161,8 @@ private:
     std::unordered_map<const ReportDescriptor*, std::vector<int>> descriptor_report_style_ids_;
     std::unordered_map<const ReportDescriptor*, std::vector<int>> descriptor_report_meta_ids_;
     std::unordered_map<const ReportDescriptor*, std::vector<const StatisticInstance*>> simdb_stats_;
+    std::unordered_map<const ReportDescriptor*, std::vector<const Report*>> simdb_stat_reports_;
+    std::unordered_map<const ReportDescriptor*, std::vector<SnapshotIndex>> simdb_stat_indices_;
     std::unordered_map<const ReportDescriptor*, uint64_t> report_start_times_;
     std::unordered_map<const ReportDescriptor*, uint64_t> report_end_times_;
     std::unordered_map<const ReportDescriptor*, std::map<std::string, std::string>> report_metadata_;
@@ -17,6 +17,7 @@
 #include "sparta/utils/MetaStructs.hpp"
 #include "sparta/utils/ValidValue.hpp"
 #include "sparta/utils/FastList.hpp"
+#include "sparta/kernel/SlabAllocator.hpp"
 #include "sparta/events/StartupEvent.hpp"
 
 namespace sparta
@@ -40,7 +41,7 @@ namespace sparta
     private:
 
         class PayloadDeliveringProxy;
-        using ProxyAllocation   = std::vector<std::unique_ptr<PayloadDeliveringProxy>>;
+        using ProxyAllocation   = std::vector<PayloadDeliveringProxy *>;
         using ProxyFreeList     = std::vector<PayloadDeliveringProxy *>;
         using ProxyInflightList = sparta::utils::FastList <PayloadDeliveringProxy *>;
 
@@ -101,10 +102,11 @@ namespace sparta
                 reclaim_();
             }
 
-            // Set a payload for a delayed delivery
-            void setPayload_(const DataT & pl) {
+            // Set a payload for a delayed delivery, constructed from args
+            template<class ...ArgsT>
+            void setPayload_(ArgsT && ...args) {
                 sparta_assert(scheduled_ == false);
-                payload_ = new (&payload_storage_) DataT(pl);
+                payload_ = new (&payload_storage_) DataT(std::forward<ArgsT>(args)...);
             }
 
             // Destroy payload
@@ -147,8 +149,10 @@ namespace sparta
         };
 
 
-        //! Allocate a delivering proxy for the payload.
-        ScheduleableHandle allocateProxy_(const DataT & dat)
+        //! Allocate a delivering proxy for the payload constructed
+        //! from args.
+        template<class ...ArgsT>
+        ScheduleableHandle allocateProxy_(ArgsT && ...args)
         {
             PayloadDeliveringProxy * proxy = nullptr;
             if(SPARTA_EXPECT_TRUE(free_idx_ != 0)) {
@@ -162,7 +166,7 @@ namespace sparta
                 }
 
                 // Take one from the allocation list
-                proxy = allocated_proxies_[allocation_idx_].get();
+                proxy = allocated_proxies_[allocation_idx_];
                 ++allocation_idx_;
 
                 sparta_assert(allocation_idx_ < inflight_pl_.max_size(),
@@ -171,7 +175,10 @@ namespace sparta
                               " outstanding events -- does that seem right?");
             }
             proxy->setInFlightLocation_(inflight_pl_.emplace_back(proxy));
-            proxy->setPayload_(dat);
+            proxy->setPayload_(std::forward<ArgsT>(args)...);
+            if(SPARTA_EXPECT_FALSE(inflight_pl_.size() > high_water_mark_)) {
+                high_water_mark_ = inflight_pl_.size();
+            }
 
             return proxy;
         }
@@ -225,6 +232,10 @@ namespace sparta
             for(PayloadDeliveringProxy * proxy : inflight_pl_) {
                 std::destroy_at(proxy->payload_);
             }
+            for(PayloadDeliveringProxy * proxy : allocated_proxies_) {
+                std::destroy_at(proxy);
+                proxy_allocator_->deallocate(proxy);
+            }
         }
 
         //! No assignments, no copies
@@ -251,6 +262,31 @@ namespace sparta
             return allocateProxy_(payload);
         }
 
+        /**
+         * \brief Prepare a Scheduleable Payload for scheduling either
+         *        now or later, moving the payload into it
+         * \param payload The payload to eventually deliver
+         * \return A handle the Scheduleable item
+         *
+         * \see preparePayload(const DataT &)
+         */
+        ScheduleableHandle preparePayload(DataT && payload) {
+            return allocateProxy_(std::move(payload));
+        }
+
+        /**
+         * \brief Prepare a Scheduleable Payload for scheduling either
+         *        now or later, constructing the payload in place
+         * \param args The arguments of the payload's constructor
+         * \return A handle the Scheduleable item
+         *
+         * \see preparePayload(const DataT &)
+         */
+        template<class ...ArgsT>
+        ScheduleableHandle emplacePayload(ArgsT && ...args) {
+            return allocateProxy_(std::forward<ArgsT>(args)...);
+        }
+
         //! Overload precedence operator for PhasedPayloadEvents since they
         //! are not Scheduleables
         Scheduleable& operator>>(Scheduleable & consumer)
@@ -288,6 +324,33 @@ namespace sparta
             return inflight_pl_.size();
         }
 
+        /**
+         * \brief Return the largest number of outstanding Payloads
+         *        this event has had at once
+         * \return The high-water mark of getNumOutstandingEvents()
+         */
+        uint32_t getHighWaterMark() const {
+            return high_water_mark_;
+        }
+
+        /**
+         * \brief Return the number of delivery proxies this event has
+         *        allocated
+         * \return The number of proxies, in flight or free
+         */
+        uint32_t getNumAllocatedProxies() const {
+            return allocated_proxies_.size();
+        }
+
+        /**
+         * \brief Return the allocator the delivery proxies came from
+         * \return The allocator, or nullptr if no proxy has been
+         *         allocated yet
+         */
+        const SlabAllocator * getProxyAllocator() const {
+            return proxy_allocator_.get();
+        }
+
         //! \brief Determine if this PhasedPayloadEvent is driven on the
         //!        given cycle
         //! \param rel_cycle The relative cycle (from now) the data
@@ -605,11 +668,27 @@ namespace sparta
 
         void addProxies_()
         {
+            // Proxies come from slabs shared with every other event
+            // with the same payload type on this Scheduler
+            if(SPARTA_EXPECT_FALSE(proxy_allocator_ == nullptr)) {
+                Scheduler * scheduler = prototype_.getScheduler(false);
+                if(scheduler != nullptr) {
+                    proxy_allocator_ = scheduler->getProxySlabAllocator(sizeof(PayloadDeliveringProxy),
+                                                                        alignof(PayloadDeliveringProxy));
+                }
+                else {
+                    proxy_allocator_ = std::make_shared<SlabAllocator>(sizeof(PayloadDeliveringProxy),
+                                                                       alignof(PayloadDeliveringProxy),
+                                                                       payload_proxy_allocation_cadence_);
+                }
+            }
+
             const uint32_t old_size = allocated_proxies_.size();
             const uint32_t new_size = payload_proxy_allocation_cadence_ + old_size;
-            allocated_proxies_.resize(new_size);
+            allocated_proxies_.reserve(new_size);
             for(uint32_t i = old_size; i < new_size; ++i) {
-                allocated_proxies_[i].reset(new PayloadDeliveringProxy(prototype_, this));
+                allocated_proxies_.emplace_back(new (proxy_allocator_->allocate())
+                                                PayloadDeliveringProxy(prototype_, this));
             }
             free_pl_.resize(new_size, nullptr);
         }
@@ -620,6 +699,9 @@ namespace sparta
         //! Prototype used for creating proxy objects
         Scheduleable      prototype_;
 
+        //! Where the proxies' memory comes from
+        std::shared_ptr<SlabAllocator> proxy_allocator_;
+
         ProxyAllocation   allocated_proxies_;
         ProxyFreeList     free_pl_;
         ProxyInflightList inflight_pl_{1100};
@@ -630,6 +712,7 @@ namespace sparta
         const uint32_t payload_proxy_allocation_cadence_ = 16;
         uint32_t free_idx_           = 0;
         uint32_t allocation_idx_     = 0;
+        uint32_t high_water_mark_    = 0;
 
     };
 }
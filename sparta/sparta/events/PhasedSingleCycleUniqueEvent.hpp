@@ -94,9 +94,6 @@ namespace sparta
         /*!
          * \brief Return true if this scheduleable was scheduled at all
          * \return true if scheduled at all
-         *
-         * This is an expensive call as it searches all time quantums
-         * for instances of this Scheduleable object.  Use with care.
          */
         bool isScheduled() const {
             return single_cycle_event_scheduleable_.isScheduled();
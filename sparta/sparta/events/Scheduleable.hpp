@@ -207,9 +207,6 @@ namespace sparta
 
         /*! \brief Return true if this scheduleable was scheduled at all
          * \return true if scheduled at all
-         *
-         * This is an expensive call as it searches all time quantums
-         * for instances of this Scheduleable object.  Use with care.
          */
         bool isScheduled() const {
             return scheduler_->isScheduled(this);
@@ -511,6 +508,10 @@ namespace sparta
         //! per tick)
         const bool is_unique_event_ = false;
 
+        //! Where this Scheduleable is on the Scheduler.  Maintained
+        //! by the Scheduler, which can cancel const Scheduleables
+        mutable Scheduler::ScheduledSlots scheduled_slots_;
+
     };//End class Scheduleable
 
 
@@ -251,6 +251,32 @@ namespace sparta
                 dirty_ = false;
             }
 
+            /*!
+             * \brief Restore data from input buffer unless this line was
+             * already restored during the given restore epoch. Otherwise, skip
+             * the line's data in the buffer.
+             * \param in Input buffer positioned at this line's data
+             * \param epoch Restore epoch (see ArchData::beginNewestLineRestore)
+             * \return true if data was restored, false if skipped
+             */
+            template <typename StorageT>
+            bool restoreOnce(StorageT& in, uint32_t epoch) {
+                if(restore_epoch_ == epoch){
+                    in.skipLineBytes(size_);
+                    return false;
+                }
+                restore(in);
+                restore_epoch_ = epoch;
+                return true;
+            }
+
+            /*!
+             * \brief Forget which restore epoch this line was last restored in
+             */
+            void clearRestoreEpoch() {
+                restore_epoch_ = 0;
+            }
+
             /*!
              * \brief Store data to output buffer.
              * \param out Output buffer. Must allow writing a number of bytes
@@ -409,6 +435,7 @@ namespace sparta
             offset_type size_;   //!< Size of this line
             bool is_pool_;       //!< Is this line's data part of a pool? If not, it is owned by this object
             mutable bool dirty_; //!< Is this line dirty. Mutable so that read methods can be const
+            uint32_t restore_epoch_ = 0; //!< Last restore epoch in which this line was restored by restoreOnce
             uint8_t * data_ = nullptr;   //!< Pointer to either the allocated memory or a pool
             std::unique_ptr<uint8_t[]> alloc_data_;      //!< Data held by this line. Always allocated
 
@@ -759,6 +786,8 @@ namespace sparta
             }
 
             if(canFreeLines()){
+                onFreeingLines_();
+
                 // Delete all lines allocated first (map contains pointers to lines)
                 for(LineMap::iterator itr = line_map_.begin(); itr != line_map_.end(); ++itr){
                     delete *itr;
@@ -1050,6 +1079,66 @@ namespace sparta
             restore(in);
         }
 
+        /*!
+         * \brief Counters describing the work done restoring checkpoints
+         */
+        struct RestoreStats {
+            uint64_t lines_restored = 0; //!< Lines copied from checkpoint data
+            uint64_t lines_skipped = 0;  //!< Older line versions skipped
+            uint64_t bytes_restored = 0; //!< Bytes copied from checkpoint data
+        };
+
+        /*!
+         * \brief Begins restoring a chain of checkpoints newest-first with
+         * restoreNewestLines. Cleans the ArchData (as restoreAll would) and
+         * starts a new restore epoch so that every line is restored once.
+         */
+        void beginNewestLineRestore() {
+            clean();
+            if(++restore_epoch_ == 0){
+                // Wrapped. Lines may hold any epoch; forget them all
+                for(LineMap::iterator itr = line_map_.begin(); itr != line_map_.end(); ++itr){
+                    if(*itr != nullptr){
+                        (*itr)->clearRestoreEpoch();
+                    }
+                }
+                restore_epoch_ = 1;
+            }
+        }
+
+        /*!
+         * \brief Restores lines from one checkpoint in a chain being restored
+         * from the newest checkpoint back to a snapshot. Lines already
+         * restored since beginNewestLineRestore (i.e. from a newer
+         * checkpoint) are skipped.
+         * \param in Checkpoint data for this ArchData
+         * \param stats Counters to update
+         * \post Restored lines flagged as not dirty
+         *
+         * Restoring a chain this way produces the same state as restoring the
+         * snapshot with restoreAll and replaying each delta with restore, but
+         * copies each line only once.
+         */
+        template <typename StorageT>
+        void restoreNewestLines(StorageT& in, RestoreStats& stats) {
+            sparta_assert(in.good(),
+                          "Encountered bad checkpoint data (invalid stream) for " << getOwnerNode()->getLocation());
+
+            while(1){
+                line_idx_type ln_idx = in.getNextRestoreLine();
+                if(ln_idx == INVALID_LINE_IDX){
+                    break; // Done with this ArchData
+                }
+                Line& ln = getLine(ln_idx * line_size_);
+                if(ln.restoreOnce(in, restore_epoch_)){
+                    ++stats.lines_restored;
+                    stats.bytes_restored += ln.getLayoutSize();
+                }else{
+                    ++stats.lines_skipped;
+                }
+            }
+        }
+
         ////////////////////////////////////////////////////////////////////////
         //! @}
 
@@ -1221,6 +1310,15 @@ namespace sparta
         ////////////////////////////////////////////////////////////////////////
         //! @}
 
+    protected:
+
+        /*!
+         * \brief Called by clean() just before all Lines are deleted.
+         * Subclasses holding pointers to Lines or their data must drop them
+         * here.
+         */
+        virtual void onFreeingLines_() {}
+
     private:
 
         /*!
@@ -1656,6 +1754,11 @@ namespace sparta
          */
         LineMap       line_map_;
 
+        /*!
+         * \brief Current epoch of restoreNewestLines (see beginNewestLineRestore)
+         */
+        uint32_t      restore_epoch_ = 0;
+
         /*!
          * \brief List of all Segments registered
          */
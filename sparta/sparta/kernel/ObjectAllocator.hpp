@@ -9,141 +9,312 @@
 
 #pragma once
 
-#include <inttypes.h>
-#include <queue>
-#include <vector>
-#include <limits>
+#include <atomic>
+#include <cinttypes>
 #include <memory>
-#include "sparta/utils/SpartaAssert.hpp"
-#include <inttypes.h>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
 
+#include "sparta/utils/SpartaAssert.hpp"
 
 namespace sparta
 {
-    template<typename ObjT>
+    /**
+     * \class ObjectAllocator
+     * \brief A pool of reusable objects of type ObjT
+     * \tparam ObjT The type of object handed out
+     * \tparam ThreadSafe If true, create() and free() can be called
+     *                    concurrently from any number of threads
+     * \tparam ChunkSize The number of objects allocated at a time
+     *
+     * Objects are stored in chunks of ChunkSize contiguous slots.
+     * Each slot carries the link for an intrusive free list, so
+     * create() and free() never allocate once the pool is warm; they
+     * are a pop and a push of a singly linked list.
+     *
+     * Objects are constructed the first time their slot is handed out
+     * and are only destroyed by clear() or the destructor.  A freed
+     * object is handed back from create() as-is, without being
+     * reconstructed, so objects that own memory (vectors, etc.) keep
+     * it across reuse.  The arguments to create() are only used when
+     * a new object is constructed.  Freed objects are reused LIFO so
+     * that the most recently touched (warm) object is handed out
+     * first.
+     *
+     * The thread-safe variant keeps the free list as a lock-free
+     * (Treiber) stack whose head is tagged with a version count to
+     * avoid ABA.  Growing the pool takes a mutex, but that only
+     * happens when the free list is empty.  It is intended for
+     * objects created by one thread and freed by another, like data
+     * handed to the Scheduler by asynchronous event producers.
+     *
+     * \code
+     * sparta::ObjectAllocator<TickQuantum> alloc;
+     * TickQuantum * tq = alloc.create(num_groups);
+     * ...
+     * alloc.free(tq);
+     * \endcode
+     */
+    template<typename ObjT, bool ThreadSafe = false, uint32_t ChunkSize = 64>
     class ObjectAllocator
     {
-    private:
-        typedef std::unique_ptr<ObjT> SmartPtr;
-        std::queue<ObjT*> free_obj_list_;
-        std::vector<SmartPtr> allocated_objs_;
-    public:
-        ~ObjectAllocator()
+        static_assert(ChunkSize > 0, "ObjectAllocator chunk size must be non-zero");
+
+        //! Free list link; an index (+1) for the lock-free list so it
+        //! can be tagged in a single word, a pointer otherwise
+        typedef typename std::conditional<ThreadSafe, std::atomic<uint32_t>, void*>::type Link;
+
+        struct Slot
         {
+            //! Must be first: an ObjT* is the address of its Slot
+            typename std::aligned_storage<sizeof(ObjT), alignof(ObjT)>::type storage;
+
+            Link     next;
+            uint32_t index;
+            bool     constructed;
+
+            ObjT * object() {
+                return reinterpret_cast<ObjT*>(&storage);
+            }
+        };
+        static_assert(std::is_standard_layout<Slot>::value,
+                      "ObjectAllocator slots must be standard layout");
+
+        //! Most chunks the thread-safe variant can address
+        static constexpr uint32_t MAX_CHUNKS = (1u << 16);
+
+    public:
+
+        //! Convenient typedef for the value type
+        typedef ObjT value_type;
+
+        ObjectAllocator() = default;
+
+        //! Destroy every object ever created
+        ~ObjectAllocator() {
+            clear();
         }
-        //allow direct access to the allocator via create and Free
+
+        //! No copies; objects point into this allocator's storage
+        ObjectAllocator(const ObjectAllocator &) = delete;
+        ObjectAllocator & operator=(const ObjectAllocator &) = delete;
+
+        /**
+         * \brief Get an object from the pool
+         * \param args Constructor arguments, only used if a new object
+         *             must be constructed
+         * \return A free object; either freshly constructed or one
+         *         previously given to free()
+         */
         template<typename... Args>
         ObjT * create(Args&&... args)
         {
-            ObjT * obj = 0;
-            if(free_obj_list_.empty()) {
-                allocated_objs_.emplace_back(new ObjT(args...));
-                obj = allocated_objs_.back().get();
+            Slot * slot = pop_();
+            if(SPARTA_EXPECT_FALSE(slot == nullptr)) {
+                slot = grow_();
             }
-            else {
-                obj = free_obj_list_.front();
-                free_obj_list_.pop();
+            if(SPARTA_EXPECT_FALSE(!slot->constructed)) {
+                new (slot->object()) ObjT(std::forward<Args>(args)...);
+                slot->constructed = true;
             }
-            return obj;
+            return slot->object();
         }
 
-        //When the obj is finished, it puts itself back on the free
-        //list
+        //! When the obj is finished, it puts itself back on the free
+        //! list
         void free(ObjT * obj) {
-            free_obj_list_.push(obj);
+            push_(reinterpret_cast<Slot*>(obj));
+        }
+
+        /**
+         * \brief Destroy every object and release all storage
+         *
+         * Objects still held by callers are destroyed as well.  Not
+         * thread safe, even for the thread-safe variant.
+         */
+        void clear()
+        {
+            const uint32_t num_chunks = getNumChunks();
+            for(uint32_t i = 0; i < num_chunks; ++i) {
+                Slot * chunk = chunk_(i);
+                for(uint32_t j = 0; j < ChunkSize; ++j) {
+                    if(chunk[j].constructed) {
+                        chunk[j].object()->~ObjT();
+                    }
+                }
+            }
+            if constexpr (ThreadSafe) {
+                for(uint32_t i = 0; i < num_chunks; ++i) {
+                    delete [] chunk_table_[i].exchange(nullptr, std::memory_order_relaxed);
+                }
+                num_chunks_.store(0, std::memory_order_relaxed);
+                free_head_.store(0, std::memory_order_relaxed);
+            }
+            else {
+                chunks_.clear();
+                free_head_ = nullptr;
+            }
+        }
+
+        //! \return The number of chunks of ChunkSize objects allocated
+        uint32_t getNumChunks() const {
+            if constexpr (ThreadSafe) {
+                return num_chunks_.load(std::memory_order_acquire);
+            }
+            else {
+                return chunks_.size();
+            }
+        }
+
+        //! \return The number of objects constructed so far (in use or free)
+        uint64_t getNumConstructed() const {
+            uint64_t total = 0;
+            const uint32_t num_chunks = getNumChunks();
+            for(uint32_t i = 0; i < num_chunks; ++i) {
+                const Slot * chunk = chunk_(i);
+                for(uint32_t j = 0; j < ChunkSize; ++j) {
+                    total += chunk[j].constructed;
+                }
+            }
+            return total;
+        }
+
+    private:
+
+        Slot * chunk_(uint32_t idx) const {
+            if constexpr (ThreadSafe) {
+                return chunk_table_[idx].load(std::memory_order_acquire);
+            }
+            else {
+                return chunks_[idx].get();
+            }
+        }
+
+        Slot * slotAt_(uint32_t index) const {
+            return chunk_(index / ChunkSize) + (index % ChunkSize);
+        }
+
+        //! Pop the head of the free list, nullptr if empty
+        Slot * pop_()
+        {
+            if constexpr (ThreadSafe) {
+                uint64_t head = free_head_.load(std::memory_order_acquire);
+                while(static_cast<uint32_t>(head) != 0) {
+                    Slot * slot = slotAt_(static_cast<uint32_t>(head) - 1);
+                    // Slots are never released while the pool is in
+                    // use, so a stale read here is harmless; the tag
+                    // makes the exchange fail
+                    const uint64_t next = slot->next.load(std::memory_order_relaxed);
+                    const uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+                    if(free_head_.compare_exchange_weak(head, new_head,
+                                                        std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+                        return slot;
+                    }
+                }
+                return nullptr;
+            }
+            else {
+                Slot * slot = free_head_;
+                if(SPARTA_EXPECT_TRUE(slot != nullptr)) {
+                    free_head_ = static_cast<Slot*>(slot->next);
+                }
+                return slot;
+            }
+        }
+
+        //! Push a slot on the free list
+        void push_(Slot * slot)
+        {
+            if constexpr (ThreadSafe) {
+                const uint64_t link = slot->index + 1;
+                uint64_t head = free_head_.load(std::memory_order_relaxed);
+                uint64_t new_head;
+                do {
+                    slot->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                    new_head = (((head >> 32) + 1) << 32) | link;
+                } while(!free_head_.compare_exchange_weak(head, new_head,
+                                                          std::memory_order_release,
+                                                          std::memory_order_relaxed));
+            }
+            else {
+                slot->next = free_head_;
+                free_head_ = slot;
+            }
+        }
+
+        //! Add a chunk, returning one of its slots and freeing the rest
+        Slot * grow_()
+        {
+            if constexpr (ThreadSafe) {
+                std::lock_guard<std::mutex> lock(grow_mutex_);
+
+                // Another thread may have grown the pool while this
+                // one waited
+                if(Slot * slot = pop_(); slot != nullptr) {
+                    return slot;
+                }
+                if(!chunk_table_) {
+                    chunk_table_.reset(new std::atomic<Slot*>[MAX_CHUNKS]);
+                    for(uint32_t i = 0; i < MAX_CHUNKS; ++i) {
+                        chunk_table_[i].store(nullptr, std::memory_order_relaxed);
+                    }
+                }
+                const uint32_t chunk_idx = num_chunks_.load(std::memory_order_relaxed);
+                sparta_assert(chunk_idx < MAX_CHUNKS,
+                              "Thread-safe ObjectAllocator is full: " << uint64_t(MAX_CHUNKS) * ChunkSize
+                              << " objects are in use");
+                Slot * chunk = newChunk_(chunk_idx);
+                chunk_table_[chunk_idx].store(chunk, std::memory_order_release);
+                num_chunks_.store(chunk_idx + 1, std::memory_order_release);
+                return freeChunk_(chunk);
+            }
+            else {
+                Slot * chunk = newChunk_(chunks_.size());
+                chunks_.emplace_back(chunk);
+                return freeChunk_(chunk);
+            }
         }
 
-        void clear() {
-            allocated_objs_.clear();
-            free_obj_list_ = std::queue<ObjT *>();
+        Slot * newChunk_(uint32_t chunk_idx)
+        {
+            Slot * chunk = new Slot[ChunkSize];
+            for(uint32_t i = 0; i < ChunkSize; ++i) {
+                chunk[i].index = chunk_idx * ChunkSize + i;
+                chunk[i].constructed = false;
+            }
+            return chunk;
         }
 
-        //Make this allocator work as a stl compliant allocator
-    // public:
-    //     typedef ObjT value_type;
-    //     typedef ObjT* pointer;
-    //     typedef const value_type* const_pointer;
-    //     typedef value_type& reference;
-    //     typedef const value_type& const_reference;
-    //     typedef std::size_t size_type;
-    //     typedef std::ptrdiff_t difference_type;
-
-    //     //convert to a different template allocator???
-    //     template<typename U>
-    //     struct rebind{
-    //         typedef ObjectAllocator<U> other;
-    //     };
-
-    //     //Allow construction of the ObjectAllocator
-    //     explicit ObjectAllocator() {}
-    //     ///Destruct
-    //     ~ObjectAllocator()
-    //     {
-    //         //nothing to do since UniquePtrs were used. :)
-    //         allocated_objs_.clear();
-    //     }
-    //     ///Allow copy construction
-    //     explicit ObjectAllocator(ObjectAllocator<ObjT> const&){}
-    //     template<typename U>
-    //     inline explicit ObjectAllocator(ObjectAllocator<U> const&) {}
-
-    //     //allow support to get the address of objects.
-    //     pointer address(reference r) { return &r; }
-    //     const_pointer address(const_reference r) { return &r; }
-
-
-    //     ///either new up some memory or use some of our already created memory.
-    //     pointer allocate(size_type size, typename std::allocator<void>::const_pointer = 0)
-    //     {
-    //         std::cout << "allocating memory" << std::endl;
-    //         pointer p;
-    //         if(free_obj_list_.empty())
-    //         {
-    //             //i don't think size should ever be greater than 1, if it is...
-    //             //then i don't know what's going on.
-    //             sparta_assert(size == 1);
-    //             allocated_objs_.emplace_back(SmartPtr(new char[sizeof(ObjT)]));
-    //             p = reinterpret_cast<pointer>(allocated_objs_.back().get());
-    //         }
-    //         else
-    //         {
-    //             p = free_obj_list_.front();
-    //             free_obj_list_.pop();
-    //         }
-    //         return p;
-    //     }
-
-    //     ///instead of deleting the memory, store a pointer to the memory
-    //     ///in a list of free memory.
-    //     void deallocate(pointer p, size_type)
-    //     {
-    //         std::cout << "deallocating by pushing to free list" << std::endl;
-    //         free_obj_list_.push(p);
-    //     }
-
-    //     ///max size?
-    //     size_type max_size() const
-    //     {
-    //         return std::numeric_limits<size_type>::max() / sizeof(ObjT);
-    //     }
-
-    //     ///construct and destruct objects.
-    //     void construct(pointer p, const ObjT& t)
-    //     {
-    //         //construct the object implace at p's location?
-    //         new (p) ObjT(t);
-    //     }
-    //     ///destruct an object.
-    //     void destroy(pointer p)
-    //     {
-    //         (void)p;
-    //         //there's nothing to do since we are going to keep the memory at p around.
-    //         //we don't care to destruct the object even? sounds ugly.
-    //     }
-
-    //     bool operator==(ObjectAllocator<ObjT> const&) { return false;}
-    //     bool operator!=(ObjectAllocator<ObjT> const& a) {return !operator==(a); }
-
-    // public:
+        //! Free all but the first slot of a new chunk, in reverse so
+        //! that slots are handed out in address order
+        Slot * freeChunk_(Slot * chunk)
+        {
+            for(uint32_t i = ChunkSize - 1; i > 0; --i) {
+                push_(chunk + i);
+            }
+            return chunk;
+        }
+
+        struct NoState {};
+
+        //! Non-thread-safe storage: a list of chunks and the head of
+        //! the free list
+        typename std::conditional<ThreadSafe, NoState,
+                                  std::vector<std::unique_ptr<Slot[]>>>::type chunks_;
+
+        //! Thread-safe storage: a fixed table of chunks so that
+        //! readers never see it move, and a mutex for growing it
+        typename std::conditional<ThreadSafe, std::unique_ptr<std::atomic<Slot*>[]>,
+                                  NoState>::type chunk_table_;
+        typename std::conditional<ThreadSafe, std::atomic<uint32_t>, NoState>::type num_chunks_{};
+        typename std::conditional<ThreadSafe, std::mutex, NoState>::type grow_mutex_;
+
+        //! Head of the free list.  For the thread-safe variant, the
+        //! upper 32 bits are a version tag and the lower 32 bits are
+        //! the slot index + 1 (0 is empty)
+        typename std::conditional<ThreadSafe, std::atomic<uint64_t>, Slot*>::type free_head_{};
     };
 }
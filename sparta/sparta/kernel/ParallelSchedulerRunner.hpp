@@ -0,0 +1,223 @@
+// <ParallelSchedulerRunner> -*- C++ -*-
+
+/**
+ * \file ParallelSchedulerRunner.hpp
+ * \brief Runs multiple Scheduler partitions in parallel using
+ *        conservative, lookahead-based synchronization
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "sparta/kernel/Scheduler.hpp"
+
+namespace sparta
+{
+
+/**
+ * \class CrossPartitionReceiver
+ * \brief Interface for anything that receives data sent from another
+ *        Scheduler partition
+ *
+ * A receiver buffers data sent from a remote partition (typically in
+ * a sparta::utils::SPSCQueue) and delivers it on its own partition
+ * when drained.  sparta::SyncInPort implements this interface when
+ * bound to a SyncOutPort whose clock is on a different partition.
+ */
+class CrossPartitionReceiver
+{
+public:
+    virtual ~CrossPartitionReceiver() {}
+
+    //! \return The Scheduler that data is delivered on
+    virtual const Scheduler * getReceivingPartition() const = 0;
+
+    //! \return The minimum number of ticks between a send on the
+    //!         remote partition and its delivery on this one
+    virtual Scheduler::Tick getMinimumLatency() const = 0;
+
+    //! \return true if data has been sent but not yet drained
+    virtual bool hasPendingMessages() const = 0;
+
+    /**
+     * \brief Schedule all buffered data on the receiving partition
+     * \return The number of messages drained
+     *
+     * Called by the ParallelSchedulerRunner from the receiving
+     * partition's thread, between lookahead windows.
+     */
+    virtual uint32_t drainCrossPartitionMessages() = 0;
+};
+
+/**
+ * \class ParallelSchedulerRunner
+ * \brief Runs a set of Scheduler partitions, each on its own thread
+ *
+ * Each partition is a complete sparta::Scheduler with its own clocks
+ * and DAG.  Partitions communicate only through
+ * CrossPartitionReceivers (SyncPorts bound across partitions), which
+ * have a minimum, non-zero latency.  The smallest such latency is the
+ * lookahead: no partition can affect another sooner than that, so
+ * all partitions can safely run a window of lookahead ticks in
+ * parallel.  At the end of a window all partitions synchronize,
+ * every receiver drains the data that was sent to it during the
+ * window, and the next window begins.
+ *
+ * Partitions must be added to the runner before ports are bound
+ * across them, since binding registers the receiver with the runner.
+ *
+ * \code
+ * sparta::Scheduler core0_sched, core1_sched;
+ * sparta::ParallelSchedulerRunner runner({&core0_sched, &core1_sched});
+ *
+ * // Build, bind, and finalize both partitions' trees ...
+ *
+ * runner.run();
+ * \endcode
+ *
+ * \note Model code running on different partitions executes
+ *       concurrently.  Anything shared between partitions other
+ *       than cross-partition SyncPorts (loggers writing to the same
+ *       file, global singletons, etc.) must be thread safe.
+ * \note The partitions must outlive the runner.
+ */
+class ParallelSchedulerRunner
+{
+public:
+
+    /**
+     * \brief Create a runner over the given partitions
+     * \param partitions The Schedulers to run in parallel.  A
+     *                   Scheduler can only be a partition of one
+     *                   runner.
+     */
+    explicit ParallelSchedulerRunner(const std::vector<Scheduler*> & partitions);
+
+    //! Release the partitions
+    ~ParallelSchedulerRunner();
+
+    //! No copies
+    ParallelSchedulerRunner(const ParallelSchedulerRunner &) = delete;
+    ParallelSchedulerRunner & operator=(const ParallelSchedulerRunner &) = delete;
+
+    //! \return The partitions being run
+    const std::vector<Scheduler*> & getPartitions() const {
+        return partitions_;
+    }
+
+    /**
+     * \brief Register a receiver of cross-partition data
+     * \param receiver The receiver; drained on the thread of
+     *                 receiver->getReceivingPartition()
+     * \pre Not running
+     */
+    void registerReceiver(CrossPartitionReceiver * receiver);
+
+    /**
+     * \brief Deregister a receiver of cross-partition data
+     * \param receiver The receiver previously registered
+     * \pre Not running
+     */
+    void deregisterReceiver(CrossPartitionReceiver * receiver);
+
+    /**
+     * \brief The size of the window all partitions run in parallel
+     * \return The minimum latency of all registered receivers, or
+     *         Scheduler::INDEFINITE if there are none (the
+     *         partitions are independent)
+     */
+    Scheduler::Tick getLookahead() const;
+
+    /**
+     * \brief Run all partitions in parallel
+     * \param num_ticks The number of ticks to run; the default runs
+     *                  until no partition has continuing work left
+     *
+     * The calling thread runs the first partition; every other
+     * partition gets its own thread for the duration of the call.
+     * Partitions are run with exacting runs so that every partition
+     * is at the same tick at the end of each window.
+     *
+     * Running ends when any of the following occur:
+     *
+     * #. \a num_ticks have elapsed
+     * #. No partition has continuing events and no cross-partition
+     *    data is in flight
+     * #. A partition is stopped with Scheduler::stopRunning()
+     *
+     * If a partition throws, all partitions are stopped at the end
+     * of the current window and the exception is rethrown here.
+     *
+     * \pre All partitions are finalized and at the same tick
+     */
+    void run(Scheduler::Tick num_ticks = Scheduler::INDEFINITE);
+
+    //! \return The number of lookahead windows run since construction
+    uint64_t getNumWindows() const {
+        return num_windows_;
+    }
+
+private:
+
+    //! Run one partition's windows until the runner stops
+    void runPartition_(uint32_t partition_idx);
+
+    /*!
+     * \brief Wait for all partitions to finish the current window
+     * \return true if the partition should run another window
+     *
+     * The last partition to arrive decides whether to continue and
+     * sets up the next window.
+     */
+    bool synchronize_();
+
+    //! Called by the last partition to reach synchronize_()
+    void decideNextWindow_();
+
+    //! The partitions
+    std::vector<Scheduler*> partitions_;
+
+    //! Receivers, indexed by the partition they deliver on
+    std::vector<std::vector<CrossPartitionReceiver*>> receivers_;
+
+    //! Lookahead of the current run
+    Scheduler::Tick lookahead_ = Scheduler::INDEFINITE;
+
+    //! Tick to stop the current run at (INDEFINITE if unbounded)
+    Scheduler::Tick end_tick_ = Scheduler::INDEFINITE;
+
+    //! End of the window currently being run (INDEFINITE if unbounded)
+    Scheduler::Tick window_end_ = 0;
+
+    //! Per-partition: is there any continuing work left after its window
+    std::vector<char> partition_idle_;
+
+    //! Set when the run should end at the next synchronization
+    std::atomic<bool> stop_requested_{false};
+
+    //! Set by the deciding partition once the run has ended
+    bool finished_ = false;
+
+    //! First exception thrown by any partition in the current run
+    std::exception_ptr exception_;
+    std::mutex exception_mutex_;
+
+    //! Number of partitions that have reached the synchronization point
+    std::atomic<uint32_t> num_arrived_{0};
+
+    //! Flipped by the deciding partition to release the others
+    std::atomic<uint64_t> generation_{0};
+
+    //! Windows run since construction
+    uint64_t num_windows_ = 0;
+
+    //! Is run() in progress
+    bool running_ = false;
+};
+
+}
@@ -23,11 +23,13 @@
 #include <algorithm>
 #include <limits>
 #include <list>
+#include <map>
 #include <ostream>
 
 #include "sparta/utils/Colors.hpp"
 #include "sparta/kernel/SpartaHandler.hpp"
 #include "sparta/kernel/ObjectAllocator.hpp"
+#include "sparta/kernel/SlabAllocator.hpp"
 #include "sparta/simulation/RootTreeNode.hpp"
 #include "sparta/log/MessageSource.hpp"
 #include "sparta/statistics/StatisticDef.hpp"
@@ -63,6 +65,7 @@ namespace sparta {
     class PhasedPayloadEvent;
     class EventSet;
     class GlobalEventProxy;
+    class ParallelSchedulerRunner;
 }
 
 namespace sparta
@@ -210,12 +213,13 @@ private:
         public:
             using Scheduleables = std::vector<Scheduleable *>;
 
-            void addScheduleable(Scheduleable* sched) {
+            uint32_t addScheduleable(Scheduleable* sched) {
                 if(SPARTA_EXPECT_FALSE(current_idx_ == size_)) {
                     scheduleables_.resize(scheduleables_.size() * 2, nullptr);
                     size_ = scheduleables_.size();
                 }
-                scheduleables_[current_idx_++] = sched;
+                scheduleables_[current_idx_] = sched;
+                return current_idx_++;
             }
 
             size_t size() const {
@@ -259,34 +263,115 @@ private:
          * \param firing_group The Firing group (dag_group + 1) to add the
          *                     event. Must be > 0.
          * \param scheduleable The sparta::Scheduleable being scheduled
+         * \return The index of the event within the firing group
          */
-        void addEvent(uint32_t firing_group, Scheduleable * scheduleable) {
+        uint32_t addEvent(uint32_t firing_group, Scheduleable * scheduleable) {
             sparta_assert(firing_group > 0);
             sparta_assert(firing_group < groups.size());
-            groups[firing_group].addScheduleable(scheduleable);
             first_group_idx = std::min(first_group_idx, firing_group);
+            return groups[firing_group].addScheduleable(scheduleable);
         }
 
-        void addEventIfNotScheduled(uint32_t firing_group, Scheduleable * scheduleable) {
-            sparta_assert(firing_group > 0);
-            sparta_assert(firing_group < groups.size());
-            auto & grp = groups[firing_group];
-            const auto grp_size = grp.size();
-            for(uint32_t idx = 0; idx < grp_size; ++idx) {
-                if(grp[idx] == scheduleable) {
+        Tick               tick = 0; //!< The tick this quantum represents
+        ScheduleableGroups groups;   //!< The list of firing groups. This is indexed by dag_group+1
+        uint32_t first_group_idx = std::numeric_limits<uint32_t>::max(); //!< The first group idx with events
+        TickQuantum * next = nullptr;
+    };
+
+    /**
+     * \class ScheduledSlots
+     * \brief The places a Scheduleable occupies on the Scheduler
+     *
+     * Every Scheduleable carries one of these, maintained by the
+     * Scheduler, so that isScheduled, cancelEvent, and unique event
+     * de-duplication do not need to search the time quanta.  An entry
+     * is added when the Scheduleable is scheduled and removed when it
+     * is cancelled or just before it fires.  A fired Scheduleable is
+     * marked with the firing of its group so that it still counts as
+     * scheduled until the group finishes, without the Scheduler
+     * touching it again after its handler (which may delete it).
+     *
+     * Copies of a Scheduleable are not on the Scheduler, so the slots
+     * are never copied or moved.
+     */
+    class ScheduledSlots
+    {
+    public:
+        struct Slot {
+            TickQuantum * quantum;      //!< The time quantum
+            uint32_t      firing_group; //!< The firing group in the quantum
+            uint32_t      index;        //!< The index within the firing group
+        };
+        using Slots = std::vector<Slot>;
+
+        ScheduledSlots() = default;
+        ScheduledSlots(const ScheduledSlots &) {}
+        ScheduledSlots(ScheduledSlots &&) noexcept {}
+        ScheduledSlots & operator=(const ScheduledSlots &) { return *this; }
+        ScheduledSlots & operator=(ScheduledSlots &&) noexcept { return *this; }
+
+        void add(TickQuantum * quantum, uint32_t firing_group, uint32_t index) {
+            slots_.push_back({quantum, firing_group, index});
+        }
+
+        //! Is there a slot in the given quantum and firing group?
+        bool contains(const TickQuantum * quantum, uint32_t firing_group) const {
+            for(const auto & slot : slots_) {
+                if((slot.quantum == quantum) && (slot.firing_group == firing_group)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //! Remove the given slot, if present
+        void remove(const TickQuantum * quantum, uint32_t firing_group, uint32_t index) {
+            for(auto it = slots_.begin(); it != slots_.end(); ++it) {
+                if((it->index == index) && (it->quantum == quantum) &&
+                   (it->firing_group == firing_group))
+                {
+                    *it = slots_.back();
+                    slots_.pop_back();
                     return;
                 }
             }
-            grp.addScheduleable(scheduleable);
-            first_group_idx = std::min(first_group_idx, firing_group);
         }
 
-        Tick               tick = 0; //!< The tick this quantum represents
-        ScheduleableGroups groups;   //!< The list of firing groups. This is indexed by dag_group+1
-        uint32_t first_group_idx = std::numeric_limits<uint32_t>::max(); //!< The first group idx with events
-        TickQuantum * next = nullptr;
+        bool empty() const {
+            return slots_.empty();
+        }
+
+        void clear() {
+            slots_.clear();
+            fired_in_ = 0;
+        }
+
+        //! Mark as fired in the given firing of a group
+        void setFiredIn(uint64_t group_firing) {
+            fired_in_ = group_firing;
+        }
+
+        //! Fired in the given firing of a group?  0 is no firing
+        bool hasFiredIn(uint64_t group_firing) const {
+            return (group_firing != 0) && (fired_in_ == group_firing);
+        }
+
+        Slots & getSlots() {
+            return slots_;
+        }
+
+        const Slots & getSlots() const {
+            return slots_;
+        }
+
+    private:
+        Slots slots_;
+        uint64_t fired_in_ = 0;
     };
 
+    // Scheduleables carry a ScheduledSlots instance
+    friend class Scheduleable;
+
     //! The current time quantum
     TickQuantum * current_tick_quantum_ = nullptr;
 
@@ -372,11 +457,16 @@ public:
     //! Register a clock with this Scheduler
     //! \param clk Pointer to a sparta::Clock to be registered
     //!
-    //! The purpose of registering the Clock is to allow the Scheduler
-    //! to update the elapsed cycles in that Clock instead of having
-    //! the Clock calculate that value over and over again.
+    //! Clocks compute and cache their current and elapsed cycles
+    //! from this Scheduler on demand, so the Scheduler does not
+    //! visit registered clocks as time advances.
     void registerClock(sparta::Clock *clk);
 
+    //! \return The clocks registered with this Scheduler
+    const std::vector<sparta::Clock*> & getRegisteredClocks() const {
+        return registered_clocks_;
+    }
+
     //! Deregister a clock from this Scheduler
     //! \param clk Pointer to a sparta::Clock to be deregistered
     //!
@@ -402,6 +492,34 @@ public:
         return dag_.get();
     }
 
+    /**
+     * \brief Index future tick quanta with a timing wheel
+     * \param num_slots The number of near-future ticks covered by the
+     *                  wheel.  Must be a power of two and a multiple
+     *                  of 64.  A value of 0 disables the wheel.
+     * \pre No events can be on the Scheduler
+     * \pre The Scheduler cannot be running
+     *
+     * By default, scheduling an event at a tick that does not yet
+     * have a time quantum walks the time quantum list from the
+     * current tick forward.  This is fast when events are scheduled
+     * now or in the next few ticks, but degrades linearly when
+     * models keep many long-latency events outstanding (DRAM,
+     * timers, watchdogs).
+     *
+     * With a timing wheel, quanta within \a num_slots ticks of the
+     * current tick are found with a direct index and quanta beyond
+     * that horizon are kept in an ordered overflow index that is
+     * drained into the wheel as time advances.  The firing order of
+     * events is identical to the default mode.
+     */
+    void setTimingWheelSize(uint32_t num_slots);
+
+    //! \return The number of slots in the timing wheel (0 if disabled)
+    uint32_t getTimingWheelSize() const {
+        return static_cast<uint32_t>(timing_wheel_.size());
+    }
+
     ////////////////////////////////////////////////////////////////////////
     //! @}
 
@@ -524,7 +642,8 @@ public:
      * in the future.  The function does *not* do a full blown
      * Scheduleable class compare, but rather a pointer comparison.
      *
-     * This function is expensive and should be used with caution.
+     * A Scheduleable that has fired is considered scheduled until
+     * the rest of its firing group has fired.
      */
     bool isScheduled(const Scheduleable * scheduleable) const;
 
@@ -539,7 +658,8 @@ public:
      * function does *not* do a full blown Scheduleable class compare,
      * but rather a pointer comparison.
      *
-     * This function is rather inefficient for rel_times that are pretty large.
+     * The cost of this function is proportional to the number of
+     * times the Scheduleable is on the Scheduler, not to \a rel_time.
      */
     bool isScheduled(const Scheduleable * scheduleable, Tick rel_time) const;
 
@@ -548,8 +668,8 @@ public:
      * \brief Cancel the given Scheduleable if on the Scheduler
      * \param scheduleable The Scheduleable to cancel (remove)
      *
-     * Will search in all time quantums for the given Scheduleable
-     * instance and cancel it everywhere found.
+     * Will cancel the given Scheduleable instance everywhere it is
+     * on the Scheduler.
      */
     void cancelEvent(const Scheduleable * scheduleable);
 
@@ -558,8 +678,8 @@ public:
      * \param scheduleable The Scheduleable to cancel (remove)
      * \param rel_time The time quantum to search in
      *
-     * Will search only in the given time quantum for the given
-     * Scheduleable and cancel it.
+     * Will cancel the given Scheduleable only in the given time
+     * quantum.
      */
     void cancelEvent(const Scheduleable * scheduleable, Tick rel_time);
 
@@ -801,6 +921,30 @@ public:
         return latest_continuing_event_;
     }
 
+    /**
+     * \brief Get the ParallelSchedulerRunner this Scheduler is a
+     *        partition of
+     * \return The runner, or nullptr if this Scheduler runs on its own
+     */
+    ParallelSchedulerRunner * getPartitionRunner() const noexcept {
+        return partition_runner_;
+    }
+
+    /**
+     * \brief Get the allocator for PhasedPayloadEvent delivery proxies
+     *        of the given size
+     * \param size  The size of the proxy
+     * \param align The alignment of the proxy
+     * \return An allocator shared by all proxies of that size and
+     *         alignment on this Scheduler
+     *
+     * Sharing slabs keeps the proxies of many events (one per
+     * DataInPort, for example) contiguous instead of scattered
+     * across the heap.  Events hold a reference to the allocator, so
+     * it can outlive this Scheduler.
+     */
+    std::shared_ptr<SlabAllocator> getProxySlabAllocator(size_t size, size_t align);
+
     /**
      * \return The current dag event firing.  The index is adjusted by
      *         one
@@ -900,6 +1044,9 @@ private:
     // The startup event adds itself to internal structures
     friend class StartupEvent;
 
+    // The runner drives partitions on their own threads
+    friend class ParallelSchedulerRunner;
+
     /**
      * \brief A temporary queue used for "cranking" the simulation
      * \param event_del The event delegate to call
@@ -927,6 +1074,35 @@ private:
      */
     TickQuantum* determineTickQuantum_(Tick rel_time);
 
+    //! Timing wheel version of determineTickQuantum_
+    TickQuantum* determineTickQuantumFromWheel_(Tick index_time);
+
+    //! Find the latest tick quantum in the wheel before index_time
+    TickQuantum* findPrecedingWheelQuantum_(Tick index_time) const;
+
+    //! Move the wheel's window to start at new_base, pulling in
+    //! quanta from the overflow index that now fall in the window
+    void advanceTimingWheel_(Tick new_base);
+
+    //! Remove all quanta from the timing wheel and overflow index
+    void clearTimingWheel_();
+
+    //! Timing wheel slots, indexed by (tick & timing_wheel_mask_).
+    //! Empty if the timing wheel is disabled
+    std::vector<TickQuantum*> timing_wheel_;
+
+    //! One bit per timing wheel slot, set if that slot has a quantum
+    std::vector<uint64_t> timing_wheel_occupancy_;
+
+    //! Mask used to convert a tick into a timing wheel slot
+    Tick timing_wheel_mask_ = 0;
+
+    //! The first tick covered by the timing wheel
+    Tick timing_wheel_base_ = 0;
+
+    //! Quanta beyond the timing wheel's window, ordered by tick
+    std::map<Tick, TickQuantum*> timing_wheel_overflow_;
+
     //! The DAG used for grouping
     std::unique_ptr<DAG> dag_;
 
@@ -976,6 +1152,14 @@ private:
     //! A list of events that are zero priority to be fired
     std::vector<SpartaHandler> startup_events_;
 
+    //! The runner this Scheduler is a partition of, if any.  The
+    //! runner, not run(), pauses and unpauses the SleeperThread for
+    //! partitions since partitions run on different threads.
+    ParallelSchedulerRunner * partition_runner_ = nullptr;
+
+    //! Allocators for PhasedPayloadEvent proxies, keyed on size and alignment
+    std::map<std::pair<size_t, size_t>, std::shared_ptr<SlabAllocator>> proxy_slab_allocators_;
+
     //! A vector of associated clocks with this scheduler.  Do not
     //! make this a std::set -- iteration is 120x slower
     std::vector<sparta::Clock*> registered_clocks_;
@@ -986,6 +1170,13 @@ private:
     //! The current event being fired.
     uint32_t current_event_firing_ = 0;
 
+    //! Number of firing groups fired so far, which identifies each
+    //! firing of a group
+    uint64_t num_group_firings_ = 0;
+
+    //! The firing of the group being fired, or 0 between groups
+    uint64_t current_group_firing_id_ = 0;
+
     //! The current SchedulingPhase
     SchedulingPhase current_scheduling_phase_ = SchedulingPhase::Trigger;
 
@@ -0,0 +1,133 @@
+// <SlabAllocator.h> -*- C++ -*-
+
+
+/**
+ * \file   SlabAllocator.hpp
+ *
+ * \brief  File that defines the SlabAllocator class
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta
+{
+    /**
+     * \class SlabAllocator
+     * \brief Hands out fixed-size blocks of raw memory carved from
+     *        large, contiguous slabs
+     *
+     * Every block is the same size and alignment.  Blocks are never
+     * returned to the system until the allocator is destroyed;
+     * deallocated blocks are reused LIFO so that recently used (warm)
+     * memory is handed out first.  The caller is responsible for
+     * constructing and destroying objects in the blocks.
+     *
+     * The Scheduler keeps one SlabAllocator per PhasedPayloadEvent
+     * proxy size (see Scheduler::getProxySlabAllocator) so that the
+     * proxies of every event with the same payload type are packed
+     * together.
+     */
+    class SlabAllocator
+    {
+    public:
+        /**
+         * \brief Create a SlabAllocator
+         * \param block_size  The size of each block in bytes
+         * \param block_align The alignment of each block
+         * \param blocks_per_slab The number of blocks allocated at a time
+         */
+        SlabAllocator(size_t block_size, size_t block_align, uint32_t blocks_per_slab = 256) :
+            block_align_(block_align),
+            block_size_(((block_size + block_align - 1) / block_align) * block_align),
+            blocks_per_slab_(blocks_per_slab)
+        {
+            sparta_assert(block_size > 0, "SlabAllocator block size must be non-zero");
+            sparta_assert(block_align > 0 && (block_align & (block_align - 1)) == 0,
+                          "SlabAllocator alignment must be a power of 2: " << block_align);
+            sparta_assert(blocks_per_slab > 0, "SlabAllocator needs at least one block per slab");
+        }
+
+        //! Release all slabs
+        ~SlabAllocator() {
+            for(std::byte * slab : slabs_) {
+                ::operator delete(slab, std::align_val_t(block_align_));
+            }
+        }
+
+        //! No copies
+        SlabAllocator(const SlabAllocator &) = delete;
+        SlabAllocator & operator=(const SlabAllocator &) = delete;
+
+        //! \return A block of getBlockSize() bytes
+        void * allocate()
+        {
+            if(SPARTA_EXPECT_FALSE(free_blocks_.empty())) {
+                addSlab_();
+            }
+            void * block = free_blocks_.back();
+            free_blocks_.pop_back();
+            if(++num_in_use_ > high_water_mark_) {
+                high_water_mark_ = num_in_use_;
+            }
+            return block;
+        }
+
+        //! Return a block obtained from allocate()
+        void deallocate(void * block)
+        {
+            sparta_assert(num_in_use_ > 0, "SlabAllocator::deallocate called more than allocate");
+            free_blocks_.emplace_back(block);
+            --num_in_use_;
+        }
+
+        //! \return The size of each block (rounded up to the alignment)
+        size_t getBlockSize() const {
+            return block_size_;
+        }
+
+        //! \return The number of slabs allocated
+        uint32_t getNumSlabs() const {
+            return slabs_.size();
+        }
+
+        //! \return The number of blocks currently allocated
+        uint64_t getNumInUse() const {
+            return num_in_use_;
+        }
+
+        //! \return The largest number of blocks ever allocated at once
+        uint64_t getHighWaterMark() const {
+            return high_water_mark_;
+        }
+
+    private:
+        void addSlab_()
+        {
+            std::byte * slab = static_cast<std::byte*>
+                (::operator new(block_size_ * blocks_per_slab_, std::align_val_t(block_align_)));
+            slabs_.emplace_back(slab);
+
+            // Push in reverse so blocks are handed out in address order
+            free_blocks_.reserve(free_blocks_.size() + blocks_per_slab_);
+            for(uint32_t i = blocks_per_slab_; i > 0; --i) {
+                free_blocks_.emplace_back(slab + (i - 1) * block_size_);
+            }
+        }
+
+        const size_t   block_align_;
+        const size_t   block_size_;
+        const uint32_t blocks_per_slab_;
+
+        std::vector<std::byte*> slabs_;
+        std::vector<void*>      free_blocks_;
+        uint64_t num_in_use_      = 0;
+        uint64_t high_water_mark_ = 0;
+    };
+}
@@ -0,0 +1,166 @@
+// <AsyncWriter> -*- C++ -*-
+
+/**
+ * \file AsyncWriter.hpp
+ * \brief Buffers formatted log messages in memory and writes them to an
+ * output stream from a background thread
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace sparta
+{
+    namespace log
+    {
+        /*!
+         * \brief Collects formatted log messages into large blocks of memory
+         * and writes those blocks to an output stream from a background I/O
+         * thread.
+         *
+         * Formatters write messages to getStream() exactly as they would to
+         * the output stream. Flushing getStream() (e.g. through std::endl) does
+         * not write anything; the owner calls endMessage() after each message
+         * and a block is handed to the I/O thread once it is full. If the I/O
+         * thread falls behind by more than a few blocks, endMessage() waits
+         * for it, which bounds memory use.
+         *
+         * flush() writes everything collected so far and flushes the output
+         * stream. Destruction does the same, so no message is lost unless the
+         * process dies without unwinding (e.g. from a signal).
+         *
+         * Errors from the I/O thread, including writes which leave the output
+         * stream failed, are rethrown by the next endMessage() or flush().
+         *
+         * \note Not thread-safe. Owners serialize calls (see
+         * sparta::log::Destination::write)
+         */
+        class AsyncWriter
+        {
+        public:
+
+            //! Default size at which a block is handed to the I/O thread, in
+            //! bytes
+            static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+            //! Number of full blocks that can wait for the I/O thread before
+            //! endMessage blocks
+            static constexpr std::size_t MAX_PENDING_BLOCKS = 4;
+
+            /*!
+             * \brief Construct a writer and start its I/O thread
+             * \param out Stream to which blocks are written. Must outlive this
+             * writer
+             * \param block_size Size at which a block is written, in bytes
+             */
+            AsyncWriter(std::ostream& out, std::size_t block_size = DEFAULT_BLOCK_SIZE);
+
+            //! Not copyable
+            AsyncWriter(const AsyncWriter&) = delete;
+
+            //! Not assignable
+            AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+            /*!
+             * \brief Write all collected messages, then stop the I/O thread
+             */
+            ~AsyncWriter();
+
+            /*!
+             * \brief Stream into which messages are formatted
+             */
+            std::ostream& getStream() {
+                return stream_;
+            }
+
+            /*!
+             * \brief Notify the writer that a complete message was written to
+             * getStream(). Hands the current block to the I/O thread if it is
+             * full
+             */
+            void endMessage() {
+                if(block_.size() >= block_size_){
+                    writeBlock_();
+                }
+            }
+
+            /*!
+             * \brief Write all collected messages to the output stream, wait
+             * for them to be written, and flush the output stream
+             */
+            void flush();
+
+        private:
+
+            /*!
+             * \brief Stream buffer appending to a block of memory. Grows the
+             * block if a message crosses its end
+             */
+            class BlockBuffer : public std::streambuf
+            {
+            public:
+
+                //! Bytes written to the current block
+                std::size_t size() const {
+                    return pptr() - pbase();
+                }
+
+                /*!
+                 * \brief Take the current block and continue in another
+                 * \param next Block to continue in. Its capacity is reused.
+                 * Receives the current block, resized to its contents
+                 */
+                void swap(std::vector<char>& next, std::size_t capacity);
+
+            protected:
+
+                int_type overflow(int_type c) override;
+
+                std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+            private:
+
+                //! Grow the block to hold at least n more bytes
+                void grow_(std::size_t n);
+
+                std::vector<char> block_;
+            };
+
+            //! Hand the current block to the I/O thread
+            void writeBlock_();
+
+            //! Body of the I/O thread
+            void ioThreadLoop_();
+
+            //! Rethrow an error from the I/O thread, if any
+            void checkIOError_();
+
+            std::ostream& out_; //!< Stream written by the I/O thread
+            const std::size_t block_size_; //!< Size at which a block is written
+            BlockBuffer block_; //!< Block being filled
+            std::ostream stream_; //!< Formats into block_
+
+            // The owner pushes full blocks to pending_blocks_ and takes empty
+            // ones from free_blocks_; the I/O thread does the reverse. All
+            // guarded by io_mutex_.
+            std::mutex io_mutex_;
+            std::condition_variable io_cond_;
+            std::deque<std::vector<char>> pending_blocks_;
+            std::vector<std::vector<char>> free_blocks_;
+            bool io_busy_ = false; //!< The I/O thread is writing a block
+            bool io_stop_ = false; //!< Tell the I/O thread to exit
+            std::exception_ptr io_error_; //!< First error from the I/O thread
+            std::thread io_thread_; //!< Writes full blocks
+        };
+
+    } // namespace log
+} // namespace sparta
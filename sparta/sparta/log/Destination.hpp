@@ -17,6 +17,7 @@
 #include <utility>
 #include <vector>
 
+#include "sparta/log/AsyncWriter.hpp"
 #include "sparta/log/Message.hpp"
 #include "sparta/app/SimulationInfo.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
@@ -40,6 +41,11 @@ namespace sparta
          * Destinations are managed by sparta::log::DestinationManager to ensure
          * that there are usually no duplicates.
          *
+         * Destinations write and flush each message as it arrives unless made
+         * asynchronous (see setAsynchronous), in which case messages are
+         * formatted into memory and written in large blocks from a background
+         * thread.
+         *
          * This Interface constains some compare and compareX methods which
          * are used to compare the Destinations by string or ostream. Supporting
          * destinations identified by a different attribute will require
@@ -171,6 +177,40 @@ namespace sparta
                 last_seq_map_[msg.info.thread_id] = msg.info.seq_num; // Update latest sequence
             };
 
+            /*!
+             * \brief Format messages into memory and write them to the output
+             * from a background thread in large blocks instead of writing and
+             * flushing each message as it arrives.
+             * \param async Write asynchronously. If false, everything buffered
+             * is written before returning
+             * \note This method IS thread-safe
+             *
+             * Destinations which cannot be written asynchronously (e.g. cout
+             * and cerr, which are shared with other output) ignore this.
+             */
+            void setAsynchronous(bool async) {
+                std::lock_guard<std::mutex> lock(write_mutex_);
+                setAsynchronous_(async);
+            }
+
+            /*!
+             * \brief Are messages written asynchronously?
+             */
+            virtual bool isAsynchronous() const {
+                return false;
+            }
+
+            /*!
+             * \brief Write every message buffered by an asynchronous
+             * destination and flush the output. Does nothing for synchronous
+             * destinations, which write messages as they arrive
+             * \note This method IS thread-safe
+             */
+            void flush() {
+                std::lock_guard<std::mutex> lock(write_mutex_);
+                flush_();
+            }
+
             /*!
              * \brief Get the total number of messages logged through this
              * destination.
@@ -217,6 +257,14 @@ namespace sparta
             //! desired.
             virtual void write_(const sparta::log::Message& msg) = 0;
 
+            //! Switch between synchronous and asynchronous writes
+            //! \pre Write mutex will be held on this destination
+            virtual void setAsynchronous_(bool) { }
+
+            //! Write out any buffered messages
+            //! \pre Write mutex will be held on this destination
+            virtual void flush_() { }
+
 
             uint64_t num_msgs_received_;  //!< Total messages received
             uint64_t num_msgs_written_;   //!< Total messages written to the destination (received - duplicates)
@@ -453,6 +501,7 @@ namespace sparta
             const std::string filename_;
             std::unique_ptr<Formatter> formatter_;
             const Formatter::Info* fmtinfo_;
+            std::unique_ptr<AsyncWriter> async_writer_; //!< Writes stream_ if asynchronous
 
         public:
 
@@ -501,6 +550,10 @@ namespace sparta
                 return filename == filename_;
             }
 
+            virtual bool isAsynchronous() const override {
+                return async_writer_ != nullptr;
+            }
+
             // From TreeNode
             virtual std::string stringize(bool pretty=false) const override {
                 (void) pretty;
@@ -515,7 +568,11 @@ namespace sparta
                 ss << "\" ostream="
                    << &stream_ << " rcv=" << getNumMessagesReceived()
                    << " wrote=" << getNumMessagesWritten()
-                   << " dups=" << getNumMessageDuplicates() << ">";
+                   << " dups=" << getNumMessageDuplicates();
+                if(async_writer_){
+                    ss << " async";
+                }
+                ss << ">";
                 return ss.str();
             }
 
@@ -523,7 +580,29 @@ namespace sparta
 
             virtual void write_(const sparta::log::Message& msg) override {
                 formatter_->write(msg);
+                if(async_writer_){
+                    async_writer_->endMessage();
+                }
             };
+
+            virtual void setAsynchronous_(bool async) override {
+                if(async == (async_writer_ != nullptr)){
+                    return;
+                }
+                if(async){
+                    async_writer_.reset(new AsyncWriter(stream_));
+                    formatter_.reset(fmtinfo_->factory(async_writer_->getStream()));
+                }else{
+                    formatter_.reset(fmtinfo_->factory(stream_));
+                    async_writer_.reset(); // Writes everything buffered
+                }
+            }
+
+            virtual void flush_() override {
+                if(async_writer_){
+                    async_writer_->flush();
+                }
+            }
         };
 
 
@@ -573,9 +652,47 @@ namespace sparta
                 }
 
                 dests_.emplace_back(createDestination(arg));
+                if(async_){
+                    dests_.back()->setAsynchronous(true);
+                }
                 return dests_.back().get();
             }
 
+            /*!
+             * \brief Make all current and future destinations write
+             * asynchronously, or make them all synchronous again
+             * \see Destination::setAsynchronous
+             * \note Not thread-safe with respect to creating destinations
+             *
+             * Asynchronous destinations are flushed when destroyed at exit.
+             * Simulations also flush them when an error occurs so that the
+             * messages leading to it are not lost.
+             */
+            static void setAsynchronous(bool async) {
+                async_ = async;
+                for(std::unique_ptr<Destination>& d : dests_){
+                    d->setAsynchronous(async);
+                }
+            }
+
+            /*!
+             * \brief Are new destinations made asynchronous?
+             */
+            static bool isAsynchronous() {
+                return async_;
+            }
+
+            /*!
+             * \brief Write every message buffered by asynchronous destinations
+             * and flush their outputs
+             * \see Destination::flush
+             */
+            static void flushDestinations() {
+                for(std::unique_ptr<Destination>& d : dests_){
+                    d->flush();
+                }
+            }
+
             //! createDestination overload for handling const char[] strings
             template <std::size_t N>
             static Destination* createDestination(const char (&arg)[N]) {
@@ -650,6 +767,9 @@ namespace sparta
 
             //! Static vector of destinations. Automatically deleted upon destruction
             static DestinationVector dests_;
+
+            //! Are new destinations made asynchronous
+            static bool async_;
         };
 
     } // namespace log
@@ -2,8 +2,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <streambuf>
 #include <string>
 #include <sstream>
 #include <utility>
@@ -14,6 +16,7 @@
 #include "sparta/log/Tap.hpp"
 #include "sparta/log/Events.hpp"
 #include "sparta/log/categories/CategoryManager.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
 #include "sparta/utils/StringManager.hpp"
 #include "sparta/utils/Utils.hpp"
 #include "sparta/log/MessageInfo.hpp"
@@ -26,6 +29,116 @@ namespace sparta
      */
     namespace log
     {
+        /*!
+         * \brief Reusable buffer into which log messages are formatted.
+         *
+         * Buffers are pooled per thread. A buffer keeps its memory and its
+         * ostream between messages, so formatting a message shorter than
+         * getSize() does not allocate. Longer messages grow the buffer, which
+         * is shrunk back to getSize() when released.
+         *
+         * The stream's formatting state (flags, fill, precision and width) is
+         * reset when a buffer is released, so manipulators such as std::hex
+         * only apply to the message in which they are used.
+         */
+        class MessageBuffer
+        {
+        public:
+
+            //! Default size of a message buffer, in bytes
+            static constexpr std::size_t DEFAULT_SIZE = 512;
+
+            //! Not copyable
+            MessageBuffer(const MessageBuffer&) = delete;
+
+            //! Not assignable
+            MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+            /*!
+             * \brief Take an empty buffer from this thread's pool, allocating
+             * one if the pool is empty
+             */
+            static MessageBuffer* acquire();
+
+            /*!
+             * \brief Return a buffer to this thread's pool
+             */
+            static void release(MessageBuffer* buf);
+
+            /*!
+             * \brief Set the size of message buffers. Messages under this size
+             * are formatted without allocating
+             * \note Applies to buffers as they are released
+             */
+            static void setSize(std::size_t size) {
+                size_ = size;
+            }
+
+            /*!
+             * \brief Get the size of message buffers
+             */
+            static std::size_t getSize() {
+                return size_;
+            }
+
+            /*!
+             * \brief Stream which formats into this buffer
+             */
+            std::ostream& getStream() {
+                return stream_;
+            }
+
+            /*!
+             * \brief Get the message formatted so far
+             * \warning Invalidated by further writes to getStream()
+             */
+            const std::string& getContent() {
+                return buf_.getContent();
+            }
+
+        private:
+
+            /*!
+             * \brief Stream buffer writing into the storage of a string
+             */
+            class StringBuffer : public std::streambuf
+            {
+            public:
+
+                //! Trim the string to what was written and return it
+                const std::string& getContent();
+
+                //! Discard the content and make room for size bytes
+                void reset(std::size_t size);
+
+            protected:
+
+                int_type overflow(int_type c) override;
+
+                std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+            private:
+
+                //! Grow the string to hold at least n more bytes
+                void grow_(std::size_t n);
+
+                std::string str_;
+            };
+
+            MessageBuffer();
+
+            ~MessageBuffer() = default;
+
+            StringBuffer buf_; //!< Storage of the message
+            std::ostream stream_; //!< Formats into buf_
+            MessageBuffer* next_free_ = nullptr; //!< Next buffer in the pool
+
+            //! Size of message buffers
+            static std::size_t size_;
+
+            friend struct MessageBufferPool;
+        };
+
         /*!
          * \brief Message source object associated with a sparta TreeNode through which messages can be sent.
          *
@@ -137,20 +250,25 @@ namespace sparta
                 const sparta::log::MessageSource* src_;
 
                 /*!
-                 * \brief Temporary string buffer
+                 * \brief Pooled buffer holding the message. Null once moved
+                 * from
                  */
-                std::ostringstream s_;
+                MessageBuffer* buf_;
 
             public:
 
                 //! \brief Not default-constructable
                 LogObject() = delete;
 
-                //! Move constructor
+                //! Move constructor. Takes the message from rhp, which will
+                //! not emit anything
                 LogObject(LogObject&& rhp) :
                     src_(rhp.src_),
-                    s_(rhp.s_.str()) // May unfortunately involve a copy
-                { }
+                    buf_(rhp.buf_)
+                {
+                    rhp.src_ = nullptr;
+                    rhp.buf_ = nullptr;
+                }
 
                 //! \brief Not Copy-constructable
                 LogObject(const LogObject& rhp) = delete;
@@ -159,7 +277,8 @@ namespace sparta
                  * \brief Construct with message source
                  */
                 LogObject(const MessageSource& src) :
-                    src_(&src)
+                    src_(&src),
+                    buf_(MessageBuffer::acquire())
                 { }
 
                 /*!
@@ -167,9 +286,9 @@ namespace sparta
                  */
                 template <class T>
                 LogObject(const MessageSource& src, const T& init) :
-                    src_(&src)
+                    LogObject(src)
                 {
-                    s_ << init;
+                    buf_->getStream() << init;
                 }
 
                 /*!
@@ -177,9 +296,9 @@ namespace sparta
                  * std::setw)
                  */
                 LogObject(const MessageSource& src, std::ostream& (*f)(std::ostream&)) :
-                    src_(&src)
+                    LogObject(src)
                 {
-                    f(s_);
+                    f(buf_->getStream());
                 }
 
                 /*!
@@ -189,8 +308,11 @@ namespace sparta
                  * MessageSource::emit_
                  */
                 ~LogObject() {
-                    if(src_){
-                        src_->emit_(s_.str());
+                    if(buf_){
+                        if(src_){
+                            src_->emit_(buf_->getContent());
+                        }
+                        MessageBuffer::release(buf_);
                     }
                 }
 
@@ -209,7 +331,7 @@ namespace sparta
                  */
                 template <class T>
                 LogObject& operator<<(const T& t) {
-                    s_ << t;
+                    buf_->getStream() << t;
                     return *this;
                 }
 
@@ -217,9 +339,54 @@ namespace sparta
                  * \brief Handler for stream modifiers (e.g. endl)
                  */
                 LogObject& operator<<(std::ostream& (*f)(std::ostream&)) {
-                    f(s_);
+                    f(buf_->getStream());
                     return *this;
                 }
+
+                /*!
+                 * \brief Append to the message with fmt-style replacement
+                 * fields
+                 * \param fmt Format string. Each "{}" is replaced by the next
+                 * argument, written as by operator<<. "{{" and "}}" write
+                 * literal braces
+                 * \return This LogObject
+                 * \throw SpartaException if the number of "{}" fields does not
+                 * match the number of arguments
+                 *
+                 * Example:
+                 * \code
+                 * logger.format("uid={} addr=0x{}", uid, addr_str);
+                 * \endcode
+                 */
+                template <typename... Args>
+                LogObject& format(const char* fmt, const Args&... args) {
+                    format_(fmt, args...);
+                    return *this;
+                }
+
+            private:
+
+                /*!
+                 * \brief Write the format string up to the next "{}" field
+                 * \return Position following the field, or nullptr if the
+                 * end of the format string was reached
+                 */
+                const char* writeLiteral_(const char* fmt);
+
+                void format_(const char* fmt) {
+                    const char* next = writeLiteral_(fmt);
+                    sparta_assert(next == nullptr,
+                                  "Too few arguments for log message format \"" << fmt << "\"");
+                }
+
+                template <typename T, typename... Args>
+                void format_(const char* fmt, const T& arg, const Args&... args) {
+                    const char* next = writeLiteral_(fmt);
+                    sparta_assert(next != nullptr,
+                                  "Too many arguments for log message format \"" << fmt << "\"");
+                    buf_->getStream() << arg;
+                    format_(next, args...);
+                }
             };
 
             template <class T>
@@ -239,6 +406,17 @@ namespace sparta
                 return LogObject(*this, msg);
             }
 
+            /*!
+             * \brief Start a message with fmt-style replacement fields
+             * \see LogObject::format
+             */
+            template <typename... Args>
+            LogObject format(const char* fmt, const Args&... args) const {
+                LogObject obj(*this);
+                obj.format(fmt, args...);
+                return obj;
+            }
+
             ////////////////////////////////////////////////////////////////////////
             //! @}
 
@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "sparta/utils/SpartaException.hpp"
 #include "sparta/memory/MemoryExceptions.hpp"
 #include "sparta/memory/AddressTypes.hpp"
@@ -34,11 +39,28 @@ namespace sparta
          *
          * For checkpointing support, the owner_node construct argument must
          * be used
+         *
+         * Accesses within a single block can optionally be resolved through a
+         * flat page table of direct pointers to block data instead of the
+         * sparse line map (see setPageTableEnabled).
          */
         class MemoryObject : public ArchData
         {
         public:
 
+            /*!
+             * \brief Number of blocks covered by each lazily-allocated page of
+             * the page table is 2^PAGE_TABLE_BITS
+             */
+            static constexpr uint32_t PAGE_TABLE_BITS = 12;
+
+            /*!
+             * \brief Maximum number of pages in the page table directory.
+             * Limits the directory of a 64 B-block memory object to 8 MB and
+             * its footprint to 256 GB
+             */
+            static constexpr addr_t MAX_PAGE_TABLE_PAGES = 1 << 20;
+
             //! \name Construction
             //! @{
             ////////////////////////////////////////////////////////////////////////
@@ -132,6 +154,22 @@ namespace sparta
             void read(addr_t addr,
                       addr_t size,
                       uint8_t *buf) const {
+                if(isPageTableAccess_(addr, size)){
+                    PageTableEntry & entry = getPageTableEntry_(addr);
+                    if(SPARTA_EXPECT_FALSE(entry.data == nullptr)){
+                        // Unrealized blocks are not cached so that they keep
+                        // reading as fill until written
+                        if(const ArchData::Line* l = ArchData::tryGetLine(addr)){
+                            // Lines are owned by this object
+                            entry = makePageTableEntry_(const_cast<ArchData::Line&>(*l));
+                        }
+                    }
+                    if(entry.data != nullptr){
+                        std::memcpy(buf, entry.data + (addr & (getBlockSize() - 1)), size);
+                        return;
+                    }
+                }
+
                 // Address validation performed in tryGetLine
                 const ArchData::Line* l = ArchData::tryGetLine(addr);
                 if(!l){
@@ -157,6 +195,16 @@ namespace sparta
             void write(addr_t addr,
                        addr_t size,
                        const uint8_t *buf) {
+                if(isPageTableAccess_(addr, size)){
+                    PageTableEntry & entry = getPageTableEntry_(addr);
+                    if(SPARTA_EXPECT_FALSE(entry.data == nullptr)){
+                        entry = makePageTableEntry_(ArchData::getLine(addr));
+                    }
+                    std::memcpy(entry.data + (addr & (getBlockSize() - 1)), buf, size);
+                    entry.line->flagDirty(); // Checkpointers save dirty lines only
+                    return;
+                }
+
                 // Address validation performed in getLine
                 ArchData::Line& l = ArchData::getLine(addr);
 
@@ -167,6 +215,63 @@ namespace sparta
             ////////////////////////////////////////////////////////////////////////
             //! @}
 
+            //! \name Page Table
+            //! @{
+            ////////////////////////////////////////////////////////////////////////
+
+            /*!
+             * \brief Enables or disables the page table resolving accesses
+             * within a single block
+             * \param enable Use the page table for read and write
+             * \throw SpartaException if enabling would require more than
+             * MAX_PAGE_TABLE_PAGES pages
+             *
+             * The page table only holds a directory of pages up front. Each
+             * page of 2^PAGE_TABLE_BITS entries is allocated the first time
+             * one of its blocks is accessed, and each entry is filled the
+             * first time its block is written (or read once realized).
+             * Entries point directly to the block data and its line, which is
+             * flagged dirty on every write so that checkpointing is
+             * unaffected. The table is dropped whenever lines are freed (e.g.
+             * by a checkpoint restore through clean()).
+             *
+             * Accesses spanning blocks or outside this object take the
+             * regular path, which validates them.
+             */
+            void setPageTableEnabled(bool enable) {
+                page_dir_.clear();
+                num_paged_blocks_ = 0;
+                if(enable){
+                    const addr_t num_blocks = getNumBlocks();
+                    const addr_t num_pages = (num_blocks + PAGE_TABLE_SIZE - 1) >> PAGE_TABLE_BITS;
+                    if(num_pages > MAX_PAGE_TABLE_PAGES){
+                        throw SpartaException("Cannot enable the page table of a MemoryObject with ")
+                            << num_blocks << " blocks, which would need " << num_pages
+                            << " pages. At most " << MAX_PAGE_TABLE_PAGES << " pages are allowed";
+                    }
+                    page_dir_.resize(num_pages);
+                    num_paged_blocks_ = num_blocks;
+                }
+                page_dir_.shrink_to_fit();
+            }
+
+            //! Is the page table used by read and write?
+            bool isPageTableEnabled() const {
+                return num_paged_blocks_ != 0;
+            }
+
+            //! Number of pages of the page table allocated so far
+            addr_t getNumPageTablePages() const {
+                addr_t num = 0;
+                for(const auto & page : page_dir_){
+                    num += (page != nullptr);
+                }
+                return num;
+            }
+
+            ////////////////////////////////////////////////////////////////////////
+            //! @}
+
             //! \name Analysis/Testing Methods
             //! @{
             ////////////////////////////////////////////////////////////////////////
@@ -225,6 +330,58 @@ namespace sparta
                 return ArchData::getInitialValSize();
             }
 
+        protected:
+
+            //! Override of ArchData::onFreeingLines_. Drops the page table
+            //! before its lines are deleted
+            void onFreeingLines_() override {
+                for(auto & page : page_dir_){
+                    page.reset();
+                }
+            }
+
+        private:
+
+            //! Number of entries in a page of the page table
+            static constexpr addr_t PAGE_TABLE_SIZE = addr_t(1) << PAGE_TABLE_BITS;
+
+            //! Page table entry of a realized block
+            struct PageTableEntry
+            {
+                uint8_t* data = nullptr;         //!< Data of the block
+                ArchData::Line* line = nullptr;  //!< Line holding the block
+            };
+
+            static PageTableEntry makePageTableEntry_(ArchData::Line& line) {
+                return {line.getRawDataPtr(0), &line};
+            }
+
+            //! Can this access go through the page table? Always false while
+            //! the page table is disabled
+            bool isPageTableAccess_(addr_t addr, addr_t size) const {
+                return (ArchData::getLineIndex(addr) < num_paged_blocks_)
+                    && ((addr & (getBlockSize() - 1)) + size <= getBlockSize());
+            }
+
+            //! Entry of the block containing addr, allocating its page if needed
+            PageTableEntry & getPageTableEntry_(addr_t addr) const {
+                const addr_t idx = ArchData::getLineIndex(addr);
+                auto & page = page_dir_[idx >> PAGE_TABLE_BITS];
+                if(SPARTA_EXPECT_FALSE(page == nullptr)){
+                    page.reset(new PageTableEntry[PAGE_TABLE_SIZE]);
+                }
+                return page[idx & (PAGE_TABLE_SIZE - 1)];
+            }
+
+            /*!
+             * \brief Directory of pages of the page table. Mutable so that reads
+             * can fill it
+             */
+            mutable std::vector<std::unique_ptr<PageTableEntry[]>> page_dir_;
+
+            //! Number of blocks covered by the page table. 0 when disabled
+            addr_t num_paged_blocks_ = 0;
+
         }; // class MemoryObject
 
 
@@ -332,12 +489,11 @@ namespace sparta
                 }
 
                 auto & line = binding_.getLine(aligned_addr);
-                dmi_ifs_.insert({aligned_addr,
-                                 std::unique_ptr<DMIBlockingMemoryIF>
-                                 (new DMIBlockingMemoryIF(line.getRawDataPtr(0),
-                                                          line.getOffset(),
-                                                          line.getLayoutSize()))});
-                return dmi_ifs_[aligned_addr].get();
+                auto & dmi = dmi_ifs_[aligned_addr];
+                dmi.reset(new DMIBlockingMemoryIF(line.getRawDataPtr(0),
+                                                  line.getOffset(),
+                                                  line.getLayoutSize()));
+                return dmi.get();
             }
 
             /*!
@@ -399,7 +555,9 @@ namespace sparta
                 return true;
             }
 
-            std::map<addr_t, std::unique_ptr<DMIBlockingMemoryIF>> dmi_ifs_;
+            //! DMI interfaces by block address. Hashed since blocks are only
+            //! ever looked up by exact address
+            std::unordered_map<addr_t, std::unique_ptr<DMIBlockingMemoryIF>> dmi_ifs_;
 
         }; // class BlockingMemoryIF
 
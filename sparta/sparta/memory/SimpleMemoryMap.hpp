@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include "sparta/memory/MemoryExceptions.hpp"
 #include "sparta/memory/AddressTypes.hpp"
 #include "sparta/memory/BlockingMemoryIF.hpp"
@@ -36,6 +39,12 @@ namespace sparta
          * Implemented as a red-black tree to balance the tree and make lookups
          * more consistently log(n).
          *
+         * Once all mappings are known, compile() flattens the tree into a
+         * sorted array of range boundaries (searched without branches), a
+         * direct table of pages when the mapped space is dense enough, and a
+         * last-hit cache. Lookups use these instead of the tree from then on.
+         * Mappings added after compile() recompile the lookup.
+         *
          * Example
          * \code
          * using sparta::memory;
@@ -149,7 +158,12 @@ namespace sparta
             SimpleMemoryMap(addr_t block_size) :
                 block_size_(block_size),
                 bintree_(nullptr),
-                num_mappings_(0)
+                num_mappings_(0),
+                compiled_(false),
+                page_base_(0),
+                page_shift_(0),
+                num_pages_(0),
+                last_hit_(nullptr)
             {
                 sparta_assert(block_size > 0, "block size must be greater than 0");
                 block_idx_rshift_ = (addr_t)log2(block_size);
@@ -423,6 +437,101 @@ namespace sparta
 
                 num_mappings_ += 1;
                 mappings_.push_back(n->dest.get());
+
+                if(compiled_){
+                    compile();
+                }
+            }
+
+            /*!
+             * \brief Build the flat lookup structures from the current
+             * mappings. findMapping, findInterface, mapAddress and
+             * verifyHasMapping use them instead of the tree from then on.
+             *
+             * The address space is split into segments at every mapping
+             * endpoint, each either holding one mapping or nothing. Their
+             * start addresses are kept in a sorted array. If the pages of the
+             * mapped span (the largest power of 2 dividing every endpoint)
+             * number no more than MAX_DIRECT_PAGES, a direct table of segment
+             * indices by page is also built.
+             *
+             * Can be called again at any time; addMapping recompiles
+             * automatically once this has been called.
+             */
+            void compile() {
+                std::vector<Mapping*> sorted;
+                sorted.reserve(num_mappings_);
+                collectMappings_(bintree_, sorted);
+                std::sort(sorted.begin(), sorted.end(),
+                          [](const Mapping* m1, const Mapping* m2){return m1->start < m2->start;});
+
+                bounds_.clear();
+                segments_.clear();
+                page_table_.clear();
+                num_pages_ = 0;
+                last_hit_ = nullptr;
+
+                // Segment 0 always starts at 0 so that every address has one.
+                // A segment starting where the last one does replaces it
+                auto add_segment = [this](addr_t start, Mapping* m) {
+                    if(bounds_.back() == start){
+                        segments_.back() = m;
+                    }else{
+                        bounds_.push_back(start);
+                        segments_.push_back(m);
+                    }
+                };
+                addr_t prev_end = 0;
+                addr_t boundary_bits = 0;
+                bounds_.push_back(0);
+                segments_.push_back(nullptr);
+                for(Mapping* m : sorted){
+                    if(m->start != prev_end){
+                        add_segment(prev_end, nullptr);
+                    }
+                    add_segment(m->start, m);
+                    boundary_bits |= m->start | m->end;
+                    prev_end = m->end;
+                }
+                add_segment(prev_end, nullptr);
+
+                if(!sorted.empty()){
+                    page_shift_ = block_idx_rshift_;
+                    while(page_shift_ < sizeof(addr_t) * 8 - 1
+                          && (boundary_bits & ((addr_t)1 << page_shift_)) == 0){
+                        ++page_shift_;
+                    }
+                    page_base_ = sorted.front()->start;
+                    const addr_t num_pages = (prev_end - page_base_) >> page_shift_;
+                    if(num_pages <= MAX_DIRECT_PAGES){
+                        page_table_.resize(num_pages);
+                        uint32_t seg = findSegment_(page_base_);
+                        for(addr_t p = 0; p < num_pages; ++p){
+                            const addr_t addr = page_base_ + (p << page_shift_);
+                            while(seg + 1 < bounds_.size() && bounds_[seg + 1] <= addr){
+                                ++seg;
+                            }
+                            page_table_[p] = seg;
+                        }
+                        num_pages_ = num_pages;
+                    }
+                }
+
+                compiled_ = true;
+            }
+
+            /*!
+             * \brief Has compile() been called on this map
+             */
+            bool isCompiled() const {
+                return compiled_;
+            }
+
+            /*!
+             * \brief Is the compiled lookup using a direct page table
+             */
+            bool hasDirectPageTable() const {
+                return num_pages_ != 0;
             }
 
             /*!
@@ -490,6 +599,10 @@ namespace sparta
              * contained in a mapping. If not found, returns nullptr.
              */
             Mapping* findMapping(addr_t addr) {
+                if(compiled_){
+                    return findCompiled_(addr);
+                }
+
                 // Navigate the bintree to find the addr (if contained)
                 BinTreeNode* n = bintree_;
                 Mapping* m = nullptr;
@@ -522,6 +635,10 @@ namespace sparta
              * const-qualified version of findMapping
              */
             const Mapping* findMapping(addr_t addr) const {
+                if(compiled_){
+                    return findCompiled_(addr);
+                }
+
                 // Navigate the bintree to find the addr (if contained)
                 const BinTreeNode* n = bintree_;
                 const Mapping* m = nullptr;
@@ -559,6 +676,17 @@ namespace sparta
             void verifyHasMapping(addr_t addr, addr_t size) const {
                 const addr_t end = addr+size;
 
+                if(compiled_){
+                    const Mapping* m = findCompiled_(addr);
+                    if(!m){
+                        throw MemoryAccessError(addr, size, "any", "No single mapping found for this address/size");
+                    }
+                    if(end > m->end){
+                        throw MemoryAccessError(addr, size, "any", "This access spans more than one mapping");
+                    }
+                    return;
+                }
+
                 const BinTreeNode* n = bintree_;
                 const Mapping* m = nullptr;
 
@@ -807,6 +935,63 @@ namespace sparta
                 bool red;               //!< Color of the node for RB-tree. If false, black
             };
 
+            /*!
+             * \brief Largest number of entries in the direct page table built
+             * by compile(). Keeps the table within 64KB
+             */
+            static constexpr addr_t MAX_DIRECT_PAGES = 16384;
+
+            /*!
+             * \brief Appends the mappings of the subtree at \a n to \a out
+             */
+            static void collectMappings_(BinTreeNode* n, std::vector<Mapping*>& out) {
+                if(!n){
+                    return;
+                }
+                collectMappings_(n->l, out);
+                if(n->dest){
+                    out.push_back(n->dest.get());
+                }
+                collectMappings_(n->r, out);
+            }
+
+            /*!
+             * \brief Index of the last segment starting at or before \a addr.
+             * The loop has a fixed trip count for a given number of segments
+             * and its body compiles to a conditional move
+             */
+            uint32_t findSegment_(addr_t addr) const noexcept {
+                const addr_t* base = bounds_.data();
+                size_t len = bounds_.size();
+                while(len > 1){
+                    const size_t half = len / 2;
+                    base = (base[half] <= addr) ? base + half : base;
+                    len -= half;
+                }
+                return base - bounds_.data();
+            }
+
+            /*!
+             * \brief Lookup used once compiled: last hit, then the page table,
+             * then the boundary array
+             */
+            Mapping* findCompiled_(addr_t addr) const noexcept {
+                if(last_hit_ && addr >= last_hit_->start && addr < last_hit_->end){
+                    return last_hit_;
+                }
+                Mapping* m;
+                const addr_t page = (addr - page_base_) >> page_shift_;
+                if(page < num_pages_){
+                    m = segments_[page_table_[page]];
+                }else{
+                    m = segments_[findSegment_(addr)];
+                }
+                if(m){
+                    last_hit_ = m;
+                }
+                return m;
+            }
+
             /*!
              * \brief Perform red-black tree insertion fixup to balance the tree
              * \param n Node to fix then ascend the tree and fix.
@@ -985,6 +1170,48 @@ namespace sparta
              */
             addr_t block_offset_mask_;
 
+            /*!
+             * \brief Has compile() been called
+             */
+            bool compiled_;
+
+            /*!
+             * \brief Sorted start addresses of the segments of the address
+             * space. The first is always 0
+             */
+            std::vector<addr_t> bounds_;
+
+            /*!
+             * \brief Mapping of each segment in bounds_ (nullptr if unmapped)
+             */
+            std::vector<Mapping*> segments_;
+
+            /*!
+             * \brief Segment index of each page of the mapped span. Empty if
+             * the span has more than MAX_DIRECT_PAGES pages
+             */
+            std::vector<uint32_t> page_table_;
+
+            /*!
+             * \brief Address of the first page in page_table_
+             */
+            addr_t page_base_;
+
+            /*!
+             * \brief Amount to rshift an offset from page_base_ to get a page
+             */
+            addr_t page_shift_;
+
+            /*!
+             * \brief Number of pages in page_table_ (0 if not built)
+             */
+            addr_t num_pages_;
+
+            /*!
+             * \brief Mapping found by the last compiled lookup
+             */
+            mutable Mapping* last_hit_;
+
         }; // class SimpleMemoryMap
     } // namespace memory
 } // namespace sparta
@@ -190,6 +190,15 @@ namespace sparta
 
         protected:
 
+            /*!
+             * \brief Compiles the lookup of this map when the tree is bound
+             * after finalization. Mappings added afterward recompile it
+             * \see SimpleMemoryMap::compile
+             */
+            void onBindTreeLate_() override {
+                compile();
+            }
+
             //! \name Access and Query Implementations
             //! @{
             ////////////////////////////////////////////////////////////////////////
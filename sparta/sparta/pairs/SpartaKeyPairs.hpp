@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <cinttypes>
+#include <cstdio>
 #include <memory>
 #include <sstream>
 #include <iostream>
@@ -63,6 +65,18 @@ namespace sparta {
             data_list_[id].second = true;
         }
 
+        /**
+         * \brief Update the value at index id of a pevent pair with a number.
+         * The number is written as Pair::formatStream_ would have formatted
+         * it (see appendValue), but only when a pevent is written as text.
+         */
+        inline void updatePEventNumericCache(const uint64_t val, const uint32_t id) {
+            data_list_[id].first = val;
+            data_list_[id].second = true;
+            string_value_list_[id].clear();
+            pevent_numeric_list_[id] = true;
+        }
+
         //! Method which updates the sizeof of the value at index id.
         inline void updateSizeOfCache(const uint16_t val, const uint32_t id) {
             sizeof_list_[id] = val;
@@ -100,6 +114,7 @@ namespace sparta {
             name_strings_list_.emplace_back(key);
             string_value_list_.emplace_back("");
             data_list_.emplace_back(std::make_pair(std::numeric_limits<uint64_t>::max(), false));
+            pevent_numeric_list_.emplace_back(false);
         }
 
         /**
@@ -111,6 +126,7 @@ namespace sparta {
             data_list_.reserve(capacity);
             string_value_list_.reserve(capacity);
             formatter_list_.reserve(capacity);
+            pevent_numeric_list_.reserve(capacity);
         }
 
         //! Return the format guide to be used in pipeViewer Viewer.
@@ -148,6 +164,12 @@ namespace sparta {
             return formatter_list_;
         }
 
+        //! Method which return a constant reference to our private vector
+        //  of flags telling which numbers came from pevent pairs.
+        inline const std::vector<bool> & getPEventNumericVector() const {
+            return pevent_numeric_list_;
+        }
+
         //! Method which returns a string vector for PEvent generation.
         const std::vector<CachedPair> & getPEventLogVector() const {
             pevents_log_vector_.clear();
@@ -157,35 +179,42 @@ namespace sparta {
                         name_strings_list_[i], string_value_list_[i]));
                 }
                 else if(data_list_[i].second) {
-                    switch(formatter_list_[i]) {
-                        case PairFormatter::OCTAL :
-                        {
-                            std::stringstream ss;
-                            ss << std::oct << data_list_[i].first;
-                            pevents_log_vector_.emplace_back(std::make_pair(
-                                name_strings_list_[i], ss.str()));
-                            break;
-                        }
-                        case PairFormatter::HEX :
-                        {
-                            std::stringstream ss;
-                            ss << std::hex << data_list_[i].first;
-                            pevents_log_vector_.emplace_back(std::make_pair(
-                                name_strings_list_[i], ss.str()));
-                            break;
-                        }
-                        default :
-                            pevents_log_vector_.emplace_back(
-                                std::make_pair(
-                                    name_strings_list_[i],
-                                    std::to_string(data_list_[i].first)));
-                            break;
-                    }
+                    std::string value;
+                    appendValue(value, data_list_[i].first, formatter_list_[i],
+                                pevent_numeric_list_[i]);
+                    pevents_log_vector_.emplace_back(std::make_pair(
+                        name_strings_list_[i], std::move(value)));
                 }
             }
             return pevents_log_vector_;
         }
 
+        /**
+         * \brief Append the text of a numeric value to a string
+         * \param out String to append to
+         * \param val Value
+         * \param format Base of the value
+         * \param pevent_numeric Format as Pair::formatStream_ does for
+         * pevent pairs (prefixed, padded octal and hex) rather than as a
+         * plain number
+         */
+        static void appendValue(std::string & out, const uint64_t val,
+                                const PairFormatter format, const bool pevent_numeric) {
+            char buf[32];
+            switch(format) {
+                case PairFormatter::OCTAL :
+                    std::snprintf(buf, sizeof(buf), pevent_numeric ? "0%08" PRIo64 : "%" PRIo64, val);
+                    break;
+                case PairFormatter::HEX :
+                    std::snprintf(buf, sizeof(buf), pevent_numeric ? "0x%08" PRIx64 : "%" PRIx64, val);
+                    break;
+                default :
+                    std::snprintf(buf, sizeof(buf), "%" PRIu64, val);
+                    break;
+            }
+            out += buf;
+        }
+
     private:
 
         /**
@@ -204,6 +233,7 @@ namespace sparta {
         std::vector<std::string> name_strings_list_;
         std::vector<std::string> string_value_list_;
         std::vector<ValidPair> data_list_;
+        std::vector<bool> pevent_numeric_list_;
         mutable std::vector<CachedPair> pevents_log_vector_;
     };
 
@@ -586,6 +616,23 @@ namespace sparta {
                 return true;
             }
 
+            // cache the new data, so we can check if it is dirty next time.
+            data_cpy_.reset(new UnRefDataT(tmp));
+
+            // Integers are only formatted if the pevent is written as text.
+            // Negative numbers are formatted now since their text depends on
+            // their type.
+            if constexpr (isPlainInteger_()) {
+                bool negative = false;
+                if constexpr (std::is_signed<UnRefDataT>::value) {
+                    negative = tmp < 0;
+                }
+                if(!negative) {
+                    c->updatePEventNumericCache(static_cast<uint64_t>(tmp), id_);
+                    return false;
+                }
+            }
+
             // let the pair_cache use my data as a string. We were dirty by this point.
             // so we need to change the data in the pair pair_cache.
             std::stringstream s;
@@ -598,15 +645,27 @@ namespace sparta {
 
             // Pass the data up to the key pair string cache.
             c->updateStringCache(s.str(), id_);
-
-            // cache the new data, so we can check if it is dirty next time.
-            data_cpy_.reset(new UnRefDataT(tmp));
             return false;
         }
 
     protected:
         std::unique_ptr<UnRefDataT> data_cpy_;
         FuncType func_;
+
+    private:
+        //! Is DataT an integer that streams as a number (not bool or a
+        //  character type)
+        static constexpr bool isPlainInteger_() {
+            using T = typename std::remove_cv<UnRefDataT>::type;
+            return std::is_integral<T>::value &&
+                !std::is_same<T, bool>::value &&
+                !std::is_same<T, char>::value &&
+                !std::is_same<T, signed char>::value &&
+                !std::is_same<T, unsigned char>::value &&
+                !std::is_same<T, wchar_t>::value &&
+                !std::is_same<T, char16_t>::value &&
+                !std::is_same<T, char32_t>::value;
+        }
     };
 
     /**
@@ -0,0 +1,300 @@
+// <BinaryPevents> -*- C++ -*-
+
+
+/**
+ * \file BinaryPevents.hpp
+ * \brief Compact binary pevent files and their conversion to the text
+ * format written through log taps
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sparta/log/AsyncWriter.hpp"
+#include "sparta/pairs/PairFormatter.hpp"
+#include "sparta/pairs/SpartaKeyPairs.hpp"
+
+namespace sparta{
+namespace pevents{
+
+    /**
+     * \brief Layout of binary pevent files.
+     *
+     * A file starts with MAGIC, the format VERSION, ENDIAN_CHECK (as written
+     * by the host, so that a reader can reject files written with another
+     * byte order) and the simulation info header that text pevent files
+     * start with. The rest of the file is a sequence of chunks, each
+     * starting with a ChunkType byte:
+     *
+     * \li SCHEMA: u32 schema id, then the event name, location and category
+     *     of the collector, u32 number of fields and, for every field, its
+     *     name and PairFormatter (u16). Written once per collector, before
+     *     its first record.
+     * \li STRING: u32 string id, then the string. Written once per distinct
+     *     string value, before the first record using it.
+     * \li RECORD: u32 schema id, u64 tick and u64 cycle of the collector
+     *     node (NO_CYCLE if it has no clock), u64 skewed pevent cycle
+     *     ("cyc"), then a FieldKind byte and a u64 value (the number, string
+     *     id or string length) for every field of the schema. Records of a
+     *     schema all have the same size, except for the characters of
+     *     INLINE_STRING fields which follow their length.
+     *
+     * Strings are written as a u32 length followed by the characters.
+     * Numbers are written in host byte order.
+     */
+    namespace binary_format
+    {
+        constexpr char MAGIC[8] = {'S', 'P', 'A', 'P', 'E', 'V', 'T', '\0'};
+        constexpr uint32_t VERSION = 1;
+        constexpr uint32_t ENDIAN_CHECK = 0x01020304;
+
+        //! Cycle of records from collector nodes without a clock
+        constexpr uint64_t NO_CYCLE = std::numeric_limits<uint64_t>::max();
+
+        enum class ChunkType : uint8_t {
+            SCHEMA = 1,
+            STRING = 2,
+            RECORD = 3
+        };
+
+        enum class FieldKind : uint8_t {
+            ABSENT         = 0, //!< Neither a string nor a valid value. Not written as text
+            NUMERIC        = 1, //!< Value is a plain number in the base of the field's PairFormatter
+            PEVENT_NUMERIC = 2, //!< Value is a number formatted like pevent pairs (e.g. 0x0000abcd)
+            STRING         = 3, //!< Value is the id of a string
+            INLINE_STRING  = 4  //!< Value is the length of a string following it
+        };
+
+        //! Number of distinct strings interned per file. Further strings
+        //! are written inline, so that unique values (e.g. disassembly with
+        //! addresses) do not grow the string table without bound
+        constexpr uint32_t MAX_INTERNED_STRINGS = 1 << 16;
+    } // namespace binary_format
+
+    /**
+     * \class BinaryPeventWriter
+     * \brief Writes pevents to a binary file instead of formatting them as
+     * text.
+     *
+     * Pevent collectors write to a BinaryPeventWriter instead of a log tap
+     * when the file given to --pevents ends with FILE_EXTENSION. Every event
+     * becomes a fixed-size record holding the raw values of its pairs;
+     * integers are not formatted at all and string values are interned and
+     * written once (up to binary_format::MAX_INTERNED_STRINGS distinct
+     * strings). Records are collected in
+     * blocks and written from a background thread (see
+     * sparta::log::AsyncWriter).
+     *
+     * BinaryPeventReader converts the file offline to exactly the text that
+     * a log tap would have written (see the pevent_convert tool).
+     *
+     * Like log destinations, a writer is opened once per file for the
+     * process and shared by every collector writing to that file.
+     */
+    class BinaryPeventWriter
+    {
+    public:
+
+        //! Files ending with this extension are written in binary
+        static constexpr const char* FILE_EXTENSION = ".bin";
+
+        //! Does the given pevent filename select the binary format
+        static bool isBinaryFile(const std::string& filename);
+
+        /**
+         * \brief Get the writer for a file, opening (and truncating) it
+         * if this process has not opened it yet
+         * \throw SpartaException if the file cannot be opened
+         */
+        static BinaryPeventWriter* getWriter(const std::string& filename);
+
+        //! Write everything collected by all writers to their files
+        static void flushWriters();
+
+        /**
+         * \brief Open a file and write the file header
+         * \note Use getWriter so that collectors share writers
+         */
+        BinaryPeventWriter(const std::string& filename);
+
+        //! Not copyable
+        BinaryPeventWriter(const BinaryPeventWriter&) = delete;
+
+        //! Not assignable
+        BinaryPeventWriter& operator=(const BinaryPeventWriter&) = delete;
+
+        const std::string& getFilename() const {
+            return filename_;
+        }
+
+        /**
+         * \brief Describe the events of a collector
+         * \param event_name Name of the event ("ev")
+         * \param location Location of the collector node
+         * \param category Log category of the collector
+         * \param names Names of the pairs of the event
+         * \param formats Formatter of each pair
+         * \return Schema id given to writeEvent
+         */
+        uint32_t addSchema(const std::string& event_name,
+                           const std::string& location,
+                           const std::string& category,
+                           const std::vector<std::string>& names,
+                           const PairFormatterVector& formats);
+
+        /**
+         * \brief Write one event
+         * \param schema Id returned by addSchema
+         * \param tick Current tick of the collector node
+         * \param cycle Current cycle of the collector node, or
+         * binary_format::NO_CYCLE
+         * \param cyc Skewed cycle of the pevent
+         * \param pairs Values of the pairs of the pevent
+         */
+        void writeEvent(uint32_t schema, uint64_t tick, uint64_t cycle, uint64_t cyc,
+                        const PairCache& pairs);
+
+        //! Write everything collected so far to the file
+        void flush();
+
+        //! Number of events written
+        uint64_t getNumEventsWritten() const {
+            return num_events_;
+        }
+
+    private:
+
+        //! Id of a string, writing it first if it is new. Returns
+        //! MAX_INTERNED_STRINGS if the string table is full
+        uint32_t internString_(const std::string& str);
+
+        //! Append raw bytes to record_
+        template<typename T>
+        void append_(const T& val) {
+            const char* bytes = reinterpret_cast<const char*>(&val);
+            record_.insert(record_.end(), bytes, bytes + sizeof(T));
+        }
+
+        //! Append a length-prefixed string to record_
+        void appendString_(const std::string& str);
+
+        //! Write record_ as one message and clear it
+        void writeRecord_();
+
+        const std::string filename_;
+        std::ofstream stream_;
+        std::unique_ptr<log::AsyncWriter> writer_; //!< Writes blocks of records to stream_
+        std::mutex write_mutex_; //!< Collectors may write from several threads
+        std::vector<char> record_; //!< Chunk being built
+        std::vector<uint32_t> num_fields_; //!< Number of fields of each schema
+        std::unordered_map<std::string, uint32_t> strings_; //!< Interned strings
+        uint64_t num_events_ = 0;
+
+        //! Writers opened by this process
+        static std::vector<std::unique_ptr<BinaryPeventWriter>> writers_;
+    };
+
+    /**
+     * \class BinaryPeventReader
+     * \brief Converts a binary pevent file (see BinaryPeventWriter) to the
+     * text a log tap writes for pevents.
+     *
+     * The text format is selected by the extension of the text filename, as
+     * log destinations select their formatter: ".log.basic", ".log.raw" or,
+     * for any other extension, the default formatter. ".log.verbose" is not
+     * supported because binary files do not record message sequence
+     * numbers.
+     */
+    class BinaryPeventReader
+    {
+    public:
+
+        //! Text formats written by convert
+        enum class TextFormat {
+            DEFAULT, //!< {tick cycle location category} content
+            BASIC,   //!< location: category: content
+            RAW      //!< content
+        };
+
+        /**
+         * \brief Text format written to a file, chosen by its extension
+         * \throw SpartaException if the format is not supported
+         */
+        static TextFormat getTextFormat(const std::string& filename);
+
+        /**
+         * \brief Convert a binary pevent file to a text pevent file
+         * \throw SpartaException if either file cannot be opened or the
+         * binary file is malformed
+         */
+        static void convert(const std::string& bin_filename, const std::string& text_filename);
+
+        /**
+         * \brief Read a binary pevent file header
+         * \param in Stream opened in binary mode at the start of the file.
+         * Must outlive this reader
+         * \throw SpartaException if the header is not valid
+         */
+        BinaryPeventReader(std::istream& in);
+
+        //! Simulation info header of the file
+        const std::string& getHeader() const {
+            return header_;
+        }
+
+        /**
+         * \brief Write the header and all events in a text format
+         * \return Number of events written
+         * \throw SpartaException if the file is malformed
+         */
+        uint64_t convert(std::ostream& out, TextFormat format);
+
+    private:
+
+        //! Fields of a collector's events
+        struct Schema
+        {
+            std::string event_name;
+            std::string location;
+            std::string category;
+            std::vector<std::string> names;
+            PairFormatterVector formats;
+        };
+
+        //! Read raw bytes. Returns false at end of file before any byte
+        bool read_(void* dest, std::size_t size);
+
+        //! Read raw bytes. Throws at end of file
+        void readExact_(void* dest, std::size_t size);
+
+        template<typename T>
+        T read_() {
+            T val;
+            readExact_(&val, sizeof(T));
+            return val;
+        }
+
+        std::string readString_();
+
+        //! Write one record as text
+        void writeRecord_(std::ostream& out, TextFormat format);
+
+        std::istream& in_;
+        std::string header_;
+        std::vector<Schema> schemas_;
+        std::vector<std::string> strings_;
+        std::string content_; //!< Event being formatted
+    };
+
+} // namespace pevents
+} // namespace sparta
@@ -12,6 +12,7 @@
 #include "sparta/simulation/Clock.hpp"
 #include "sparta/pairs/SpartaKeyPairs.hpp"
 #include "sparta/pevents/PeventTreeNode.hpp"
+#include "sparta/pevents/BinaryPevents.hpp"
 #include "sparta/log/MessageSource.hpp"
 #include "sparta/utils/MetaStructs.hpp"
 
@@ -44,6 +45,9 @@ namespace pevents {
         using PairCollector<PairDef_t>::turnOn_;
         using PairCollector<PairDef_t>::turnOff_;
         using PairCollector<PairDef_t>::collect_;
+        using PairCollector<PairDef_t>::getNameStrings;
+        using PairCollector<PairDef_t>::getFormatVector;
+        using PairCollector<PairDef_t>::pair_cache_;
 
     public:
         using PairCollector<PairDef_t>::isCollecting;
@@ -103,7 +107,9 @@ namespace pevents {
          * \param type the type of pevent being tapped. This is necessary since pevent's
          * are tapped via a traversal of the tree, we would like to only create the tap
          * if this pevent is of the same type.
-         * \param file the output file path we'd like the tap to write too
+         * \param file the output file path we'd like the tap to write too.
+         * Files ending with BinaryPeventWriter::FILE_EXTENSION are written
+         * in binary through a BinaryPeventWriter instead of a log tap
          * \param verbose are we trying to tap a verbose pevent or normal pevent.
          */
         virtual bool addTap(const std::string& type, const std::string& file, const bool verbose) override final {
@@ -117,6 +123,17 @@ namespace pevents {
                 // Make sure they cannot add taps after the trigger has fired.
                 sparta_assert(running_ == false, "Cannot turnOn a pevent collector for which go() has already been called.");
 
+                if(BinaryPeventWriter::isBinaryFile(file)) {
+                    BinaryPeventWriter* writer = BinaryPeventWriter::getWriter(file);
+                    for(const auto& sink : binary_sinks_) {
+                        if(sink.first == writer) {
+                            return false;
+                        }
+                    }
+                    binary_sinks_.emplace_back(writer, 0);
+                    return true;
+                }
+
                 // only create a custom tap if we don't already have this one.
                 // we could potentially end up with duplicates since the user can turn collection
                 // on at treenodes that overlap
@@ -164,7 +181,7 @@ namespace pevents {
          * or the trigger is reached.
          */
         virtual void go() override final {
-            if(taps_.size() > 0) {
+            if(taps_.size() > 0 || binary_sinks_.size() > 0) {
                 running_ = true;
                 // Mark the pair collector running
                 turnOn_();
@@ -174,6 +191,13 @@ namespace pevents {
             for(auto& tap : taps_) {
                 tap->reset(this);
             }
+
+            // describe our events to the binary files.
+            for(auto& sink : binary_sinks_) {
+                sink.second = sink.first->addSchema(event_name_, getLocation(),
+                                                    message_src_.getCategoryName(),
+                                                    getNameStrings(), getFormatVector());
+            }
         }
 
     protected:
@@ -184,24 +208,39 @@ namespace pevents {
          */
         virtual void generateCollectionString_() override final {
 
-            // Write the pevent to the log.
-            std::stringstream ss;
+            const uint64_t cyc = f_skew_(clk_->currentCycle(), skew_);
 
-            // Write the event name.
-            ss << "ev=" << "\"" << event_name_ << "\" ";
+            // Only format text when a tap is listening
+            if(message_src_) {
+                // Write the pevent to the log. It is emitted when msg goes out
+                // of scope
+                log::MessageSource::LogObject msg(message_src_);
 
-            // Now write the cached key values.
-            for(const auto & pair : getPEventLogVector())
-            {
-                ss << pair.first << "=" << "\"" << pair.second << "\" ";
-            }
+                // Write the event name.
+                msg << "ev=" << "\"" << event_name_ << "\" ";
 
-            // Write the time
-            ss << "cyc=" << f_skew_(clk_->currentCycle(), skew_);
+                // Now write the cached key values.
+                for(const auto & pair : getPEventLogVector())
+                {
+                    msg << pair.first << "=" << "\"" << pair.second << "\" ";
+                }
+
+                // Write the time
+                msg << "cyc=" << cyc;
+
+                // Finish the line
+                msg << ";";
+            }
 
-            // Finish the line
-            ss << ";";
-            message_src_ << ss.str();
+            // Write the raw pair values to the binary files
+            if(!binary_sinks_.empty()) {
+                const Clock* node_clk = getClock();
+                const uint64_t tick = node_clk ? node_clk->getScheduler()->getCurrentTick() : 0;
+                const uint64_t cycle = node_clk ? node_clk->currentCycle() : binary_format::NO_CYCLE;
+                for(const auto& sink : binary_sinks_) {
+                    sink.first->writeEvent(sink.second, tick, cycle, cyc, pair_cache_);
+                }
+            }
         }
 
     private:
@@ -214,6 +253,10 @@ namespace pevents {
         // Log taps that this pevent is being outputted too.
         std::vector<std::unique_ptr<log::Tap > > taps_;
 
+        // Binary files that this pevent is being outputted too, with the
+        // schema id of this pevent in each.
+        std::vector<std::pair<BinaryPeventWriter*, uint32_t> > binary_sinks_;
+
         // We do need a clock b/c each pevent records it's time.
         const Clock* clk_;
         std::function<uint64_t(const uint64_t &, const uint32_t &)> f_skew_;
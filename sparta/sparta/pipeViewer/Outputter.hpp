@@ -15,6 +15,12 @@
 #include <iomanip>
 #include <sstream>
 #include <limits>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "sparta/pipeViewer/transaction_structures.hpp"
 #include "sparta/utils/SpartaException.hpp"
@@ -39,6 +45,14 @@ namespace sparta::pipeViewer
      * (Note) the last entry in the index file will always point to the last record
      * written to file.
      *
+     * Records are appended to an in-memory buffer rather than written
+     * to the record file one at a time, and record positions are
+     * tracked by counting bytes instead of asking the stream.  Once a
+     * buffer fills up it is handed to a background I/O thread which
+     * writes it to the record file while the simulation fills the next
+     * one.  If the I/O thread falls behind by more than a few buffers
+     * the simulation waits for it, which bounds memory use.  The files
+     * written are byte-for-byte the same as with synchronous output.
      */
     class Outputter
     {
@@ -62,6 +76,26 @@ namespace sparta::pipeViewer
             writeData_(ss, &data, sizeof(T));
         }
 
+        /**
+         * \brief Append record data to the current record buffer
+         */
+        void writeRecordData_(const char* const data, const std::size_t size)
+        {
+            buffer_.insert(buffer_.end(), data, data + size);
+        }
+
+        template<typename T>
+        void writeRecordData_(const T* const data, const std::size_t size = sizeof(T))
+        {
+            writeRecordData_(reinterpret_cast<const char* const>(data), size);
+        }
+
+        template<typename T>
+        void writeRecordData_(const T& data)
+        {
+            writeRecordData_(&data, sizeof(T));
+        }
+
     public:
 
         /*!
@@ -72,12 +106,24 @@ namespace sparta::pipeViewer
          */
         static constexpr uint32_t FILE_VERSION = 2;
 
+        //! Default size of a record buffer, in bytes
+        static constexpr std::size_t DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+        //! Number of full buffers that can wait for the I/O thread
+        //! before the simulation blocks
+        static constexpr std::size_t MAX_PENDING_BUFFERS = 4;
+
         /**
          * \brief Construct an Outputter
          * \param file_path the path to the folder to store output files.
          * \param interval The number of cycles between indexes
+         * \param async_io Write full record buffers from a background
+         *        thread.  If false, they are written by the caller.
+         * \param buffer_size Size of a record buffer, in bytes
          */
-        Outputter(const std::string& filepath, const uint64_t interval);
+        Outputter(const std::string& filepath, const uint64_t interval,
+                  const bool async_io = false,
+                  const std::size_t buffer_size = DEFAULT_BUFFER_SIZE);
 
         /**
          * \brief Close the Record file and the index file.
@@ -92,20 +138,50 @@ namespace sparta::pipeViewer
         template<class R_Type>
         void writeTransaction(const R_Type& dat)
         {
-            last_record_pos_ = record_file_.tellp();
+            // Only start a new buffer between records
+            if(SPARTA_EXPECT_FALSE(buffer_.size() >= buffer_size_)) {
+                flushBuffer_();
+            }
+            last_record_pos_ = getRecordPosition_();
 #ifdef PIPELINE_DBG
             std::cout << "writing transaction at: " << last_record_pos_ << " TMST: "
                       << dat.time_Start << " TMEN: " << dat.time_End <<  std::endl;
 #endif
-            writeData_(record_file_, dat);
+            writeRecordData_(dat);
         }
 
         /**
          * \brief A method that marks a pointer to the record file's current location.
          * This method will likely be set to run on the schedular on a given interval.
+         * Buffered records are written first, so an index entry never
+         * points past the end of the record file.
          */
         void writeIndex();
+
+        /**
+         * \brief Write all buffered records to the record file and
+         * wait for them to be written
+         */
+        void flush();
+
     private:
+        //! Offset in the record file of the next byte written
+        uint64_t getRecordPosition_() const {
+            return handed_off_bytes_ + buffer_.size();
+        }
+
+        //! Hand the current buffer off to be written and start a new one
+        void flushBuffer_();
+
+        //! Write a buffer to the record file
+        void writeBuffer_(const std::vector<char>& buf);
+
+        //! Body of the I/O thread
+        void ioThreadLoop_();
+
+        //! Rethrow an error from the I/O thread, if any
+        void checkIOError_();
+
         std::ofstream record_file_; /*!< The record file contains the actual transaction data */
         std::ofstream index_file_; /*!< The file stream for index file being created */
         std::ofstream map_file_; /*!< The file stream for map file which maps Location ID to Pair ID */
@@ -114,6 +190,30 @@ namespace sparta::pipeViewer
         std::ofstream display_format_file_;
 
         uint64_t last_record_pos_; /*!< A pointer to the last record written */
+
+        const std::size_t buffer_size_; /*!< Size at which a record buffer is written */
+        std::vector<char> buffer_; /*!< Records not yet handed off to be written */
+        uint64_t handed_off_bytes_ = 0; /*!< Bytes in buffers handed off to be written */
+        uint64_t flushed_bytes_ = 0; /*!< Bytes written to the record file. Guarded by io_mutex_ if async */
+
+        // The simulation thread pushes full buffers to pending_buffers_
+        // and takes empty ones from free_buffers_; the I/O thread does
+        // the reverse.  All guarded by io_mutex_.
+        std::mutex io_mutex_;
+        std::condition_variable io_cond_;
+        std::deque<std::vector<char>> pending_buffers_;
+        std::vector<std::vector<char>> free_buffers_;
+        bool io_busy_ = false; /*!< The I/O thread is writing a buffer */
+        bool io_stop_ = false; /*!< Tell the I/O thread to exit */
+        std::exception_ptr io_error_; /*!< First error from the I/O thread */
+        std::thread io_thread_; /*!< Writes full buffers, if async */
+
+        // String tables for pair records, so that each location, pair
+        // and string is only described once per set of files
+        using StringKey = std::tuple<uint64_t, uint64_t, uint64_t>;
+        std::unordered_set<uint32_t> pair_location_ids_;
+        std::unordered_set<uint16_t> pair_ids_;
+        std::unordered_map<StringKey, std::string, hashtuple::hash<StringKey>> pair_strings_;
     };
 
     /*!
@@ -126,9 +226,9 @@ namespace sparta::pipeViewer
     inline void Outputter::writeTransaction(const annotation_t& dat)
     {
 
-        writeTransaction<transaction_t>(static_cast<transaction_t>(dat));
-        writeData_(record_file_, dat.length);
-        writeData_(record_file_, dat.annt.data(), dat.length);
+        writeTransaction<transaction_t>(static_cast<const transaction_t&>(dat));
+        writeRecordData_(dat.length);
+        writeRecordData_(dat.annt.data(), dat.length);
     }
 
     /*!
@@ -137,37 +237,27 @@ namespace sparta::pipeViewer
     template<>
     inline void Outputter::writeTransaction(const pair_t & dat){
 
-        // A static Unordered Set which contains unique location id of the records.
-        static std::unordered_set<uint32_t> locIDSet;
-
-        // A static Unordered Set which contains unique pair id of the records.
-        static std::unordered_set<uint16_t> pairIDSet;
-
-        using multiIndex = std::tuple<uint64_t, uint64_t, uint64_t>;
-
-        // A static Unordered Map with a Tuple of 3 Integers as Key and a String as Value.
-        // This map is used to store the String mappings from the Intermediate Integer values.
+        // pair_strings_ stores the String mappings from the Intermediate Integer values.
         // We use integers as this makes the database smaller and also very fast to write to Binary File.
-        // The first Integer in the May Key is the unique Pair they bleong to.
+        // The first Integer in the Map Key is the unique Pair they belong to.
         // The Second Integer is the Field number they belong to.
         // The Third Integer is the actual Integral value which corresponds to the String value.
-        static std::unordered_map<multiIndex, std::string, hashtuple::hash<multiIndex>> stringMap;
 
         // If we find a Location ID that we have not seen before, we store it in the Location ID set.
-        if(locIDSet.emplace(dat.location_ID).second) {
+        if(pair_location_ids_.emplace(dat.location_ID).second) {
             // We add the Location Id followed by the Pair Id of that record in the map file.
             map_file_ << dat.location_ID << ':' << dat.pairId << '\n';
         }
 
         // If we find a Pair ID we have not seen before, we store it in the Pair ID set.
-        if(pairIDSet.emplace(dat.pairId).second) {
+        if(pair_ids_.emplace(dat.pairId).second) {
             // We write the Pair ID to the data file followed by the Number of pairs
             // this kind of pair collectable contains.
             // The first pair of every pair record is its PairID, so we do not add that to the database.
             data_file_ << dat.pairId << ':' << dat.length;
 
             // We write the generic transaction structure to the record file.
-            writeTransaction<transaction_t>(static_cast<transaction_t>(dat));
+            writeTransaction<transaction_t>(static_cast<const transaction_t&>(dat));
 
             // We iterate over all the name value pairs of the current pair record.
             for(std::size_t i = 0; i < dat.length; ++i) {
@@ -178,16 +268,15 @@ namespace sparta::pipeViewer
 
                     // We write the Value for field "i" and only write as much Bytes
                     // as it needs to by checking Sizes[i].
-                    writeData_(record_file_,
-                               &dat.valueVector[i].first,
-                               dat.sizeOfVector[i]);
+                    writeRecordData_(&dat.valueVector[i].first,
+                                     dat.sizeOfVector[i]);
 
                     // We check if the value at field "i" has any String Representation.
                     // If it has, then its corresponding string vector field will not be empty.
                     if(!dat.stringVector[i].empty()){
                         // We check if we have seen this exact pair, field and value before or not.
                         if(const auto& [val, str] = std::tie(dat.valueVector[i].first, dat.stringVector[i]);
-                           stringMap.emplace(std::piecewise_construct, std::forward_as_tuple(dat.pairId, i, val), std::forward_as_tuple(str)).second) {
+                           pair_strings_.emplace(std::piecewise_construct, std::forward_as_tuple(dat.pairId, i, val), std::forward_as_tuple(str)).second) {
                             // We add this mapping into out String Map file which we will
                             // use when reading back from the database.
                             string_file_ << dat.pairId
@@ -205,8 +294,8 @@ namespace sparta::pipeViewer
                     // as it needs to by checking Sizes[i].
                     const auto& str = dat.stringVector[i];
                     const uint16_t length = str.size();
-                    writeData_(record_file_, length);
-                    writeData_(record_file_, str.data(), length);
+                    writeRecordData_(length);
+                    writeRecordData_(str.data(), length);
                 }
             }
             data_file_ << '\n';
@@ -222,23 +311,22 @@ namespace sparta::pipeViewer
         else{
 
             // We write the generic transaction structure to the record file.
-            writeTransaction<transaction_t>(static_cast<transaction_t>(dat));
+            writeTransaction<transaction_t>(static_cast<const transaction_t&>(dat));
 
             // We iterate over all the name value pairs of the current pair record.
             for(std::size_t i = 0; i < dat.length; ++i){
                 if(dat.valueVector[i].second){
                     // We write the Value for field "i" and only write as much Bytes
                     // as it needs to by checking Sizes[i].
-                    writeData_(record_file_,
-                               &dat.valueVector[i].first,
-                               dat.sizeOfVector[i]);
+                    writeRecordData_(&dat.valueVector[i].first,
+                                     dat.sizeOfVector[i]);
 
                     // We check if the value at field "i" has any String Representation.
                     // If it has, then its corresponding string vector field will not be empty.
                     if(!dat.stringVector[i].empty()){
                         // We check if we have seen this exact pair, field and value before or not.
                         if(const auto& [val, str] = std::tie(dat.valueVector[i].first, dat.stringVector[i]);
-                           stringMap.emplace(std::piecewise_construct, std::forward_as_tuple(dat.pairId, i, val), std::forward_as_tuple(str)).second) {
+                           pair_strings_.emplace(std::piecewise_construct, std::forward_as_tuple(dat.pairId, i, val), std::forward_as_tuple(str)).second) {
                             // We add this mapping into out String Map file which we will
                             // use when reading back from the database.
                             string_file_ << dat.pairId
@@ -253,8 +341,8 @@ namespace sparta::pipeViewer
                     // as it needs to by checking Sizes[i].
                     const auto& str = dat.stringVector[i];
                     const uint16_t length = str.size();
-                    writeData_(record_file_, length);
-                    writeData_(record_file_, str.data(), length);
+                    writeRecordData_(length);
+                    writeRecordData_(str.data(), length);
                 }
             }
         }
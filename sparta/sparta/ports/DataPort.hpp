@@ -9,7 +9,10 @@
 
 #pragma once
 
+#include <optional>
 #include <set>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "sparta/ports/Port.hpp"
@@ -19,6 +22,7 @@
 #include "sparta/events/Precedence.hpp"
 #include "sparta/events/Scheduleable.hpp"
 #include "sparta/collection/Collectable.hpp"
+#include "sparta/utils/SpartaSharedPointer.hpp"
 
 namespace sparta
 {
@@ -44,7 +48,14 @@ namespace sparta
      * bind.
      *
      * The modeler must expect the data being sent to be _copied_ into
-     * the port for future (or immediate) delivery.
+     * the port for future (or immediate) delivery.  Data sent as an
+     * rvalue is moved into the last bound DataInPort instead.
+     *
+     * For ports bound to several DataInPorts with data that is
+     * expensive to copy, setSharedFanOut(true) makes each send store
+     * one reference-counted copy of the data shared by all of the
+     * DataInPorts, rather than one copy per DataInPort.  The data type
+     * must opt in by specializing sparta::EnableSharedFanOut.
      *
      * <br>
      * Example:
@@ -146,11 +157,74 @@ namespace sparta
         {
             sparta_assert(!bound_in_ports_.empty(),
                           "ERROR! Attempt to send data on unbound port: " << getLocation());
+            if constexpr (SHARED_FAN_OUT) {
+                if(SPARTA_EXPECT_FALSE(isSharingFanOut_())) {
+                    sendShared_(SharedDataType(new DataT(dat)), rel_time);
+                    return;
+                }
+            }
             for(DataInPort<DataT>* itr : bound_in_ports_) {
                 itr->send_(dat, rel_time);
             }
         }
 
+        /**
+         * \brief Send data to bound receivers, moving it into the last
+         *        one
+         * \param dat The data to send
+         * \param rel_time The relative time for sending
+         *
+         * Same as send(const DataT &, sparta::Clock::Cycle), except
+         * that the data is copied to all but the last bound DataInPort
+         * and moved into that one (or into the shared copy if
+         * setSharedFanOut is enabled).
+         */
+        void send(DataT && dat, sparta::Clock::Cycle rel_time = 0)
+        {
+            sparta_assert(!bound_in_ports_.empty(),
+                          "ERROR! Attempt to send data on unbound port: " << getLocation());
+            if constexpr (SHARED_FAN_OUT) {
+                if(SPARTA_EXPECT_FALSE(isSharingFanOut_())) {
+                    sendShared_(SharedDataType(new DataT(std::move(dat))), rel_time);
+                    return;
+                }
+            }
+            const uint32_t last = bound_in_ports_.size() - 1;
+            for(uint32_t i = 0; i < last; ++i) {
+                bound_in_ports_[i]->send_(std::as_const(dat), rel_time);
+            }
+            bound_in_ports_[last]->send_(std::move(dat), rel_time);
+        }
+
+        /**
+         * \brief Share one copy of the data of each send among all
+         *        bound DataInPorts
+         * \param shared true to share the data; false [default] to
+         *        give each DataInPort its own copy
+         *
+         * When enabled and this port is bound to more than one
+         * DataInPort, each send copies (or moves) the data once into a
+         * reference-counted object.  Every DataInPort delivers that
+         * object and holds on to it as its received data until it
+         * receives new data or is cleared.  Consumers only ever see the
+         * data as const, so this is invisible to them, but it costs an
+         * allocation per send that is only worth it for data that is
+         * expensive to copy.
+         *
+         * Only available for data with EnableSharedFanOut, so that
+         * ports of other data do not pay for the shared payload.
+         */
+        void setSharedFanOut(bool shared) {
+            static_assert(SHARED_FAN_OUT,
+                          "Specialize sparta::EnableSharedFanOut<DataT> to share data among DataInPorts");
+            shared_fan_out_ = shared;
+        }
+
+        //! \brief Is setSharedFanOut enabled?
+        bool isSharedFanOut() const {
+            return shared_fan_out_;
+        }
+
         /*! \brief Determine if this DataOutPort has any connected
          *        DataInPort where the data is to be delivered on the
          *        given cycle.
@@ -236,8 +310,29 @@ namespace sparta
         }
 
     private:
+        //! Can sends share their data among the DataInPorts?
+        static constexpr bool SHARED_FAN_OUT = EnableSharedFanOut<DataT>::value;
+
+        //! Object shared by all bound DataInPorts with setSharedFanOut
+        using SharedDataType = SpartaSharedPointer<DataT>;
+
+        //! Does the next send share its data among the DataInPorts?
+        bool isSharingFanOut_() const {
+            return shared_fan_out_ && (bound_in_ports_.size() > 1);
+        }
+
+        //! Send shared data to every bound DataInPort
+        void sendShared_(const SharedDataType & dat, sparta::Clock::Cycle rel_time) {
+            for(DataInPort<DataT>* itr : bound_in_ports_) {
+                itr->send_(dat, rel_time);
+            }
+        }
+
         //! The bound DataIn ports
         std::vector <DataInPort<DataT>*> bound_in_ports_;
+
+        //! Share the data of each send among the DataInPorts
+        bool shared_fan_out_ = false;
     };
 
     /**
@@ -318,9 +413,9 @@ namespace sparta
                           "DataInPort " << name << " does not have a clock");
             sparta_assert(name.length() != 0, "You cannot have an unnamed port.");
 
-            user_payload_delivery_.reset(new PhasedPayloadEvent<DataT>(&data_in_port_events_, name + "_forward_event",
-                                                                       delivery_phase,
-                                                                       CREATE_SPARTA_HANDLER_WITH_DATA(DataInPort<DataT>, receivePortData_, DataT)));
+            user_payload_delivery_.reset(new PhasedPayloadEvent<PayloadType>(&data_in_port_events_, name + "_forward_event",
+                                                                             delivery_phase,
+                                                                             CREATE_SPARTA_HANDLER_WITH_DATA(DataInPort<DataT>, receivePortData_, PayloadType)));
         }
 
         /**
@@ -423,7 +518,14 @@ namespace sparta
          * event unscheduled (if scheduled).
          */
         uint32_t cancelIf(const DataT & criteria) {
-            return user_payload_delivery_->cancelIf(criteria);
+            if constexpr (DataContainer<DataT>::SHARED_FAN_OUT) {
+                return user_payload_delivery_->cancelIf([&criteria](const PortPayload & payload) -> bool {
+                                                            return payload.get() == criteria;
+                                                        });
+            }
+            else {
+                return user_payload_delivery_->cancelIf(criteria);
+            }
         }
 
         /**
@@ -437,7 +539,14 @@ namespace sparta
          * example.
          */
         uint32_t cancelIf(std::function<bool(const DataT &)> compare) {
-            return user_payload_delivery_->cancelIf(compare);
+            if constexpr (DataContainer<DataT>::SHARED_FAN_OUT) {
+                return user_payload_delivery_->cancelIf([&compare](const PortPayload & payload) -> bool {
+                                                            return compare(payload.get());
+                                                        });
+            }
+            else {
+                return user_payload_delivery_->cancelIf(compare);
+            }
         }
 
         /*!
@@ -451,6 +560,53 @@ namespace sparta
 
     private:
 
+        //! Data shared by all DataInPorts of a DataOutPort with
+        //! DataOutPort::setSharedFanOut
+        using SharedDataType = SpartaSharedPointer<DataT>;
+
+        /*!
+         * \brief Payload of the delivery event for data with
+         *        EnableSharedFanOut: either a copy of the data sent, or
+         *        the data shared with the other DataInPorts of the
+         *        sender
+         */
+        class PortPayload
+        {
+        public:
+            explicit PortPayload(const DataT & dat) :
+                data_(std::in_place, dat)
+            {}
+
+            explicit PortPayload(DataT && dat) :
+                data_(std::in_place, std::move(dat))
+            {}
+
+            explicit PortPayload(const SharedDataType & dat) :
+                shared_data_(dat)
+            {}
+
+            //! The data sent
+            const DataT & get() const {
+                if(SPARTA_EXPECT_FALSE(shared_data_ != nullptr)) {
+                    return *shared_data_;
+                }
+                return *data_;
+            }
+
+            //! The data sent if shared, nullptr otherwise
+            const SharedDataType & getShared() const {
+                return shared_data_;
+            }
+
+        private:
+            std::optional<DataT> data_;
+            SharedDataType shared_data_;
+        };
+
+        //! Payload of the delivery event.  Data that is never shared
+        //! is delivered as is
+        using PayloadType = std::conditional_t<DataContainer<DataT>::SHARED_FAN_OUT, PortPayload, DataT>;
+
         Scheduleable & getScheduleable_() override final {
             return user_payload_delivery_->getScheduleable();
         }
@@ -500,8 +656,12 @@ namespace sparta
          * SchedulingPhase MUST be either equal to or greater than the
          * phase of the sender.  Otherwise, the user will get a
          * sparta::Scheduler precedence issue.
+         *
+         * \a dat is either the data (as a const reference or an rvalue)
+         * or data shared with other DataInPorts.
          */
-        void send_(const DataT & dat, sparta::Clock::Cycle rel_time)
+        template<class PayloadT>
+        void send_(PayloadT && dat, sparta::Clock::Cycle rel_time)
         {
             const uint32_t total_delay = rel_time + port_delay_;
 
@@ -511,18 +671,18 @@ namespace sparta
                 checkSchedulerPhaseForZeroCycleDelivery_(user_payload_delivery_->getSchedulingPhase());
                 if(user_payload_delivery_->getSchedulingPhase() == scheduler_->getCurrentSchedulingPhase()) {
                     // Receive the port data now
-                    receivePortData_(dat);
+                    receivePortData_(std::forward<PayloadT>(dat));
                     return;
                 }
             }
-            user_payload_delivery_->preparePayload(dat)->schedule(total_delay, receiver_clock_);
+            user_payload_delivery_->emplacePayload(std::forward<PayloadT>(dat))->schedule(total_delay, receiver_clock_);
         }
 
         //! Event Set for this port
         sparta::EventSet data_in_port_events_;
 
         //! The User-specified delivery notification
-        std::unique_ptr<PhasedPayloadEvent<DataT>> user_payload_delivery_;
+        std::unique_ptr<PhasedPayloadEvent<PayloadType>> user_payload_delivery_;
 
         //! The handler name for scheduler debug
         std::string handler_name_;
@@ -533,10 +693,41 @@ namespace sparta
         /// Pipeline collection
         std::unique_ptr<CollectorType> collector_;
 
+        //! Data receiving point for delayed deliveries
+        void receivePortData_(const PortPayload & payload)
+        {
+            if(SPARTA_EXPECT_FALSE(payload.getShared() != nullptr)) {
+                receivePortData_(payload.getShared());
+            }
+            else {
+                receivePortData_(payload.get());
+            }
+        }
+
         //! Data receiving point
         void receivePortData_(const DataT & dat)
         {
             DataContainer<DataT>::setData_(dat);
+            notifyConsumer_(dat);
+        }
+
+        //! Data receiving point for data moved in
+        void receivePortData_(DataT && dat)
+        {
+            DataContainer<DataT>::setData_(std::move(dat));
+            notifyConsumer_(DataContainer<DataT>::peekData());
+        }
+
+        //! Data receiving point for data shared with other DataInPorts
+        void receivePortData_(const SharedDataType & dat)
+        {
+            DataContainer<DataT>::setSharedData_(dat);
+            notifyConsumer_(*dat);
+        }
+
+        //! Hand received data to the consumer and collector
+        void notifyConsumer_(const DataT & dat)
+        {
             if(SPARTA_EXPECT_TRUE(explicit_consumer_handler_)) {
                 explicit_consumer_handler_((const void*)&dat);
             }
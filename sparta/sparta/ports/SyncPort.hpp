@@ -66,6 +66,23 @@
  *    For zero-cycle connections, we don't allow one in-flight request in
  *    sync-port since we're trying to deliver the data on the same cycle it
  *    was sent.
+ *
+ * Connections across Scheduler partitions:
+ *
+ *    A SyncOutPort can be bound to a SyncInPort on a different Scheduler
+ *    when both Schedulers are partitions of the same
+ *    sparta::ParallelSchedulerRunner.  The sender computes the arrival
+ *    tick as usual and pushes the data onto a lock-free queue, which the
+ *    receiving partition drains between lookahead windows.  The port
+ *    delay must be non-zero (it bounds the lookahead), the SyncInPort can
+ *    only have the one sender, and ready/valid backpressure is not
+ *    supported since the receiver's ready state cannot be seen by the
+ *    sender within a window.
+ *
+ *    The sender and receiver then run on different threads, so the
+ *    sender only uses state it owns itself (the previous data arrival
+ *    tick).  The ready state and num_in_flight_ belong to the
+ *    receiving partition and are never read from the sender's side.
  */
 
 #pragma once
@@ -76,6 +93,8 @@
 #include "sparta/ports/Port.hpp"
 #include "sparta/events/Precedence.hpp"
 #include "sparta/events/EventSet.hpp"
+#include "sparta/kernel/ParallelSchedulerRunner.hpp"
+#include "sparta/utils/SPSCQueue.hpp"
 
 namespace sparta
 {
@@ -155,6 +174,7 @@ namespace sparta
             sparta_assert(sync_in_port_ == 0, "Multiple bind attempts on port:" << getLocation());
             sync_in_port_ = inp;
             sparta_assert(sync_in_port_ != 0, "Cannot bind to null input port in:" << getLocation());
+            sync_in_port_->connectSender_(clk_);
 
             OutPort::bind(in);
 
@@ -188,9 +208,16 @@ namespace sparta
          * Return whether the output port is ready to send data to the
          * input port, present-state version.  This ONLY takes into account
          * the ready signal, and ignores whether data has been sent or not.
+         *
+         * A port bound across Scheduler partitions is always ready:
+         * its ready state belongs to the receiving partition's thread
+         * and cannot be set to false, so it is never read here.
          */
         bool isReadyPS() const {
             sparta_assert(sync_in_port_ != 0, "isReadyPS() check on unbound port:" << getLocation());
+            if (SPARTA_EXPECT_FALSE(sync_in_port_->partition_channel_ != nullptr)) {
+                return true;
+            }
             return sync_in_port_->getRawReady_();
         }
 
@@ -452,7 +479,11 @@ namespace sparta
         /**
          */
         ~SyncInPort()
-        { }
+        {
+            if(partition_channel_ && scheduler_->getPartitionRunner()) {
+                scheduler_->getPartitionRunner()->deregisterReceiver(partition_channel_.get());
+            }
+        }
 
         /**
          * \brief Bind to an SyncOutPort
@@ -508,7 +539,7 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 computeSendToReceiveTickDelay_(send_clk, rel_cycle, false, prev_data_arrival_tick_);
 
-            sparta::Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick = send_clk->getScheduler()->getCurrentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             bool is_already_driven =
@@ -528,7 +559,7 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 computeSendToReceiveTickDelay_(send_clk, 0, false, prev_data_arrival_tick_);
 
-            sparta::Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick = send_clk->getScheduler()->getCurrentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             bool is_already_driven =
@@ -619,6 +650,9 @@ namespace sparta
          *                 output port in 1 clock cycle.
          */
         void setReady(bool is_ready) {
+            sparta_assert(partition_channel_ == nullptr || is_ready,
+                          "Ready/valid backpressure is not supported on SyncPorts bound across "
+                          "Scheduler partitions: " << getLocation());
             if (SPARTA_EXPECT_FALSE(info_logger_)) {
                 info_logger_ << "setting ready to: " << is_ready << "; num_in_flight = " << num_in_flight_ << "\n";
             }
@@ -859,13 +893,22 @@ namespace sparta
                 calculateClockCrossingDelay(send_clk->currentTick(), send_clk, receive_delay_ticks_, receiver_clock_);
 
             sparta::Scheduler::Tick cur_tick =
-                scheduler_->getCurrentTick();
+                send_clk->getScheduler()->getCurrentTick();
 
             sparta::Scheduler::Tick abs_scheduled_tick =
                 num_delay_ticks + cur_tick;
 
             bool retval = (abs_scheduled_tick > prev_data_arrival_tick_ || prev_data_arrival_tick_ == PREV_DATA_ARRIVAL_TICK_INIT);
 
+            // A sender on another Scheduler partition cannot see this
+            // port's ready state or in-flight count, which belong to the
+            // receiving partition's thread.  There is no backpressure
+            // across partitions, so only the sender's own arrival tick
+            // matters.
+            if (SPARTA_EXPECT_FALSE(send_clk->getScheduler() != scheduler_)) {
+                return retval;
+            }
+
             sparta_assert(cur_tick >= set_ready_tick_, "Someone drove setReady() in the future in" << getLocation());
 
             // Check for sync-port ready/valid backpressure and override
@@ -913,7 +956,7 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 calculateClockCrossingDelay(send_clk->getTick(send_delay_cycles), send_clk, receive_delay_ticks_, receiver_clock_);
 
-            sparta::Scheduler::Tick current_tick       = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick       = send_clk->getScheduler()->getCurrentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             // Slide pushes this send out past the previous arrival,
@@ -959,6 +1002,102 @@ namespace sparta
             return num_delay_ticks;
         }
 
+        /*!
+         * \class PartitionChannel_
+         * \brief Carries data sent from a SyncOutPort on another
+         *        Scheduler partition to this port
+         */
+        class PartitionChannel_ final : public CrossPartitionReceiver
+        {
+        public:
+            explicit PartitionChannel_(SyncInPort<DataT> * port) :
+                port_(port)
+            {}
+
+            //! Called on the sender's partition
+            void push(Scheduler::Tick arrival_tick, const DataT & dat) {
+                queue_.push(std::make_pair(arrival_tick, dat));
+            }
+
+            const Scheduler * getReceivingPartition() const override {
+                return port_->scheduler_;
+            }
+
+            Scheduler::Tick getMinimumLatency() const override {
+                return port_->receive_delay_ticks_;
+            }
+
+            bool hasPendingMessages() const override {
+                return !queue_.empty();
+            }
+
+            uint32_t drainCrossPartitionMessages() override {
+                uint32_t num_drained = 0;
+                while(auto * msg = queue_.front()) {
+                    port_->deliverFromPartition_(msg->first, msg->second);
+                    queue_.pop();
+                    ++num_drained;
+                }
+                return num_drained;
+            }
+
+        private:
+            SyncInPort<DataT> * port_;
+            utils::SPSCQueue<std::pair<Scheduler::Tick, DataT>> queue_;
+        };
+
+        /*!
+         * \brief Called by SyncOutPort::bind before binding to set up
+         *        delivery from a sender on another Scheduler partition
+         * \param send_clk The sender's clock
+         */
+        void connectSender_(const Clock * send_clk)
+        {
+            sparta_assert(partition_channel_ == nullptr,
+                          getLocation() << ": a SyncInPort bound across Scheduler partitions "
+                          "can only have one SyncOutPort");
+
+            const Scheduler * send_scheduler = send_clk->getScheduler();
+            if(send_scheduler == scheduler_) {
+                return;
+            }
+
+            ParallelSchedulerRunner * runner = scheduler_->getPartitionRunner();
+            sparta_assert(runner != nullptr && runner == send_scheduler->getPartitionRunner(),
+                          getLocation() << ": SyncPorts can only be bound across Schedulers that are "
+                          "partitions of the same ParallelSchedulerRunner");
+            sparta_assert(isBound() == false,
+                          getLocation() << ": a SyncInPort bound across Scheduler partitions "
+                          "can only have one SyncOutPort");
+            sparta_assert(receive_delay_ticks_ > 0,
+                          getLocation() << ": SyncPorts bound across Scheduler partitions must "
+                          "have a non-zero port delay, set before binding");
+
+            partition_channel_.reset(new PartitionChannel_(this));
+            runner->registerReceiver(partition_channel_.get());
+        }
+
+        /*!
+         * \brief Schedule data sent from another Scheduler partition
+         * \param arrival_tick The absolute tick the data arrives
+         * \param dat The data
+         */
+        void deliverFromPartition_(Scheduler::Tick arrival_tick, const DataT & dat)
+        {
+            const Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            sparta_assert(arrival_tick >= current_tick,
+                          getLocation() << ": data from another partition arrived at tick "
+                          << arrival_tick << ", which is in this partition's past ("
+                          << current_tick << ")");
+
+            forward_event_->preparePayload(dat)->scheduleRelativeTick(arrival_tick - current_tick, scheduler_);
+            num_in_flight_++;
+
+            if (SPARTA_EXPECT_TRUE(is_continuing_)) {
+                scheduler_->kickTheDog();
+            }
+        }
+
         //! Called by the DataOutPort, remember the binding
         void bind_(SyncOutPort<DataT> * inp) {
             bound_ports_.push_back(inp);
@@ -994,19 +1133,14 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 computeSendToReceiveTickDelay_(send_clk, send_delay_cycles, allow_slide, prev_data_arrival_tick_);
 
-            sparta::Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            const Scheduler * send_scheduler = send_clk->getScheduler();
+            sparta::Scheduler::Tick current_tick = send_scheduler->getCurrentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             // Underlying assumption is that all destinations get their
             // event at the same time.
             sparta_assert((abs_scheduled_tick % receiver_clock_->getPeriod()) == 0, "Failed posedge check in:" << getLocation()); // posedge check
 
-            if (SPARTA_EXPECT_FALSE(info_logger_)) {
-                info_logger_ << "RECEIVE SCHEDULED @" << receiver_clock_->getCycle(abs_scheduled_tick)
-                             << "(" << num_in_flight_ << ") "
-                             << " # " << dat;
-            }
-
             // Only one item can be received per cycle
             sparta_assert(prev_data_arrival_tick_ < abs_scheduled_tick || prev_data_arrival_tick_ == PREV_DATA_ARRIVAL_TICK_INIT,
                           getLocation() << ": attempt to schedule send for tick "
@@ -1017,6 +1151,25 @@ namespace sparta
 
             prev_data_arrival_tick_ = abs_scheduled_tick;
 
+            // The receiver is on another partition; it schedules the
+            // data itself once this window is over.  num_in_flight_
+            // belongs to the receiver's thread, so is not logged here
+            if (SPARTA_EXPECT_FALSE(send_scheduler != scheduler_)) {
+                if (SPARTA_EXPECT_FALSE(info_logger_)) {
+                    info_logger_ << "RECEIVE SCHEDULED @" << receiver_clock_->getCycle(abs_scheduled_tick)
+                                 << "(other partition) "
+                                 << " # " << dat;
+                }
+                partition_channel_->push(abs_scheduled_tick, dat);
+                return num_delay_ticks;
+            }
+
+            if (SPARTA_EXPECT_FALSE(info_logger_)) {
+                info_logger_ << "RECEIVE SCHEDULED @" << receiver_clock_->getCycle(abs_scheduled_tick)
+                             << "(" << num_in_flight_ << ") "
+                             << " # " << dat;
+            }
+
             if(num_delay_ticks == 0) {
                 checkSchedulerPhaseForZeroCycleDelivery_(forward_event_->getSchedulingPhase());
             }
@@ -1063,6 +1216,9 @@ namespace sparta
         //! Pipeline collection.  TODO: See if this works for syncports
         std::unique_ptr<CollectorType> collector_;
 
+        //! Data from a sender on another Scheduler partition, if any
+        std::unique_ptr<PartitionChannel_> partition_channel_;
+
         /// loggers
         sparta::log::MessageSource info_logger_;
     };
@@ -11,12 +11,14 @@
 
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 #include <unordered_map>
 #include <vector>
 #include <cmath>
 
 #include "sparta/statistics/StatisticInstance.hpp"
+#include "sparta/report/ReportSnapshot.hpp"
 #include "sparta/kernel/Scheduler.hpp"
 #include "sparta/utils/SpartaException.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
@@ -262,6 +264,7 @@ namespace sparta
             }
 
             stats_.clear(); // Clear local stats
+            invalidateSnapshots_();
 
             // Copy StatisticInstances
             for(const statistics::stat_pair_t& sp : rhp.stats_){
@@ -684,6 +687,7 @@ namespace sparta
             for(auto itr = subreps_.begin(); itr != subreps_.end(); ++itr){
                 if(&(*itr) == &r){
                     subreps_.erase(itr);
+                    invalidateSnapshots_();
                     return 1;
                 }
             }
@@ -704,6 +708,7 @@ namespace sparta
             for(auto itr = subreps_.begin(); itr != subreps_.end();){
                 if(itr->getName() == name){
                     itr = subreps_.erase(itr);
+                    invalidateSnapshots_();
                     ++num_removed;
                 }else{
                     ++itr;
@@ -865,6 +870,18 @@ namespace sparta
             return num_stats;
         }
 
+        /*!
+         * \brief Gets the plan for evaluating every statistic in this report
+         * and all subreports (recursively) at once. Created on first use
+         * \see ReportSnapshot
+         */
+        ReportSnapshot& getSnapshot() const {
+            if(!snapshot_){
+                snapshot_.reset(new ReportSnapshot(this));
+            }
+            return *snapshot_;
+        }
+
         /*!
          * \brief Mapping from statistic definitions to their substatistic instances
          * (supports using ContextCounters together with report triggers)
@@ -1170,6 +1187,17 @@ namespace sparta
 
     private:
 
+        /*!
+         * \brief Discard the snapshot plans of this report and its ancestors
+         * after statistics were destroyed. New statistics could otherwise be
+         * mistaken for the destroyed ones
+         */
+        void invalidateSnapshots_() {
+            for(Report* r = this; r != nullptr; r = r->parent_){
+                r->snapshot_.reset();
+            }
+        }
+
         /*!
          * \brief Adds a new field to the stats_ list. Catches and rethrows
          * SpartaExceptions after appending what would have been the name of the
@@ -1353,6 +1381,11 @@ namespace sparta
          * \brief Flag for enabling auto-expansion of ContextCounter stats (off by default)
          */
         bool auto_expand_context_counter_stats_ = false;
+
+        /*!
+         * \brief Plan for evaluating all statistics at once. Never copied
+         */
+        mutable std::unique_ptr<ReportSnapshot> snapshot_;
     };
 
     //! \brief Report stream operator
@@ -0,0 +1,122 @@
+// <ReportSnapshot> -*- C++ -*-
+
+/*!
+ * \file ReportSnapshot.hpp
+ * \brief Evaluates every statistic in a Report at once for periodic updates
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "sparta/statistics/ExpressionProgram.hpp"
+
+namespace sparta
+{
+    class Report;
+    class StatisticInstance;
+
+    /*!
+     * \brief Plan for taking a snapshot of every statistic in a report and
+     * its subreports
+     *
+     * The statistics are compiled into a single
+     * statistics::expression::ExpressionProgram. Taking a snapshot gathers
+     * every counter referenced by the report into one array, computes all
+     * counter deltas at once and then evaluates the remaining arithmetic
+     * with each shared sub-expression computed once.
+     *
+     * Values are ordered depth-first: the statistics of a report, then those
+     * of each of its subreports. This is the order in which formatters write
+     * them.
+     *
+     * Several formatters (and the SimDB collector) may write the same report
+     * at the same time. Whoever drives the update calls capture() first, and
+     * every getValues() until release() then returns the captured values
+     * rather than evaluating the statistics again. Without a capture,
+     * getValues() evaluates the statistics on each call.
+     *
+     * \note Reports own their snapshot. See Report::getSnapshot
+     */
+    class ReportSnapshot
+    {
+    public:
+
+        /*!
+         * \brief Construct a plan for a report
+         * \param r Report whose statistics are evaluated. Must outlive this
+         * snapshot
+         */
+        explicit ReportSnapshot(const Report* r) :
+            report_(r)
+        { }
+
+        //! Not copyable
+        ReportSnapshot(const ReportSnapshot&) = delete;
+
+        //! Not assignable
+        ReportSnapshot& operator=(const ReportSnapshot&) = delete;
+
+        /*!
+         * \brief Statistics of the report and its subreports in the order of
+         * the values returned by getValues
+         */
+        const std::vector<const StatisticInstance*>& getStatistics() {
+            updatePlan_();
+            return stats_;
+        }
+
+        /*!
+         * \brief Get the value of every statistic
+         * \return Captured values if captured, otherwise the current value
+         * of each statistic, as from StatisticInstance::getValue
+         */
+        const std::vector<double>& getValues();
+
+        /*!
+         * \brief Evaluate every statistic now and return those values from
+         * getValues until release
+         */
+        void capture();
+
+        /*!
+         * \brief Stop returning captured values from getValues
+         */
+        void release() {
+            captured_ = false;
+        }
+
+        /*!
+         * \brief Are values captured?
+         */
+        bool isCaptured() const {
+            return captured_;
+        }
+
+    private:
+
+        /*!
+         * \brief Rebuild the program if statistics were added to or removed
+         * from the report
+         * \return true if the program was rebuilt
+         */
+        bool updatePlan_();
+
+        //! Report being evaluated
+        const Report* const report_;
+
+        //! Statistics compiled into program_, in output order
+        std::vector<const StatisticInstance*> stats_;
+
+        //! Statistics currently in the report. Compared to stats_
+        std::vector<const StatisticInstance*> stats_scratch_;
+
+        //! Program evaluating stats_
+        std::unique_ptr<statistics::expression::ExpressionProgram> program_;
+
+        //! Are the values from the last evaluation captured?
+        bool captured_ = false;
+    };
+
+} // namespace sparta
@@ -228,8 +228,12 @@ protected:
      */
     void writeRow_(std::ostream& out,
                    const Report* r) const {
+        // The snapshot holds every value in the row, in row order
+        const std::vector<double>& values = r->getSnapshot().getValues();
+
         const bool preceded_by_value = false;
-        writeSubReportPartialRow_(out, r, preceded_by_value);
+        uint32_t idx = 0;
+        writeSubReportPartialRow_(out, r, values, idx, preceded_by_value);
         out << "\n";
     }
 
@@ -253,12 +257,17 @@ protected:
      * \brief Write a subreport on the current row
      * \param[in] out Ostream to which output will be written
      * \param[in] r Report to print to \a out (recursively)
+     * \param[in] values Value of every statistic in the row
+     * \param[in,out] idx Index in \a values of the first statistic of \a r.
+     * Advanced past every statistic written
      * \param[in] preceded_by_value Is this call preceded by a value on the same
      * line in \a out, thus requiring a leading comma?
      * \return Returns true if a value was written, false if not.
      */
     bool writeSubReportPartialRow_(std::ostream& out,
                                    const Report* r,
+                                   const std::vector<double>& values,
+                                   uint32_t& idx,
                                    bool preceded_by_value) const {
         bool wrote_value = false; // Did this function write a value (this is the result of this function)
 
@@ -270,8 +279,7 @@ protected:
                 }
 
                 // Print the value
-                const statistics::stat_pair_t& si = *itr;
-                out << Report::formatNumber(si.second->getValue());
+                out << Report::formatNumber(values[idx++]);
 
                 wrote_value = true; // 1 or more values written here
 
@@ -290,7 +298,7 @@ protected:
         }
 
         for (const Report& sr : r->getSubreports()){
-            const bool sr_wrote_value = writeSubReportPartialRow_(out, &sr, wrote_value);
+            const bool sr_wrote_value = writeSubReportPartialRow_(out, &sr, values, idx, wrote_value);
 
             wrote_value |= sr_wrote_value;
         }
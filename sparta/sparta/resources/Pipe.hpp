@@ -57,6 +57,22 @@ private:
         return (tail_ + stage) & stage_mask_;
     }
 
+    //! Track the validity of a physical entry in valid_mask_
+    void setValidBit_(uint32_t physical_stage)
+    {
+        if(physical_size_ <= MAX_VALID_MASK_SIZE) {
+            valid_mask_ |= (uint64_t(1) << physical_stage);
+        }
+    }
+
+    //! Track the invalidity of a physical entry in valid_mask_
+    void clearValidBit_(uint32_t physical_stage)
+    {
+        if(physical_size_ <= MAX_VALID_MASK_SIZE) {
+            valid_mask_ &= ~(uint64_t(1) << physical_stage);
+        }
+    }
+
     void initPipe_(uint32_t num_entries)
     {
         sparta_assert(num_entries > 0, "ERROR: sparta::Pipe '" << name_
@@ -65,6 +81,7 @@ private:
         physical_size_ = sparta::utils::pow2 (sparta::utils::ceil_log2 (num_entries + 1));
         stage_mask_ = physical_size_ - 1;
         pipe_.reset(new PipeEntry[physical_size_]);
+        valid_mask_ = 0;
     }
 
 public:
@@ -325,6 +342,7 @@ public:
             --num_valid_;
         }
         pe.data.clearValid();
+        clearValidBit_(getPhysicalStage_(stage));
         if(perform_own_updates_) {
             ev_update_.schedule();
         }
@@ -336,6 +354,7 @@ public:
     void clear() {
         pipe_.reset (new PipeEntry[physical_size_]);
         num_valid_ = 0;
+        valid_mask_ = 0;
     }
 
     //! Invalidate the data at the given stage RIGHT NOW.  Will throw
@@ -353,6 +372,7 @@ public:
             --num_valid_;
         }
         pe.data.clearValid();
+        clearValidBit_(getPhysicalStage_(stage));
     }
 
     //! Flush the item that was appended
@@ -360,6 +380,7 @@ public:
     {
         PipeEntry & pe = pipe_[getPhysicalStage_(-1)];
         pe.data.clearValid();
+        clearValidBit_(getPhysicalStage_(-1));
     }
 
     //! Flush everything, RIGHT NOW
@@ -370,6 +391,7 @@ public:
             pe.data.clearValid();
         }
         num_valid_ = 0;
+        valid_mask_ = 0;
     }
 
     /**
@@ -389,6 +411,7 @@ public:
                         --num_valid_;
                     }
                     pe.data.clearValid();
+                    clearValidBit_(getPhysicalStage_(i));
                 }
             }
         }
@@ -412,6 +435,7 @@ public:
                         --num_valid_;
                     }
                     pe.data.clearValid();
+                    clearValidBit_(getPhysicalStage_(i));
                 }
             }
         }
@@ -437,6 +461,30 @@ public:
         return (num_valid_ > 0) || isValid(uint32_t(-1));
     }
 
+    //! Can the valid stages be given as a bit mask by getValidMask?
+    bool hasValidMask () const
+    {
+        return physical_size_ <= MAX_VALID_MASK_SIZE;
+    }
+
+    /**
+     * \brief Bit mask of the valid stages, where bit N is set if stage N
+     *        is valid. Excludes data appended THIS cycle
+     * \pre hasValidMask() (the pipe has fewer than 64 stages)
+     */
+    uint64_t getValidMask () const
+    {
+        sparta_assert(hasValidMask(), "ERROR: sparta::Pipe '" << name_
+                      << "' has too many stages for a valid mask");
+        // Rotate the physical entries so that the tail becomes stage 0. The
+        // append entry and unused entries land above the last stage
+        uint64_t mask = valid_mask_;
+        if(tail_ != 0) {
+            mask = (mask >> tail_) | (mask << (physical_size_ - tail_));
+        }
+        return mask & ((uint64_t(1) << num_entries_) - 1);
+    }
+
     //! Is the last entry valid?
     bool isLastValid () const
     {
@@ -499,6 +547,7 @@ public:
         }
         writePS(0, pe_neg1.data.getValue());
         pe_neg1.data.clearValid();
+        clearValidBit_(getPhysicalStage_(-1));
         return true;
     }
 
@@ -532,6 +581,13 @@ private:
     size_type num_valid_     = 0; //!< Number of valid entries
     size_type tail_          = 0; //!< The tail of the pipe
 
+    //! Largest physical size for which valid_mask_ is maintained
+    static constexpr size_type MAX_VALID_MASK_SIZE = 64;
+
+    //! Validity of each physical entry (including the append entry) when
+    //! physical_size_ <= MAX_VALID_MASK_SIZE
+    uint64_t valid_mask_ = 0;
+
     std::unique_ptr<PipeEntry[]> pipe_;
 
     const std::string name_;
@@ -551,6 +607,7 @@ private:
             --num_valid_;
         }
         pe_head.data.clearValid();
+        clearValidBit_(getPhysicalStage_(num_entries_ - 1));
 
         // Shift the pipe
         tail_ = getPhysicalStage_(-1);
@@ -572,6 +629,7 @@ private:
         sparta_assert(pe.data.isValid() == false, "ERROR: sparta::Pipe '" << name_
                     << "' Double append of data before update");
         pe.data = std::forward<U>(data);
+        setValidBit_(getPhysicalStage_(-1));
         if(perform_own_updates_) {
             ev_update_.schedule();
         }
@@ -586,6 +644,7 @@ private:
         }
         pe.data = std::forward<U>(data);
         ++num_valid_;
+        setValidBit_(getPhysicalStage_(stage));
         if(perform_own_updates_) {
             ev_update_.schedule();
         }
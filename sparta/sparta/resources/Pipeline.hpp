@@ -300,6 +300,7 @@ namespace sparta
 
             // Create a new stage event handler, and add it to its event list
             auto & event_list = event_list_at_stage_[id];
+            stage_events_stale_ = true;
             if constexpr (std::is_same_v<EventT, PhasedPayloadEvent<DataT>>) {
                 sparta_assert(handler.argCount() == 1, "Expecting Sparta Handler with 1 data parameter!");
                 event_list.emplace_back(new EventT(es_,
@@ -336,7 +337,7 @@ namespace sparta
                     producer_event->precedes(*new_event);
                 }
             } else {
-                events_valid_at_stage_[id] = true;
+                setEventsValidAtStage_(id, true);
             }
 
             // Add the raw pointer of newly added event to the stage event list on 'sched_phase'
@@ -593,7 +594,7 @@ namespace sparta
             sparta_assert((event_list_at_stage_[id].size() > 0),
                           "Activation fails: No registered event handler for stage[" << id << "]!");
 
-            events_valid_at_stage_[id] = true;
+            setEventsValidAtStage_(id, true);
         }
 
         /*!
@@ -611,7 +612,7 @@ namespace sparta
             sparta_assert((event_list_at_stage_[id].size() > 0),
                           "Deactivation fails: No registered event handler for stage[" << id << "]!");
 
-            events_valid_at_stage_[id] = false;
+            setEventsValidAtStage_(id, false);
         }
 
         /*!
@@ -1028,8 +1029,11 @@ namespace sparta
                           "Try to cancel events for invalid pipeline stage[" << stage_id << "]");
             if (pipe_.isValid(stage_id) && events_valid_at_stage_[stage_id]) {
                 sparta_assert(event_list_at_stage_[stage_id].size());
-                for (const auto & ev_ptr :  event_list_at_stage_[stage_id]) {
-                    ev_ptr->cancel(sparta::Clock::Cycle(0));
+                if (SPARTA_EXPECT_FALSE(stage_events_stale_)) {
+                    buildStageEvents_();
+                }
+                for (uint32_t i = stage_events_begin_[stage_id]; i < stage_events_begin_[stage_id + 1]; i++) {
+                    stage_events_[i]->cancel(sparta::Clock::Cycle(0));
                 }
             }
         }
@@ -1039,20 +1043,67 @@ namespace sparta
         {
             sparta_assert(num_stages_ == event_list_at_stage_.size());
 
-            for (uint32_t i = 0; i < num_stages_; i++) {
-                if (pipe_.isValid(i) && events_valid_at_stage_[i]) {
-                    sparta_assert(event_list_at_stage_[i].size());
-                    for (const auto & ev_ptr :  event_list_at_stage_[i]) {
-                        if constexpr (std::is_same_v<EventT, PhasedPayloadEvent<DataT>>) {
-                            ev_ptr->preparePayload(at(i))->schedule(sparta::Clock::Cycle(0));
-                        } else {
-                            ev_ptr->schedule(sparta::Clock::Cycle(0));
-                        }
+            if (SPARTA_EXPECT_FALSE(stage_events_stale_)) {
+                buildStageEvents_();
+            }
+
+            if (pipe_.hasValidMask()) {
+                // Only visit the valid stages with active events
+                for (uint64_t stages = pipe_.getValidMask() & events_valid_mask_; stages != 0; stages &= (stages - 1)) {
+                    scheduleEventsAtStage_(__builtin_ctzll(stages));
+                }
+            } else {
+                for (const uint32_t i : stages_with_events_) {
+                    if (events_valid_at_stage_[i] && pipe_.isValid(i)) {
+                        scheduleEventsAtStage_(i);
                     }
                 }
             }
         }
 
+        //! Schedule the events of a pipeline stage
+        void scheduleEventsAtStage_(const uint32_t stage_id)
+        {
+            sparta_assert(stage_events_begin_[stage_id] < stage_events_begin_[stage_id + 1]);
+            for (uint32_t i = stage_events_begin_[stage_id]; i < stage_events_begin_[stage_id + 1]; i++) {
+                if constexpr (std::is_same_v<EventT, PhasedPayloadEvent<DataT>>) {
+                    stage_events_[i]->preparePayload(at(stage_id))->schedule(sparta::Clock::Cycle(0));
+                } else {
+                    stage_events_[i]->schedule(sparta::Clock::Cycle(0));
+                }
+            }
+        }
+
+        //! Lay out the events of every stage contiguously, in stage and registration order
+        void buildStageEvents_()
+        {
+            stage_events_.clear();
+            stage_events_begin_.clear();
+            stages_with_events_.clear();
+            for (uint32_t stage_id = 0; stage_id < num_stages_; stage_id++) {
+                const auto & event_list = event_list_at_stage_[stage_id];
+                stage_events_begin_.push_back(stage_events_.size());
+                if (!event_list.empty()) {
+                    stages_with_events_.push_back(stage_id);
+                }
+                for (const auto & ev_ptr : event_list) {
+                    stage_events_.push_back(ev_ptr.get());
+                }
+            }
+            stage_events_begin_.push_back(stage_events_.size());
+            stage_events_stale_ = false;
+        }
+
+        //! Activate or deactivate the events of a pipeline stage
+        void setEventsValidAtStage_(const uint32_t stage_id, const bool valid)
+        {
+            events_valid_at_stage_[stage_id] = valid;
+            if (stage_id < 64) {
+                const uint64_t stage_bit = uint64_t(1) << stage_id;
+                events_valid_mask_ = valid ? (events_valid_mask_ | stage_bit) : (events_valid_mask_ & ~stage_bit);
+            }
+        }
+
         //! Deactivate the pipeline stage handling events up to the stall causing stage
         void deactivate_(const uint32_t & stall_stage_id,
                          const bool crush_bubbles,
@@ -1068,7 +1119,7 @@ namespace sparta
                 }
 
                 if (suppress_events && event_list_at_stage_[stage_id].size() > 0) {
-                    events_valid_at_stage_[stage_id] = false;
+                    setEventsValidAtStage_(stage_id, false);
                 }
                 advance_into_stage_[stage_id] = false;
             }
@@ -1081,7 +1132,7 @@ namespace sparta
                 sparta_assert(stage_id < num_stages_,
                               "Try to restart invalid pipeline stage[" << stage_id << "]");
                 if (event_list_at_stage_[stage_id].size() > 0) {
-                    events_valid_at_stage_[stage_id] = true;
+                    setEventsValidAtStage_(stage_id, true);
                 }
                 advance_into_stage_[stage_id] = true;
             }
@@ -1105,10 +1156,27 @@ namespace sparta
         //     std::vector<std::unique_ptr<Scheduleable>> event_list_at_stage_; // OK
         //     std::vector<std::unique_ptr<EventNode>> event_list_at_stage_; // oops
 
+        //! The events of every pipeline stage, contiguous and in stage order.
+        //! Built from event_list_at_stage_ on the first update after a registration
+        std::vector<EventT*> stage_events_;
+
+        //! Index of the first event of each stage in stage_events_, followed by the end
+        std::vector<uint32_t> stage_events_begin_;
+
+        //! Stages with registered events, in stage order
+        std::vector<uint32_t> stages_with_events_;
+
+        //! Indicate stage_events_ needs to be rebuilt
+        bool stage_events_stale_ = true;
+
         //! A vector of valid/active bits for pipeline stage events
         std::vector<bool> events_valid_at_stage_;
         std::vector<bool> advance_into_stage_;
 
+        //! Valid/active bits of the first 64 pipeline stage events, matched
+        //! against the pipe valid mask when scheduling
+        uint64_t events_valid_mask_ = 0;
+
         //! A vector of event index matrix for every pipeline stage
         std::vector<EventMatrix> event_matrix_at_stage_;
 
@@ -0,0 +1,246 @@
+// <CheckpointCompression> -*- C++ -*-
+
+/**
+ * \file   CheckpointCompression.hpp
+ *
+ * \brief  Simple, dependency-free codecs used to compress checkpoint data
+ */
+
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <cstring>
+#include <vector>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta::serialization::checkpoint::compression
+{
+
+/*!
+ * \brief Run-length encode a buffer (PackBits style)
+ * \param src Bytes to encode
+ * \param size Number of bytes in \a src
+ * \param out Encoded bytes are appended here
+ * \return Number of bytes appended to \a out
+ *
+ * Each control byte c is followed either by c+1 literal bytes
+ * (c < 128) or by a single byte repeated c-126 times (c >= 128).
+ * Worst case output is size + size/128 + 1 bytes.
+ */
+inline size_t rleEncode(const char * src, size_t size, std::vector<char> & out)
+{
+    const size_t start_size = out.size();
+    size_t i = 0;
+    while(i < size) {
+        size_t run = 1;
+        while((i + run < size) && (run < 129) && (src[i + run] == src[i])) {
+            ++run;
+        }
+        if(run >= 3) {
+            out.push_back(static_cast<char>(run + 126));
+            out.push_back(src[i]);
+            i += run;
+            continue;
+        }
+
+        // Gather literals until a run of 3 or more starts
+        size_t j = i;
+        while((j < size) && (j - i < 128)) {
+            if((j + 2 < size) && (src[j] == src[j + 1]) && (src[j] == src[j + 2])) {
+                break;
+            }
+            ++j;
+        }
+        out.push_back(static_cast<char>(j - i - 1));
+        out.insert(out.end(), src + i, src + j);
+        i = j;
+    }
+    return out.size() - start_size;
+}
+
+/*!
+ * \brief Decode a buffer encoded with rleEncode
+ * \param src Encoded bytes
+ * \param size Number of encoded bytes
+ * \param dest Destination for the decoded bytes
+ * \param dest_size Expected number of decoded bytes
+ */
+inline void rleDecode(const char * src, size_t size, char * dest, size_t dest_size)
+{
+    size_t i = 0;
+    size_t o = 0;
+    while(i < size) {
+        const uint8_t ctrl = static_cast<uint8_t>(src[i++]);
+        if(ctrl < 128) {
+            const size_t count = ctrl + 1u;
+            sparta_assert(i + count <= size && o + count <= dest_size,
+                          "Corrupt run-length encoded checkpoint data");
+            ::memcpy(dest + o, src + i, count);
+            i += count;
+            o += count;
+        }
+        else {
+            const size_t count = ctrl - 126u;
+            sparta_assert(i < size && o + count <= dest_size,
+                          "Corrupt run-length encoded checkpoint data");
+            ::memset(dest + o, src[i++], count);
+            o += count;
+        }
+    }
+    sparta_assert(o == dest_size,
+                  "Run-length encoded checkpoint data decoded to " << o
+                  << " bytes but " << dest_size << " were expected");
+}
+
+namespace detail
+{
+    inline uint32_t load32(const uint8_t * p) {
+        uint32_t val;
+        ::memcpy(&val, p, sizeof(val));
+        return val;
+    }
+
+    inline void writeLength(size_t len, std::vector<char> & out) {
+        while(len >= 255) {
+            out.push_back(static_cast<char>(255));
+            len -= 255;
+        }
+        out.push_back(static_cast<char>(len));
+    }
+
+    inline size_t readLength(const uint8_t * src, size_t size, size_t & i) {
+        size_t len = 0;
+        uint8_t b;
+        do {
+            sparta_assert(i < size, "Corrupt LZ compressed checkpoint data");
+            b = src[i++];
+            len += b;
+        } while(b == 255);
+        return len;
+    }
+
+    inline void writeSequence(const uint8_t * literals, size_t num_literals,
+                              size_t offset, size_t match_len, std::vector<char> & out)
+    {
+        const size_t lit_nibble = (num_literals < 15) ? num_literals : 15;
+        const size_t match_nibble = (match_len == 0) ? 0 :
+            ((match_len - 4 < 15) ? (match_len - 4) : 15);
+        out.push_back(static_cast<char>((lit_nibble << 4) | match_nibble));
+        if(lit_nibble == 15) {
+            writeLength(num_literals - 15, out);
+        }
+        out.insert(out.end(), literals, literals + num_literals);
+        if(match_len == 0) {
+            return;
+        }
+        out.push_back(static_cast<char>(offset & 0xff));
+        out.push_back(static_cast<char>(offset >> 8));
+        if(match_nibble == 15) {
+            writeLength(match_len - 4 - 15, out);
+        }
+    }
+}
+
+/*!
+ * \brief Compress a buffer with a small LZ77 codec in the style of LZ4
+ * \param src Bytes to compress
+ * \param size Number of bytes in \a src
+ * \param out Compressed bytes are appended here
+ * \return Number of bytes appended to \a out
+ *
+ * The output is a series of sequences, each a token byte (literal
+ * count in the high nibble, match length - 4 in the low), optional
+ * extended literal count, literals, then a 16-bit little-endian match
+ * offset and optional extended match length.  The final sequence has
+ * only literals.  Matches are found with a single-entry hash table of
+ * 4-byte prefixes, which favors speed over ratio.
+ */
+inline size_t lzCompress(const char * src, size_t size, std::vector<char> & out)
+{
+    constexpr uint32_t HASH_BITS = 12;
+    constexpr size_t   MIN_MATCH = 4;
+    constexpr size_t   MAX_OFFSET = 65535;
+
+    const size_t start_size = out.size();
+    const uint8_t * in = reinterpret_cast<const uint8_t*>(src);
+
+    // Positions + 1 so that 0 means empty
+    std::array<uint32_t, (1u << HASH_BITS)> table{};
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while(i + MIN_MATCH <= size) {
+        const uint32_t seq = detail::load32(in + i);
+        const uint32_t h = (seq * 2654435761u) >> (32 - HASH_BITS);
+        const size_t cand = table[h];
+        table[h] = static_cast<uint32_t>(i + 1);
+        if((cand != 0) && (i - (cand - 1) <= MAX_OFFSET) && (detail::load32(in + cand - 1) == seq)) {
+            const size_t match = cand - 1;
+            size_t len = MIN_MATCH;
+            while((i + len < size) && (in[match + len] == in[i + len])) {
+                ++len;
+            }
+            detail::writeSequence(in + anchor, i - anchor, i - match, len, out);
+            i += len;
+            anchor = i;
+        }
+        else {
+            ++i;
+        }
+    }
+    detail::writeSequence(in + anchor, size - anchor, 0, 0, out);
+    return out.size() - start_size;
+}
+
+/*!
+ * \brief Decompress a buffer compressed with lzCompress
+ * \param src Compressed bytes
+ * \param size Number of compressed bytes
+ * \param dest Destination for the decompressed bytes
+ * \param dest_size Expected number of decompressed bytes
+ */
+inline void lzDecompress(const char * src, size_t size, char * dest, size_t dest_size)
+{
+    const uint8_t * in = reinterpret_cast<const uint8_t*>(src);
+    size_t i = 0;
+    size_t o = 0;
+    while(i < size) {
+        const uint8_t token = in[i++];
+        size_t num_literals = token >> 4;
+        if(num_literals == 15) {
+            num_literals += detail::readLength(in, size, i);
+        }
+        sparta_assert(i + num_literals <= size && o + num_literals <= dest_size,
+                      "Corrupt LZ compressed checkpoint data");
+        ::memcpy(dest + o, in + i, num_literals);
+        i += num_literals;
+        o += num_literals;
+        if(i == size) {
+            break; // Last sequence has no match
+        }
+
+        sparta_assert(i + 2 <= size, "Corrupt LZ compressed checkpoint data");
+        const size_t offset = in[i] | (size_t(in[i + 1]) << 8);
+        i += 2;
+        size_t match_len = (token & 0xf) + 4;
+        if((token & 0xf) == 15) {
+            match_len += detail::readLength(in, size, i);
+        }
+        sparta_assert(offset != 0 && offset <= o && o + match_len <= dest_size,
+                      "Corrupt LZ compressed checkpoint data");
+
+        // Byte by byte since the match may overlap the output
+        const char * match = dest + o - offset;
+        for(size_t k = 0; k < match_len; ++k) {
+            dest[o + k] = match[k];
+        }
+        o += match_len;
+    }
+    sparta_assert(o == dest_size,
+                  "LZ compressed checkpoint data decompressed to " << o
+                  << " bytes but " << dest_size << " were expected");
+}
+
+} // namespace sparta::serialization::checkpoint::compression
@@ -0,0 +1,482 @@
+// <CompressedStorage> -*- C++ -*-
+
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sparta/functional/ArchData.hpp"
+#include "sparta/utils/SpartaException.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+#include "sparta/serialization/checkpoint/CheckpointCompression.hpp"
+
+namespace sparta::serialization::checkpoint::storage
+{
+
+/*!
+ * \brief Append-only file that cold checkpoint data is moved to, read
+ * back through a memory mapping
+ *
+ * Space in the file is never reclaimed; the file is removed when the
+ * SpillFile is destroyed.
+ */
+class SpillFile
+{
+public:
+    /*!
+     * \brief Create (or truncate) the spill file
+     * \param filename Path of the file
+     */
+    explicit SpillFile(const std::string & filename) :
+        filename_(filename)
+    {
+        fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(fd_ < 0) {
+            throw SpartaException("Could not open checkpoint spill file '")
+                << filename << "': " << ::strerror(errno);
+        }
+    }
+
+    //! Unmap and remove the file
+    ~SpillFile() {
+        unmap_();
+        ::close(fd_);
+        ::unlink(filename_.c_str());
+    }
+
+    SpillFile(const SpillFile &) = delete;
+    SpillFile & operator=(const SpillFile &) = delete;
+
+    /*!
+     * \brief Append bytes to the file
+     * \return Offset in the file of the first byte written
+     */
+    uint64_t append(const char * data, size_t size)
+    {
+        const uint64_t offset = size_;
+        size_t written = 0;
+        while(written < size) {
+            const ssize_t res = ::pwrite(fd_, data + written, size - written, offset + written);
+            if(res < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                throw SpartaException("Failed to write ") << size << " bytes to checkpoint spill file '"
+                    << filename_ << "': " << ::strerror(errno);
+            }
+            written += res;
+        }
+        size_ += size;
+        return offset;
+    }
+
+    /*!
+     * \brief Get a pointer to bytes previously appended
+     * \note The pointer is invalidated by the next append() and map()
+     */
+    const char * map(uint64_t offset, size_t size)
+    {
+        sparta_assert(offset + size <= size_,
+                      "Attempted to read past the end of checkpoint spill file '" << filename_ << "'");
+        if(offset + size > mapped_size_) {
+            unmap_();
+            void * addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+            if(addr == MAP_FAILED) {
+                throw SpartaException("Failed to map checkpoint spill file '")
+                    << filename_ << "': " << ::strerror(errno);
+            }
+            mapped_ = static_cast<const char*>(addr);
+            mapped_size_ = size_;
+        }
+        return mapped_ + offset;
+    }
+
+    //! \return The number of bytes in the file
+    uint64_t getSize() const {
+        return size_;
+    }
+
+    //! \return The file name
+    const std::string & getFilename() const {
+        return filename_;
+    }
+
+private:
+    void unmap_() {
+        if(mapped_ != nullptr) {
+            ::munmap(const_cast<char*>(mapped_), mapped_size_);
+            mapped_ = nullptr;
+            mapped_size_ = 0;
+        }
+    }
+
+    const std::string filename_;
+    int fd_ = -1;
+    uint64_t size_ = 0;
+    const char * mapped_ = nullptr;
+    uint64_t mapped_size_ = 0;
+};
+
+/*!
+ * \brief Storage that packs all lines of a checkpoint into one
+ * contiguous arena, compressing them as they are written
+ *
+ * Each line is stored as a small header followed by its encoded
+ * bytes.  All-zero lines store no bytes at all, and lines that
+ * run-length encode smaller are stored encoded.  After a checkpoint
+ * has been written, the whole arena can additionally be block
+ * compressed with compress() and moved out of memory into a SpillFile
+ * with spill().  Both are transparent to restoring, which decodes
+ * into a per-thread scratch buffer when needed.
+ */
+class CompressedStorage
+{
+public:
+
+    //! How lines are compressed when written
+    enum class Compression : uint8_t {
+        NONE, //!< Lines are stored as-is
+        RLE,  //!< Zero lines are elided and lines are run-length encoded when smaller
+        LZ    //!< As RLE, plus compress() block compresses the arena
+    };
+
+    CompressedStorage() = default;
+
+    //! \param compression How lines are compressed when written
+    explicit CompressedStorage(Compression compression) :
+        compression_(compression)
+    {}
+
+    CompressedStorage(const CompressedStorage&) = default;
+    CompressedStorage(CompressedStorage&&) = default;
+
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int /*version*/) {
+        if constexpr (Archive::is_saving::value) {
+            if(spill_file_) {
+                const char * data = spill_file_->map(spill_offset_, stored_bytes_);
+                std::vector<char> arena(data, data + stored_bytes_);
+                ar & arena;
+            }
+            else {
+                ar & arena_;
+            }
+        }
+        else {
+            ar & arena_;
+            spill_file_.reset();
+            stored_bytes_ = arena_.size();
+        }
+        ar & compression_;
+        ar & encoded_bytes_;
+        ar & raw_bytes_;
+        ar & block_compressed_;
+    }
+
+    void dump(std::ostream& o) const {
+        o << "\nCompressed checkpoint storage: " << raw_bytes_ << " bytes, stored in "
+          << stored_bytes_ << " bytes" << (block_compressed_ ? " (block compressed)" : "")
+          << (spill_file_ ? " (spilled)" : "");
+    }
+
+    //! \return How lines are compressed when written
+    Compression getCompression() const {
+        return compression_;
+    }
+
+    //! \return Bytes of memory used, excluding anything spilled
+    uint32_t getSize() const {
+        return sizeof(decltype(*this)) + arena_.capacity();
+    }
+
+    //! \return Bytes of line data before compression, including headers
+    uint64_t getUncompressedSize() const {
+        return raw_bytes_;
+    }
+
+    //! \return Bytes of line data as stored (in memory or spilled)
+    uint64_t getStoredSize() const {
+        return stored_bytes_;
+    }
+
+    //! \return Has this storage been block compressed
+    bool isBlockCompressed() const {
+        return block_compressed_;
+    }
+
+    //! \return Has this storage been spilled to a file
+    bool isSpilled() const {
+        return spill_file_ != nullptr;
+    }
+
+    /*!
+     * \brief Block compress the arena if it makes it smaller
+     * \pre All data has been written
+     *
+     * Has no effect unless the compression is Compression::LZ, or if
+     * already compressed or spilled.
+     */
+    void compress()
+    {
+        if(compression_ != Compression::LZ || block_compressed_ || spill_file_) {
+            return;
+        }
+        std::vector<char> compressed;
+        compressed.reserve(arena_.size() / 2);
+        compression::lzCompress(arena_.data(), arena_.size(), compressed);
+        if(compressed.size() < arena_.size()) {
+            compressed.shrink_to_fit();
+            arena_.swap(compressed);
+            stored_bytes_ = arena_.size();
+            block_compressed_ = true;
+        }
+    }
+
+    //! Release memory over-allocated while writing
+    void shrinkToFit() {
+        arena_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief Move the arena out of memory and into a file
+     * \param file File to append the arena to. Kept alive by this
+     *             storage
+     * \pre All data has been written
+     */
+    void spill(const std::shared_ptr<SpillFile> & file)
+    {
+        sparta_assert(file != nullptr);
+        if(spill_file_) {
+            return;
+        }
+        spill_offset_ = file->append(arena_.data(), arena_.size());
+        spill_file_ = file;
+        std::vector<char>().swap(arena_);
+    }
+
+    void prepareForLoad() {
+        const char * data = spill_file_ ? spill_file_->map(spill_offset_, stored_bytes_) : arena_.data();
+        if(block_compressed_) {
+            std::vector<char> & scratch = restoreBuffer_();
+            scratch.resize(encoded_bytes_);
+            compression::lzDecompress(data, stored_bytes_, scratch.data(), encoded_bytes_);
+            data = scratch.data();
+        }
+        read_ptr_ = data;
+        read_pos_ = 0;
+        reads_past_end_ = 0;
+    }
+
+    void beginLine(ArchData::line_idx_type idx) {
+        sparta_assert(idx != ArchData::INVALID_LINE_IDX,
+                      "Cannot begin line with INVALID_LINE_IDX index");
+        sparta_assert(idx != last_line_idx_,
+                      "Cannot store the same line idx twice in a checkpoint. Line "
+                      << idx << " detected twice in a row");
+        next_idx_ = idx;
+    }
+
+    void writeLineBytes(const char* data, size_t size) {
+        sparta_assert(next_idx_ != ArchData::INVALID_LINE_IDX,
+                      "Cannot write line bytes with INVALID_LINE_IDX index");
+        sparta_assert(!block_compressed_ && !spill_file_,
+                      "Cannot write to checkpoint storage after it has been compressed or spilled");
+
+        const size_t header_pos = arena_.size();
+        arena_.resize(header_pos + HEADER_SIZE);
+
+        Encoding enc = Encoding::RAW;
+        if(compression_ != Compression::NONE) {
+            if(isZero_(data, size)) {
+                enc = Encoding::ZERO;
+            }
+            else {
+                compression::rleEncode(data, size, arena_);
+                if(arena_.size() - header_pos - HEADER_SIZE < size) {
+                    enc = Encoding::RLE;
+                }
+                else {
+                    arena_.resize(header_pos + HEADER_SIZE);
+                }
+            }
+        }
+        if(enc == Encoding::RAW) {
+            arena_.insert(arena_.end(), data, data + size);
+        }
+        writeHeader_(header_pos, next_idx_, size, arena_.size() - header_pos - HEADER_SIZE, enc);
+
+        raw_bytes_ += HEADER_SIZE + size;
+        encoded_bytes_ = stored_bytes_ = arena_.size();
+        last_line_idx_ = next_idx_;
+        next_idx_ = ArchData::INVALID_LINE_IDX;
+    }
+
+    /*!
+     * \brief Signals end of this checkpoint's data for one ArchData
+     */
+    void endArchData() {
+        const size_t header_pos = arena_.size();
+        arena_.resize(header_pos + HEADER_SIZE);
+        writeHeader_(header_pos, ArchData::INVALID_LINE_IDX, 0, 0, Encoding::ZERO);
+        raw_bytes_ += HEADER_SIZE;
+        encoded_bytes_ = stored_bytes_ = arena_.size();
+        last_line_idx_ = ArchData::INVALID_LINE_IDX;
+    }
+
+    /*!
+     * \brief Is the reading state of this storage good? (i.e. haven't tried
+     * to read past the end of the data)
+     */
+    bool good() const {
+        return reads_past_end_ <= 1;
+    }
+
+    /*!
+     * \brief Restore next line. Return ArchData::INVALID_LINE_IDX on
+     * end of data.
+     */
+    ArchData::line_idx_type getNextRestoreLine() {
+        if(read_pos_ == encoded_bytes_){
+            if(reads_past_end_++ == 0){
+                return ArchData::INVALID_LINE_IDX; // Done with restore
+            }
+            throw SpartaException("Failed to restore a checkpoint because ")
+                << "caller tried to keep getting next line even after "
+                "reaching the end of the restore data";
+        }
+
+        const char * header = read_ptr_ + read_pos_;
+        ::memcpy(&cur_idx_, header, sizeof(cur_idx_));
+        ::memcpy(&cur_bytes_, header + sizeof(cur_idx_), sizeof(cur_bytes_));
+        ::memcpy(&cur_encoded_bytes_, header + sizeof(cur_idx_) + sizeof(cur_bytes_),
+                 sizeof(cur_encoded_bytes_));
+        cur_encoding_ = static_cast<Encoding>(header[HEADER_SIZE - 1]);
+        read_pos_ += HEADER_SIZE + cur_encoded_bytes_;
+        return cur_idx_; // May be invalid to indicate end of ArchData
+    }
+
+    /*!
+     * \brief Read bytes for the current line
+     */
+    void copyLineBytes(char* buf, uint32_t size) {
+        sparta_assert(cur_idx_ != ArchData::INVALID_LINE_IDX,
+                      "About to return line from checkpoint data segment with INVALID_LINE_IDX index");
+        sparta_assert(size == cur_bytes_,
+                      "Attempted to restore checkpoint data for a line where the "
+                      "data was " << cur_bytes_ << " bytes but the loader requested "
+                      << size << " bytes. The sizes must match up or something is "
+                      "wrong");
+        const char * payload = read_ptr_ + read_pos_ - cur_encoded_bytes_;
+        switch(cur_encoding_) {
+        case Encoding::ZERO:
+            ::memset(buf, 0, size);
+            break;
+        case Encoding::RLE:
+            compression::rleDecode(payload, cur_encoded_bytes_, buf, size);
+            break;
+        case Encoding::RAW:
+            ::memcpy(buf, payload, size);
+            break;
+        }
+    }
+
+    /*!
+     * \brief Skip bytes for the current line
+     */
+    void skipLineBytes(uint32_t size) {
+        sparta_assert(size == cur_bytes_,
+                      "Attempted to skip " << size << " bytes of checkpoint data for a line where the "
+                      "data was " << cur_bytes_ << " bytes");
+        // getNextRestoreLine already moved past this line's data
+    }
+
+private:
+
+    //! How an individual line is encoded in the arena
+    enum class Encoding : uint8_t {
+        RAW,
+        ZERO,
+        RLE
+    };
+
+    //! Line index, raw bytes, encoded bytes, encoding
+    static constexpr size_t HEADER_SIZE = sizeof(ArchData::line_idx_type) + 2 * sizeof(uint32_t) + 1;
+
+    void writeHeader_(size_t pos, ArchData::line_idx_type idx, uint32_t bytes,
+                      uint32_t encoded_bytes, Encoding enc)
+    {
+        char * header = arena_.data() + pos;
+        ::memcpy(header, &idx, sizeof(idx));
+        ::memcpy(header + sizeof(idx), &bytes, sizeof(bytes));
+        ::memcpy(header + sizeof(idx) + sizeof(bytes), &encoded_bytes, sizeof(encoded_bytes));
+        header[HEADER_SIZE - 1] = static_cast<char>(enc);
+    }
+
+    static bool isZero_(const char * data, size_t size) {
+        uint64_t word;
+        size_t i = 0;
+        for(; i + sizeof(word) <= size; i += sizeof(word)) {
+            ::memcpy(&word, data + i, sizeof(word));
+            if(word != 0) {
+                return false;
+            }
+        }
+        for(; i < size; ++i) {
+            if(data[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Scratch space to decompress into while restoring
+    static std::vector<char> & restoreBuffer_() {
+        thread_local std::vector<char> buf;
+        return buf;
+    }
+
+    Compression compression_ = Compression::RLE;
+
+    //! Encoded lines, or the block compressed lines
+    std::vector<char> arena_;
+
+    //! Bytes of lines before block compression (headers included)
+    uint64_t raw_bytes_ = 0;
+
+    //! Bytes of encoded lines before block compression
+    uint64_t encoded_bytes_ = 0;
+
+    //! Bytes of arena_, or of the spilled arena
+    uint64_t stored_bytes_ = 0;
+
+    //! Was the arena block compressed
+    bool block_compressed_ = false;
+
+    //! File holding the arena once spilled
+    std::shared_ptr<SpillFile> spill_file_;
+    uint64_t spill_offset_ = 0;
+
+    //! Write state
+    ArchData::line_idx_type next_idx_ = ArchData::INVALID_LINE_IDX;
+    ArchData::line_idx_type last_line_idx_ = ArchData::INVALID_LINE_IDX;
+
+    //! Read state
+    const char * read_ptr_ = nullptr;
+    uint64_t read_pos_ = 0;
+    uint32_t reads_past_end_ = 0;
+    ArchData::line_idx_type cur_idx_ = ArchData::INVALID_LINE_IDX;
+    uint32_t cur_bytes_ = 0;
+    uint32_t cur_encoded_bytes_ = 0;
+    Encoding cur_encoding_ = Encoding::RAW;
+};
+
+} // namespace sparta::serialization::checkpoint::storage
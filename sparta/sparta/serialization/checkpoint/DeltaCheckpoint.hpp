@@ -15,6 +15,7 @@
 #include "sparta/serialization/checkpoint/Checkpointer.hpp"
 #include "sparta/serialization/checkpoint/CheckpointExceptions.hpp"
 #include "sparta/serialization/checkpoint/VectorStorage.hpp"
+#include "sparta/serialization/checkpoint/CompressedStorage.hpp"
 #include "sparta/serialization/checkpoint/StringStreamStorage.hpp"
 
 namespace sparta::serialization::checkpoint
@@ -85,6 +86,9 @@ namespace sparta::serialization::checkpoint
          * this. If not ensured, a loaded checkpoint could produce incorrect
          * state
          *
+         * \param storage Initial (empty) storage for this checkpoint's data,
+         * carrying any storage configuration
+         *
          * Snapshot checkpoint can be restored without walking any checkpoint
          * chains
          */
@@ -92,10 +96,12 @@ namespace sparta::serialization::checkpoint
                         chkpt_id_t id,
                         tick_t tick,
                         DeltaCheckpoint* prev_delta,
-                        bool is_snapshot) :
+                        bool is_snapshot,
+                        StorageT storage = StorageT()) :
             Checkpoint(id, tick, prev_delta),
             deleted_id_(UNIDENTIFIED_CHECKPOINT),
-            is_snapshot_(is_snapshot)
+            is_snapshot_(is_snapshot),
+            data_(std::move(storage))
         {
             if(nullptr == prev_delta){
                 if(is_snapshot == false){
@@ -395,6 +401,45 @@ namespace sparta::serialization::checkpoint
             }
         }
 
+        /*!
+         * \brief Restores this checkpoint by walking the restore chain
+         * backward from this checkpoint to the previous snapshot, restoring
+         * only the newest version of each line.
+         * \param dats ArchDatas to restore
+         * \param stats Counters of lines restored and skipped to update
+         * \return The number of checkpoints in the restore chain
+         *
+         * Results in the same state as load, but each line is copied once
+         * regardless of how many deltas in the chain contain it, so restore
+         * cost depends on the number of distinct lines changed since the
+         * snapshot rather than the length of the chain.
+         */
+        uint32_t loadNewestLines(const std::vector<ArchData*>& dats,
+                                 ArchData::RestoreStats& stats) {
+            for(ArchData* ad : dats){
+                ad->beginNewestLineRestore();
+            }
+
+            uint32_t chain_length = 0;
+            DeltaCheckpoint* d = this;
+            while(d){
+                d->data_.prepareForLoad();
+                sparta_assert(d->data_.good(),
+                              "Attempted to loadNewestLines from a DeltaCheckpoint with a bad data buffer");
+                for(ArchData* ad : dats){
+                    ad->restoreNewestLines(d->data_, stats);
+                }
+                ++chain_length;
+                if(d->isSnapshot()){
+                    return chain_length;
+                }
+                d = static_cast<DeltaCheckpoint*>(d->getPrev());
+            }
+
+            throw CheckpointError("In loadNewestLines, reached a null previous checkpoint from checkpoint ")
+                << getID() << " without encountering a snapshot";
+        }
+
         /*!
          * \brief Can this checkpoint be deleted
          * Cannot be deleted if:
@@ -528,6 +573,11 @@ namespace sparta::serialization::checkpoint
             */
         }
 
+        /*!
+         * \brief Storage holding this checkpoint's data
+         */
+        const StorageT& getStorage() const noexcept { return data_; }
+
         /*!
          * \brief Make this the head checkpoint by detaching from previous checkpoint.
          * \note Asserts that this is a snapshot.
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <stack>
@@ -57,17 +59,55 @@ namespace sparta::serialization::checkpoint
      * \li repeat in any order necessary
      * \endverbatim
      *
+     * Checkpoint data is held in storage::CompressedStorage. By default,
+     * all-zero lines are elided and other lines are run-length encoded
+     * when that makes them smaller (see setCompression). All but the
+     * most recent getNumHotCheckpoints() checkpoints are considered cold:
+     * they are block compressed (with Compression::LZ) and, if a spill file
+     * was given with setSpillFile, moved out of memory into that file.
+     *
+     * By default, loadCheckpoint walks from the checkpoint back to the
+     * previous snapshot and restores only the newest version of each line
+     * instead of replaying every delta (see setRestoreMode). Statistics about
+     * restores are available from getRestoreStats.
+     *
      * \todo Implement reverse delta storage for backward checkpoint loading
      * \todo Tune ArchData line size based on checkpointer performance
      * \todo More profiling
-     * \todo Compression
      * \todo Saving to disk using a templated checkpoint object storage class (allowing for non-binary)
      */
     class FastCheckpointer : public Checkpointer
     {
     public:
 
-        using checkpoint_type = DeltaCheckpoint<storage::VectorStorage>;
+        using checkpoint_type = DeltaCheckpoint<storage::CompressedStorage>;
+        using Compression = storage::CompressedStorage::Compression;
+
+        /*!
+         * \brief How checkpoints are restored by loadCheckpoint
+         */
+        enum class RestoreMode {
+            //! Restore the previous snapshot, then replay each delta after it
+            REPLAY_DELTAS,
+
+            //! Walk from the checkpoint back to the previous snapshot,
+            //! restoring only the newest version of each line
+            NEWEST_LINES
+        };
+
+        /*!
+         * \brief Statistics about checkpoint restores
+         */
+        struct RestoreStats {
+            uint64_t num_restores = 0;         //!< Number of checkpoints loaded
+            uint64_t num_chain_checkpoints = 0; //!< Sum of restore chain lengths
+            uint32_t max_chain_length = 0;     //!< Longest restore chain
+            uint64_t lines_restored = 0;       //!< Lines copied (NEWEST_LINES only)
+            uint64_t lines_skipped = 0;        //!< Older line versions skipped (NEWEST_LINES only)
+            uint64_t bytes_restored = 0;       //!< Bytes copied (NEWEST_LINES only)
+            double   total_seconds = 0;        //!< Total wall time spent restoring
+            double   max_seconds = 0;          //!< Longest single restore
+        };
         using checkpoint_ptr = std::unique_ptr<checkpoint_type>;
         using checkpoint_ptrs = std::vector<checkpoint_ptr>;
 
@@ -165,6 +205,102 @@ namespace sparta::serialization::checkpoint
             snap_thresh_ = thresh;
         }
 
+        /*!
+         * \brief Returns how checkpoints are restored
+         */
+        RestoreMode getRestoreMode() const noexcept { return restore_mode_; }
+
+        /*!
+         * \brief Sets how checkpoints are restored
+         * \see RestoreMode
+         */
+        void setRestoreMode(RestoreMode mode) noexcept {
+            restore_mode_ = mode;
+        }
+
+        /*!
+         * \brief Returns statistics of all checkpoint restores since
+         * construction or the last resetRestoreStats
+         */
+        const RestoreStats& getRestoreStats() const noexcept { return restore_stats_; }
+
+        /*!
+         * \brief Clears the restore statistics
+         */
+        void resetRestoreStats() noexcept {
+            restore_stats_ = RestoreStats();
+        }
+
+        /*!
+         * \brief Writes the restore statistics to \a o. Useful for tuning the
+         * snapshot threshold: restore latency grows with the average chain
+         * length, which grows with the snapshot threshold
+         */
+        void dumpRestoreStats(std::ostream& o) const {
+            const RestoreStats& st = restore_stats_;
+            const double num = st.num_restores ? st.num_restores : 1;
+            o << "Checkpoint restores: " << st.num_restores
+              << "\n  mode: " << (restore_mode_ == RestoreMode::NEWEST_LINES ? "newest lines" : "replay deltas")
+              << "\n  avg chain length: " << st.num_chain_checkpoints / num
+              << " (max " << st.max_chain_length << ")"
+              << "\n  avg lines restored: " << st.lines_restored / num
+              << ", skipped: " << st.lines_skipped / num
+              << "\n  avg bytes restored: " << st.bytes_restored / num
+              << "\n  avg latency: " << st.total_seconds * 1e6 / num << " us"
+              << " (max " << st.max_seconds * 1e6 << " us)" << std::endl;
+        }
+
+        /*!
+         * \brief Returns how checkpoint data is compressed
+         */
+        Compression getCompression() const noexcept { return compression_; }
+
+        /*!
+         * \brief Sets how the data of subsequent checkpoints is compressed
+         * \see storage::CompressedStorage::Compression
+         */
+        void setCompression(Compression compression) noexcept {
+            compression_ = compression;
+        }
+
+        /*!
+         * \brief Returns the number of most recently created checkpoints
+         * which are kept uncompressed and in memory
+         */
+        uint32_t getNumHotCheckpoints() const noexcept { return num_hot_; }
+
+        /*!
+         * \brief Sets the number of most recently created checkpoints
+         * which are kept uncompressed and in memory. Older checkpoints are
+         * block compressed and spilled (if enabled) as new checkpoints are
+         * created
+         * \pre \a num_hot must be at least 1
+         */
+        void setNumHotCheckpoints(uint32_t num_hot) {
+            sparta_assert(num_hot > 0, "FastCheckpointer must keep at least 1 hot checkpoint");
+            num_hot_ = num_hot;
+        }
+
+        /*!
+         * \brief Spill cold checkpoints to a memory-mapped file instead of
+         * keeping them in memory
+         * \param filename File to create. It is removed once the
+         * checkpointer and all checkpoints spilled to it are destroyed
+         * \note Checkpoints already cold are not spilled
+         */
+        void setSpillFile(const std::string& filename) {
+            spill_file_.reset(new storage::SpillFile(filename));
+        }
+
+        /*!
+         * \brief Returns the number of bytes of checkpoint data moved to the
+         * spill file (0 if spilling is not enabled). This includes data of
+         * checkpoints since deleted
+         */
+        uint64_t getSpilledBytes() const noexcept {
+            return spill_file_ ? spill_file_->getSize() : 0;
+        }
+
         /*!
          * \brief Computes and returns the memory usage by this checkpointer at
          * this moment including any framework overhead
@@ -263,7 +399,24 @@ namespace sparta::serialization::checkpoint
                     << id << " because no checkpoint by this ID was found";
             }
 
-            d->load(getArchDatas());
+            const auto start = std::chrono::steady_clock::now();
+            uint32_t chain_length;
+            if(restore_mode_ == RestoreMode::NEWEST_LINES){
+                ArchData::RestoreStats line_stats;
+                chain_length = d->loadNewestLines(getArchDatas(), line_stats);
+                restore_stats_.lines_restored += line_stats.lines_restored;
+                restore_stats_.lines_skipped += line_stats.lines_skipped;
+                restore_stats_.bytes_restored += line_stats.bytes_restored;
+            }else{
+                chain_length = d->getDistanceToPrevSnapshot() + 1;
+                d->load(getArchDatas());
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            restore_stats_.num_restores++;
+            restore_stats_.num_chain_checkpoints += chain_length;
+            restore_stats_.max_chain_length = std::max(restore_stats_.max_chain_length, chain_length);
+            restore_stats_.total_seconds += seconds;
+            restore_stats_.max_seconds = std::max(restore_stats_.max_seconds, seconds);
 
             // Move current to another checkpoint. Anything between head and the
             // old current_ is fair game for removal if allowed
@@ -780,8 +933,6 @@ namespace sparta::serialization::checkpoint
             // only) can the whole chain (including the leading shapshot) be
             // deleted.
 
-            //! \todo Support compression
-
             if(d == getHead()){
                 // Cannot delete head of checkpoint tree
                 return;
@@ -949,7 +1100,9 @@ namespace sparta::serialization::checkpoint
                 }
             }
 
-            checkpoint_type* dcp = new checkpoint_type(getArchDatas(), next_chkpt_id_++, tick, nullptr, true);
+            checkpoint_type* dcp = new checkpoint_type(getArchDatas(), next_chkpt_id_++, tick, nullptr, true,
+                                                       storage::CompressedStorage(compression_));
+            dcp->data_.shrinkToFit();
             chkpts_[dcp->getID()].reset(dcp);
             setHead_(dcp);
             num_alive_checkpoints_++;
@@ -1008,7 +1161,9 @@ namespace sparta::serialization::checkpoint
                                                        next_chkpt_id_++,
                                                        tick,
                                                        prev,
-                                                       force_snapshot || is_snapshot);
+                                                       force_snapshot || is_snapshot,
+                                                       storage::CompressedStorage(compression_));
+            dcp->data_.shrinkToFit();
             chkpts_[dcp->getID()].reset(dcp);
             num_alive_checkpoints_++;
             num_alive_snapshots_ += (dcp->isSnapshot() == true);
@@ -1021,9 +1176,32 @@ namespace sparta::serialization::checkpoint
                 cleanupChain_(dcp);
             }
 
+            coolCheckpoints_();
+
             return dcp->getID();
         }
 
+        /*!
+         * \brief Compress and spill (if enabled) the data of every checkpoint
+         * that is no longer one of the getNumHotCheckpoints() most recently
+         * created
+         */
+        void coolCheckpoints_() {
+            if(next_chkpt_id_ - checkpoint_type::MIN_CHECKPOINT <= num_hot_){
+                return;
+            }
+            const chkpt_id_t cold_end = next_chkpt_id_ - num_hot_;
+            for(auto itr = chkpts_.lower_bound(next_cold_id_);
+                itr != chkpts_.end() && itr->first < cold_end; ++itr){
+                checkpoint_type* d = static_cast<checkpoint_type*>(itr->second.get());
+                d->data_.compress();
+                if(spill_file_){
+                    d->data_.spill(spill_file_);
+                }
+            }
+            next_cold_id_ = cold_end;
+        }
+
         /*!
          * \brief All checkpoints sorted by ascending tick number (or
          * equivalently ascending checkpoint ID since both are monotonically
@@ -1064,6 +1242,36 @@ namespace sparta::serialization::checkpoint
          * still exist in the checkpointer.
          */
         uint32_t num_dead_checkpoints_;
+
+        /*!
+         * \brief How checkpoints are restored
+         */
+        RestoreMode restore_mode_ = RestoreMode::NEWEST_LINES;
+
+        /*!
+         * \brief Statistics of checkpoint restores
+         */
+        RestoreStats restore_stats_;
+
+        /*!
+         * \brief Compression of new checkpoint data
+         */
+        Compression compression_ = Compression::RLE;
+
+        /*!
+         * \brief Number of most recent checkpoints not cooled
+         */
+        uint32_t num_hot_ = 1;
+
+        /*!
+         * \brief Lowest checkpoint ID which has not been cooled
+         */
+        chkpt_id_t next_cold_id_ = checkpoint_type::MIN_CHECKPOINT;
+
+        /*!
+         * \brief File cold checkpoints are spilled to (if any)
+         */
+        std::shared_ptr<storage::SpillFile> spill_file_;
     };
 
 } // namespace sparta::serialization::checkpoint
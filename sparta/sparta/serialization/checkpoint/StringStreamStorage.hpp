@@ -119,6 +119,13 @@ public:
     void copyLineBytes(char* buf, uint32_t size) {
         ss_.read(buf, size);
     }
+
+    /*!
+     * \brief Skip bytes for the current line
+     */
+    void skipLineBytes(uint32_t size) {
+        ss_.seekg(size, std::ios_base::cur);
+    }
 };
 
 } // namespace sparta::serialization::checkpoint::storage
@@ -224,6 +224,13 @@ public:
         cur_restore_itr_->copyTo(buf, size);
     }
 
+    /*!
+     * \brief Skip bytes for the current line
+     */
+    void skipLineBytes(uint32_t size) {
+        (void) size; // Next call to getNextRestoreLine moves to the next segment
+    }
+
 };
 
 } // namespace sparta::serialization::checkpoint::storage
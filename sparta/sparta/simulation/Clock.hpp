@@ -17,6 +17,7 @@
 #include <memory>
 #include <list>
 #include <map>
+#include <limits>
 
 #include "sparta/kernel/Scheduler.hpp"
 #include "sparta/simulation/TreeNode.hpp"
@@ -140,6 +141,7 @@ namespace sparta
             sparta_assert(!isFinalized(),
                               "Should not be setting period on a sparta::Clock after device tree finalization");
             period_ = uint32_t(root_ratio_ * norm);
+            invalidateCycleCaches_();
         }
 
         /*!
@@ -165,10 +167,18 @@ namespace sparta
          * \brief Get the current cycle (uses current tick from the
          *        Scheduler)
          * \return The current cycle based on current tick
+         *
+         * The cycle is computed on demand and cached until the
+         * Scheduler's current tick changes.
          */
         Cycle currentCycle() const
         {
-            return getCycle(scheduler_->getCurrentTick());
+            const Scheduler::Tick tick = scheduler_->getCurrentTick();
+            if(SPARTA_EXPECT_FALSE(tick != current_cycle_tick_)) {
+                current_cycle_tick_ = tick;
+                current_cycle_      = getCycle(tick);
+            }
+            return current_cycle_;
         }
 
         /**
@@ -180,22 +190,22 @@ namespace sparta
             return scheduler_->getCurrentTick();
         }
 
-        /**
-         * \brief Update the elapsed_cycles internal value given the
-         * number of ticks
-         * \param elapsed_ticks The number of ticks elapsed
-         */
-        void updateElapsedCycles(const Scheduler::Tick elapsed_ticks)
-        {
-            elapsed_cycles_ = getCycle(elapsed_ticks);
-        }
-
         /**
          * \brief Return the total elapsed cycles from this Clocks POV
          * \return The elapsed cycles
+         *
+         * The cycle count is computed on demand and cached until the
+         * Scheduler's elapsed ticks change.  The Scheduler does not
+         * visit every Clock on every tick, so the cost of running the
+         * Scheduler does not depend on the number of Clocks.
          */
         Cycle elapsedCycles() const
         {
+            const Scheduler::Tick elapsed_ticks = scheduler_->getElapsedTicks();
+            if(SPARTA_EXPECT_FALSE(elapsed_ticks != elapsed_cycles_tick_)) {
+                elapsed_cycles_tick_ = elapsed_ticks;
+                elapsed_cycles_      = getCycle(elapsed_ticks);
+            }
             return elapsed_cycles_;
         }
 
@@ -322,7 +332,20 @@ namespace sparta
         Period                    period_        = 1;
         StatisticSet              sset_ = {this};
         const double              frequency_mhz_ = 0.0;
-        Cycle                     elapsed_cycles_ = 0;
+
+        //! Cached cycle values and the Scheduler tick they were
+        //! computed for.  An invalid tick forces recomputation
+        static constexpr Scheduler::Tick INVALID_CYCLE_TICK = std::numeric_limits<Scheduler::Tick>::max();
+        mutable Cycle             elapsed_cycles_ = 0;
+        mutable Scheduler::Tick   elapsed_cycles_tick_ = INVALID_CYCLE_TICK;
+        mutable Cycle             current_cycle_ = 0;
+        mutable Scheduler::Tick   current_cycle_tick_ = INVALID_CYCLE_TICK;
+
+        //! Force the cached cycle values to be recomputed (period changed)
+        void invalidateCycleCaches_() {
+            elapsed_cycles_tick_ = INVALID_CYCLE_TICK;
+            current_cycle_tick_  = INVALID_CYCLE_TICK;
+        }
 
         class CurrentCycleCounter : public ReadOnlyCounter {
             Clock& clk_;
@@ -363,7 +386,8 @@ namespace sparta
  * \param src_clk   The sender's clock
  * \param dst_delay The receiver's delay (in ticks) to schedule from "now"
  * \param dst_clk   The receiver's clock
- * \note both clocks must be on the same scheduler. See
+ * \note both clocks must be on the same scheduler, or on partitions
+ * of the same sparta::ParallelSchedulerRunner. See
  * sparta::Clock::getScheduler
  *
  * \return Relative scheduler tick that the crossing would incur
@@ -373,14 +397,17 @@ inline Scheduler::Tick calculateClockCrossingDelay(Scheduler::Tick src_delay, co
 {
     sparta_assert(src_clk, "calculateClockCrossingDelay requires a non-null src_clk");
     sparta_assert(dst_clk, "calculateClockCrossingDelay requires a non-null dst_clk");
-    sparta_assert(src_clk->getScheduler() == dst_clk->getScheduler(),
-                      "calculateClockCrossingDelay requires src_clk and dst_clk to operate on "
-                      "the same scheduler. src = " << src_clk->getScheduler() << " and dst = "
-                      << dst_clk->getScheduler());
     auto scheduler = src_clk->getScheduler();
     sparta_assert(scheduler,
                       "calculateClockCrossingDelay requires src_clk (" << *src_clk << ") to "
                       "have a non-null scheduler");
+    sparta_assert(scheduler == dst_clk->getScheduler() ||
+                  (scheduler->getPartitionRunner() != nullptr &&
+                   dst_clk->getScheduler() != nullptr &&
+                   scheduler->getPartitionRunner() == dst_clk->getScheduler()->getPartitionRunner()),
+                      "calculateClockCrossingDelay requires src_clk and dst_clk to operate on "
+                      "the same scheduler or partitions of the same runner. src = "
+                      << src_clk->getScheduler() << " and dst = " << dst_clk->getScheduler());
 
     sparta::Scheduler::Tick current_tick = scheduler->getCurrentTick();
     sparta::Scheduler::Tick num_delay_ticks = 0;
@@ -422,7 +449,8 @@ inline Scheduler::Tick calculateClockCrossingDelay(Scheduler::Tick src_delay, co
  * \param src_clk   The sender's clock
  * \param dst_delay The receiver's delay (in ticks) to schedule from "now"
  * \param dst_clk   The receiver's clock
- * \note both clocks must be on the same scheduler. See
+ * \note both clocks must be on the same scheduler, or on partitions
+ * of the same sparta::ParallelSchedulerRunner. See
  * sparta::Clock::getScheduler
  *
  * \return Relative scheduler tick that the reverse crossing would incur
@@ -433,14 +461,17 @@ inline Scheduler::Tick calculateReverseClockCrossingDelay(Scheduler::Tick dst_ar
 {
     sparta_assert(src_clk, "calculateReverseClockCrossingDelay requires a non-null src_clk");
     sparta_assert(dst_clk, "calculateReverseClockCrossingDelay requires a non-null dst_clk");
-    sparta_assert(src_clk->getScheduler() == dst_clk->getScheduler(),
-                      "calculateReverseClockCrossingDelay requires src_clk and dst_clk to operate on "
-                      "the same scheduler. src = " << src_clk->getScheduler() << " and dst = "
-                      << dst_clk->getScheduler());
     auto scheduler = src_clk->getScheduler();
     sparta_assert(scheduler,
                       "calculateReverseClockCrossingDelay requires src_clk (" << *src_clk << ") to "
                       "have a non-null scheduler");
+    sparta_assert(scheduler == dst_clk->getScheduler() ||
+                  (scheduler->getPartitionRunner() != nullptr &&
+                   dst_clk->getScheduler() != nullptr &&
+                   scheduler->getPartitionRunner() == dst_clk->getScheduler()->getPartitionRunner()),
+                      "calculateReverseClockCrossingDelay requires src_clk and dst_clk to operate on "
+                      "the same scheduler or partitions of the same runner. src = "
+                      << src_clk->getScheduler() << " and dst = " << dst_clk->getScheduler());
 
     sparta::Scheduler::Tick relative_ticks_before_arrival = 0;
 
@@ -4,7 +4,6 @@
 
 #include <vector>
 #include <sstream>
-#include <regex>
 #include <memory>
 #include <string>
 #include <map>
@@ -17,6 +16,7 @@
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/utils/LexicalCast.hpp"
 #include "sparta/utils/MetaStructs.hpp"
+#include "sparta/utils/GlobPattern.hpp"
 
 namespace sparta
 {
@@ -72,6 +72,7 @@ namespace sparta
             Node* parent_ = nullptr; //!< Parent node
             ParameterTree * tree_ = nullptr;  //!< Tree owning this node. Applies to root only
             std::string name_;     //!< Name of this node relative to it's parent
+            mutable std::shared_ptr<const utils::GlobPattern> pattern_; //!< name_ compiled as a pattern. Set on first use
             std::string value_;    //!< Value of this node (if set. See has_value_)
             std::string origin_;   //!< Origin of this node (e.g. which yaml file and line). Valid only if value is set.
             bool has_value_;       //!< Does this node have a value yet
@@ -220,6 +221,7 @@ namespace sparta
             Node& operator= (const Node& n) {
                 // preserve parent_
                 name_ = n.name_;
+                pattern_ = n.pattern_;
                 value_ = n.value_;
                 origin_ = n.origin_;
                 has_value_ = n.has_value_;
@@ -246,6 +248,16 @@ namespace sparta
              */
             const std::string& getName() const { return name_; }
 
+            /*!
+             * \brief Gets the name of this node compiled as a pattern
+             */
+            const utils::GlobPattern& getPattern() const {
+                if(!pattern_){
+                    pattern_ = utils::GlobPattern::get(name_);
+                }
+                return *pattern_;
+            }
+
             /*!
              * \brief Gets the parent of this node
              */
@@ -436,9 +448,7 @@ namespace sparta
              * \erturn true if \a pattern matches \a other, false if not/
              */
             static bool matches(const std::string& pattern, const std::string& other) {
-                std::regex expr(TreeNode::createSearchRegexPattern(pattern));
-                std::smatch what;
-                return std::regex_match(other, what, expr);
+                return utils::GlobPattern::get(pattern)->matches(other);
             }
 
             /*!
@@ -457,7 +467,7 @@ namespace sparta
                 // Always search in reverse-applied order to match on most recent changes first
                 auto itr = children_.rbegin();
                 for(; itr != children_.rend(); ++itr){
-                    if(matches((*itr)->getName(), name)){
+                    if((*itr)->getPattern().matches(name)){
                         return itr->get();
                     }
                 }
@@ -563,7 +573,7 @@ namespace sparta
                             // will not apply
                             continue;
                         }
-                    }else if(matches((*itr)->getName(), name)){
+                    }else if((*itr)->getPattern().matches(name)){
                         // Encountered a wildcard node which matches on this name before hitting an
                         // exact match. Therefore, a new node must be created by the caller so that
                         // the parameter being set will affect a subset of this node's pattern
@@ -1056,7 +1066,7 @@ namespace sparta
                 void operator++() {++itr_;}
 
                 bool matches(const std::string& other) const {
-                    return ParameterTree::Node::matches((*itr_)->getName(), other);
+                    return (*itr_)->getPattern().matches(other);
                 }
 
                 const Node* get() const {
@@ -19,7 +19,6 @@
 #include <set>
 #include <map>
 #include <unordered_map>
-#include <regex>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -31,6 +30,7 @@
 #include "sparta/extensions/TreeNodeExtensionManager.hpp"
 #include "sparta/functional/ArchDataContainer.hpp"
 #include "sparta/utils/Utils.hpp"
+#include "sparta/utils/GlobPattern.hpp"
 #include "sparta/utils/SpartaException.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
 #include "sparta/utils/Printing.hpp"
@@ -1435,14 +1435,16 @@ namespace sparta
 
         /*!
          * \brief Finds immediate children with some identity (name or alias)
-         * matching a regex.
-         * \param expr Expression to match with child node identities
+         * matching a pattern.
+         * \param expr Compiled pattern to match with child node identities.
+         * A pattern without wildcards is looked up by name rather than
+         * compared with every child
          * \param found All nodes with matching identities are appended to this
          * vector. This vector is not cleared
          * \return Number of children found in this call
          * \note Does not recurse
          */
-        virtual uint32_t findImmediateChildren_(std::regex& expr,
+        virtual uint32_t findImmediateChildren_(const utils::GlobPattern& expr,
                                                 std::vector<TreeNode*>& found,
                                                 std::vector<std::vector<std::string>>& replacements,
                                                 bool allow_private=false);
@@ -1450,14 +1452,14 @@ namespace sparta
         /*!
          * \brief Variant of findImmediateChildren_ with no replacements vector
          */
-        uint32_t findImmediateChildren_(std::regex& expr,
+        uint32_t findImmediateChildren_(const utils::GlobPattern& expr,
                                         std::vector<TreeNode*>& found,
                                         bool allow_private=false);
 
         /*!
          * \brief Const-qualified variant of findImmediateChildren_
          */
-        virtual uint32_t findImmediateChildren_(std::regex& expr,
+        virtual uint32_t findImmediateChildren_(const utils::GlobPattern& expr,
                                                 std::vector<const TreeNode*>& found,
                                                 std::vector<std::vector<std::string>>& replacements,
                                                 bool allow_private=false) const;
@@ -1466,7 +1468,7 @@ namespace sparta
          * \brief Variant of const-qualified findImmediateChildren_ with no
          * replacements vector
          */
-        uint32_t findImmediateChildren_(std::regex& expr,
+        uint32_t findImmediateChildren_(const utils::GlobPattern& expr,
                                         std::vector<const TreeNode*>& found,
                                         bool allow_private=false) const;
 
@@ -2668,14 +2670,13 @@ namespace sparta
 
         /*!
          * \brief Performs pattern matching on a identity string.
-         * \param ident Regex identity. This could be generated from an input
-         * glob pattern
-         * \param expr Expression to compare against \a ident
+         * \param ident Identity to test
+         * \param expr Compiled pattern to compare against \a ident
          * \param replacements Returns each captured replacement of a in the
          * expression
          */
         static bool identityMatchesPattern_(const std::string& ident,
-                                            std::regex& expr,
+                                            const utils::GlobPattern& expr,
                                             std::vector<std::string>& replacements);
 
 
@@ -2683,7 +2684,7 @@ namespace sparta
          * \brief Variant of identityMatchesPattern_ with no replacements vector
          */
         static bool identityMatchesPattern_(const std::string& ident,
-                                            std::regex& expr);
+                                            const utils::GlobPattern& expr);
 
         /*!
          * \brief Gets the previous name between two '.' chars in a string starting
@@ -2,7 +2,6 @@
 
 #pragma once
 
-#include <regex>
 #include <string>
 #include <vector>
 #include <memory>
@@ -127,7 +126,7 @@ namespace sparta
         // Searches parentless nodes
 
         // Const variant of findImmediateChildren_
-        virtual uint32_t findImmediateChildren_(std::regex& expr,
+        virtual uint32_t findImmediateChildren_(const utils::GlobPattern& expr,
                                                 std::vector<TreeNode*>& found,
                                                 std::vector<std::vector<std::string>>& replacements,
                                                 bool allow_private) override final {
@@ -154,7 +153,7 @@ namespace sparta
         }
 
         // Const variant of findImmediateChildren_
-        virtual uint32_t findImmediateChildren_(std::regex& expr,
+        virtual uint32_t findImmediateChildren_(const utils::GlobPattern& expr,
                                                 std::vector<const TreeNode*>& found,
                                                 std::vector<std::vector<std::string>>& replacements,
                                                 bool allow_private) const override final {
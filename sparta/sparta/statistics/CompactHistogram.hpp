@@ -0,0 +1,524 @@
+// <CompactHistogram.hpp> -*- C++ -*-
+
+
+/**
+ * \file CompactHistogram.hpp
+ * \brief Histogram implementation accumulating into a flat array of counts
+ */
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sparta/utils/MathUtils.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+#include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/ReadOnlyCounter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
+#include "sparta/statistics/StatisticSet.hpp"
+#include "sparta/simulation/Resource.hpp"
+
+namespace sparta
+{
+/*!
+ * \brief Histogram base class for uint64_t values which keeps its counts in
+ * a flat array instead of one sparta::Counter per bin.
+ *
+ * Bins are laid out exactly as in sparta::HistogramBase (see
+ * HistogramBase for how the number of bins is computed) and the same
+ * statistics are published under the same names, so reports cannot tell
+ * the two apart. The difference is in how they are stored:
+ *
+ * \li addValue only touches a contiguous array of uint64_t counts (the
+ * underflow bin, the regular bins, then the overflow bin) and two plain
+ * integers for the total and sum. There are no per-bin Counter objects
+ * on the hot path and no bounds-checked accesses.
+ * \li Each bin is exposed to the tree as a sparta::ReadOnlyCounter which
+ * reads its count from the array only when a report or statistic asks
+ * for it.
+ *
+ * This makes it the better choice for latency histograms with many bins
+ * which are updated often.
+ *
+ * \note Like all ReadOnlyCounters, the bins are not checkpointed.
+ */
+class CompactHistogramBase
+{
+protected:
+    /*!
+     * \brief CompactHistogramBase constructor
+     * \param lower_val the lower value of the histogram. Values lower than
+     * lower_val go into the underflow bin.
+     * \param upper_val the upper value of the histogram. Values higher than
+     * upper_val go into the overflow bin.
+     * \param num_vals_per_bin Number of values per bin. Must be power of two
+     * for fast devision.
+     */
+    CompactHistogramBase(uint64_t lower_val,
+                         uint64_t upper_val,
+                         uint32_t num_vals_per_bin) :
+        lower_val_(lower_val),
+        upper_val_(upper_val),
+        num_vals_per_bin_(num_vals_per_bin)
+    {
+        sparta_assert_context(upper_val > lower_val,
+                            "CompactHistogram: upper value must be greater than lower value");
+        sparta_assert_context(utils::is_power_of_2(num_vals_per_bin),
+                            "CompactHistogram: num_vals_per_bin must be power of 2");
+        idx_shift_amount_ = utils::floor_log2(num_vals_per_bin);  // for quick devide
+        double actual_num_bins = (upper_val - lower_val)/num_vals_per_bin + 1;
+        num_bins_ = (uint64_t) actual_num_bins;
+        sparta_assert_context(actual_num_bins == num_bins_,
+                            "CompactHistogram: Actual number of bins (" << actual_num_bins
+                            << ") is not an integer");
+
+        // Underflow, regular bins, overflow. Never resized: the bin
+        // counters point into this array
+        counts_.assign(num_bins_ + 2, 0);
+    }
+
+public:
+
+    //! Not copy-constructable: bin counters point into this object
+    CompactHistogramBase(const CompactHistogramBase&) = delete;
+
+    //! Not assignable
+    CompactHistogramBase& operator=(const CompactHistogramBase&) = delete;
+
+    /*!
+     * \brief Add a value to histogram
+     * \param val New value to add
+     * \post Correct bin will be incremented
+     * \post Total will be incremented
+     */
+    void addValue(uint64_t val)
+    {
+        ++total_values_;
+        running_sum_ += val;
+
+        uint64_t idx;
+        if (SPARTA_EXPECT_FALSE(val < lower_val_)) {
+            idx = 0;
+        }
+        else if (SPARTA_EXPECT_FALSE(val > upper_val_)) {
+            idx = num_bins_ + 1;
+        }
+        else {
+            idx = ((val - lower_val_) >> idx_shift_amount_) + 1;
+        }
+        ++counts_[idx];
+
+        if (max_counters_.size()) {
+            updateMaxValues_(val);
+        }
+    }
+
+    /*!
+     * \brief Calculate Standard Deviation of counts in bins.
+     *  This API also takes into account the count in underflow
+     *  and overflow bins.
+     */
+    double getStandardDeviation() const {
+        const double mean = getMeanBinCount();
+        double accum = 0.0;
+        for (const uint64_t c : counts_) {
+            accum += (c - mean) * (c - mean);
+        }
+        return std::sqrt(accum / (counts_.size() - 1));
+    }
+
+    /*!
+     * \brief Calculate the mean bin count of all the bins.
+     *  This API also takes into account the count in underflow
+     *  and overflow bins.
+     */
+    double getMeanBinCount() const {
+        const double sum = std::accumulate(counts_.begin(), counts_.end(), 0.0);
+        return sum / counts_.size();
+    }
+
+    /*!
+     * \brief Return aggregate of this histogram
+     */
+    uint64_t getAggValues() const {
+        return total_values_;
+    }
+
+    /*!
+     * \brief Return the sum of all values added to this histogram
+     */
+    uint64_t getSum() const {
+        return running_sum_;
+    }
+
+    /*!
+     * \brief Return the count of regular bin \a idx
+     * \pre idx < getNumBins()
+     */
+    uint64_t getBinCount(uint32_t idx) const {
+        sparta_assert(idx < num_bins_);
+        return counts_[idx + 1];
+    }
+
+    /*!
+     * \brief Return the counters publishing the regular bins, in bin order
+     */
+    const std::vector<sparta::ReadOnlyCounter>& getRegularBin() const {
+        return bin_;
+    }
+
+    /*!
+     * \brief Return count of underflow bin.
+     */
+    uint64_t getUnderflowBin() const {
+        return counts_.front();
+    }
+
+    /*!
+     * \brief Return count of overflow bin.
+     */
+    uint64_t getOverflowBin() const {
+        return counts_.back();
+    }
+
+    /*!
+     * \brief Return underflow probability.
+     */
+    double getUnderflowProbability() const {
+        return static_cast<double>(counts_.front()) / static_cast<double>(total_values_);
+    }
+
+    /*!
+     * \brief Return overflow probability.
+     */
+    double getOverflowProbability() const {
+        return static_cast<double>(counts_.back()) / static_cast<double>(total_values_);
+    }
+
+    /*!
+     * \brief Return vector of probabilities regular bins.
+     */
+    const std::vector<double>& recomputeRegularBinProbabilities() const {
+        bin_prob_vector_.clear();
+        for (uint32_t i = 0; i < num_bins_; ++i) {
+            bin_prob_vector_.emplace_back(static_cast<double>(counts_[i + 1]) /
+                                          static_cast<double>(total_values_));
+        }
+        return bin_prob_vector_;
+    }
+
+    uint64_t getHistogramUpperValue() const { return upper_val_; }
+    uint64_t getHistogramLowerValue() const { return lower_val_; }
+    uint32_t getNumBins() const { return num_bins_; }
+    uint32_t getNumValuesPerBin() const { return num_vals_per_bin_; }
+
+protected:
+
+    /*!
+     *  Keep track of the maximum 'N' values seen
+     *  \param val The value currently being added to the histogram
+     */
+    void updateMaxValues_(uint64_t val) {
+        auto min_it = max_values_.begin();
+        if (*min_it >= val) {
+            return;
+        }
+
+        max_values_.erase(min_it);
+        max_values_.insert(val);
+
+        uint32_t idx = 0;
+        for (auto it = max_values_.begin(); it != max_values_.end(); it++) {
+            max_counters_[idx].set(*it);
+            idx++;
+        }
+    }
+
+    /*!
+     * \brief Render the cumulative values of this histogram for use in
+     * standalone model
+     */
+    std::string getDisplayStringCumulative_(const std::string & name) const
+    {
+        std::stringstream str;
+        str << std::dec;
+        uint64_t running_sum = counts_.front();
+        str << "\t" <<  name << "[ UF ] = " << running_sum << std::endl;
+        uint64_t start_val = lower_val_;
+        uint64_t end_val  = start_val + num_vals_per_bin_ - 1;
+        for (uint32_t i=0; i<num_bins_; ++i) {
+            if (end_val > upper_val_)
+                end_val = upper_val_;
+            running_sum += counts_[i + 1];
+            str << "\t" << name
+                << "[ " << start_val << "-" << end_val << " ] = "
+                << running_sum << std::endl;
+            start_val = end_val + 1;
+            end_val  += num_vals_per_bin_;
+        }
+        running_sum += counts_.back();
+        str << "\t" << name << "[ OF ] = " << running_sum << std::endl;
+        return str.str();
+    }
+
+    /*!
+     *  Creates the counters and statistics publishing this histogram. These
+     *  are named as in HistogramBase::initializeStats_
+     *  \param sset The statistic set to add all histogram stats into
+     *  \param stat_prefix String used as a prefix for all generated stat names
+     *  \param bin_vis Visibility of the bin / total / OF / UF stats
+     *  \param prob_vis Visibility of the probability stats
+     *  \param num_max_values Track the max 'num_max_values' seen as separate counters
+     */
+    void initializeStats_(StatisticSet * sset,
+                          const std::string & stat_prefix = "",
+                          InstrumentationNode::Visibility bin_vis = InstrumentationNode::VIS_NORMAL,
+                          InstrumentationNode::Visibility prob_vis = InstrumentationNode::VIS_NORMAL,
+                          uint32_t num_max_values = 0,
+                          InstrumentationNode::Visibility max_vis = InstrumentationNode::VIS_SUMMARY)
+    {
+        total_values_ctr_.reset(new sparta::ReadOnlyCounter(sset,
+                                                            stat_prefix + "total",
+                                                            "Total values added to the histogram",
+                                                            CounterBase::COUNT_NORMAL,
+                                                            &total_values_,
+                                                            bin_vis));
+
+        running_sum_ctr_.reset(new sparta::ReadOnlyCounter(sset,
+                                                           stat_prefix + "sum",
+                                                           "Sum of all values added to the histogram",
+                                                           CounterBase::COUNT_NORMAL,
+                                                           &running_sum_,
+                                                           bin_vis));
+
+        // Reserve to use emplacement without tree child reordering
+        bin_.reserve(num_bins_);
+
+        underflow_bin_.reset(new sparta::ReadOnlyCounter(sset,
+                                                         stat_prefix + "UF",
+                                                         "underflow bin",
+                                                         CounterBase::COUNT_NORMAL,
+                                                         &counts_.front(),
+                                                         bin_vis));
+        underflow_probability_.reset(new StatisticDef(sset,
+                                                      stat_prefix + "UF_probability",
+                                                      "Probability of underflow",
+                                                      sset,
+                                                      stat_prefix + "UF" + "/" + stat_prefix + "total",
+                                                      StatisticDef::VS_FRACTIONAL,
+                                                      prob_vis));
+        uint64_t start_val = lower_val_;
+        uint64_t end_val   = start_val + num_vals_per_bin_ - 1;
+        for (uint32_t i=0; i<num_bins_; ++i) {
+            if (end_val > upper_val_)
+                end_val = upper_val_;
+            std::stringstream str;
+            str << stat_prefix << "bin_" << start_val << "_" << end_val;
+            bin_.emplace_back(sset,
+                              str.str(),
+                              str.str() + " histogram bin",
+                              CounterBase::COUNT_NORMAL,
+                              &counts_[i + 1],
+                              bin_vis);
+            probabilities_.emplace_back(new StatisticDef(sset,
+                                                         str.str() + "_probability",
+                                                         str.str() + " bin probability",
+                                                         sset,
+                                                         str.str() + "/" + stat_prefix + "total",
+                                                         StatisticDef::VS_FRACTIONAL,
+                                                         prob_vis));
+            start_val = end_val + 1;
+            end_val  += num_vals_per_bin_;
+        }
+        overflow_bin_.reset(new sparta::ReadOnlyCounter(sset,
+                                                        stat_prefix + "OF",
+                                                        stat_prefix + "overflow bin",
+                                                        CounterBase::COUNT_NORMAL,
+                                                        &counts_.back(),
+                                                        bin_vis));
+        overflow_probability_.reset(new StatisticDef(sset,
+                                                     stat_prefix + "OF_probability",
+                                                     "Probability of overflow",
+                                                     sset,
+                                                     stat_prefix + "OF" + "/" + stat_prefix + "total",
+                                                     StatisticDef::VS_FRACTIONAL,
+                                                     prob_vis));
+
+        average_.reset(new StatisticDef(sset,
+                                        stat_prefix + "average",
+                                        "Average of all values added to the histogram",
+                                        sset,
+                                        stat_prefix + "sum" + "/" + stat_prefix + "total",
+                                        StatisticDef::VS_ABSOLUTE,
+                                        sparta::InstrumentationNode::VIS_NORMAL));
+
+        if (num_max_values > 0) {
+            max_counters_.reserve(num_max_values);
+            for (uint32_t idx = 0; idx < num_max_values; idx++) {
+                std::stringstream mvtext;
+                mvtext << "maxval" << idx;
+                max_counters_.emplace_back(sset,
+                                           stat_prefix + mvtext.str(),
+                                           stat_prefix + " maximum value",
+                                           Counter::COUNT_LATEST,
+                                           max_vis);
+                max_counters_[idx].set(0); // Counters can't have -1, so use '0' for uninitialized
+                max_values_.insert(0);
+            }
+        }
+    }
+
+private:
+    const uint64_t lower_val_; //!< Lowest value captured in normal bins
+    const uint64_t upper_val_; //!< Highest value vaptured in normal bins
+    const uint32_t num_vals_per_bin_; //!< Number of values captured by each bin
+
+    uint64_t total_values_ = 0; //!< Total number of values
+    uint64_t running_sum_ = 0; //!< Sum of all values that have been logged
+    std::vector<uint64_t> counts_; //!< Underflow, regular and overflow bin counts
+
+    std::unique_ptr<sparta::ReadOnlyCounter> total_values_ctr_; //!< Publishes total_values_
+    std::unique_ptr<sparta::ReadOnlyCounter> running_sum_ctr_; //!< Publishes running_sum_
+    std::unique_ptr<sparta::ReadOnlyCounter> underflow_bin_; //!< Publishes the underflow count
+    std::unique_ptr<sparta::ReadOnlyCounter> overflow_bin_; //!< Publishes the overflow count
+    std::vector<sparta::ReadOnlyCounter> bin_; //!< Publish the regular bin counts
+    std::unique_ptr<sparta::StatisticDef> underflow_probability_; //!< Probability of underflow
+    std::unique_ptr<sparta::StatisticDef> overflow_probability_; //!< Probability of overflow
+    std::vector<std::unique_ptr<sparta::StatisticDef>> probabilities_; //!< Probabilities of each normal bin
+    std::unique_ptr<sparta::StatisticDef> average_; //!< Average of all values in the histogram
+
+    std::vector<sparta::Counter> max_counters_;
+    std::multiset<uint64_t>      max_values_;
+
+    uint32_t num_bins_; //!< Number of bins
+
+    /*!
+     * \brief Number of bits which cannot distinguish between bins for a given input value
+     */
+    uint32_t idx_shift_amount_;
+    mutable std::vector<double> bin_prob_vector_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+class CompactHistogramStandalone : public CompactHistogramBase
+{
+public:
+    /*!
+     *  Create a standalone compact histogram
+     *  \param sset Statistic set to add this histogram's stats into
+     *  \param stat_prefix String prefix to prepend to all internally
+     *  generated stat names
+     *  \param lower_val Minimum value in the histogram
+     *  \param upper_val Maximum value in the histogram
+     *  \param num_vals_per_bin Number of values per bin
+     *  \param num_max_values Track the top 'num_max_values' maximum values
+     *  \param bin_vis Visbility of the bin / OF / UF / total stats
+     *  \param prob_vis Visibility of the probability stats
+     */
+    CompactHistogramStandalone(StatisticSet * sset,
+                               const std::string & stat_prefix,
+                               uint64_t lower_val,
+                               uint64_t upper_val,
+                               uint32_t num_vals_per_bin,
+                               uint32_t num_max_vals,
+                               InstrumentationNode::Visibility bin_vis = InstrumentationNode::VIS_NORMAL,
+                               InstrumentationNode::Visibility prob_vis = InstrumentationNode::VIS_NORMAL,
+                               InstrumentationNode::Visibility max_vis = InstrumentationNode::VIS_NORMAL) :
+        CompactHistogramBase(lower_val, upper_val, num_vals_per_bin)
+    {
+        initializeStats_(sset, stat_prefix, bin_vis, prob_vis, num_max_vals, max_vis);
+    }
+
+    std::string getDisplayStringCumulative(const std::string & name) const {
+        return getDisplayStringCumulative_(name);
+    }
+};
+
+//////////////////////////////////////////////////////////////////////
+
+/**
+ *  Compact counterpart of sparta::HistogramTreeNode
+ */
+class CompactHistogramTreeNode : public TreeNode, public CompactHistogramBase
+{
+public:
+
+    /*!
+     * \brief Not default constructable
+     */
+    CompactHistogramTreeNode() = delete;
+
+    /*!
+     * \brief Not copy-constructable
+     */
+    CompactHistogramTreeNode(const CompactHistogramTreeNode&) = delete;
+
+    /*!
+     * \brief Not move-constructable
+     */
+    CompactHistogramTreeNode(CompactHistogramTreeNode&&) = delete;
+
+    /*!
+     * \brief Not assignable
+     */
+    void operator=(const CompactHistogramTreeNode&) = delete;
+
+    /*!
+     * \brief CompactHistogramTreeNode constructor
+     * \param parent_treenode parent node. Must not be nullptr
+     * \param histogram_name Name of this histograms. Used as name of the
+     * TreeNode representing this histogram
+     * \param description Description of this histogran. Stored as TreeNode
+     * description
+     * \param lower_val the lower value of the histogram. Values lower than
+     * lower_val go into the underflow bin.
+     * \param upper_val the upper value of the histogram. Values higher than
+     * upper_val go into the overflow bin.
+     * \param num_vals_per_bin Number of values per bin. Must be power of two
+     * for fast devision.
+     * \param num_max_values Track the top 'num_max_values' maximum values
+     */
+    CompactHistogramTreeNode(TreeNode* parent_treenode,
+                             const std::string & histogram_name,
+                             const std::string & description,
+                             uint64_t lower_val,
+                             uint64_t upper_val,
+                             uint32_t num_vals_per_bin,
+                             uint32_t num_max_values = 0,
+                             InstrumentationNode::Visibility bin_vis = InstrumentationNode::VIS_NORMAL,
+                             InstrumentationNode::Visibility prob_vis = InstrumentationNode::VIS_NORMAL) :
+        TreeNode(histogram_name, description),
+        CompactHistogramBase(lower_val, upper_val, num_vals_per_bin),
+        sset_(this)
+    {
+        if(parent_treenode){
+            setExpectedParent_(parent_treenode);
+        }
+
+        initializeStats_(&sset_, "", bin_vis, prob_vis, num_max_values,
+                         InstrumentationNode::VIS_SUMMARY);
+
+        if(parent_treenode){
+            parent_treenode->addChild(this);
+        }
+    }
+
+    std::string getDisplayStringCumulative() const {
+        return getDisplayStringCumulative_(getName());
+    }
+
+private:
+
+    sparta::StatisticSet sset_; //!< StatisticSet node
+
+}; // class CompactHistogramTreeNode
+
+} // namespace sparta
@@ -165,6 +165,7 @@ namespace sparta
             }
 
             val_ = val;
+            checkThreshold_();
             return val;
         }
 
@@ -204,6 +205,7 @@ namespace sparta
             // sparta_assert(ret != true, "Encountered an overflowing Counter: " << getLocation());
 
             val_ += add;
+            checkThreshold_();
             return val_;
         }
 
@@ -214,7 +216,9 @@ namespace sparta
          * \todo Allow indexed accesses if larger counters are supported
          */
         counter_type operator++() {
-            return ++val_;
+            ++val_;
+            checkThreshold_();
+            return val_;
         }
 
         /*!
@@ -224,7 +228,9 @@ namespace sparta
          * \todo Allow indexed accesses if larger counters are supported
          */
         counter_type operator++(int) {
-            return val_++;
+            const counter_type prev = val_++;
+            checkThreshold_();
+            return prev;
         }
 
         //! \brief Increment this value withi overflow detection
@@ -263,6 +269,11 @@ namespace sparta
             return true;
         }
 
+        //! Counters call back armed thresholds as they are updated
+        bool supportsArmedThresholds() const override {
+            return true;
+        }
+
         //! \name Printing Methods
         //! @{
         ////////////////////////////////////////////////////////////////////////
@@ -297,6 +308,14 @@ namespace sparta
 
     private:
 
+        //! Call back armed thresholds if the value has reached them.
+        //! With no thresholds armed this never calls out
+        void checkThreshold_() const {
+            if(SPARTA_EXPECT_FALSE(val_ >= armed_threshold_)) {
+                thresholdReached_(val_);
+            }
+        }
+
         /*!
          * \brief Current value of the counter
          */
@@ -3,6 +3,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "sparta/kernel/SpartaHandler.hpp"
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/statistics/InstrumentationNode.hpp"
 #include "sparta/utils/ByteOrder.hpp"
@@ -273,7 +279,11 @@ namespace sparta
         CounterBase(CounterBase&& rhp) :
             InstrumentationNode(std::move(rhp)),
             behave_(rhp.behave_)
-        {;}
+        {
+            sparta_assert(rhp.threshold_observers_.empty(),
+                          "Cannot move counter " << rhp.getLocation()
+                          << " while thresholds are armed on it");
+        }
 
         /*!
          * \brief Destructor
@@ -326,6 +336,74 @@ namespace sparta
         ////////////////////////////////////////////////////////////////////////
         //! @}
 
+        //! \name Armed Thresholds
+        //! @{
+        ////////////////////////////////////////////////////////////////////////
+
+        /*!
+         * \brief Does this counter notify armed thresholds itself when
+         * its value reaches them?
+         *
+         * Counters that return false (the default) must be polled by
+         * anything waiting on their value.  Counters that return true
+         * call the callback given to armThreshold from the code that
+         * updates their value.
+         */
+        virtual bool supportsArmedThresholds() const {
+            return false;
+        }
+
+        /*!
+         * \brief Call back when the value of this counter reaches a threshold
+         * \param owner Identifies this threshold for disarmThreshold.
+         *        An owner can only have one threshold armed at a time
+         * \param threshold Value at or above which to call back
+         * \param callback Called once, from the code that updates the
+         *        counter, when the value reaches \a threshold.  The
+         *        threshold is disarmed before the callback is made.  If
+         *        the value is already at or above \a threshold, the
+         *        callback is made immediately
+         * \pre supportsArmedThresholds() must be true
+         *
+         * Thresholds are not part of the counter's value, so they can be
+         * armed on a const counter.
+         */
+        void armThreshold(const void * owner, counter_type threshold,
+                          const SpartaHandler & callback) const
+        {
+            sparta_assert(supportsArmedThresholds(),
+                          "Counter " << getLocation() << " does not support armed thresholds");
+            disarmThreshold(owner);
+            if(get() >= threshold) {
+                callback();
+                return;
+            }
+            threshold_observers_.emplace_back(ThresholdObserver{owner, threshold, callback});
+            armed_threshold_ = std::min(armed_threshold_, threshold);
+        }
+
+        /*!
+         * \brief Disarm the threshold armed by \a owner, if any
+         */
+        void disarmThreshold(const void * owner) const
+        {
+            auto it = std::find_if(threshold_observers_.begin(), threshold_observers_.end(),
+                                   [owner](const ThresholdObserver & obs) { return obs.owner == owner; });
+            if(it != threshold_observers_.end()) {
+                threshold_observers_.erase(it);
+                updateArmedThreshold_();
+            }
+        }
+
+        //! Get the lowest armed threshold, or the maximum counter value
+        //! if no threshold is armed
+        counter_type getArmedThreshold() const {
+            return armed_threshold_;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //! @}
+
         //! \name Printing Methods
         //! @{
         ////////////////////////////////////////////////////////////////////////
@@ -363,8 +441,56 @@ namespace sparta
             throw SpartaException("Cannot add children to a CounterBase");
         }
 
+        /*!
+         * \brief Make the callbacks of every threshold at or below val and
+         * disarm them.  Subclasses supporting armed thresholds call this
+         * when their value reaches armed_threshold_
+         */
+        void thresholdReached_(counter_type val) const
+        {
+            // Callbacks may arm or disarm thresholds, so take the reached
+            // ones out before calling any of them
+            std::vector<SpartaHandler> reached;
+            auto it = std::partition(threshold_observers_.begin(), threshold_observers_.end(),
+                                     [val](const ThresholdObserver & obs) { return obs.threshold > val; });
+            for(auto obs = it; obs != threshold_observers_.end(); ++obs) {
+                reached.emplace_back(obs->callback);
+            }
+            threshold_observers_.erase(it, threshold_observers_.end());
+            updateArmedThreshold_();
+            for(auto & callback : reached) {
+                callback();
+            }
+        }
+
+        /*!
+         * \brief Lowest armed threshold.  Subclasses supporting armed
+         * thresholds compare their value against this on every update
+         */
+        mutable counter_type armed_threshold_ = std::numeric_limits<counter_type>::max();
+
     private:
 
+        //! A threshold armed on this counter
+        struct ThresholdObserver
+        {
+            const void * owner;
+            counter_type threshold;
+            SpartaHandler callback;
+        };
+
+        //! Recompute armed_threshold_ from threshold_observers_
+        void updateArmedThreshold_() const
+        {
+            armed_threshold_ = std::numeric_limits<counter_type>::max();
+            for(const auto & obs : threshold_observers_) {
+                armed_threshold_ = std::min(armed_threshold_, obs.threshold);
+            }
+        }
+
+        //! Thresholds armed on this counter
+        mutable std::vector<ThresholdObserver> threshold_observers_;
+
         /*!
          * \brief Ensures that the parent node is a StatisticSet
          * \param parent Node to test for validity
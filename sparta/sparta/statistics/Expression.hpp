@@ -13,6 +13,7 @@
 #include "sparta/utils/SpartaException.hpp"
 #include "sparta/statistics/ExpressionNode.hpp"
 #include "sparta/statistics/ExpressionNodeTypes.hpp"
+#include "sparta/statistics/ExpressionProgram.hpp"
 
 namespace sparta {
 
@@ -443,6 +444,20 @@ public:
         return content_->evaluate();
     };
 
+    /*!
+     * \brief Append the instructions computing this expression to an
+     * ExpressionProgram
+     * \return Slot of the program holding the value of this expression
+     * \throw SpartaException if this expression has no content (as evaluate)
+     */
+    uint32_t compile(ExpressionProgram& prog) const {
+        if(content_ == nullptr){
+            throw SpartaException("Cannot evaluate expression because it has no content. Test with "
+                                "hasContent before blindly evaluating foreign expressions");
+        }
+        return content_->compile(prog);
+    }
+
     /*!
      * \brief Notify every item in this expression to start a new computation
      * window
@@ -2,16 +2,21 @@
 
 #pragma once
 
+#include <vector>
+
 #include "sparta/utils/SpartaAssert.hpp"
 #include "sparta/utils/SpartaException.hpp"
 
 namespace sparta {
 
+    class Clock;
     class StatisticInstance;
 
     namespace statistics {
         namespace expression {
 
+class ExpressionProgram;
+
 /*!
  * \brief Types of operations supported
  */
@@ -73,7 +78,7 @@ public:
      * \brief Compute value of this item in simulation. Must be implemented by
      * subclass
      */
-    double evaluate(){
+    double evaluate() const {
         double val = evaluate_();
 
         // trace
@@ -83,6 +88,28 @@ public:
         return val;
     }
 
+    /*!
+     * \brief Append the instructions computing this item to an
+     * ExpressionProgram
+     * \return Slot of the program holding the value of this item
+     * \note The default implementation emits a single instruction which
+     * calls evaluate(), so subclasses only need to override this to be
+     * evaluated without a virtual call
+     */
+    virtual uint32_t compile(ExpressionProgram& prog) const;
+
+    /*!
+     * \brief Compute the value of this function item from the values of its
+     * operands, already computed by an ExpressionProgram
+     * \param operands Value of each operand, in order
+     * \note Only called for items which compile themselves with
+     * ExpressionProgram::emitFunction
+     */
+    virtual double apply(const double* operands) const {
+        (void) operands;
+        throw SpartaException("Expression item does not implement apply()");
+    }
+
     virtual void start() = 0;
     virtual void end() = 0;
 
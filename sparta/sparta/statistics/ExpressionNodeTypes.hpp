@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "sparta/statistics/ExpressionNode.hpp"
+#include "sparta/statistics/ExpressionProgram.hpp"
 
 namespace sparta {
 
@@ -110,6 +111,36 @@ struct Operation : public ExpressionNode
         }
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        switch(type_){
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+            if(operands_.size() >= 2){
+                const uint32_t a = operands_[0]->compile(prog);
+                const uint32_t b = operands_[1]->compile(prog);
+                return prog.emitOperation(type_, a, b);
+            }
+            break;
+        case OP_NEGATE:
+            if(operands_.size() >= 1){
+                return prog.emitOperation(type_, operands_[0]->compile(prog));
+            }
+            break;
+        case OP_PROMOTE:
+        case OP_FORWARD:
+            if(operands_.size() >= 1){
+                return operands_[0]->compile(prog);
+            }
+            break;
+        default:
+            break;
+        }
+        // Leave errors to be thrown by evaluate
+        return ExpressionNode::compile(prog);
+    }
+
     //! Every SI needs to make an estimation (ahead of simulation)
     //! whether it's a good candidate for compression or not. There
     //! are some obvious good choices such as integral counters and
@@ -246,6 +277,10 @@ struct Constant : public ExpressionNode
         return value_;
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        return prog.emitConstant(value_);
+    }
+
     //! Constants are always good candidates for compression
     virtual bool supportsCompression() const override {
         return true;
@@ -345,6 +380,15 @@ struct UnaryFunction : public ExpressionNode
         return (double)fxn_(operand_->evaluate());
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        const uint32_t operands[] = {operand_->compile(prog)};
+        return prog.emitFunction(this, 1, operands);
+    }
+
+    virtual double apply(const double* operands) const override {
+        return (double)fxn_(operands[0]);
+    }
+
     //! We currently are not attempting compression for UnaryFunction,
     //! BinaryFunction, and TernaryFunction SI's. These are not used
     //! with nearly as much frequency as counters, constants, and
@@ -472,6 +516,15 @@ struct BinaryFunction : public ExpressionNode
         return (double)fxn_(x, y);
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        const uint32_t operands[] = {operand_1_->compile(prog), operand_2_->compile(prog)};
+        return prog.emitFunction(this, 2, operands);
+    }
+
+    virtual double apply(const double* operands) const override {
+        return (double)fxn_(operands[0], operands[1]);
+    }
+
     //! We currently are not attempting compression for UnaryFunction,
     //! BinaryFunction, and TernaryFunction SI's. These are not used
     //! with nearly as much frequency as counters, constants, and
@@ -610,6 +663,17 @@ struct TernaryFunction : public ExpressionNode
         return (double)fxn_(operand_1_->evaluate(), operand_2_->evaluate(), operand_3_->evaluate());
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        const uint32_t operands[] = {operand_1_->compile(prog),
+                                     operand_2_->compile(prog),
+                                     operand_3_->compile(prog)};
+        return prog.emitFunction(this, 3, operands);
+    }
+
+    virtual double apply(const double* operands) const override {
+        return (double)fxn_(operands[0], operands[1], operands[2]);
+    }
+
     //! We currently are not attempting compression for UnaryFunction,
     //! BinaryFunction, and TernaryFunction SI's. These are not used
     //! with nearly as much frequency as counters, constants, and
@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "sparta/statistics/ExpressionNode.hpp"
+#include "sparta/statistics/ExpressionProgram.hpp"
 #include "sparta/statistics/StatisticInstance.hpp"
 
 namespace sparta {
@@ -76,6 +77,10 @@ struct StatVariable : public ExpressionNode
         return stat_.getValue();
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        return prog.emitStatistic(stat_);
+    }
+
     virtual bool supportsCompression() const override {
         return stat_.supportsCompression();
     }
@@ -166,6 +171,10 @@ struct SimVariable : public ExpressionNode
         return getter_();
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        return prog.emitGetter(getter_);
+    }
+
     //! The SimVariable is a wrapper around a function
     //! pointer which returns a double. It might as well
     //! be generating random floating-point numbers. Let's
@@ -265,6 +274,10 @@ struct ReferenceVariable : public ExpressionNode
         return ref_;
     }
 
+    virtual uint32_t compile(ExpressionProgram& prog) const override {
+        return prog.emitReference(&ref_);
+    }
+
     //! We currently are not attempting compression for
     //! ReferenceVariable's. These are not used with nearly
     //! as much frequency as counters, constants, and parameters.
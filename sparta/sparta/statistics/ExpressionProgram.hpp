@@ -0,0 +1,282 @@
+// <ExpressionProgram> -*- C++ -*-
+
+/*!
+ * \file ExpressionProgram.hpp
+ * \brief Flattened form of one or more statistics expressions which can be
+ * evaluated without walking the expression trees
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "sparta/statistics/ExpressionNode.hpp"
+
+namespace sparta {
+
+    class CounterBase;
+    class ParameterBase;
+    class StatisticInstance;
+
+    namespace statistics {
+        namespace expression {
+
+class Expression;
+
+/*!
+ * \brief A set of expressions (and StatisticInstances) compiled into a single
+ * flat list of instructions in postfix order.
+ *
+ * Each instruction computes one value from constants, parameters or values
+ * computed by earlier instructions, so evaluating every expression in the
+ * program is a single loop over the instructions. Identical sub-expressions
+ * are computed once no matter how many of the expressions (or referenced
+ * StatisticDefs) contain them.
+ *
+ * Counters are not read by instructions. Every counter delta (current value
+ * less the value at the start of the window) used by the program is kept in
+ * one contiguous block of values, filled before the instructions run by
+ * gathering all counters and then subtracting all initial values at once.
+ *
+ * Programs are built from the same expression trees created by the
+ * ExpressionGrammar: every ExpressionNode appends its own instructions
+ * through ExpressionNode::compile.
+ *
+ * The computation window of every StatisticInstance in the program is baked
+ * into the program (e.g. the result of an ended window is a constant). The
+ * program notices when any of those instances is started, ended, assigned or
+ * loses its TreeNode before the next evaluation, so results always match
+ * evaluating the expressions directly. Restarting instances only updates the
+ * initial values of their counters; anything else recompiles the program.
+ *
+ * \note Expressions and StatisticInstances added as roots must outlive the
+ * program and must not be reassigned (call invalidate() if they are).
+ */
+class ExpressionProgram
+{
+public:
+
+    ExpressionProgram() = default;
+
+    //! Not copyable
+    ExpressionProgram(const ExpressionProgram&) = delete;
+
+    //! Not assignable
+    ExpressionProgram& operator=(const ExpressionProgram&) = delete;
+
+    /*!
+     * \brief Add an expression to evaluate
+     * \return Index of the value of this expression in the vector returned by
+     * evaluate. Its value is that of Expression::evaluate
+     */
+    uint32_t addRoot(const Expression& expr);
+
+    /*!
+     * \brief Add a statistic instance to evaluate
+     * \return Index of the value of this instance in the vector returned by
+     * evaluate. Its value, exceptions and snapshot logging are those of
+     * StatisticInstance::getValue, as are those of every instance nested in
+     * its expression
+     */
+    uint32_t addRoot(const StatisticInstance& si);
+
+    /*!
+     * \brief Number of roots added
+     */
+    uint32_t getNumRoots() const {
+        return roots_.size();
+    }
+
+    /*!
+     * \brief Evaluate every root, compiling the program first if needed
+     * \return Value of each root, indexed by the values returned from addRoot
+     * \throw Whatever evaluating the roots directly would throw
+     */
+    const std::vector<double>& evaluate();
+
+    /*!
+     * \brief Force the program to be recompiled before the next evaluation
+     */
+    void invalidate() {
+        compiled_ = false;
+    }
+
+    /*!
+     * \brief Number of instructions run by each evaluation
+     * \note Constants are not instructions. Only valid after evaluate
+     */
+    uint32_t getNumInstructions() const {
+        return code_.size();
+    }
+
+    /*!
+     * \brief Number of counter deltas gathered by each evaluation
+     * \note Only valid after evaluate
+     */
+    uint32_t getNumCounters() const {
+        return counters_.size();
+    }
+
+    /*!
+     * \brief Number of times this program has been compiled
+     */
+    uint32_t getNumCompiles() const {
+        return num_compiles_;
+    }
+
+    /*!
+     * \brief Values computed by the most recent evaluate
+     */
+    const std::vector<double>& getResults() const {
+        return results_;
+    }
+
+    //! \name Compilation
+    //! Used by ExpressionNode::compile to append instructions. Each returns
+    //! the slot holding the computed value. Emitting an instruction
+    //! identical to an earlier one returns the earlier slot.
+    //! @{
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Constant value
+    uint32_t emitConstant(double value);
+
+    //! Arithmetic operation on one (OP_NEGATE) or two slots
+    uint32_t emitOperation(operation_t op, uint32_t a, uint32_t b=0);
+
+    //! Call fn->apply() with the values in \a num_operands (at most 3) slots
+    uint32_t emitFunction(const ExpressionNode* fn,
+                          uint32_t num_operands,
+                          const uint32_t* operands);
+
+    //! Call node->evaluate(). Fallback for nodes which cannot compile
+    uint32_t emitNode(const ExpressionNode* node);
+
+    //! Call a getter function
+    uint32_t emitGetter(double (*getter)());
+
+    //! Read a double by reference
+    uint32_t emitReference(const double* ref);
+
+    //! Value of a StatisticInstance referenced from an expression
+    uint32_t emitStatistic(const StatisticInstance& si);
+
+    ////////////////////////////////////////////////////////////////////////
+    //! @}
+
+private:
+
+    enum class OpCode : uint8_t
+    {
+        CONSTANT,       //!< Not an instruction. Value numbering only
+        COUNTER_DELTA,  //!< Not an instruction. Gathered before the code runs
+        LOAD_PARAMETER,
+        LOAD_REFERENCE,
+        CALL_GETTER,
+        EVALUATE_NODE,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        NEGATE,
+        CALL_FUNCTION
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        uint8_t num_operands;
+        uint32_t dst;
+        uint32_t operands[3];
+        union {
+            const ParameterBase* param;
+            const double* ref;
+            double (*getter)();
+            const ExpressionNode* node;
+        };
+    };
+
+    //! A root: exactly one of expr and si is set
+    struct Root
+    {
+        const Expression* expr;
+        const StatisticInstance* si;
+    };
+
+    //! A StatisticInstance whose state was baked into the program
+    struct Dependency
+    {
+        const StatisticInstance* si;
+        uint64_t window_version;
+        uint64_t identity_version;
+        bool ended;
+        bool expired;
+        uint32_t delta;     //!< Index of its counter delta, if a counter
+        uint32_t slot;      //!< Slot holding its value
+    };
+
+    static constexpr uint32_t NO_DELTA = ~uint32_t(0);
+
+    typedef std::tuple<OpCode, uint32_t, uint32_t, uint32_t, uint64_t> ValueKey;
+
+    /*!
+     * \brief Emit an instruction unless an identical one exists
+     */
+    uint32_t emit_(const ValueKey& key, const Instruction& inst);
+
+    /*!
+     * \brief Emit the delta of a counter from an initial value
+     * \param[out] delta Index of the delta in counters_
+     */
+    uint32_t emitCounterDelta_(const CounterBase* ctr, double initial, uint32_t& delta);
+
+    /*!
+     * \brief Initial value subtracted from the counter of an instance
+     */
+    static double getCounterInitial_(const StatisticInstance& si);
+
+    /*!
+     * \brief Compile all roots from scratch
+     */
+    void compile_();
+
+    /*!
+     * \brief Move the counter deltas to the first slots
+     */
+    void gatherCounterSlots_();
+
+    /*!
+     * \brief Bring the program up to date with the StatisticInstances baked
+     * into it, if that does not require recompiling
+     * \return false if the program must be recompiled
+     */
+    bool refresh_();
+
+    std::vector<Root> roots_;
+
+    bool compiled_ = false;
+    uint32_t num_compiles_ = 0;
+    std::vector<Instruction> code_;
+    std::vector<double> slots_;
+    std::vector<uint32_t> root_slots_;
+    std::vector<const CounterBase*> counters_; //!< Delta i is in slot i
+    std::vector<double> initials_;             //!< Initial value of each delta
+    std::vector<uint32_t> counter_slots_;      //!< Slot of each delta while compiling
+    std::vector<uint32_t> delta_users_;        //!< Number of Dependencies on each delta
+    std::vector<Dependency> deps_;
+    std::map<ValueKey, uint32_t> values_;
+
+    //! Scratch space of refresh_, per delta
+    std::vector<uint32_t> restarted_users_;
+    std::vector<double> prev_initials_;
+    std::vector<uint32_t> restarted_deltas_;
+
+    std::vector<double> results_;
+};
+
+        } // namespace expression
+    } // namespace statistics
+} // namespace sparta
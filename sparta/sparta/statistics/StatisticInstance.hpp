@@ -9,6 +9,7 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <math.h>
 #include <utility>
@@ -21,6 +22,7 @@
 #include "sparta/simulation/Parameter.hpp"
 #include "sparta/simulation/Clock.hpp"
 #include "sparta/statistics/Expression.hpp"
+#include "sparta/statistics/ExpressionProgram.hpp"
 #include "sparta/statistics/StatInstCalculator.hpp"
 #include "sparta/statistics/dispatch/StatisticSnapshot.hpp"
 
@@ -92,6 +94,9 @@ namespace sparta
      */
     class StatisticInstance final
     {
+        //! Compiles and evaluates instances without calling getValue
+        friend class statistics::expression::ExpressionProgram;
+
         /*!
          * \brief Private Default constructor
          */
@@ -453,6 +458,26 @@ namespace sparta
 
     private:
 
+        /*!
+         * \brief Throws the exceptions getValue would for this window at
+         * the current tick, before any value is computed
+         */
+        void checkRange_() const;
+
+        /*!
+         * \brief Hands a value returned by getValue to the snapshot loggers
+         * \return \a value
+         */
+        double takeSnapshots_(double value) const;
+
+        /*!
+         * \brief Has the TreeNode this instance refers to (if any) been
+         * destroyed?
+         */
+        bool isExpired_() const {
+            return (sdef_ || ctr_ || par_) && node_ref_.expired();
+        }
+
         /*!
          * \brief Computes the value for this statistic.
          * \return Computed value over computation window. If any dependant
@@ -461,6 +486,11 @@ namespace sparta
          */
         double computeValue_() const;
 
+        /*!
+         * \brief Evaluates stat_expr_ through program_
+         */
+        double evaluateProgram_() const;
+
         /*!
          * \brief Append one pending substatistic for future creation (and addition to the
          * appropriate report)
@@ -588,6 +618,26 @@ namespace sparta
          */
         double result_{NAN};
 
+        /*!
+         * \brief Incremented whenever the window (start/end ticks, initial
+         * or result value) changes. Tells ExpressionPrograms that compiled
+         * this instance to refresh or recompile
+         */
+        uint64_t window_version_ = 0;
+
+        /*!
+         * \brief Incremented whenever this instance is assigned or moved
+         * from, after which it refers to different nodes and expression.
+         * Tells ExpressionPrograms that compiled this instance to recompile
+         */
+        uint64_t identity_version_ = 0;
+
+        /*!
+         * \brief Compiled form of stat_expr_, used by computeValue_. Created
+         * on first use and never copied
+         */
+        mutable std::unique_ptr<statistics::expression::ExpressionProgram> program_;
+
         /*!
          * \brief Snapshot objects who have requested access to statistics values
          */
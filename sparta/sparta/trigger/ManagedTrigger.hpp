@@ -21,6 +21,11 @@ namespace trigger {
  * method will be called at every Scheduler tick. Once this method
  * returns true, the virtual method 'invokeTrigger_()' will be called,
  * and the trigger will be removed from the TriggerManager.
+ *
+ * Subclasses that can tell when they may have been reached (e.g. by
+ * arming a threshold on a counter) override 'arm_()' and call
+ * 'thresholdReached_()' instead.  'isTriggerReached_()' is then only
+ * called on the cycle after each such call rather than every cycle.
  */
 class ManagedTrigger
 {
@@ -99,12 +104,39 @@ protected:
 
     bool isActive_() const;
 
+    /*!
+     * \brief Tell the TriggerManager that this armed trigger may have
+     * been reached. It will be checked at the top of the next cycle
+     */
+    void thresholdReached_();
+
 private:
     void deregisterSelf_() const;
 
     virtual bool isTriggerReached_() const = 0;
     virtual void invokeTrigger_() = 0;
 
+    /*!
+     * \brief Arrange for thresholdReached_() to be called when this
+     * trigger may have been reached, instead of being checked every cycle
+     * \return true if armed, false if this trigger must be checked every
+     * cycle
+     * \note Called by the TriggerManager when the trigger is added, and
+     * again if it was checked but not reached. Not called during
+     * construction of the ManagedTrigger base, so subclasses that arm
+     * should register again once constructed
+     */
+    virtual bool arm_() { return false; }
+
+    /*!
+     * \brief Undo arm_(). Called when an armed trigger is removed from
+     * the TriggerManager. Subclasses that arm must deactivate in their
+     * destructor so that this is dispatched to them
+     */
+    virtual void disarm_() const {}
+
+    friend class TriggerManager;
+
     std::string name_;
     const Clock * clk_ = nullptr;
     bool active_ = false;
@@ -414,6 +414,22 @@ private:
         SingleTrigger::invokeCallback_();
     }
 
+    /**
+     * \brief Arm the trigger point on counters that support armed
+     * thresholds (sparta::Counter), so that this trigger is only checked
+     * once the counter reaches it rather than every cycle
+     */
+    bool arm_() override;
+
+    //! Disarm the trigger point on the counter
+    void disarm_() const override;
+
+    //! Callback from the counter's armed threshold
+    void counterReachedTriggerPoint_();
+
+    //! Register again as an armed trigger once fully constructed
+    void reregister_();
+
     /**
      * \brief Counter to oberve
      */
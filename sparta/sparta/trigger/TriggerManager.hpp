@@ -17,6 +17,8 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include "sparta/trigger/ManagedTrigger.hpp"
@@ -97,6 +99,10 @@ public:
      * \brief Add a ManagedTrigger to update
      * \param trig Trigger to add. This must not already be in the TriggerManager. Must not be
      * nullptr
+     *
+     * Triggers that can arm themselves (see ManagedTrigger::arm_) are only
+     * checked after they report that they may have been reached. All
+     * others are checked every cycle of their clock.
      */
     void addTrigger(ManagedTrigger* trig) {
         sparta_assert(trig != nullptr,
@@ -104,8 +110,7 @@ public:
         sparta_assert(trig->getClock() != nullptr,
                           "Cannot add Trigger " << trig << " (which has a null clock) to TriggerManager");
 
-        // Check if the manager already has this trigger. Note that this checks each ClockHandler
-        // and considers deferred added/removed
+        // Check if the manager already has this trigger
         sparta_assert(hasTrigger(trig) == false,
                           "Cannot add Trigger " << trig << " to TriggerManager");
 
@@ -125,7 +130,7 @@ public:
      * \brief Does this handler have a particular trigger
      * \param trig Trigger to look for. This handler will never have null triggers
      */
-    bool hasTrigger(ManagedTrigger* trig) const {
+    bool hasTrigger(const ManagedTrigger* trig) const {
         auto handler_itr = clocks_.find(trig->getClock());
         if(handler_itr == clocks_.end()){
             return false;
@@ -148,15 +153,44 @@ public:
         }
 
         handler_itr->second->removeTrigger(trig);
-        if (handler_itr->second->getNumTriggers() == 0) {
+        if (handler_itr->second->canDestroy()) {
             clocks_.erase(handler_itr);
         }
     }
 
+    /*!
+     * \brief Check an armed trigger when a polled trigger on its clock would next be checked
+     * \param trig Trigger reporting that it may have been reached. Has no
+     * effect if it is not an armed trigger in this manager
+     */
+    void wakeTrigger(ManagedTrigger* trig) {
+        auto handler_itr = clocks_.find(trig->getClock());
+        if(handler_itr != clocks_.end()){
+            handler_itr->second->wakeTrigger(trig);
+        }
+    }
+
+    /*!
+     * \brief Is any trigger on this clock checked every cycle?
+     * \note Intended for testing. A clock without polled triggers costs
+     * no events until one of its armed triggers is reached
+     */
+    bool isPolling(const Clock* clk) const {
+        auto handler_itr = clocks_.find(clk);
+        return (handler_itr != clocks_.end()) && handler_itr->second->isPolling();
+    }
+
 private:
 
     /*!
      * \brief Handles ticks on a particular clock to query counters operating on that clock
+     *
+     * Polled triggers are held in a vector in the order they were added,
+     * with an index for constant-time lookup. Removing a trigger leaves a
+     * null in its place, which is skipped and compacted away at the end
+     * of the next tick. This makes it safe to add and remove triggers
+     * from within trigger callbacks: triggers added during a tick are
+     * first checked on the next one.
      */
     class ClockHandler
     {
@@ -169,8 +203,7 @@ private:
             TickLock(ClockHandler& ch) : ch_(ch) { ch.in_tick_ = true; }
             ~TickLock() {
                 ch_.in_tick_ = false;
-                ch_.handleDeferredRemovals_();
-                ch_.handleDeferredAdditions_();
+                ch_.compact_();
             }
         };
 
@@ -180,7 +213,8 @@ private:
 
         /*!
          * \brief Constructor
-         * \post Sets up callbacks on this clock's ticks directed to clockTick_
+         * \post Callbacks on this clock's ticks directed to clockTick_ will
+         * be scheduled once there is a trigger to check
          */
         ClockHandler(const Clock* clock) :
             clock_(clock),
@@ -189,8 +223,6 @@ private:
                    clock),
             in_tick_(false)
         {
-            // Schedule for the top of the tick on the next cycle
-            event_.schedule(1);
         }
 
         /*!
@@ -203,7 +235,22 @@ private:
          * \brief Gets the number of triggers currently observed by this handler
          */
         uint32_t getNumTriggers() const {
-            return triggers_.size();
+            return polled_index_.size() + armed_.size();
+        }
+
+        /*!
+         * \brief Can this handler be destroyed? It must have no triggers
+         * and not be within its own tick
+         */
+        bool canDestroy() const {
+            return (getNumTriggers() == 0) && !in_tick_;
+        }
+
+        /*!
+         * \brief Are any triggers checked every cycle?
+         */
+        bool isPolling() const {
+            return !polled_index_.empty();
         }
 
         /*!
@@ -216,157 +263,155 @@ private:
             sparta_assert(hasTrigger(trig) == false,
                               "Cannot add Trigger " << trig << " to Clock Handler for " << clock_);
 
-            if(in_tick_){
-                addTriggerDefferred_(trig);
-            }else{
-                addTriggerNow_(trig);
+            // The trigger may report that it was reached from within arm_.
+            // It is then first checked on the next cycle, as a polled
+            // trigger would be
+            armed_.insert(trig);
+            in_arm_ = true;
+            const bool armed = trig->arm_();
+            in_arm_ = false;
+            if(armed){
+                return;
             }
+            armed_.erase(trig);
+
+            polled_index_[trig] = polled_.size();
+            polled_.push_back(trig);
+            scheduleTick_();
         }
 
         /*!
          * \brief Does this handler have a particular trigger
          * \param trig Trigger to look for. This handler will never have null triggers
          */
-        bool hasTrigger(ManagedTrigger* trig) const {
-            // Note: the order of these tests reflects the order of TickLock in that it removes
-            // deferred triggers from the deferred to-remove list, then adds triggers from the
-            // deferred to-add list
-            auto cur_itr = std::find(triggers_.begin(), triggers_.end(), trig);
-            if(cur_itr != triggers_.end()){
-                auto removed_itr = std::find(to_remove_.begin(), to_remove_.end(), trig);
-                if(removed_itr != to_remove_.end()){
-                    auto added_itr = std::find(to_add_.begin(), to_add_.end(), trig);
-                    if(added_itr != to_add_.end()){
-                        return true; // Has trigger, but it is in to-remove list, but it is also in the to-add list
-                    }else{
-                        return false; // Has trigger, but it is in to-remove list (and not to-add list)
-                    }
-                }else{
-                    return true; // Has trigger, not in to-remove list
-                }
-            }else{
-                auto added_itr = std::find(to_add_.begin(), to_add_.end(), trig);
-                if(added_itr != to_add_.end()){
-                    return true; // Does not currently trigger, but it is in the to-add list
-                }else{
-                    return false; // Does not currently trigger and it is not in the to-add list
-                }
-            }
+        bool hasTrigger(const ManagedTrigger* trig) const {
+            return (polled_index_.count(trig) != 0) || (armed_.count(trig) != 0);
         }
 
         /*!
          * \brief Remove a trigger from this handler
          * \param trig Trigger to remove. Has no effect if not found (or if nullptr)
-         * \note Removals may be defferred if within a trigger callback.
-         * Deferred removals will then be handled at the end of clockTick_
          */
         void removeTrigger(const ManagedTrigger* trig) {
             if(nullptr == trig){
                 return;
             }
 
-            if(in_tick_){
-                removeTriggerDefferred_(trig);
-            }else{
-                removeTriggerNow_(trig);
+            auto armed_itr = armed_.find(trig);
+            if(armed_itr != armed_.end()){
+                armed_.erase(armed_itr);
+                trig->disarm_();
+                return;
             }
-        }
-
-    private:
-
-        /*!
-         * \brief Add a trigger at the end of a tick
-         * \post trig will not already be contained in this handler (or to_add_ list)
-         */
-        void addTriggerDefferred_(ManagedTrigger* trig) {
-            sparta_assert(in_tick_,
-                              "ClockHandler addTriggerDefferred_ called but ClockHandler was not "
-                              "currently within a tick");
 
-            to_add_.push_back(trig);
+            auto polled_itr = polled_index_.find(trig);
+            if(polled_itr != polled_index_.end()){
+                polled_[polled_itr->second] = nullptr;
+                polled_index_.erase(polled_itr);
+                ++num_removed_;
+                if(!in_tick_){
+                    compact_();
+                }
+            }
         }
 
         /*!
-         * \brief Add a trigger immediately
-         * \param trig Trigger to remove. Has no effect if not found
-         * \pre trig will not already be contained in this handler
+         * \brief Check an armed trigger at the next clock edge whose
+         * Trigger phase has not yet run, which is when a polled trigger
+         * would next have been checked
          */
-        void addTriggerNow_(ManagedTrigger* trig) {
-            sparta_assert(false == in_tick_,
-                              "ClockHandler addTriggerNow_ called but ClockHandler was "
-                              "currently within a tick");
-
-            // Ensure it is not already present
-            auto itr = std::find(triggers_.begin(), triggers_.end(), trig);
-            sparta_assert(itr == triggers_.end(),
-                              "Cannot add trigger " << trig << " to a ClockHandler because it is "
-                              " already present");
-
-            triggers_.push_back(trig);
+        void wakeTrigger(ManagedTrigger* trig) {
+            if(armed_.count(trig) == 0){
+                return;
+            }
+            woken_.push_back(trig);
+            if(in_arm_){
+                scheduleTick_();
+            }else{
+                scheduleWake_();
+            }
         }
 
-        /*!
-         * \brief Remove a trigger at the end of a tick
-         */
-        void removeTriggerDefferred_(const ManagedTrigger* trig) {
-            sparta_assert(in_tick_,
-                              "ClockHandler removeTriggerDefferred_ called but ClockHandler was not "
-                              "currently within a tick");
-
-            to_remove_.push_back(trig);
-        }
+    private:
 
         /*!
-         * \brief Remove a trigger immediately
-         * \param trig Trigger to remove. Has no effect if not found
+         * \brief Schedule clockTick_ for the next cycle if it is not already
          */
-        void removeTriggerNow_(const ManagedTrigger* trig) {
-            sparta_assert(false == in_tick_,
-                              "ClockHandler removeTriggerNow_ called but ClockHandler was "
-                              "currently within a tick");
-
-            auto itr = std::find(triggers_.begin(), triggers_.end(), trig);
-            if(itr != triggers_.end()){
-                triggers_.erase(itr);
+        void scheduleTick_() {
+            if(!event_.isScheduled()){
+                event_.schedule(1, clock_);
             }
         }
 
         /*!
-         * \brief Handle all deferred removals
+         * \brief Schedule clockTick_ for the next clock edge whose Trigger
+         * phase has not yet run, if it is not already scheduled. Between
+         * runs that is the current tick when it is an edge. During a run
+         * the Trigger phase (the first) of the current tick has passed
          */
-        void handleDeferredRemovals_() {
-            for(auto tr : to_remove_){
-                removeTriggerNow_(tr);
+        void scheduleWake_() {
+            if(event_.isScheduled()){
+                return;
+            }
+            const Scheduler* sched = clock_->getScheduler();
+            const Scheduler::Tick period = clock_->getPeriod();
+            const Scheduler::Tick offset = sched->getCurrentTick() % period;
+            if(offset == 0 && !sched->isRunning()){
+                event_.scheduleRelativeTick(0, clock_->getScheduler());
+            }else{
+                event_.scheduleRelativeTick(period - offset, clock_->getScheduler());
             }
-
-            to_remove_.clear();
         }
 
         /*!
-         * \brief Handle all deferred additions
+         * \brief Drop the nulls left in polled_ by removals
          */
-        void handleDeferredAdditions_() {
-            for(auto tr : to_add_){
-                addTriggerNow_(tr);
+        void compact_() {
+            if(num_removed_ == 0){
+                return;
             }
-
-            to_add_.clear();
+            polled_.erase(std::remove(polled_.begin(), polled_.end(), nullptr), polled_.end());
+            for(uint32_t i = 0; i < polled_.size(); ++i){
+                polled_index_[polled_[i]] = i;
+            }
+            num_removed_ = 0;
         }
 
         /*!
          * \brief Tick event from scheduler. Indicates a clock edge
          */
         void clockTick_() {
-            // Toggle in_tick_ and handle deferred removals & additions at end
-            // of this function
+            // Toggle in_tick_ and compact removals at end of this function
             TickLock tl(*this);
 
-            for(auto trig : triggers_){
-                trig->check();
+            // Triggers added during this tick are checked on the next one
+            const uint32_t num_polled = polled_.size();
+            for(uint32_t i = 0; i < num_polled; ++i){
+                if(ManagedTrigger* trig = polled_[i]){
+                    trig->check();
+                }
+            }
+
+            // Armed triggers that may have been reached.  If one was not
+            // (e.g. its counter was set back down), arm it again
+            std::vector<ManagedTrigger*> woken;
+            woken.swap(woken_);
+            for(auto trig : woken){
+                if(armed_.count(trig) != 0){
+                    trig->check();
+                    if(armed_.count(trig) != 0 && !trig->arm_()){
+                        armed_.erase(trig);
+                        polled_index_[trig] = polled_.size();
+                        polled_.push_back(trig);
+                    }
+                }
             }
 
-            // Schedule for next cycle on this event's clock
-            event_.schedule(1, clock_);
+            // Schedule for next cycle on this event's clock only if there
+            // is something to check
+            if(!polled_index_.empty() || !woken_.empty()){
+                scheduleTick_();
+            }
         }
 
 
@@ -381,25 +426,41 @@ private:
         TriggerEvent event_;
 
         /*!
-         * \brief Triggers beign checked by this ClockHandler
+         * \brief Triggers checked every cycle by this ClockHandler, in the
+         * order they were added. Removed triggers are null until compacted
+         */
+        std::vector<ManagedTrigger*> polled_;
+
+        /*!
+         * \brief Index of each trigger in polled_
+         */
+        std::unordered_map<const ManagedTrigger*, uint32_t> polled_index_;
+
+        /*!
+         * \brief Number of nulls in polled_
          */
-        std::vector<ManagedTrigger*> triggers_;
+        uint32_t num_removed_ = 0;
 
         /*!
-         * \brief Triggers removed from this ClockHandler during its callbacks
+         * \brief Triggers that report when they may have been reached
          */
-        std::vector<const ManagedTrigger*> to_remove_;
+        std::unordered_set<const ManagedTrigger*> armed_;
 
         /*!
-         * \brief Triggers being added to this ClockHandler during its callbacks
+         * \brief Armed triggers to check on the next tick
          */
-        std::vector<ManagedTrigger*> to_add_;
+        std::vector<ManagedTrigger*> woken_;
 
         /*!
          * \brief Currently within a tick handler
          */
         bool in_tick_;
 
+        /*!
+         * \brief Currently arming a trigger being added
+         */
+        bool in_arm_ = false;
+
     }; // class ClockHandler
 
 
@@ -9,22 +9,42 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "sparta/utils/ValidValue.hpp"
+#include "sparta/utils/SpartaSharedPointer.hpp"
 #include "sparta/simulation/Clock.hpp"
 
 namespace sparta
 {
+    /**
+     * \brief Specialize to std::true_type for data that
+     *        DataOutPort::setSharedFanOut may share among DataInPorts
+     *
+     * Ports of any other type keep the data they deliver and receive
+     * as plain copies, without the cost of checking for shared data.
+     */
+    template<class DataT>
+    struct EnableSharedFanOut : std::false_type {};
+
     /**
      * \class DataContainer
      * \brief Used by DataInPort and SyncInPort, this class holds received
      * data from these ports and remembers the time in which the data
      * was set.  It also maintains the validity of the data.
      *
+     * The data is a copy held by this container or, for data with
+     * EnableSharedFanOut fanned out to several DataInPorts at once, a
+     * reference-counted object shared with the other ports.
+     *
      */
     template<class DataT>
     class DataContainer
     {
     public:
+        //! Can the data be shared with other containers?
+        static constexpr bool SHARED_FAN_OUT = EnableSharedFanOut<DataT>::value;
+
         /**
          * \brief Construct the DataContainer with the clock used for
          *        timestamping.
@@ -46,6 +66,9 @@ namespace sparta
          * on \b this cycle.  For that, use dataReceivedThisCycle function.
          */
         bool dataReceived() const {
+            if constexpr (SHARED_FAN_OUT) {
+                return data_.isValid() || (shared_data_ != nullptr);
+            }
             return data_.isValid();
         }
 
@@ -57,7 +80,7 @@ namespace sparta
          * on this port \b this cycle.
          */
         bool dataReceivedThisCycle() const {
-            return (data_.isValid() &&
+            return (dataReceived() &&
                     (data_valid_time_stamp_ == clock_->getScheduler()->getCurrentTick()));
         }
 
@@ -70,9 +93,8 @@ namespace sparta
          * mechanism, meaning the port is cleared
          */
         DataT pullData() {
-            sparta_assert(dataReceived());
-            const DataT & dat = data_.getValue();
-            data_.clearValid();
+            DataT dat = peekData();
+            clearData();
             return dat;
         }
 
@@ -83,12 +105,20 @@ namespace sparta
          */
         const DataT & peekData() const {
             sparta_assert(dataReceived());
+            if constexpr (SHARED_FAN_OUT) {
+                if(SPARTA_EXPECT_FALSE(shared_data_ != nullptr)) {
+                    return *shared_data_;
+                }
+            }
             return data_.getValue();
         }
 
         //! \brief Clear the validity of the data at the port
         void clearData() {
             data_.clearValid();
+            if constexpr (SHARED_FAN_OUT) {
+                shared_data_.reset();
+            }
         }
 
         /**
@@ -106,14 +136,46 @@ namespace sparta
         //! Set the data received
         void setData_(const DataT & dat) {
             data_ = dat;
+            releaseSharedData_();
+            data_valid_time_stamp_ = clock_->getScheduler()->getCurrentTick();
+        }
+
+        //! Set the data received, moving it in
+        void setData_(DataT && dat) {
+            data_ = std::move(dat);
+            releaseSharedData_();
+            data_valid_time_stamp_ = clock_->getScheduler()->getCurrentTick();
+        }
+
+        //! Set the data received to an object shared with other containers
+        void setSharedData_(const SpartaSharedPointer<DataT> & dat) {
+            shared_data_ = dat;
+            data_.clearValid();
             data_valid_time_stamp_ = clock_->getScheduler()->getCurrentTick();
         }
 
     private:
 
+        //! Drop the reference to shared data, if any
+        void releaseSharedData_() {
+            if constexpr (SHARED_FAN_OUT) {
+                if(SPARTA_EXPECT_FALSE(shared_data_ != nullptr)) {
+                    shared_data_.reset();
+                }
+            }
+        }
+
+        //! Stands in for the shared data of containers without
+        //! EnableSharedFanOut
+        struct NoSharedData_ {};
+
         //! The last data delivered on this port
         sparta::utils::ValidValue<DataT> data_;
 
+        //! The last data delivered on this port, if shared with other
+        //! ports. Takes the place of data_ when not null
+        std::conditional_t<SHARED_FAN_OUT, SpartaSharedPointer<DataT>, NoSharedData_> shared_data_;
+
         //! Timestamp when data sent last
         Scheduler::Tick data_valid_time_stamp_ = 0;
 
@@ -0,0 +1,227 @@
+// <GlobPattern.hpp> -*- C++ -*-
+
+
+/**
+ * \file GlobPattern.hpp
+ * \brief Compiled single-location TreeNode search patterns
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sparta
+{
+namespace utils
+{
+    /*!
+     * \brief A TreeNode search pattern for a single location (e.g.
+     * "core*", no '.' characters), compiled once so that it can be
+     * matched against many names without building a std::regex.
+     *
+     * '*' matches any string, '+' any non-empty string and '?' zero or
+     * one character. Every other character matches itself. Each wildcard
+     * captures the text it matched. Wildcards are greedy and backtrack in
+     * the same order as the regular expression built by
+     * TreeNode::createSearchRegexPattern, so matches and captures are
+     * identical for valid TreeNode names. Unlike that regex, characters
+     * such as '|', '{', '^' or '\\' are never regex metacharacters.
+     *
+     * Patterns are normally obtained through get(), which keeps a
+     * process-wide cache of compiled patterns.
+     */
+    class GlobPattern
+    {
+    public:
+
+        //! Maximum number of patterns held by the cache used by get()
+        static constexpr size_t MAX_CACHED_PATTERNS = 4096;
+
+        /*!
+         * \brief Compile a pattern
+         * \param pattern Single-location pattern (no '.' characters)
+         */
+        explicit GlobPattern(const std::string& pattern) :
+            pattern_(pattern)
+        {
+            for(const char c : pattern){
+                Element::Type type = Element::LITERAL;
+                switch(c){
+                case '*': type = Element::ANY;         break;
+                case '+': type = Element::ONE_OR_MORE; break;
+                case '?': type = Element::ZERO_OR_ONE; break;
+                default:
+                    if(elements_.empty() || elements_.back().type != Element::LITERAL){
+                        elements_.push_back({Element::LITERAL, 0, 0, ""});
+                    }
+                    elements_.back().literal += c;
+                    continue;
+                }
+                elements_.push_back({type, num_captures_++, 0, ""});
+            }
+
+            // Shortest suffix of the name that each element onward can match
+            uint32_t min_remaining = 0;
+            for(auto e = elements_.rbegin(); e != elements_.rend(); ++e){
+                min_remaining += minLength_(*e);
+                e->min_remaining = min_remaining;
+            }
+        }
+
+        /*!
+         * \brief Get the compiled form of a pattern from the process-wide
+         * cache, compiling it if needed
+         * \note Thread-safe. The returned pattern remains valid for as long
+         * as it is held, even if the cache is later trimmed
+         */
+        static std::shared_ptr<const GlobPattern> get(const std::string& pattern)
+        {
+            static std::mutex mutex;
+            static std::unordered_map<std::string, std::shared_ptr<const GlobPattern>> cache;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto itr = cache.find(pattern);
+            if(itr != cache.end()){
+                return itr->second;
+            }
+            if(cache.size() >= MAX_CACHED_PATTERNS){
+                cache.clear();
+            }
+            return cache.emplace(pattern, std::make_shared<const GlobPattern>(pattern)).first->second;
+        }
+
+        //! The pattern this was compiled from
+        const std::string& getPattern() const {
+            return pattern_;
+        }
+
+        //! Does this pattern contain no wildcards (i.e. only match itself)?
+        bool isLiteral() const {
+            return num_captures_ == 0;
+        }
+
+        //! Number of wildcards, which is the number of captures of a match
+        uint32_t getNumCaptures() const {
+            return num_captures_;
+        }
+
+        /*!
+         * \brief Does the whole of \a name match this pattern?
+         */
+        bool matches(const std::string& name) const
+        {
+            if(isLiteral()){
+                return name == pattern_;
+            }
+            std::vector<Capture> caps(num_captures_);
+            return match_(name.data(), name.size(), 0, 0, caps.data());
+        }
+
+        /*!
+         * \brief Does the whole of \a name match this pattern?
+         * \param captures On a match, the text matched by each wildcard is
+         * appended to this vector in pattern order. Unchanged otherwise
+         */
+        bool matches(const std::string& name, std::vector<std::string>& captures) const
+        {
+            if(isLiteral()){
+                return name == pattern_;
+            }
+            std::vector<Capture> caps(num_captures_);
+            if(!match_(name.data(), name.size(), 0, 0, caps.data())){
+                return false;
+            }
+            for(const Capture& cap : caps){
+                captures.emplace_back(name, cap.pos, cap.len);
+            }
+            return true;
+        }
+
+    private:
+
+        //! A run of literal characters or a single wildcard
+        struct Element
+        {
+            enum Type : uint8_t { LITERAL, ANY, ONE_OR_MORE, ZERO_OR_ONE };
+
+            Type type;
+            uint32_t capture_idx;   //!< Index of this wildcard's capture
+            uint32_t min_remaining; //!< Fewest characters matched by this and later elements
+            std::string literal;    //!< Characters of a LITERAL element
+        };
+
+        //! Position and length of the text matched by a wildcard
+        struct Capture
+        {
+            size_t pos = 0;
+            size_t len = 0;
+        };
+
+        static uint32_t minLength_(const Element& e) {
+            switch(e.type){
+            case Element::LITERAL:     return e.literal.size();
+            case Element::ONE_OR_MORE: return 1;
+            default:                   return 0;
+            }
+        }
+
+        /*!
+         * \brief Match elements idx onward against name[pos, len), trying
+         * the longest match for each wildcard first
+         */
+        bool match_(const char* name, size_t len, size_t pos, uint32_t idx, Capture* caps) const
+        {
+            if(idx == elements_.size()){
+                return pos == len;
+            }
+            const Element& e = elements_[idx];
+            const size_t remaining = len - pos;
+            if(remaining < e.min_remaining){
+                return false;
+            }
+
+            if(e.type == Element::LITERAL){
+                if(std::memcmp(name + pos, e.literal.data(), e.literal.size()) != 0){
+                    return false;
+                }
+                return match_(name, len, pos + e.literal.size(), idx + 1, caps);
+            }
+
+            const Element* next = (idx + 1 < elements_.size()) ? &elements_[idx + 1] : nullptr;
+            size_t take = remaining - (next ? next->min_remaining : 0);
+            if(e.type == Element::ZERO_OR_ONE && take > 1){
+                take = 1;
+            }
+            const size_t min_take = (e.type == Element::ONE_OR_MORE) ? 1 : 0;
+            if(next == nullptr && take != remaining){
+                return false; // '?' followed by more than one character
+            }
+
+            Capture& cap = caps[e.capture_idx];
+            for(size_t n = take + 1; n-- > min_take; ){
+                // Skip positions where the following literal cannot start
+                if(next && next->type == Element::LITERAL && name[pos + n] != next->literal[0]){
+                    continue;
+                }
+                cap.pos = pos;
+                cap.len = n;
+                if(match_(name, len, pos + n, idx + 1, caps)){
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string pattern_;
+        std::vector<Element> elements_;
+        uint32_t num_captures_ = 0;
+    };
+
+} // namespace utils
+} // namespace sparta
@@ -0,0 +1,182 @@
+// <SPSCQueue> -*- C++ -*-
+
+
+/**
+ * \file   SPSCQueue.hpp
+ *
+ * \brief  File that defines an unbounded single-producer/single-consumer queue
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta{
+namespace utils{
+
+/**
+ * \class SPSCQueue
+ * \brief An unbounded, lock-free queue with exactly one producer
+ *        thread and exactly one consumer thread
+ * \tparam T The type held in the queue
+ * \tparam BlockSize The number of elements allocated at a time
+ *
+ * Elements are stored in fixed-size blocks chained in a singly
+ * linked list.  The producer appends to the tail block and only
+ * allocates when the tail block is full; the consumer frees a block
+ * once it has popped every element from it.  Neither side takes a
+ * lock, and the producer and consumer never touch the same element
+ * concurrently.
+ *
+ * push() must only be called from the producer thread, and front()
+ * and pop() from the consumer thread.  empty() and size() can be
+ * called from either thread, but are only exact when the other side
+ * is quiescent.
+ *
+ * \code
+ * sparta::utils::SPSCQueue<uint32_t> q;
+ * q.push(1);                          // producer
+ * while(uint32_t * val = q.front()) { // consumer
+ *     ...
+ *     q.pop();
+ * }
+ * \endcode
+ */
+template<typename T, uint32_t BlockSize = 256>
+class SPSCQueue
+{
+    static_assert(BlockSize > 0, "SPSCQueue block size must be non-zero");
+
+    struct Block
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type items[BlockSize];
+
+        //! Number of items the producer has published in this block
+        std::atomic<uint32_t> committed{0};
+
+        //! The next block, set by the producer once this one is full
+        std::atomic<Block*> next{nullptr};
+
+        T * item(uint32_t idx) {
+            return reinterpret_cast<T*>(&items[idx]);
+        }
+    };
+
+public:
+    //! Convenient typedef for the value type
+    typedef T value_type;
+
+    SPSCQueue() :
+        head_block_(new Block),
+        tail_block_(head_block_)
+    {}
+
+    //! No copies; the producer and consumer hold on to this queue
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue & operator=(const SPSCQueue &) = delete;
+
+    ~SPSCQueue()
+    {
+        uint32_t idx = head_idx_;
+        while(head_block_ != nullptr) {
+            const uint32_t committed = head_block_->committed.load(std::memory_order_acquire);
+            for(; idx < committed; ++idx) {
+                head_block_->item(idx)->~T();
+            }
+            Block * next = head_block_->next.load(std::memory_order_acquire);
+            delete head_block_;
+            head_block_ = next;
+            idx = 0;
+        }
+    }
+
+    /**
+     * \brief Append an element to the queue (producer only)
+     * \param val The element to append
+     */
+    template<typename U>
+    void push(U && val)
+    {
+        if(SPARTA_EXPECT_FALSE(tail_idx_ == BlockSize)) {
+            Block * blk = new Block;
+            tail_block_->next.store(blk, std::memory_order_release);
+            tail_block_ = blk;
+            tail_idx_ = 0;
+        }
+        new (tail_block_->item(tail_idx_)) T(std::forward<U>(val));
+        ++tail_idx_;
+        tail_block_->committed.store(tail_idx_, std::memory_order_release);
+        num_pushed_.store(num_pushed_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+    }
+
+    /**
+     * \brief Get the oldest element in the queue (consumer only)
+     * \return Pointer to the oldest element, or nullptr if empty
+     */
+    T * front()
+    {
+        if(head_idx_ == head_block_->committed.load(std::memory_order_acquire))
+        {
+            if(head_idx_ < BlockSize) {
+                return nullptr;
+            }
+            Block * next = head_block_->next.load(std::memory_order_acquire);
+            if(next == nullptr) {
+                return nullptr;
+            }
+            delete head_block_;
+            head_block_ = next;
+            head_idx_ = 0;
+            if(head_block_->committed.load(std::memory_order_acquire) == 0) {
+                return nullptr;
+            }
+        }
+        return head_block_->item(head_idx_);
+    }
+
+    /**
+     * \brief Remove the oldest element from the queue (consumer only)
+     * \pre The queue is not empty
+     */
+    void pop()
+    {
+        T * item = front();
+        sparta_assert(item != nullptr, "pop() called on an empty SPSCQueue");
+        item->~T();
+        ++head_idx_;
+        num_popped_.store(num_popped_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+    }
+
+    //! Number of elements in the queue
+    uint64_t size() const {
+        const uint64_t popped = num_popped_.load(std::memory_order_acquire);
+        return num_pushed_.load(std::memory_order_acquire) - popped;
+    }
+
+    //! Is the queue empty?
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    //! Consumer side
+    Block * head_block_ = nullptr;
+    uint32_t head_idx_ = 0;
+    alignas(64) std::atomic<uint64_t> num_popped_{0};
+
+    //! Producer side, kept off the consumer's cache line
+    alignas(64) Block * tail_block_ = nullptr;
+    uint32_t tail_idx_ = 0;
+    std::atomic<uint64_t> num_pushed_{0};
+};
+
+} // namespace utils
+} // namespace sparta
@@ -0,0 +1,61 @@
+// <SpartaPerfTester.hpp> -*- C++ -*-
+
+#pragma once
+
+/**
+ * \file   SpartaPerfTester.hpp
+ *
+ * \brief Helpers shared by the performance tests
+ *
+ * Performance tests always run their correctness checks, on problems
+ * small enough for a regression run.  Their timing loops, on the full
+ * size problems, only run when SPARTA_PERF_TESTS is set to a non-zero
+ * value in the environment:
+ *
+ * \code
+ * SPARTA_PERF_TESTS=1 ctest -R Perf
+ * \endcode
+ *
+ * Example usage:
+ * \code
+ * const uint32_t num_accesses = sparta::perf::problemSize(4000000, 10000);
+ * const auto start = std::chrono::steady_clock::now();
+ * ...
+ * if(sparta::perf::isTimingEnabled()) {
+ *     std::cout << sparta::perf::secondsSince(start) << " s" << std::endl;
+ * }
+ * \endcode
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace sparta
+{
+namespace perf
+{
+    //! Are the timing loops of performance tests to be run?
+    inline bool isTimingEnabled()
+    {
+        static const bool enabled = []() {
+            const char * env = std::getenv("SPARTA_PERF_TESTS");
+            return (env != nullptr) && (env[0] != '\0') && (std::strcmp(env, "0") != 0);
+        }();
+        return enabled;
+    }
+
+    //! The size of a test problem: timing_size when timing, else check_size
+    template<typename SizeT>
+    SizeT problemSize(SizeT timing_size, SizeT check_size)
+    {
+        return isTimingEnabled() ? timing_size : check_size;
+    }
+
+    //! Wall time in seconds since start
+    inline double secondsSince(const std::chrono::steady_clock::time_point & start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace perf
+} // namespace sparta
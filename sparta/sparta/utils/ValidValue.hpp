@@ -73,7 +73,7 @@ namespace utils
          * \param val The value to assign, becomes immediately valid
          * \return The value after assignment
          */
-        value_type operator=(const value_type & val) {
+        value_type & operator=(const value_type & val) {
             valid_ = true;
             return (value_ = val);
         }
@@ -83,7 +83,7 @@ namespace utils
          * \param val The value to assign, becomes immediately valid
          * \return The value after assignment
          */
-        value_type operator=(value_type && val) {
+        value_type & operator=(value_type && val) {
             valid_ = true;
             return (value_ = std::move(val));
         }
@@ -9,6 +9,7 @@
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <utility>
 
 #include "sparta/pipeViewer/Outputter.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
@@ -18,14 +19,16 @@
 // #define PIPELINE_DBG 1
 namespace sparta::pipeViewer
 {
-    Outputter::Outputter(const std::string& filepath, const uint64_t interval) :
+    Outputter::Outputter(const std::string& filepath, const uint64_t interval,
+                         const bool async_io, const std::size_t buffer_size) :
         record_file_(filepath + "record.bin", std::fstream::out | std::fstream::binary),
         index_file_(filepath + "index.bin", std::fstream::out | std::fstream::binary),
         map_file_(filepath + "map.dat", std::ios::out),
         data_file_(filepath + "data.dat", std::ios::out),
         string_file_(filepath + "string_map.dat", std::ios::out),
         display_format_file_(filepath + "display_format.dat", std::ios::out),
-        last_record_pos_(0)
+        last_record_pos_(0),
+        buffer_size_(buffer_size)
     {
         // Make sure the files opened correctly!
         sparta_assert(index_file_.is_open() && record_file_.is_open(),
@@ -49,8 +52,31 @@ namespace sparta::pipeViewer
         // Notice that we write the interval offset first.
         writeData_(index_file_, interval);
         index_file_.flush();
+
+        // Leave room for the record that crosses the buffer size
+        buffer_.reserve(buffer_size_ + sizeof(transaction_t) * 4);
+        if(async_io) {
+            io_thread_ = std::thread(&Outputter::ioThreadLoop_, this);
+        }
     }
     Outputter::~Outputter(){
+        try {
+            flush();
+        }
+        catch(const std::exception& ex) {
+            std::cerr << "Failed to write pipeline collection records: " << ex.what() << std::endl;
+            // Already reported; do not throw again from close()
+            record_file_.exceptions(std::ostream::goodbit);
+        }
+        if(io_thread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(io_mutex_);
+                io_stop_ = true;
+            }
+            io_cond_.notify_all();
+            io_thread_.join();
+        }
+
         //Write an index for the end of the record file, so that the last record
         //is always easily accessable reguardless of indexing.
         writeData_(index_file_, last_record_pos_);
@@ -66,8 +92,109 @@ namespace sparta::pipeViewer
         std::cout << "The outputter is done destructing." << std::endl;
     }
     void Outputter::writeIndex(){
-        const uint64_t current_record_pos = record_file_.tellp();
+        flush();
+        // Everything handed off has been written now
+        const uint64_t current_record_pos = flushed_bytes_;
         writeData_(index_file_, current_record_pos);
         index_file_.flush();
     }
+
+    void Outputter::flush(){
+        flushBuffer_();
+        if(io_thread_.joinable()) {
+            std::unique_lock<std::mutex> lock(io_mutex_);
+            io_cond_.wait(lock, [this]() { return (pending_buffers_.empty() && !io_busy_) || io_error_; });
+        }
+        checkIOError_();
+        sparta_assert(flushed_bytes_ == handed_off_bytes_);
+        record_file_.flush();
+        index_file_.flush();
+    }
+
+    void Outputter::flushBuffer_(){
+        if(buffer_.empty()) {
+            return;
+        }
+        if(!io_thread_.joinable()) {
+            // On failure the buffer is kept, and nothing is counted as
+            // written
+            writeBuffer_(buffer_);
+            handed_off_bytes_ += buffer_.size();
+            flushed_bytes_ += buffer_.size();
+            buffer_.clear();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(io_mutex_);
+        io_cond_.wait(lock, [this]() { return pending_buffers_.size() < MAX_PENDING_BUFFERS || io_error_; });
+        if(io_error_) {
+            lock.unlock();
+            checkIOError_();
+        }
+        handed_off_bytes_ += buffer_.size();
+        pending_buffers_.emplace_back(std::move(buffer_));
+        if(free_buffers_.empty()) {
+            buffer_ = std::vector<char>();
+            buffer_.reserve(buffer_size_ + sizeof(transaction_t) * 4);
+        }
+        else {
+            buffer_ = std::move(free_buffers_.back());
+            free_buffers_.pop_back();
+        }
+        lock.unlock();
+        io_cond_.notify_all();
+    }
+
+    void Outputter::writeBuffer_(const std::vector<char>& buf){
+        writeData_(record_file_, buf.data(), buf.size());
+    }
+
+    void Outputter::ioThreadLoop_(){
+        std::unique_lock<std::mutex> lock(io_mutex_);
+        while(true) {
+            io_cond_.wait(lock, [this]() { return !pending_buffers_.empty() || io_stop_; });
+            if(pending_buffers_.empty()) {
+                return; // Stopped, and everything is written
+            }
+            std::vector<char> buf = std::move(pending_buffers_.front());
+            pending_buffers_.pop_front();
+            io_busy_ = true;
+            lock.unlock();
+
+            std::exception_ptr error;
+            try {
+                writeBuffer_(buf);
+            }
+            catch(...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            io_busy_ = false;
+            if(error) {
+                if(!io_error_) {
+                    io_error_ = error;
+                }
+            }
+            else {
+                flushed_bytes_ += buf.size();
+            }
+            buf.clear();
+            free_buffers_.emplace_back(std::move(buf));
+            io_cond_.notify_all();
+        }
+    }
+
+    void Outputter::checkIOError_(){
+        // The error is kept: records after the failed buffer are never
+        // written, so every later flush fails too
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(io_mutex_);
+            error = io_error_;
+        }
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
 }//namespace sparta::pipeViewer
@@ -0,0 +1,175 @@
+// <AsyncWriter> -*- C++ -*-
+
+/**
+ * \file AsyncWriter.cpp
+ * \brief Writes blocks of formatted log messages from a background thread
+ */
+
+#include "sparta/log/AsyncWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace sparta
+{
+    namespace log
+    {
+        namespace
+        {
+            //! Room left in a block for the message which crosses its size
+            constexpr std::size_t BLOCK_SLACK = 64 * 1024;
+        }
+
+        AsyncWriter::AsyncWriter(std::ostream& out, std::size_t block_size) :
+            out_(out),
+            block_size_(block_size),
+            stream_(&block_)
+        {
+            std::vector<char> none;
+            block_.swap(none, block_size_ + BLOCK_SLACK);
+            io_thread_ = std::thread(&AsyncWriter::ioThreadLoop_, this);
+        }
+
+        AsyncWriter::~AsyncWriter()
+        {
+            try{
+                flush();
+            }catch(const std::exception& ex){
+                std::cerr << "Failed to write log messages: " << ex.what() << std::endl;
+            }
+            {
+                std::lock_guard<std::mutex> lock(io_mutex_);
+                io_stop_ = true;
+            }
+            io_cond_.notify_all();
+            io_thread_.join();
+        }
+
+        void AsyncWriter::flush()
+        {
+            writeBlock_();
+            {
+                std::unique_lock<std::mutex> lock(io_mutex_);
+                io_cond_.wait(lock, [this]() { return (pending_blocks_.empty() && !io_busy_) || io_error_; });
+            }
+            checkIOError_();
+            out_.flush();
+            if(out_.fail()){
+                throw SpartaException("Failed to flush log messages to their output stream");
+            }
+        }
+
+        void AsyncWriter::writeBlock_()
+        {
+            if(block_.size() == 0){
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(io_mutex_);
+            io_cond_.wait(lock, [this]() { return pending_blocks_.size() < MAX_PENDING_BLOCKS || io_error_; });
+            if(io_error_){
+                lock.unlock();
+                checkIOError_();
+            }
+            std::vector<char> full;
+            if(!free_blocks_.empty()){
+                full = std::move(free_blocks_.back());
+                free_blocks_.pop_back();
+            }
+            block_.swap(full, block_size_ + BLOCK_SLACK);
+            pending_blocks_.emplace_back(std::move(full));
+            lock.unlock();
+            io_cond_.notify_all();
+        }
+
+        void AsyncWriter::ioThreadLoop_()
+        {
+            std::unique_lock<std::mutex> lock(io_mutex_);
+            while(true){
+                io_cond_.wait(lock, [this]() { return !pending_blocks_.empty() || io_stop_; });
+                if(pending_blocks_.empty()){
+                    return; // Stopped, and everything is written
+                }
+                std::vector<char> block = std::move(pending_blocks_.front());
+                pending_blocks_.pop_front();
+                io_busy_ = true;
+                lock.unlock();
+
+                std::exception_ptr error;
+                try{
+                    out_.write(block.data(), block.size());
+                    if(out_.fail()){
+                        throw SpartaException("Failed to write ")
+                            << block.size() << " bytes of log messages to their output stream";
+                    }
+                }catch(...){
+                    error = std::current_exception();
+                }
+
+                lock.lock();
+                io_busy_ = false;
+                if(error && !io_error_){
+                    io_error_ = error;
+                }
+                free_blocks_.emplace_back(std::move(block));
+                io_cond_.notify_all();
+            }
+        }
+
+        void AsyncWriter::checkIOError_()
+        {
+            std::exception_ptr error;
+            {
+                std::lock_guard<std::mutex> lock(io_mutex_);
+                std::swap(error, io_error_);
+            }
+            if(error){
+                std::rethrow_exception(error);
+            }
+        }
+
+        void AsyncWriter::BlockBuffer::swap(std::vector<char>& next, std::size_t capacity)
+        {
+            block_.resize(size());
+            block_.swap(next);
+            if(block_.size() < capacity){
+                block_.resize(capacity);
+            }
+            setp(block_.data(), block_.data() + block_.size());
+        }
+
+        AsyncWriter::BlockBuffer::int_type AsyncWriter::BlockBuffer::overflow(int_type c)
+        {
+            if(traits_type::eq_int_type(c, traits_type::eof())){
+                return traits_type::not_eof(c);
+            }
+            grow_(1);
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+            return c;
+        }
+
+        std::streamsize AsyncWriter::BlockBuffer::xsputn(const char* s, std::streamsize n)
+        {
+            if(epptr() - pptr() < n){
+                grow_(n);
+            }
+            std::memcpy(pptr(), s, n);
+            pbump(n);
+            return n;
+        }
+
+        void AsyncWriter::BlockBuffer::grow_(std::size_t n)
+        {
+            const std::size_t used = size();
+            block_.resize(std::max(block_.size() * 2, used + n));
+            setp(block_.data(), block_.data() + block_.size());
+            pbump(used);
+        }
+
+    } // namespace log
+} // namespace sparta
@@ -0,0 +1,403 @@
+// <BinaryPevents> -*- C++ -*-
+
+
+/**
+ * \file BinaryPevents.cpp
+ * \brief Writing and converting binary pevent files
+ */
+
+#include "sparta/pevents/BinaryPevents.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "sparta/app/SimulationInfo.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace sparta{
+namespace pevents{
+
+    using namespace binary_format;
+
+    std::vector<std::unique_ptr<BinaryPeventWriter>> BinaryPeventWriter::writers_;
+
+    bool BinaryPeventWriter::isBinaryFile(const std::string& filename)
+    {
+        const std::string ext = FILE_EXTENSION;
+        return filename.size() > ext.size() &&
+            filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+    }
+
+    BinaryPeventWriter* BinaryPeventWriter::getWriter(const std::string& filename)
+    {
+        for(auto& w : writers_){
+            if(w->getFilename() == filename){
+                return w.get();
+            }
+        }
+        writers_.emplace_back(new BinaryPeventWriter(filename));
+        return writers_.back().get();
+    }
+
+    void BinaryPeventWriter::flushWriters()
+    {
+        for(auto& w : writers_){
+            w->flush();
+        }
+    }
+
+    BinaryPeventWriter::BinaryPeventWriter(const std::string& filename) :
+        filename_(filename),
+        stream_(filename, std::ofstream::out | std::ofstream::binary)
+    {
+        if(stream_.good() == false){
+            throw SpartaException("Failed to open binary pevent file \"")
+                << filename << "\"";
+        }
+
+        // Throw on write errors
+        stream_.exceptions(std::ostream::badbit | std::ostream::failbit);
+
+        std::stringstream header;
+        SimulationInfo::getInstance().write(header, "#", "\n");
+
+        record_.insert(record_.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        append_(VERSION);
+        append_(ENDIAN_CHECK);
+        appendString_(header.str());
+        stream_.write(record_.data(), record_.size());
+        record_.clear();
+
+        writer_.reset(new log::AsyncWriter(stream_));
+    }
+
+    uint32_t BinaryPeventWriter::addSchema(const std::string& event_name,
+                                           const std::string& location,
+                                           const std::string& category,
+                                           const std::vector<std::string>& names,
+                                           const PairFormatterVector& formats)
+    {
+        sparta_assert(names.size() == formats.size(),
+                      "Every pair of pevent " << event_name << " needs a formatter");
+
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        const uint32_t schema = num_fields_.size();
+        num_fields_.push_back(names.size());
+
+        append_(ChunkType::SCHEMA);
+        append_(schema);
+        appendString_(event_name);
+        appendString_(location);
+        appendString_(category);
+        append_(static_cast<uint32_t>(names.size()));
+        for(uint32_t i = 0; i < names.size(); ++i){
+            appendString_(names[i]);
+            append_(static_cast<PairFormatterInt>(formats[i]));
+        }
+        writeRecord_();
+        return schema;
+    }
+
+    void BinaryPeventWriter::writeEvent(uint32_t schema, uint64_t tick, uint64_t cycle, uint64_t cyc,
+                                        const PairCache& pairs)
+    {
+        const std::vector<std::string>& strings = pairs.getStringVector();
+        const std::vector<PairCache::ValidPair>& data = pairs.getDataVector();
+        const std::vector<bool>& pevent_numeric = pairs.getPEventNumericVector();
+
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        sparta_assert(schema < num_fields_.size());
+        sparta_assert(strings.size() == num_fields_[schema],
+                      "Pevent record does not match its schema in " << filename_);
+
+        append_(ChunkType::RECORD);
+        append_(schema);
+        append_(tick);
+        append_(cycle);
+        append_(cyc);
+        for(uint32_t i = 0; i < strings.size(); ++i){
+            // Same precedence as PairCache::getPEventLogVector
+            if(!strings[i].empty()){
+                const uint32_t id = internString_(strings[i]);
+                if(id < MAX_INTERNED_STRINGS){
+                    append_(FieldKind::STRING);
+                    append_(static_cast<uint64_t>(id));
+                }else{
+                    append_(FieldKind::INLINE_STRING);
+                    append_(static_cast<uint64_t>(strings[i].size()));
+                    record_.insert(record_.end(), strings[i].begin(), strings[i].end());
+                }
+            }else if(data[i].second){
+                append_(pevent_numeric[i] ? FieldKind::PEVENT_NUMERIC : FieldKind::NUMERIC);
+                append_(data[i].first);
+            }else{
+                append_(FieldKind::ABSENT);
+                append_(uint64_t(0));
+            }
+        }
+        writeRecord_();
+        ++num_events_;
+    }
+
+    void BinaryPeventWriter::flush()
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        writer_->flush();
+    }
+
+    uint32_t BinaryPeventWriter::internString_(const std::string& str)
+    {
+        auto itr = strings_.find(str);
+        if(itr != strings_.end()){
+            return itr->second;
+        }
+        if(strings_.size() == MAX_INTERNED_STRINGS){
+            return MAX_INTERNED_STRINGS;
+        }
+
+        // Written straight to the stream, ahead of the record being built
+        const uint32_t id = strings_.size();
+        strings_.emplace(str, id);
+        const ChunkType type = ChunkType::STRING;
+        const uint32_t size = str.size();
+        std::ostream& out = writer_->getStream();
+        out.write(reinterpret_cast<const char*>(&type), sizeof(type));
+        out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(str.data(), size);
+        return id;
+    }
+
+    void BinaryPeventWriter::appendString_(const std::string& str)
+    {
+        append_(static_cast<uint32_t>(str.size()));
+        record_.insert(record_.end(), str.begin(), str.end());
+    }
+
+    void BinaryPeventWriter::writeRecord_()
+    {
+        writer_->getStream().write(record_.data(), record_.size());
+        writer_->endMessage();
+        record_.clear();
+    }
+
+    BinaryPeventReader::TextFormat BinaryPeventReader::getTextFormat(const std::string& filename)
+    {
+        auto ends_with = [&filename](const std::string& ext) {
+            return filename.size() >= ext.size() &&
+                filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+        };
+        if(ends_with(".log.basic")){
+            return TextFormat::BASIC;
+        }
+        if(ends_with(".log.raw")){
+            return TextFormat::RAW;
+        }
+        if(ends_with(".log.verbose")){
+            throw SpartaException("Cannot convert binary pevents to \"") << filename
+                << "\": the verbose log format is not supported";
+        }
+        return TextFormat::DEFAULT;
+    }
+
+    void BinaryPeventReader::convert(const std::string& bin_filename, const std::string& text_filename)
+    {
+        const TextFormat format = getTextFormat(text_filename);
+        std::ifstream in(bin_filename, std::ifstream::in | std::ifstream::binary);
+        if(in.good() == false){
+            throw SpartaException("Failed to open binary pevent file \"")
+                << bin_filename << "\"";
+        }
+        std::ofstream out(text_filename);
+        if(out.good() == false){
+            throw SpartaException("Failed to open pevent file \"")
+                << text_filename << "\" for writing";
+        }
+        out.exceptions(std::ostream::badbit | std::ostream::failbit);
+
+        BinaryPeventReader reader(in);
+        reader.convert(out, format);
+    }
+
+    BinaryPeventReader::BinaryPeventReader(std::istream& in) :
+        in_(in)
+    {
+        char magic[sizeof(MAGIC)];
+        if(!read_(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0){
+            throw SpartaException("Not a binary pevent file");
+        }
+        const uint32_t version = read_<uint32_t>();
+        if(version != VERSION){
+            throw SpartaException("Unsupported binary pevent file version ") << version
+                << ". Expected " << VERSION;
+        }
+        if(read_<uint32_t>() != ENDIAN_CHECK){
+            throw SpartaException("Binary pevent file was written on a host with a different byte order");
+        }
+        header_ = readString_();
+    }
+
+    uint64_t BinaryPeventReader::convert(std::ostream& out, TextFormat format)
+    {
+        out << header_;
+
+        uint64_t num_events = 0;
+        ChunkType type;
+        while(read_(&type, sizeof(type))){
+            switch(type){
+                case ChunkType::SCHEMA : {
+                    const uint32_t id = read_<uint32_t>();
+                    if(id != schemas_.size()){
+                        throw SpartaException("Binary pevent file has schema ") << id
+                            << " out of order";
+                    }
+                    Schema schema;
+                    schema.event_name = readString_();
+                    schema.location = readString_();
+                    schema.category = readString_();
+                    const uint32_t num_fields = read_<uint32_t>();
+                    for(uint32_t i = 0; i < num_fields; ++i){
+                        schema.names.emplace_back(readString_());
+                        schema.formats.emplace_back(static_cast<PairFormatter>(read_<PairFormatterInt>()));
+                    }
+                    schemas_.emplace_back(std::move(schema));
+                    break;
+                }
+                case ChunkType::STRING : {
+                    const uint32_t id = read_<uint32_t>();
+                    if(id != strings_.size()){
+                        throw SpartaException("Binary pevent file has string ") << id
+                            << " out of order";
+                    }
+                    strings_.emplace_back(readString_());
+                    break;
+                }
+                case ChunkType::RECORD :
+                    writeRecord_(out, format);
+                    ++num_events;
+                    break;
+                default:
+                    throw SpartaException("Binary pevent file has an unknown chunk type ")
+                        << static_cast<uint32_t>(type);
+            }
+        }
+        out.flush();
+        return num_events;
+    }
+
+    void BinaryPeventReader::writeRecord_(std::ostream& out, TextFormat format)
+    {
+        const uint32_t id = read_<uint32_t>();
+        if(id >= schemas_.size()){
+            throw SpartaException("Binary pevent record refers to unknown schema ") << id;
+        }
+        const Schema& schema = schemas_[id];
+        const uint64_t tick = read_<uint64_t>();
+        const uint64_t cycle = read_<uint64_t>();
+        const uint64_t cyc = read_<uint64_t>();
+
+        // Same text as PeventCollector::generateCollectionString_
+        char num[32];
+        content_ = "ev=\"";
+        content_ += schema.event_name;
+        content_ += "\" ";
+        for(uint32_t i = 0; i < schema.names.size(); ++i){
+            const FieldKind kind = read_<FieldKind>();
+            const uint64_t val = read_<uint64_t>();
+            switch(kind){
+                case FieldKind::ABSENT :
+                    continue;
+                case FieldKind::STRING :
+                    if(val >= strings_.size()){
+                        throw SpartaException("Binary pevent record refers to unknown string ") << val;
+                    }
+                    content_ += schema.names[i];
+                    content_ += "=\"";
+                    content_ += strings_[val];
+                    break;
+                case FieldKind::INLINE_STRING : {
+                    content_ += schema.names[i];
+                    content_ += "=\"";
+                    const std::size_t pos = content_.size();
+                    content_.resize(pos + val);
+                    readExact_(&content_[pos], val);
+                    break;
+                }
+                case FieldKind::NUMERIC :
+                case FieldKind::PEVENT_NUMERIC :
+                    content_ += schema.names[i];
+                    content_ += "=\"";
+                    PairCache::appendValue(content_, val, schema.formats[i],
+                                           kind == FieldKind::PEVENT_NUMERIC);
+                    break;
+                default:
+                    throw SpartaException("Binary pevent record has an unknown field kind ")
+                        << static_cast<uint32_t>(kind);
+            }
+            content_ += "\" ";
+        }
+        std::snprintf(num, sizeof(num), "%" PRIu64, cyc);
+        content_ += "cyc=";
+        content_ += num;
+        content_ += ";";
+
+        // Log formatters drop newlines from message content
+        content_.erase(std::remove(content_.begin(), content_.end(), '\n'), content_.end());
+
+        // Same prefixes as the log formatters (see sparta::log::DefaultFormatter)
+        switch(format){
+            case TextFormat::DEFAULT :
+                std::snprintf(num, sizeof(num), "%010" PRIu64, tick);
+                out << '{' << num << ' ';
+                if(cycle != NO_CYCLE){
+                    std::snprintf(num, sizeof(num), "%08" PRIu64, cycle);
+                    out << num << ' ';
+                }else{
+                    out << "-------- ";
+                }
+                out << schema.location << ' ' << schema.category << "} ";
+                break;
+            case TextFormat::BASIC :
+                out << schema.location << ": " << schema.category << ": ";
+                break;
+            case TextFormat::RAW :
+                break;
+        }
+        out << content_ << '\n';
+    }
+
+    bool BinaryPeventReader::read_(void* dest, std::size_t size)
+    {
+        in_.read(static_cast<char*>(dest), size);
+        const std::size_t count = in_.gcount();
+        if(count == size){
+            return true;
+        }
+        if(count == 0 && in_.eof()){
+            return false;
+        }
+        throw SpartaException("Binary pevent file is truncated");
+    }
+
+    void BinaryPeventReader::readExact_(void* dest, std::size_t size)
+    {
+        if(!read_(dest, size)){
+            throw SpartaException("Binary pevent file is truncated");
+        }
+    }
+
+    std::string BinaryPeventReader::readString_()
+    {
+        const uint32_t size = read_<uint32_t>();
+        std::string str(size, '\0');
+        if(size > 0){
+            readExact_(&str[0], size);
+        }
+        return str;
+    }
+
+} // namespace pevents
+} // namespace sparta
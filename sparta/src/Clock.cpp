@@ -73,5 +73,6 @@ namespace sparta {
         root_ratio_   = parent_ratio_.inv();
         period_       = 1;
         normalized_   = false;
+        invalidateCycleCaches_();
     }
 }
@@ -283,8 +283,11 @@ CommandLineSimulator::CommandLineSimulator(const std::string& usage,
          "Log pevents in category CATEGORY that are passed to the PEventLogger during simulation "
          "to FILENAME.\n"
          "when CATEGORY == ALL, all pevent types will be logged to FILENAME\n"
+         "If FILENAME ends with .bin, pevents are written in a compact binary format which "
+         "pevent_convert turns into text\n"
          "Examples: \n--pevents output.pevents ALL\n"
-         "--pevents log.log complete,retire,decode")
+         "--pevents log.log complete,retire,decode\n"
+         "--pevents retire.bin retire")
         ("verbose-pevents",
          named_value<std::vector<std::string> >("FILENAME CATEGORY", 2, 2)->multitoken(),
          "Log more verbose pevents in category CATEGORY that are passed to the PEventLogger during "
@@ -516,6 +519,11 @@ CommandLineSimulator::CommandLineSimulator(const std::string& usage,
         ("no-warn-stderr",
          "Do not write warnings from the simulator to stderr. Unset by default. This is has no "
          "relationship with --warn-file")
+        ("async-log",
+         "Format log messages into memory and write log files from a background thread in large "
+         "blocks instead of writing and flushing each message. Log files are flushed when the "
+         "simulator encounters an error and at exit. Messages written to stdout and stderr are "
+         "not affected")
         ;
 
     // Reports
@@ -1922,6 +1930,7 @@ bool CommandLineSimulator::parse(int argc,
     use_pyshell_                        = vm_.count("python-shell") > 0;
     sim_config_.show_dag                = vm_.count("show-dag") > 0;
     sim_config_.warn_stderr             = vm_.count("no-warn-stderr") == 0;
+    sim_config_.async_logging           = vm_.count("async-log") > 0;
     sim_config_.verbose_cfg             = vm_.count("verbose-config") > 0;
     sim_config_.verbose_report_triggers = vm_.count("verbose-report-triggers") > 0;
     sim_config_.debug_sim               = vm_.count("debug-sim") > 0;
@@ -1962,6 +1971,7 @@ bool CommandLineSimulator::parse(int argc,
         std::cout << "  warnings file:       \"" << sim_config_.warnings_file << '"' << std::endl;
         std::cout << "  final config out:    \"" << sim_config_.getFinalConfigFile() << '"' << std::endl;
         std::cout << "  no-warn-stderr:      " << std::boolalpha << !sim_config_.warn_stderr << std::endl;
+        std::cout << "  async-log:           " << std::boolalpha << sim_config_.async_logging << std::endl;
         std::cout << "  verbose-params:      " << std::boolalpha << sim_config_.verbose_cfg << std::endl;
         std::cout << "  debug-sim:           " << std::boolalpha << sim_config_.debug_sim << std::endl;
         std::cout << "  report-on-error:     " << std::boolalpha << sim_config_.report_on_error << std::endl;
@@ -18,6 +18,7 @@ namespace sparta {
     namespace log {
 
 DestinationManager::DestinationVector sparta::log::DestinationManager::dests_;
+bool DestinationManager::async_ = false;
 const Formatter::Info FMTLIST[] = {
     /*! Writes source, category, content */
     { ".log.basic",
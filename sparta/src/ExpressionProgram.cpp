@@ -0,0 +1,393 @@
+// <ExpressionProgram> -*- C++ -*-
+
+#include "sparta/statistics/ExpressionProgram.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "sparta/statistics/Expression.hpp"
+#include "sparta/statistics/StatisticInstance.hpp"
+
+namespace sparta {
+    namespace statistics {
+        namespace expression {
+
+uint32_t ExpressionNode::compile(ExpressionProgram& prog) const
+{
+    return prog.emitNode(this);
+}
+
+uint32_t ExpressionProgram::addRoot(const Expression& expr)
+{
+    roots_.push_back({&expr, nullptr});
+    compiled_ = false;
+    return roots_.size() - 1;
+}
+
+uint32_t ExpressionProgram::addRoot(const StatisticInstance& si)
+{
+    roots_.push_back({nullptr, &si});
+    compiled_ = false;
+    return roots_.size() - 1;
+}
+
+const std::vector<double>& ExpressionProgram::evaluate()
+{
+    if(!compiled_ || !refresh_()){
+        compile_();
+    }
+
+    // Same checks as StatisticInstance::getValue of every root and nested
+    // instance, before computing anything
+    for(const Dependency& d : deps_){
+        d.si->checkRange_();
+    }
+
+    double* const slots = slots_.data();
+
+    // Gather every counter, then compute all deltas in one pass over
+    // contiguous values
+    const uint32_t num_counters = counters_.size();
+    const CounterBase* const * counters = counters_.data();
+    for(uint32_t i = 0; i < num_counters; ++i){
+        slots[i] = counters[i]->get();
+    }
+    const double* const initials = initials_.data();
+    for(uint32_t i = 0; i < num_counters; ++i){
+        slots[i] -= initials[i];
+    }
+
+    for(const Instruction& inst : code_){
+        double& dst = slots[inst.dst];
+        switch(inst.op){
+        case OpCode::LOAD_PARAMETER:
+            dst = inst.param->getDoubleValue();
+            break;
+        case OpCode::LOAD_REFERENCE:
+            dst = *inst.ref;
+            break;
+        case OpCode::CALL_GETTER:
+            dst = inst.getter();
+            break;
+        case OpCode::EVALUATE_NODE:
+            dst = inst.node->evaluate();
+            break;
+        case OpCode::ADD:
+            dst = slots[inst.operands[0]] + slots[inst.operands[1]];
+            break;
+        case OpCode::SUB:
+            dst = slots[inst.operands[0]] - slots[inst.operands[1]];
+            break;
+        case OpCode::MUL:
+            dst = slots[inst.operands[0]] * slots[inst.operands[1]];
+            break;
+        case OpCode::DIV:
+            dst = slots[inst.operands[0]] / slots[inst.operands[1]];
+            break;
+        case OpCode::NEGATE:
+            dst = -slots[inst.operands[0]];
+            break;
+        case OpCode::CALL_FUNCTION: {
+            double args[3];
+            for(uint32_t i = 0; i < inst.num_operands; ++i){
+                args[i] = slots[inst.operands[i]];
+            }
+            dst = inst.node->apply(args);
+            break;
+        }
+        case OpCode::CONSTANT:
+        case OpCode::COUNTER_DELTA:
+            sparta_assert(false, "Constants and counters are not instructions");
+        }
+    }
+
+    for(uint32_t i = 0; i < roots_.size(); ++i){
+        results_[i] = slots[root_slots_[i]];
+    }
+    for(const Dependency& d : deps_){
+        d.si->takeSnapshots_(slots[d.slot]);
+    }
+    return results_;
+}
+
+uint32_t ExpressionProgram::emitConstant(double value)
+{
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(value), "double is expected to be 64 bits");
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const ValueKey key{OpCode::CONSTANT, 0, 0, 0, bits};
+    auto itr = values_.find(key);
+    if(itr != values_.end()){
+        return itr->second;
+    }
+    const uint32_t slot = slots_.size();
+    slots_.push_back(value);
+    values_.emplace(key, slot);
+    return slot;
+}
+
+uint32_t ExpressionProgram::emitOperation(operation_t op, uint32_t a, uint32_t b)
+{
+    Instruction inst{};
+    switch(op){
+    case OP_ADD:    inst.op = OpCode::ADD;    break;
+    case OP_SUB:    inst.op = OpCode::SUB;    break;
+    case OP_MUL:    inst.op = OpCode::MUL;    break;
+    case OP_DIV:    inst.op = OpCode::DIV;    break;
+    case OP_NEGATE: inst.op = OpCode::NEGATE; break;
+    case OP_PROMOTE:
+    case OP_FORWARD:
+        return a;
+    default:
+        throw SpartaException("Cannot compile operation type: ") << op;
+    }
+
+    if(inst.op == OpCode::NEGATE){
+        b = 0;
+        inst.num_operands = 1;
+    }else{
+        // Addition and multiplication are commutative. Order the operands
+        // so that "a+b" and "b+a" are shared
+        if((inst.op == OpCode::ADD || inst.op == OpCode::MUL) && b < a){
+            std::swap(a, b);
+        }
+        inst.num_operands = 2;
+    }
+    inst.operands[0] = a;
+    inst.operands[1] = b;
+    return emit_(ValueKey{inst.op, a, b, 0, 0}, inst);
+}
+
+uint32_t ExpressionProgram::emitFunction(const ExpressionNode* fn,
+                                         uint32_t num_operands,
+                                         const uint32_t* operands)
+{
+    sparta_assert(num_operands <= 3, "Functions take at most 3 operands");
+    Instruction inst{};
+    inst.op = OpCode::CALL_FUNCTION;
+    inst.num_operands = num_operands;
+    for(uint32_t i = 0; i < num_operands; ++i){
+        inst.operands[i] = operands[i];
+    }
+    inst.node = fn;
+    return emit_(ValueKey{inst.op, inst.operands[0], inst.operands[1], inst.operands[2],
+                          reinterpret_cast<uintptr_t>(fn)}, inst);
+}
+
+uint32_t ExpressionProgram::emitNode(const ExpressionNode* node)
+{
+    Instruction inst{};
+    inst.op = OpCode::EVALUATE_NODE;
+    inst.node = node;
+    return emit_(ValueKey{inst.op, 0, 0, 0, reinterpret_cast<uintptr_t>(node)}, inst);
+}
+
+uint32_t ExpressionProgram::emitGetter(double (*getter)())
+{
+    Instruction inst{};
+    inst.op = OpCode::CALL_GETTER;
+    inst.getter = getter;
+    return emit_(ValueKey{inst.op, 0, 0, 0, reinterpret_cast<uintptr_t>(getter)}, inst);
+}
+
+uint32_t ExpressionProgram::emitReference(const double* ref)
+{
+    Instruction inst{};
+    inst.op = OpCode::LOAD_REFERENCE;
+    inst.ref = ref;
+    return emit_(ValueKey{inst.op, 0, 0, 0, reinterpret_cast<uintptr_t>(ref)}, inst);
+}
+
+uint32_t ExpressionProgram::emitStatistic(const StatisticInstance& si)
+{
+    // Must mirror StatisticInstance::getValue and computeValue_
+    const bool ended = si.end_tick_ != Scheduler::INDEFINITE;
+    const bool expired = si.isExpired_();
+    const uint32_t dep = deps_.size();
+    deps_.push_back({&si, si.window_version_, si.identity_version_, ended, expired, NO_DELTA, 0});
+
+    uint32_t slot;
+    if(ended){
+        // Window has ended. The value was computed then
+        slot = emitConstant(si.result_);
+    }else if(expired){
+        slot = emitConstant(NAN);
+    }else if(si.ctr_){
+        slot = emitCounterDelta_(si.ctr_, getCounterInitial_(si), deps_[dep].delta);
+    }else if(si.par_){
+        Instruction inst{};
+        inst.op = OpCode::LOAD_PARAMETER;
+        inst.param = si.par_;
+        slot = emit_(ValueKey{inst.op, 0, 0, 0, reinterpret_cast<uintptr_t>(si.par_)}, inst);
+    }else{
+        slot = si.stat_expr_.compile(*this);
+    }
+    deps_[dep].slot = slot;
+    return slot;
+}
+
+uint32_t ExpressionProgram::emitCounterDelta_(const CounterBase* ctr, double initial, uint32_t& delta)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &initial, sizeof(bits));
+
+    // Deltas are numbered like other values. The slot is not an
+    // instruction's so the key holds the index of the delta
+    const ValueKey key{OpCode::COUNTER_DELTA, uint32_t(bits), uint32_t(bits >> 32), 0,
+                       reinterpret_cast<uintptr_t>(ctr)};
+    auto itr = values_.find(key);
+    if(itr != values_.end()){
+        delta = itr->second;
+    }else{
+        delta = counters_.size();
+        counters_.push_back(ctr);
+        initials_.push_back(initial);
+        counter_slots_.push_back(slots_.size());
+        delta_users_.push_back(0);
+        slots_.push_back(NAN);
+        values_.emplace(key, delta);
+    }
+    ++delta_users_[delta];
+    return counter_slots_[delta];
+}
+
+double ExpressionProgram::getCounterInitial_(const StatisticInstance& si)
+{
+    // Latest values are not deltas. Subtracting 0 leaves them unchanged
+    if(si.ctr_->getBehavior() == CounterBase::COUNT_LATEST){
+        return 0;
+    }
+    return si.getInitial();
+}
+
+uint32_t ExpressionProgram::emit_(const ValueKey& key, const Instruction& inst)
+{
+    auto itr = values_.find(key);
+    if(itr != values_.end()){
+        return itr->second;
+    }
+    const uint32_t slot = slots_.size();
+    slots_.push_back(NAN);
+    code_.push_back(inst);
+    code_.back().dst = slot;
+    values_.emplace(key, slot);
+    return slot;
+}
+
+void ExpressionProgram::compile_()
+{
+    compiled_ = false;
+    code_.clear();
+    slots_.clear();
+    root_slots_.clear();
+    counters_.clear();
+    initials_.clear();
+    counter_slots_.clear();
+    delta_users_.clear();
+    deps_.clear();
+    values_.clear();
+
+    for(const Root& r : roots_){
+        if(r.expr){
+            root_slots_.push_back(r.expr->compile(*this));
+        }else{
+            root_slots_.push_back(emitStatistic(*r.si));
+        }
+    }
+
+    values_.clear(); // Only needed while compiling
+    gatherCounterSlots_();
+    restarted_users_.assign(counters_.size(), 0);
+    prev_initials_.assign(counters_.size(), NAN);
+    results_.assign(roots_.size(), NAN);
+    compiled_ = true;
+    ++num_compiles_;
+}
+
+void ExpressionProgram::gatherCounterSlots_()
+{
+    // Counter deltas take the first slots in the order they were emitted.
+    // Every other slot keeps its relative order after them
+    std::vector<uint32_t> remap(slots_.size(), 0);
+    std::vector<bool> is_counter(slots_.size(), false);
+    for(uint32_t i = 0; i < counter_slots_.size(); ++i){
+        remap[counter_slots_[i]] = i;
+        is_counter[counter_slots_[i]] = true;
+    }
+    std::vector<double> slots(slots_.size(), NAN);
+    uint32_t next = counter_slots_.size();
+    for(uint32_t i = 0; i < slots_.size(); ++i){
+        if(!is_counter[i]){
+            remap[i] = next;
+            slots[next++] = slots_[i];
+        }
+    }
+
+    for(Instruction& inst : code_){
+        inst.dst = remap[inst.dst];
+        for(uint32_t i = 0; i < inst.num_operands; ++i){
+            inst.operands[i] = remap[inst.operands[i]];
+        }
+    }
+    for(uint32_t& slot : root_slots_){
+        slot = remap[slot];
+    }
+    for(Dependency& d : deps_){
+        d.slot = remap[d.slot];
+    }
+    slots_.swap(slots);
+    counter_slots_.clear();
+}
+
+bool ExpressionProgram::refresh_()
+{
+    // Instances are recorded before the instances nested in their
+    // expressions. Assigning an instance destroys its nested instances, so
+    // stop at the first change requiring recompilation rather than reading
+    // those
+    restarted_deltas_.clear();
+    for(Dependency& d : deps_){
+        const StatisticInstance& si = *d.si;
+        if(SPARTA_EXPECT_TRUE(si.window_version_ == d.window_version &&
+                              si.identity_version_ == d.identity_version &&
+                              si.isExpired_() == d.expired)){
+            continue;
+        }
+        const bool ended = si.end_tick_ != Scheduler::INDEFINITE;
+        if(si.identity_version_ != d.identity_version || si.isExpired_() != d.expired ||
+           ended || d.ended){
+            return false;
+        }
+
+        // Restarted. Only the initial value of a counter can have changed.
+        // Every restarted user of a delta must agree on the new value
+        if(d.delta != NO_DELTA){
+            const double initial = getCounterInitial_(si);
+            if(restarted_users_[d.delta] == 0){
+                restarted_deltas_.push_back(d.delta);
+                prev_initials_[d.delta] = initials_[d.delta];
+                initials_[d.delta] = initial;
+            }else if(initials_[d.delta] != initial){
+                return false;
+            }
+            ++restarted_users_[d.delta];
+        }
+        d.window_version = si.window_version_;
+    }
+
+    // Users of a delta which were not restarted still need the old value
+    bool current = true;
+    for(const uint32_t delta : restarted_deltas_){
+        if(restarted_users_[delta] != delta_users_[delta] &&
+           initials_[delta] != prev_initials_[delta]){
+            current = false;
+        }
+        restarted_users_[delta] = 0;
+    }
+    return current;
+}
+
+        } // namespace expression
+    } // namespace statistics
+} // namespace sparta
@@ -8,6 +8,8 @@
 
 #include "sparta/log/MessageSource.hpp"
 
+#include <algorithm>
+
 #include "sparta/kernel/Scheduler.hpp"
 #include "sparta/utils/TimeManager.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
@@ -19,6 +21,136 @@ namespace sparta {
 
 seq_num_type MessageSource::seq_num_ = 0;
 
+std::size_t MessageBuffer::size_ = MessageBuffer::DEFAULT_SIZE;
+
+/*!
+ * \brief Free message buffers of a thread
+ */
+struct MessageBufferPool
+{
+    ~MessageBufferPool();
+
+    MessageBuffer* free = nullptr;
+};
+
+namespace {
+    thread_local MessageBufferPool buffer_pool;
+
+    //! Messages may be logged from the destructors of other thread-local or
+    //! static objects after the pool is gone. Trivially destructible, so it
+    //! is valid for the whole life of the thread
+    thread_local bool buffer_pool_destroyed = false;
+}
+
+MessageBufferPool::~MessageBufferPool()
+{
+    while(free){
+        MessageBuffer* next = free->next_free_;
+        delete free;
+        free = next;
+    }
+    buffer_pool_destroyed = true;
+}
+
+MessageBuffer::MessageBuffer() :
+    stream_(&buf_)
+{
+    buf_.reset(size_);
+}
+
+MessageBuffer* MessageBuffer::acquire()
+{
+    if(buffer_pool_destroyed || buffer_pool.free == nullptr){
+        return new MessageBuffer;
+    }
+    MessageBuffer* buf = buffer_pool.free;
+    buffer_pool.free = buf->next_free_;
+    return buf;
+}
+
+void MessageBuffer::release(MessageBuffer* buf)
+{
+    if(buffer_pool_destroyed){
+        delete buf;
+        return;
+    }
+
+    // Reset the stream for the next message
+    std::ostream& os = buf->stream_;
+    os.clear();
+    os.flags(std::ios_base::skipws | std::ios_base::dec);
+    os.fill(' ');
+    os.precision(6);
+    os.width(0);
+    buf->buf_.reset(size_);
+
+    buf->next_free_ = buffer_pool.free;
+    buffer_pool.free = buf;
+}
+
+const std::string& MessageBuffer::StringBuffer::getContent()
+{
+    str_.resize(pptr() - pbase());
+    setp(&str_[0], &str_[0] + str_.size());
+    pbump(str_.size());
+    return str_;
+}
+
+void MessageBuffer::StringBuffer::reset(std::size_t size)
+{
+    if(str_.size() > size){
+        std::string().swap(str_); // Return what a long message allocated
+    }
+    str_.resize(size);
+    setp(&str_[0], &str_[0] + str_.size());
+}
+
+MessageBuffer::StringBuffer::int_type MessageBuffer::StringBuffer::overflow(int_type c)
+{
+    if(traits_type::eq_int_type(c, traits_type::eof())){
+        return traits_type::not_eof(c);
+    }
+    grow_(1);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+std::streamsize MessageBuffer::StringBuffer::xsputn(const char* s, std::streamsize n)
+{
+    if(epptr() - pptr() < n){
+        grow_(n);
+    }
+    traits_type::copy(pptr(), s, n);
+    pbump(n);
+    return n;
+}
+
+void MessageBuffer::StringBuffer::grow_(std::size_t n)
+{
+    const std::size_t used = pptr() - pbase();
+    str_.resize(std::max(str_.size() * 2, used + n));
+    setp(&str_[0], &str_[0] + str_.size());
+    pbump(used);
+}
+
+const char* MessageSource::LogObject::writeLiteral_(const char* fmt)
+{
+    std::ostream& os = buf_->getStream();
+    const char* lit = fmt;
+    for(const char* p = fmt; *p != '\0'; ++p){
+        if((p[0] == '{' && p[1] == '{') || (p[0] == '}' && p[1] == '}')){
+            os.write(lit, p + 1 - lit); // Write one brace
+            lit = ++p + 1;
+        }else if(p[0] == '{' && p[1] == '}'){
+            os.write(lit, p - lit);
+            return p + 2;
+        }
+    }
+    os.write(lit, std::char_traits<char>::length(lit));
+    return nullptr;
+}
+
 // Implemented here to prevent circular dependency on scheduler
 void MessageSource::emit_(const std::string& content) const {
     sparta_assert(getParent() != nullptr);
@@ -0,0 +1,210 @@
+// <ParallelSchedulerRunner.cpp> -*- C++ -*-
+
+
+/**
+ * \file ParallelSchedulerRunner.cpp
+ * \brief Runs multiple Scheduler partitions in parallel using
+ *        conservative, lookahead-based synchronization
+ */
+
+#include "sparta/kernel/ParallelSchedulerRunner.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include "sparta/kernel/SleeperThread.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta
+{
+
+ParallelSchedulerRunner::ParallelSchedulerRunner(const std::vector<Scheduler*> & partitions) :
+    partitions_(partitions),
+    receivers_(partitions.size())
+{
+    sparta_assert(!partitions_.empty(), "A ParallelSchedulerRunner needs at least one partition");
+    for(auto it = partitions_.begin(); it != partitions_.end(); ++it) {
+        Scheduler * sched = *it;
+        sparta_assert(sched != nullptr, "Null partition given to ParallelSchedulerRunner");
+        sparta_assert(std::find(partitions_.begin(), it, sched) == it,
+                      "Scheduler '" << sched->getName() << "' given to ParallelSchedulerRunner twice");
+        sparta_assert(sched->partition_runner_ == nullptr,
+                      "Scheduler '" << sched->getName() << "' is already a partition of another "
+                      "ParallelSchedulerRunner");
+        sched->partition_runner_ = this;
+    }
+}
+
+ParallelSchedulerRunner::~ParallelSchedulerRunner()
+{
+    for(Scheduler * sched : partitions_) {
+        sched->partition_runner_ = nullptr;
+    }
+}
+
+void ParallelSchedulerRunner::registerReceiver(CrossPartitionReceiver * receiver)
+{
+    sparta_assert(receiver != nullptr);
+    sparta_assert(running_ == false, "Cannot register a cross-partition receiver while running");
+    sparta_assert(receiver->getMinimumLatency() > 0,
+                  "Cross-partition receivers must have a non-zero latency; the latency "
+                  "bounds how far partitions can run ahead of each other");
+    auto it = std::find(partitions_.begin(), partitions_.end(), receiver->getReceivingPartition());
+    sparta_assert(it != partitions_.end(),
+                  "Cross-partition receiver delivers on a Scheduler that is not a partition of this runner");
+    receivers_[std::distance(partitions_.begin(), it)].emplace_back(receiver);
+}
+
+void ParallelSchedulerRunner::deregisterReceiver(CrossPartitionReceiver * receiver)
+{
+    sparta_assert(running_ == false, "Cannot deregister a cross-partition receiver while running");
+    for(auto & partition_receivers : receivers_) {
+        auto it = std::find(partition_receivers.begin(), partition_receivers.end(), receiver);
+        if(it != partition_receivers.end()) {
+            partition_receivers.erase(it);
+            return;
+        }
+    }
+}
+
+Scheduler::Tick ParallelSchedulerRunner::getLookahead() const
+{
+    Scheduler::Tick lookahead = Scheduler::INDEFINITE;
+    for(const auto & partition_receivers : receivers_) {
+        for(const CrossPartitionReceiver * receiver : partition_receivers) {
+            lookahead = std::min(lookahead, receiver->getMinimumLatency());
+        }
+    }
+    return lookahead;
+}
+
+void ParallelSchedulerRunner::run(Scheduler::Tick num_ticks)
+{
+    sparta_assert(running_ == false, "ParallelSchedulerRunner::run is not reentrant");
+
+    const Scheduler::Tick start_tick = partitions_.front()->getCurrentTick();
+    for(const Scheduler * sched : partitions_) {
+        sparta_assert(sched->isFinalized(), "Partition '" << sched->getName() << "' is not finalized");
+        sparta_assert(sched->isRunning() == false, "Partition '" << sched->getName() << "' is already running");
+        sparta_assert(sched->getCurrentTick() == start_tick,
+                      "All partitions must start running at the same tick. Partition '"
+                      << sched->getName() << "' is at tick " << sched->getCurrentTick()
+                      << ", expected " << start_tick);
+    }
+
+    if(num_ticks == 0) {
+        return;
+    }
+
+    lookahead_ = getLookahead();
+    end_tick_  = (num_ticks == Scheduler::INDEFINITE) ? Scheduler::INDEFINITE : start_tick + num_ticks;
+    window_end_ = (lookahead_ == Scheduler::INDEFINITE) ? end_tick_ :
+        std::min(start_tick + lookahead_, end_tick_);
+
+    partition_idle_.assign(partitions_.size(), 0);
+    stop_requested_ = false;
+    finished_  = false;
+    exception_ = nullptr;
+    running_   = true;
+
+    // Partitions do not touch the SleeperThread since they run on
+    // different threads; do it once for all of them here.
+    SleeperThread::getInstance()->unpause();
+
+    std::vector<std::thread> threads;
+    threads.reserve(partitions_.size() - 1);
+    for(uint32_t i = 1; i < partitions_.size(); ++i) {
+        threads.emplace_back(&ParallelSchedulerRunner::runPartition_, this, i);
+    }
+    runPartition_(0);
+    for(auto & thread : threads) {
+        thread.join();
+    }
+
+    SleeperThread::getInstance()->pause();
+    running_ = false;
+
+    if(exception_) {
+        std::rethrow_exception(exception_);
+    }
+}
+
+void ParallelSchedulerRunner::runPartition_(uint32_t partition_idx)
+{
+    Scheduler * sched = partitions_[partition_idx];
+    do {
+        try {
+            // Anything sent to this partition in previous windows
+            // arrives at or after the start of this window
+            for(CrossPartitionReceiver * receiver : receivers_[partition_idx]) {
+                receiver->drainCrossPartitionMessages();
+            }
+
+            const Scheduler::Tick window_end = window_end_;
+            if(window_end == Scheduler::INDEFINITE) {
+                sched->run(Scheduler::INDEFINITE, false, false);
+            }
+            else {
+                sched->run(window_end - sched->getCurrentTick(), true, false);
+                if(sched->getCurrentTick() != window_end) {
+                    // Someone called stopRunning on this partition
+                    stop_requested_ = true;
+                }
+            }
+
+            // Idle if there are no continuing events left at or after
+            // the next tick this partition will run
+            partition_idle_[partition_idx] =
+                (sched->getNextContinuingEventTime() < sched->getCurrentTick());
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lock(exception_mutex_);
+            if(!exception_) {
+                exception_ = std::current_exception();
+            }
+            stop_requested_ = true;
+        }
+    } while(synchronize_());
+}
+
+bool ParallelSchedulerRunner::synchronize_()
+{
+    const uint64_t generation = generation_.load(std::memory_order_acquire);
+    if((num_arrived_.fetch_add(1, std::memory_order_acq_rel) + 1) == partitions_.size()) {
+        num_arrived_.store(0, std::memory_order_relaxed);
+        decideNextWindow_();
+        generation_.store(generation + 1, std::memory_order_release);
+    }
+    else {
+        while(generation_.load(std::memory_order_acquire) == generation) {
+            std::this_thread::yield();
+        }
+    }
+    return !finished_;
+}
+
+void ParallelSchedulerRunner::decideNextWindow_()
+{
+    ++num_windows_;
+
+    bool all_idle = std::all_of(partition_idle_.begin(), partition_idle_.end(),
+                                [](char idle) { return idle != 0; });
+    if(all_idle) {
+        for(const auto & partition_receivers : receivers_) {
+            for(const CrossPartitionReceiver * receiver : partition_receivers) {
+                if(receiver->hasPendingMessages()) {
+                    all_idle = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    if(stop_requested_ || all_idle || (window_end_ == end_tick_)) {
+        finished_ = true;
+        return;
+    }
+    window_end_ = std::min(window_end_ + lookahead_, end_tick_);
+}
+
+}
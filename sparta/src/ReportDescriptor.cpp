@@ -357,6 +357,10 @@ uint32_t ReportDescriptor::writeOutput(std::ostream* out)
     for(auto & inst : getInstantiations()){
         const bool report_active = this->updateReportActiveState_(inst.first);
         if (report_active && false == inst.second->supportsUpdate()) {
+            // The formatter and the SimDB collector share one snapshot of
+            // the report's statistics
+            ReportSnapshot & snapshot = inst.first->getSnapshot();
+            snapshot.capture();
             //TODO: Deprecate "during simulation" formatters
             if (legacy_reports_enabled_) {
                 inst.second->write();
@@ -364,6 +368,7 @@ uint32_t ReportDescriptor::writeOutput(std::ostream* out)
             if (collector_) {
                 sweepSimDbStats_();
             }
+            snapshot.release();
             num_saved++;
 
             // User information
@@ -424,6 +429,10 @@ uint32_t ReportDescriptor::updateOutput(std::ostream* out)
                 skipped_annotator_->reset();
             }
             if (capture_update_values) {
+                // The formatter and the SimDB collector share one snapshot
+                // of the report's statistics
+                ReportSnapshot & snapshot = inst.first->getSnapshot();
+                snapshot.capture();
                 //TODO: Deprecate "during simulation" formatters
                 if (legacy_reports_enabled_) {
                     inst.second->update();
@@ -431,6 +440,7 @@ uint32_t ReportDescriptor::updateOutput(std::ostream* out)
                 if (collector_) {
                     sweepSimDbStats_();
                 }
+                snapshot.release();
             }
             num_updated++;
 
@@ -0,0 +1,57 @@
+// <ReportSnapshot> -*- C++ -*-
+
+#include "sparta/report/ReportSnapshot.hpp"
+
+#include "sparta/report/Report.hpp"
+#include "sparta/statistics/StatisticInstance.hpp"
+
+namespace sparta
+{
+    namespace
+    {
+        //! Collect statistics depth-first, in the order formatters write them
+        void getReportStatistics(const Report* r, std::vector<const StatisticInstance*>& stats)
+        {
+            for(const statistics::stat_pair_t& si : r->getStatistics()){
+                stats.push_back(si.second.get());
+            }
+            for(const Report& sr : r->getSubreports()){
+                getReportStatistics(&sr, stats);
+            }
+        }
+    }
+
+    const std::vector<double>& ReportSnapshot::getValues()
+    {
+        // A plan which changed since the capture has nothing captured
+        if(updatePlan_() == false && captured_){
+            return program_->getResults();
+        }
+        captured_ = false;
+        return program_->evaluate();
+    }
+
+    void ReportSnapshot::capture()
+    {
+        captured_ = false;
+        getValues();
+        captured_ = true;
+    }
+
+    bool ReportSnapshot::updatePlan_()
+    {
+        stats_scratch_.clear();
+        getReportStatistics(report_, stats_scratch_);
+        if(program_ && stats_scratch_ == stats_){
+            return false;
+        }
+
+        stats_.swap(stats_scratch_);
+        program_.reset(new statistics::expression::ExpressionProgram);
+        for(const StatisticInstance* si : stats_){
+            program_->addRoot(*si);
+        }
+        return true;
+    }
+
+} // namespace sparta
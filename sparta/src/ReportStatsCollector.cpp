@@ -311,16 +311,71 @@ void ReportStatsCollector::postInit(int argc, char** argv)
 
 void ReportStatsCollector::collect(const ReportDescriptor* desc)
 {
+    // Values come from the snapshots of the descriptor's reports, which are
+    // shared with formatters writing those reports at the same time
+    const auto& desc_stats = simdb_stats_.at(desc);
+    const auto& reports = simdb_stat_reports_[desc];
+    const auto& indices = simdb_stat_indices_[desc];
+
+    std::vector<const std::vector<const StatisticInstance*>*> snapshot_stats;
+    for (const auto r : reports) {
+        snapshot_stats.push_back(&r->getSnapshot().getStatistics());
+    }
+    bool indexed = (indices.size() == desc_stats.size());
+    for (size_t i = 0; indexed && i < desc_stats.size(); ++i) {
+        const auto& idx = indices[i];
+        indexed = (idx.report == NO_REPORT) ||
+                  (idx.index < snapshot_stats[idx.report]->size() &&
+                   (*snapshot_stats[idx.report])[idx.index] == desc_stats[i]);
+    }
+    if (!indexed) {
+        indexSnapshots_(desc);
+    }
+
+    // Only snapshot the reports actually holding a collected statistic
+    std::vector<const std::vector<double>*> snapshot_values(reports.size(), nullptr);
     std::vector<double> stats;
-    stats.reserve(simdb_stats_.at(desc).size());
-    for (const auto stat : simdb_stats_[desc]) {
-        stats.push_back(stat->getValue());
+    stats.reserve(desc_stats.size());
+    for (size_t i = 0; i < desc_stats.size(); ++i) {
+        const auto& idx = indices[i];
+        if (idx.report == NO_REPORT) {
+            stats.push_back(desc_stats[i]->getValue());
+            continue;
+        }
+        auto& values = snapshot_values[idx.report];
+        if (values == nullptr) {
+            values = &reports[idx.report]->getSnapshot().getValues();
+        }
+        stats.push_back((*values)[idx.index]);
     }
 
     ReportStatsAtTick in(desc, scheduler_->getCurrentTick(), std::move(stats));
     pipeline_queue_->emplace(std::move(in));
 }
 
+void ReportStatsCollector::indexSnapshots_(const ReportDescriptor* desc)
+{
+    auto& reports = simdb_stat_reports_[desc];
+    reports.clear();
+
+    std::unordered_map<const StatisticInstance*, SnapshotIndex> index;
+    for (const auto r : desc->getAllInstantiations()) {
+        const auto& snapshot_stats = r->getSnapshot().getStatistics();
+        const uint32_t report_idx = reports.size();
+        for (uint32_t i = 0; i < snapshot_stats.size(); ++i) {
+            index.emplace(snapshot_stats[i], SnapshotIndex{report_idx, i});
+        }
+        reports.push_back(r);
+    }
+
+    auto& indices = simdb_stat_indices_[desc];
+    indices.clear();
+    for (const auto stat : simdb_stats_.at(desc)) {
+        auto it = index.find(stat);
+        indices.push_back(it != index.end() ? it->second : SnapshotIndex{NO_REPORT, 0});
+    }
+}
+
 void ReportStatsCollector::writeSkipAnnotation(
     const ReportDescriptor* desc,
     const std::string& annotation)
@@ -191,6 +191,15 @@ void Scheduler::deregisterClock(sparta::Clock *clk)
     }
 }
 
+std::shared_ptr<SlabAllocator> Scheduler::getProxySlabAllocator(size_t size, size_t align)
+{
+    auto & allocator = proxy_slab_allocators_[std::make_pair(size, align)];
+    if(allocator == nullptr) {
+        allocator = std::make_shared<SlabAllocator>(size, align);
+    }
+    return allocator;
+}
+
 void Scheduler::finalize()
 {
     if(!dag_finalized_)
@@ -241,21 +250,29 @@ void Scheduler::clearEvents()
         debug_ << "Clearing all events";
     }
 
-    uint32_t last_event_idx = current_event_firing_;
+    // If a handler threw out of run(), the events of the current
+    // group before it have already fired and may have been deleted
+    // since.  Skip them.
+    const bool mid_group = (current_group_firing_id_ != 0);
     auto tq = current_tick_quantum_;
     while(tq != nullptr)
     {
-        for(auto & events : tq->groups)
+        for(uint32_t grp = 0; grp < tq->groups.size(); ++grp)
         {
+            auto & events = tq->groups[grp];
+            const uint32_t first_event_idx =
+                (mid_group && (tq == current_tick_quantum_) && (grp == current_group_firing_)) ?
+                current_event_firing_ : 0;
+
             // Iterate each scheduled sparta event, and cancel's it.
             // There's no need to replace the event with a null
             // delegate since the list is to be completely emptied.
-            for(uint32_t i = last_event_idx; i < events.size(); ++i)
+            for(uint32_t i = first_event_idx; i < events.size(); ++i)
             {
+                events[i]->scheduled_slots_.clear();
                 events[i]->eventCancelled_();
             }
             events.clear();
-            last_event_idx = 0;
         }
 
         auto temp_tq = tq;
@@ -265,8 +282,13 @@ void Scheduler::clearEvents()
         tick_quantum_allocator_.free(temp_tq);
     }
     current_tick_quantum_ = nullptr;
+    current_group_firing_id_ = 0;
     latest_continuing_event_ = 0;
     is_finished_ = true;
+
+    if(!timing_wheel_.empty()) {
+        clearTimingWheel_();
+    }
 }
 
 void Scheduler::restartAt(Tick t)
@@ -283,6 +305,7 @@ void Scheduler::restartAt(Tick t)
 
     clearEvents();
     current_tick_ = t;
+    timing_wheel_base_ = t;
     if(first_tick_ || (t == 0)) {
         elapsed_ticks_ = t;
     }
@@ -291,9 +314,136 @@ void Scheduler::restartAt(Tick t)
     }
 }
 
+void Scheduler::setTimingWheelSize(uint32_t num_slots)
+{
+    sparta_assert(!running_, "Cannot change the timing wheel size while the scheduler is running");
+    sparta_assert(current_tick_quantum_ == nullptr,
+                  "Cannot change the timing wheel size while events are scheduled");
+    sparta_assert(((num_slots & (num_slots - 1)) == 0) && ((num_slots % 64) == 0),
+                  "The timing wheel size must be a power of two and a multiple of 64, not "
+                  << num_slots);
+
+    timing_wheel_.assign(num_slots, nullptr);
+    timing_wheel_occupancy_.assign(num_slots / 64, 0);
+    timing_wheel_mask_ = (num_slots > 0) ? (num_slots - 1) : 0;
+    timing_wheel_base_ = current_tick_;
+    timing_wheel_overflow_.clear();
+}
+
+void Scheduler::clearTimingWheel_()
+{
+    std::fill(timing_wheel_.begin(), timing_wheel_.end(), nullptr);
+    std::fill(timing_wheel_occupancy_.begin(), timing_wheel_occupancy_.end(), 0);
+    timing_wheel_overflow_.clear();
+}
+
+void Scheduler::advanceTimingWheel_(Tick new_base)
+{
+    // All ticks before new_base have been fired, so their slots
+    // are already empty.  Slots that wrap around to the end of the
+    // new window can be filled from the overflow index.
+    timing_wheel_base_ = new_base;
+    const Tick horizon = new_base + timing_wheel_.size();
+    while(!timing_wheel_overflow_.empty() &&
+          (timing_wheel_overflow_.begin()->first < horizon))
+    {
+        const auto it = timing_wheel_overflow_.begin();
+        const Tick slot = it->first & timing_wheel_mask_;
+        timing_wheel_[slot] = it->second;
+        timing_wheel_occupancy_[slot >> 6] |= (1ull << (slot & 63));
+        timing_wheel_overflow_.erase(it);
+    }
+}
+
+Scheduler::TickQuantum* Scheduler::findPrecedingWheelQuantum_(Tick index_time) const
+{
+    // Walk the occupancy bits backwards from index_time - 1 down to
+    // the base of the wheel, one 64-bit word at a time
+    Tick tick = index_time;
+    while(tick > timing_wheel_base_)
+    {
+        const Tick     last = tick - 1;
+        const Tick     slot = last & timing_wheel_mask_;
+        const uint32_t bit  = slot & 63;
+        const Tick     span = last - timing_wheel_base_;
+
+        // Keep bits [0, bit] of this word, but do not look before
+        // the base of the wheel
+        uint64_t bits = timing_wheel_occupancy_[slot >> 6] & (~0ull >> (63 - bit));
+        if(span < bit) {
+            bits &= (~0ull << (bit - span));
+        }
+        if(bits != 0) {
+            const Tick found = (slot & ~Tick(63)) + (63 - __builtin_clzll(bits));
+            return timing_wheel_[found];
+        }
+        if(span <= bit) {
+            break;
+        }
+        tick = last - bit;
+    }
+    return nullptr;
+}
+
+Scheduler::TickQuantum* Scheduler::determineTickQuantumFromWheel_(Tick index_time)
+{
+    sparta_assert(index_time >= timing_wheel_base_);
+
+    // Find either the quantum for index_time or the quantum that
+    // will precede it in the list
+    TickQuantum * prev_tq = nullptr;
+    const bool in_wheel = (index_time - timing_wheel_base_) < timing_wheel_.size();
+    auto overflow_it = timing_wheel_overflow_.end();
+    if(SPARTA_EXPECT_TRUE(in_wheel))
+    {
+        TickQuantum * tq = timing_wheel_[index_time & timing_wheel_mask_];
+        if(tq != nullptr) {
+            return tq;
+        }
+        prev_tq = findPrecedingWheelQuantum_(index_time);
+    }
+    else
+    {
+        overflow_it = timing_wheel_overflow_.lower_bound(index_time);
+        if((overflow_it != timing_wheel_overflow_.end()) && (overflow_it->first == index_time)) {
+            return overflow_it->second;
+        }
+        if(overflow_it != timing_wheel_overflow_.begin()) {
+            prev_tq = std::prev(overflow_it)->second;
+        }
+        else {
+            prev_tq = findPrecedingWheelQuantum_(timing_wheel_base_ + timing_wheel_.size());
+        }
+    }
+
+    TickQuantum * tq = tick_quantum_allocator_.create(firing_group_count_);
+    tq->tick = index_time;
+    if(prev_tq == nullptr) {
+        tq->next = current_tick_quantum_;
+        current_tick_quantum_ = tq;
+    }
+    else {
+        tq->next = prev_tq->next;
+        prev_tq->next = tq;
+    }
+
+    if(SPARTA_EXPECT_TRUE(in_wheel)) {
+        const Tick slot = index_time & timing_wheel_mask_;
+        timing_wheel_[slot] = tq;
+        timing_wheel_occupancy_[slot >> 6] |= (1ull << (slot & 63));
+    }
+    else {
+        timing_wheel_overflow_.emplace_hint(overflow_it, index_time, tq);
+    }
+    return tq;
+}
+
 Scheduler::TickQuantum* Scheduler::determineTickQuantum_(Tick rel_time)
 {
     const Tick index_time = calcIndexTime(rel_time);
+    if(!timing_wheel_.empty()) {
+        return determineTickQuantumFromWheel_(index_time);
+    }
 
     // This might look inefficient, but 99.9% of the time the
     // event being scheduled is either on the current time
@@ -400,11 +550,12 @@ void Scheduler::scheduleEvent(Scheduleable * scheduleable,
 
     auto rit = determineTickQuantum_(rel_time);
 
-    if (false == add_if_not_scheduled) {
-        rit->addEvent(firing_group, scheduleable);
-    }
-    else {
-        rit->addEventIfNotScheduled(firing_group, scheduleable);
+    auto & scheduled_slots = scheduleable->scheduled_slots_;
+    if (!add_if_not_scheduled ||
+        !(scheduled_slots.contains(rit, firing_group) ||
+          ((rit == current_tick_quantum_) && scheduled_slots.hasFiredIn(current_group_firing_id_))))
+    {
+        scheduled_slots.add(rit, firing_group, rit->addEvent(firing_group, scheduleable));
     }
 
     if(continuing){
@@ -452,7 +603,9 @@ void Scheduler::run(Tick num_ticks,
     }
 
     // unpause infinite loop protection if we need
-    SleeperThread::getInstance()->unpause();
+    if(partition_runner_ == nullptr) {
+        SleeperThread::getInstance()->unpause();
+    }
 
     // Special case the first tick.  Current Tick is always 1-based
     // and trails elapsed ticks. Since we can't make current_tick_ -1,
@@ -502,8 +655,8 @@ void Scheduler::run(Tick num_ticks,
 
                 // Elapsed ticks always trail current_tick_ by one
                 elapsed_ticks_ += std::llabs(int64_t(current_tick_) - int64_t(elapsed_ticks_) - 1);
-                for(auto clk : registered_clocks_) {
-                    clk->updateElapsedCycles(elapsed_ticks_);
+                if(!timing_wheel_.empty()) {
+                    advanceTimingWheel_(current_tick_);
                 }
             }
             running_ = false;
@@ -545,8 +698,8 @@ void Scheduler::run(Tick num_ticks,
         // Optimization -- start at the first group with events
         current_group_firing_       = quantum->first_group_idx;
 
-        for(auto clk : registered_clocks_) {
-            clk->updateElapsedCycles(elapsed_ticks_);
+        if(!timing_wheel_.empty()) {
+            advanceTimingWheel_(current_tick_);
         }
 
         if(SPARTA_EXPECT_FALSE(debug_)) {
@@ -583,6 +736,7 @@ void Scheduler::run(Tick num_ticks,
         while(current_group_firing_ < grp_cnt)
         {
             TickQuantum::ScheduleableGroup & events = quantum->groups[current_group_firing_];
+            current_group_firing_id_ = ++num_group_firings_;
 
             // The design of this for loop is important to keep as is.
             // The events array can grow in size after firing the
@@ -598,6 +752,12 @@ void Scheduler::run(Tick num_ticks,
                 ++current_event_firing_)
             {
                 const Scheduleable * sched = events[current_event_firing_];
+
+                // The event is no longer on the Scheduler once it
+                // fires.  Cancelled events were already removed.
+                sched->scheduled_slots_.remove(quantum, current_group_firing_, current_event_firing_);
+                sched->scheduled_slots_.setFiredIn(current_group_firing_id_);
+
                 current_scheduling_phase_ = sched->getSchedulingPhase();
                 if(SPARTA_EXPECT_FALSE(debug_)) {
                     printNextCycleEventTree(debug_, current_group_firing_, current_event_firing_);
@@ -612,6 +772,7 @@ void Scheduler::run(Tick num_ticks,
                 sched->getHandler()();
                 ++events_fired_;
             }
+            current_group_firing_id_ = 0;
             events.clear();
             ++current_group_firing_;
         }
@@ -624,6 +785,11 @@ void Scheduler::run(Tick num_ticks,
         // Move to the next quantum
         current_tick_quantum_ = quantum->next;
         quantum->next         = nullptr;
+        if(!timing_wheel_.empty()) {
+            const Tick slot = quantum->tick & timing_wheel_mask_;
+            timing_wheel_[slot] = nullptr;
+            timing_wheel_occupancy_[slot >> 6] &= ~(1ull << (slot & 63));
+        }
         tick_quantum_allocator_.free(quantum);
         sparta_assert(watchdogExpired_() == false);
 
@@ -665,7 +831,9 @@ void Scheduler::run(Tick num_ticks,
     ++current_tick_;
 
     // pause infinite loop protection if we need
-    SleeperThread::getInstance()->pause();
+    if(partition_runner_ == nullptr) {
+        SleeperThread::getInstance()->pause();
+    }
 
     running_ = false;
     if(SPARTA_EXPECT_TRUE(measure_run_time)) {
@@ -680,119 +848,76 @@ void Scheduler::run(Tick num_ticks,
 
 bool Scheduler::isScheduled(const Scheduleable * scheduleable, Tick rel_time) const
 {
-    const uint32_t dag_group =
-        (scheduleable->getGroupID() != 0 ? scheduleable->getGroupID() + 1 : group_zero_);
     const Tick index_time = calcIndexTime(rel_time);
-    const TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
-    {
-        if(rit->tick == index_time)
-        {
-            // This is the time quantum requested
-            const auto events = rit->groups[dag_group];
-            const auto grp_size = events.size();
-            for(size_t idx = 0; idx < grp_size; ++idx)
-            {
-                if(events[idx] == scheduleable) {
-                    return true;
-                }
-            }
-            return false;
+    const auto & scheduled_slots = scheduleable->scheduled_slots_;
+    for(const auto & slot : scheduled_slots.getSlots()) {
+        if(slot.quantum->tick == index_time) {
+            return true;
         }
-        else if(rit->tick > index_time) {
-            // We're past the tick quantum -- didn't find it
-            return false;
-        }
-        rit = rit->next;
     }
-    return false;
+    return (rel_time == 0) && scheduled_slots.hasFiredIn(current_group_firing_id_);
 }
 
 bool Scheduler::isScheduled(const Scheduleable * scheduleable) const
 {
-    const uint32_t dag_group =
-        (scheduleable->getGroupID() != 0 ? scheduleable->getGroupID() + 1 : group_zero_);
-
-    const TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
-    {
-        const auto events = rit->groups[dag_group];
-        const auto grp_size = events.size();
-        for(size_t idx = 0; idx < grp_size; ++idx)
-        {
-            if(events[idx] == scheduleable) {
-                return true;
-            }
-        }
-        rit = rit->next;
-    }
-    return false;
+    const auto & scheduled_slots = scheduleable->scheduled_slots_;
+    return !scheduled_slots.empty() || scheduled_slots.hasFiredIn(current_group_firing_id_);
 }
 
 void Scheduler::cancelEvent(const Scheduleable * scheduleable)
 {
-    uint32_t dag_group = scheduleable->getGroupID();
-    if(SPARTA_EXPECT_FALSE(dag_group == 0)) {
-        dag_group = group_zero_;
-    } else {
-        dag_group += 1;
-    }
-
-    TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
+    auto & scheduled_slots = scheduleable->scheduled_slots_;
+    for(const auto & slot : scheduled_slots.getSlots())
     {
-        TickQuantum::ScheduleableGroup & scheduleables = rit->groups[dag_group];
-        for(uint32_t i = 0; i < scheduleables.size(); ++i)
-        {
-            if(scheduleables[i] == scheduleable) {
-                scheduleables[i] = cancelled_event_.get();
-                if(SPARTA_EXPECT_FALSE(debug_)) {
-                    debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
-                           << "canceling: " << scheduleable->getLabel()
-                           << " at tick: " << rit->tick
-                           << " group: " << dag_group
-                           << SPARTA_CURRENT_COLOR_NORMAL;
-                }
-            }
+        slot.quantum->groups[slot.firing_group][slot.index] = cancelled_event_.get();
+        if(SPARTA_EXPECT_FALSE(debug_)) {
+            debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
+                   << "canceling: " << scheduleable->getLabel()
+                   << " at tick: " << slot.quantum->tick
+                   << " group: " << slot.firing_group
+                   << SPARTA_CURRENT_COLOR_NORMAL;
         }
-        rit = rit->next;
     }
+    scheduled_slots.clear();
 }
 
 void Scheduler::cancelEvent(const Scheduleable * scheduleable, Tick rel_time)
 {
-    uint32_t dag_group = scheduleable->getGroupID();
-    if(SPARTA_EXPECT_FALSE(dag_group == 0)) {
-        dag_group = group_zero_;
-    } else {
-        dag_group += 1;
-    }
     const Tick index_time = calcIndexTime(rel_time);
 
-    TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
+    auto & slots = scheduleable->scheduled_slots_.getSlots();
+    auto new_end = slots.begin();
+    Scheduleable * cancelled = nullptr;
+    uint32_t num_cancelled = 0;
+    for(const auto & slot : slots)
     {
-        if(rit->tick == index_time)
-        {
-            TickQuantum::ScheduleableGroup & scheduleables = rit->groups[dag_group];
-            for(uint32_t i = 0; i < scheduleables.size(); ++i)
-            {
-                if(scheduleables[i] == scheduleable) {
-                    scheduleables[i]->eventCancelled_();
-                    scheduleables[i] = cancelled_event_.get();
-                    if(SPARTA_EXPECT_FALSE(debug_)) {
-                        debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
-                               << "canceling: " << scheduleable->getLabel()
-                               << " at tick: " << rit->tick
-                               << " reltime: " << rel_time
-                               << " group: " << dag_group
-                               << SPARTA_CURRENT_COLOR_NORMAL;
-                    }
-                }
-            }
-            return;
+        if(slot.quantum->tick != index_time) {
+            *new_end++ = slot;
+            continue;
         }
-        rit = rit->next;
+
+        auto & scheduled = slot.quantum->groups[slot.firing_group][slot.index];
+        cancelled = scheduled;
+        scheduled = cancelled_event_.get();
+        ++num_cancelled;
+        if(SPARTA_EXPECT_FALSE(debug_)) {
+            debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
+                   << "canceling: " << scheduleable->getLabel()
+                   << " at tick: " << slot.quantum->tick
+                   << " reltime: " << rel_time
+                   << " group: " << slot.firing_group
+                   << SPARTA_CURRENT_COLOR_NORMAL;
+        }
+    }
+    slots.erase(new_end, slots.end());
+    if(rel_time == 0) {
+        // No longer counts as scheduled if it already fired
+        scheduleable->scheduled_slots_.setFiredIn(0);
+    }
+
+    // Let the Scheduleable know once the bookkeeping is consistent
+    for(uint32_t i = 0; i < num_cancelled; ++i) {
+        cancelled->eventCancelled_();
     }
 }
 
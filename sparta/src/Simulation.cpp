@@ -33,6 +33,7 @@
 #include "sparta/app/Simulation.hpp"
 #include "sparta/app/AppTriggers.hpp"
 #include "sparta/pevents/PeventTrigger.hpp"
+#include "sparta/pevents/BinaryPevents.hpp"
 #include "sparta/trigger/SingleTrigger.hpp"
 #include "sparta/report/format/Text.hpp"
 #include "sparta/kernel/SleeperThread.hpp"
@@ -303,6 +304,25 @@ void printSchedulerPerformanceInfo(std::ostream& o, const boost::timer::cpu_time
       << scheduler->getNumFired() << std::endl;
 }
 
+/*!
+ * \brief Write log messages buffered by asynchronous destinations and binary
+ * pevent files so that the messages leading up to an error or exit are not
+ * lost
+ */
+static void flushLogDestinations() noexcept
+{
+    try{
+        sparta::log::DestinationManager::flushDestinations();
+        sparta::pevents::BinaryPeventWriter::flushWriters();
+    }catch(std::exception& e){
+        std::cerr << "Warning: suppressed exception while flushing log destinations:\n"
+                  << e.what() << std::endl;
+    }catch(...){
+        std::cerr << "Warning: suppressed unknown exception while flushing log destinations"
+                  << std::endl;
+    }
+}
+
 Simulation::Simulation(const std::string& sim_name,
                        Scheduler * scheduler) :
     clk_manager_(scheduler),
@@ -369,6 +389,8 @@ Simulation::~Simulation()
     root_.getNodeAttachedNotification().DEREGISTER_FOR_THIS(rootDescendantAdded_);
 
     report_repository_.reset();
+
+    flushLogDestinations();
 }
 
 void Simulation::configure(const int argc,
@@ -425,6 +447,11 @@ void Simulation::configure(const int argc,
     // users add more if needed
     report_config_.reset(new ReportConfiguration(sim_config_, &rep_descs_, &root_));
 
+    // Buffer log files and write them from a background thread
+    if(sim_config_->async_logging){
+        sparta::log::DestinationManager::setAsynchronous(true);
+    }
+
     // Disabling default-warnings tap if applicable
     if(false == sim_config_->warn_stderr){
         warn_to_cerr_.detach(); // Do no observe
@@ -894,6 +921,7 @@ void Simulation::run(uint64_t run_time)
             // Show simulator performance
             printSchedulerPerformanceInfo(std::cout, timer, scheduler_);
         }else{
+            flushLogDestinations();
             std::cerr << SPARTA_CMDLINE_COLOR_ERROR "Exception while running" SPARTA_CMDLINE_COLOR_NORMAL
                       << std::endl;
             try {
@@ -954,6 +982,8 @@ void Simulation::run(uint64_t run_time)
 
 void Simulation::dumpDebugContentIfAllowed(std::exception_ptr eptr, bool force) noexcept
 {
+    flushLogDestinations();
+
     // Assume a DEBUG_DUMP_ERROR if no sim_config
     const SimulationConfiguration::PostRunDebugDumpPolicy debug_dump_policy =
         (sim_config_ ? sim_config_->debug_dump_policy : SimulationConfiguration::PostRunDebugDumpPolicy::DEBUG_DUMP_ERROR);
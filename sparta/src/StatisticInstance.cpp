@@ -150,6 +150,8 @@ namespace sparta
         rhp.ctr_ = nullptr;
         rhp.par_ = nullptr;
         rhp.result_ = NAN;
+        rhp.program_.reset();
+        ++rhp.identity_version_;
     }
 
     StatisticInstance& StatisticInstance::operator=(const StatisticInstance& rhp) {
@@ -167,6 +169,10 @@ namespace sparta
 
         sub_statistics_ = rhp.sub_statistics_;
 
+        // The program refers to the old expression
+        program_.reset();
+        ++identity_version_;
+
         return *this;
     }
 
@@ -199,6 +205,7 @@ namespace sparta
 
         // Clear result value
         result_ = NAN;
+        ++window_version_;
     }
 
     void StatisticInstance::end(){
@@ -228,9 +235,10 @@ namespace sparta
 
         // Recompute result value
         result_ = computeValue_();
+        ++window_version_;
     }
 
-    double StatisticInstance::getValue() const {
+    void StatisticInstance::checkRange_() const {
         if(SPARTA_EXPECT_FALSE(end_tick_ < start_tick_)) {
             throw ReversedStatisticRange("Range is reversed. End < start");
         }
@@ -239,28 +247,37 @@ namespace sparta
             throw FutureStatisticRange("Range starts in the future at ") << start_tick_;
         }
 
+        if(SPARTA_EXPECT_FALSE(end_tick_ != Scheduler::INDEFINITE &&
+                               end_tick_ > getScheduler_()->getElapsedTicks())) {
+            // Rang ends in the future - probable because of a checkpoint
+            throw FutureStatisticRange("Range ends in the future at ") << end_tick_;
+        }
+    }
+
+    double StatisticInstance::takeSnapshots_(double value) const {
+        //Update any snapshot loggers that are listening for these updates
+        for (auto & logger : snapshot_loggers_) {
+            logger.takeSnapshot(value);
+        }
+        return value;
+    }
+
+    double StatisticInstance::getValue() const {
+        checkRange_();
+
         double value;
         if(end_tick_ == Scheduler::INDEFINITE){
             // Compute Value
             value = computeValue_();
         }
 
-        else if(SPARTA_EXPECT_FALSE(end_tick_ > getScheduler_()->getElapsedTicks())) {
-            // Rang ends in the future - probable because of a checkpoint
-            throw FutureStatisticRange("Range ends in the future at ") << end_tick_;
-        }
-
         else {
             // End tick <= current tick. Use pre-computed value because this
             // window ended in the past
             value = result_;
         }
 
-        //Update any snapshot loggers that are listening for these updates
-        for (auto & logger : snapshot_loggers_) {
-            logger.takeSnapshot(value);
-        }
-        return value;
+        return takeSnapshots_(value);
     }
 
     double StatisticInstance::getRawLatest() const
@@ -542,7 +559,7 @@ namespace sparta
                 return NAN;
             }
             // Evaluate the expression
-            return stat_expr_.evaluate();
+            return evaluateProgram_();
         }else if(ctr_){
             if(node_ref_.expired() == true){
                 return NAN;
@@ -559,8 +576,16 @@ namespace sparta
             }
             return par_->getDoubleValue();
         }else{
-            return stat_expr_.evaluate();
+            return evaluateProgram_();
+        }
+    }
+
+    double StatisticInstance::evaluateProgram_() const {
+        if(!program_){
+            program_.reset(new statistics::expression::ExpressionProgram);
+            program_->addRoot(stat_expr_);
         }
+        return program_->evaluate()[0];
     }
 
     const Scheduler * StatisticInstance::getScheduler_() const {
@@ -16,7 +16,6 @@
 #include <vector>
 #include <sstream>
 #include <stack>
-#include <regex>
 #include <algorithm>
 #include <cstdint>
 #include <initializer_list>
@@ -901,15 +900,10 @@ uint32_t TreeNode::findChildren_(const std::string& pattern,
     }
     else
     {
-        // Using regex here to find children because full regex pattern
-        // should probably be supported eventually. Having some regex
-        // code here already should encourage that.
-
-        std::string patexp = createSearchRegexPattern(sub_pattern);
-
-        //std::cout << "Local search pattern is \"" << patexp << "\" from " << getLocation()
-        //          << " extracted from pattern \"" << pattern << "\"" << std::endl;
-        std::regex expr(patexp);
+        // Compiled patterns are cached, so each pattern token is only
+        // parsed once no matter how many nodes it is compared against
+        const auto expr_ptr = utils::GlobPattern::get(sub_pattern);
+        const utils::GlobPattern& expr = *expr_ptr;
 
         // Get the immediate children of this node matching the first part of
         // the pattern
@@ -961,13 +955,20 @@ uint32_t TreeNode::findChildren_(const std::string& pattern,
     return findChildren_(pattern, results, replacements, allow_private);
 }
 
-uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
+uint32_t TreeNode::findImmediateChildren_(const utils::GlobPattern& expr,
                                           std::vector<TreeNode*>& found,
                                           std::vector<std::vector<std::string>>& replacements,
                                           bool allow_private) {
     uint32_t num_found = 0;
-    for(ChildNameMapping::reference chp : names_)
+
+    // A pattern without wildcards can only match children by that name
+    auto range = std::make_pair(names_.begin(), names_.end());
+    if(expr.isLiteral()){
+        range = names_.equal_range(expr.getPattern());
+    }
+    for(auto itr = range.first; itr != range.second; ++itr)
     {
+        ChildNameMapping::reference chp = *itr;
         std::vector<std::string> replaced; // Replacements per name
         if(identityMatchesPattern_(chp.first, expr, replaced)){
             TreeNode* child = chp.second;
@@ -990,7 +991,7 @@ uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
     return num_found;
 }
 
-uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
+uint32_t TreeNode::findImmediateChildren_(const utils::GlobPattern& expr,
                                           std::vector<TreeNode*>& found,
                                           bool allow_private) {
     std::vector<std::vector<std::string>> replacements;
@@ -998,12 +999,19 @@ uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
 }
 
 // Const variant of findImmediateChildren_
-uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
+uint32_t TreeNode::findImmediateChildren_(const utils::GlobPattern& expr,
                                           std::vector<const TreeNode*>& found,
                                           std::vector<std::vector<std::string>>& replacements,
                                           bool allow_private) const {
     uint32_t num_found = 0;
-    for(ChildNameMapping::const_reference chp : names_){
+
+    // A pattern without wildcards can only match children by that name
+    auto range = std::make_pair(names_.begin(), names_.end());
+    if(expr.isLiteral()){
+        range = names_.equal_range(expr.getPattern());
+    }
+    for(auto itr = range.first; itr != range.second; ++itr){
+        ChildNameMapping::const_reference chp = *itr;
 
         std::vector<std::string> replaced; // Replacements per name
         if(identityMatchesPattern_(chp.first, expr, replaced)){
@@ -1023,7 +1031,7 @@ uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
     return num_found;
 }
 
-uint32_t TreeNode::findImmediateChildren_(std::regex& expr,
+uint32_t TreeNode::findImmediateChildren_(const utils::GlobPattern& expr,
                                           std::vector<const TreeNode*>& found,
                                           bool allow_private) const {
     std::vector<std::vector<std::string>> replacements;
@@ -1066,15 +1074,13 @@ bool TreeNode::locationMatchesPattern(const std::string& pattern,
             // This is the reason why this function cannot be called
             // with any upwards traversal
         }
-        std::string pat_expr = createSearchRegexPattern(pat_tok);
-        std::regex expr(pat_expr);
+        const auto expr = utils::GlobPattern::get(pat_tok);
 
         auto idents = node->getIdentifiers();
         bool matched = false;
         for(const std::string* ident : idents){
-            std::cmatch what;
             // Test against this ident
-            if(std::regex_match(ident->c_str(), what, expr)){
+            if(expr->matches(*ident)){
 
                 // If parent is null, check that it might be the start
                 // node because if the startnode is a GlobalTreeNode
@@ -1233,9 +1239,7 @@ std::pair<uint32_t, std::string> TreeNode::recursGetDeepestMatchingPath_(const s
         deepest += getParent()->recursGetDeepestMatchingPath_(path, out_path_pos).second;
     }else{
         std::vector<const TreeNode*> children;
-        std::string patexp = createSearchRegexPattern(immediate_child_name);
-        std::regex expr(patexp);
-        findImmediateChildren_(expr, children);
+        findImmediateChildren_(*utils::GlobPattern::get(immediate_child_name), children);
         uint32_t max_depth = 0;
         if(children.size() == 0){
             return {0, ""}; // No children found
@@ -1528,10 +1532,7 @@ std::string TreeNode::getNextName(const std::string& name, size_t& pos) {
 }
 
 bool TreeNode::matchesGlobLike(const std::string& pattern, const std::string& other) {
-    std::string patexpr = createSearchRegexPattern(pattern);
-    std::regex expr(patexpr);
-    std::smatch what;
-    return std::regex_match(other, what, expr); // , boost::match_extra);
+    return utils::GlobPattern::get(pattern)->matches(other);
 }
 
 TreeNode::node_uid_type TreeNode::getNextNodeUID_() {
@@ -2093,31 +2094,16 @@ void TreeNode::ensureNoParent_(const char* action) {
 // Miscellaneous
 
 bool TreeNode::identityMatchesPattern_(const std::string& ident,
-                                       std::regex& expr,
+                                       const utils::GlobPattern& expr,
                                        std::vector<std::string>& replacements) {
-    std::smatch what;
-    // Test against this name (could be alias, group, etc.)
-    if(std::regex_match(ident, what, expr)) { // , boost::match_extra)){
-        // Print out matches
-        //for(unsigned i = 0; i < what.size(); ++i){
-        //    std::cout << "      $" << i << " = \"" << what[i] << "\"\n";
-        //}
-
-        // Captures - Equivalent of perl regex $i.
-        // Skip 0 because it is the whole expression and these replacements will
-        // probably be concatenated together
-        for(unsigned i = 1; i < what.size(); ++i){
-            replacements.push_back(what[i].str());
-        }
-        return true;
-    }
-    return false;
+    // Test against this name (could be alias, group, etc.). Captures are
+    // the text matched by each wildcard, equivalent of perl regex $i
+    return expr.matches(ident, replacements);
 }
 
 bool TreeNode::identityMatchesPattern_(const std::string& ident,
-                                       std::regex& expr) {
-    std::vector<std::string> replacements;
-    return identityMatchesPattern_(ident, expr, replacements);
+                                       const utils::GlobPattern& expr) {
+    return expr.matches(ident);
 }
 
 std::string TreeNode::getPreviousName_(const std::string& name,
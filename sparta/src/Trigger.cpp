@@ -41,6 +41,7 @@ CounterTrigger::CounterTrigger(const std::string& name,
                 << counter << "\" having a null clock");
 
     counter_wref_ = counter_->getWeakPtr();
+    reregister_();
 }
 
 CounterTrigger::CounterTrigger(const CounterTrigger& rhp) :
@@ -50,22 +51,61 @@ CounterTrigger::CounterTrigger(const CounterTrigger& rhp) :
     counter_wref_(rhp.counter_wref_),
     trigger_point_(rhp.trigger_point_)
 {
+    reregister_();
 }
 
 CounterTrigger::~CounterTrigger()
 {
+    // Disarm while arm_/disarm_ still dispatch to this class
+    ManagedTrigger::deactivate_();
+}
+
+void CounterTrigger::reregister_()
+{
+    // The ManagedTrigger base registers itself before the counter is
+    // known, as a polled trigger. Register again so it can be armed
+    if(ManagedTrigger::isActive_()) {
+        ManagedTrigger::deactivate_();
+        ManagedTrigger::registerSelf_();
+    }
+}
+
+bool CounterTrigger::arm_()
+{
+    if(counter_ == nullptr || counter_wref_.expired() || !counter_->supportsArmedThresholds()) {
+        return false;
+    }
+    counter_->armThreshold(this, trigger_point_,
+                           CREATE_SPARTA_HANDLER(CounterTrigger, counterReachedTriggerPoint_));
+    return true;
+}
+
+void CounterTrigger::disarm_() const
+{
+    if(counter_ != nullptr && !counter_wref_.expired()) {
+        counter_->disarmThreshold(this);
+    }
+}
+
+void CounterTrigger::counterReachedTriggerPoint_()
+{
+    ManagedTrigger::thresholdReached_();
 }
 
 CounterTrigger& CounterTrigger::operator= (const CounterTrigger& rhp)
 {
-    *static_cast<SingleTrigger*>(this) = *static_cast<const SingleTrigger*>(&rhp);
-    *static_cast<ManagedTrigger*>(this) = *static_cast<const ManagedTrigger*>(&rhp);
+    // Disarm from the current counter before switching counters
+    ManagedTrigger::deactivate_();
 
-    // Copy over data and re-register
     sparta_assert(rhp.counter_);
     counter_ = rhp.counter_;
+    counter_wref_ = rhp.counter_wref_;
     trigger_point_ = rhp.trigger_point_;
 
+    // Copy over base data and re-register (and re-arm) if active
+    *static_cast<SingleTrigger*>(this) = *static_cast<const SingleTrigger*>(&rhp);
+    *static_cast<ManagedTrigger*>(this) = *static_cast<const ManagedTrigger*>(&rhp);
+
     return *this;
 }
 
@@ -121,6 +161,11 @@ void ManagedTrigger::deregisterSelf_() const
     TriggerManager::getTriggerManager().removeTrigger(this);
 }
 
+void ManagedTrigger::thresholdReached_()
+{
+    TriggerManager::getTriggerManager().wakeTrigger(this);
+}
+
 void ManagedTrigger::deactivate_()
 {
     deregisterSelf_();
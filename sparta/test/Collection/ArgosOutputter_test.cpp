@@ -0,0 +1,240 @@
+#include "sparta/pipeViewer/Outputter.hpp"
+
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+/*
+ * Writes the same stream of transactions through pipeViewer::Outputter
+ * with unbuffered, buffered and asynchronous output, and checks that
+ * every file written is identical and that the index points at the
+ * right records.  Also checks that an index entry is only written
+ * once the records before it are in the record file, and that a failed
+ * record write is reported.  With SPARTA_PERF_TESTS set, also reports
+ * the time each mode takes.
+ */
+
+TEST_INIT
+
+namespace
+{
+    const char * FILE_NAMES[] = {"record.bin", "index.bin", "map.dat", "data.dat",
+                                 "string_map.dat", "display_format.dat"};
+
+    std::string readFile(const std::string & path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        EXPECT_TRUE(in.is_open());
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    pair_t makePair(uint64_t start, uint64_t end, uint64_t id)
+    {
+        pair_t dat(start, end, 0, id, BAD_DISPLAY_ID, 3 + ((id / 10) % 2), is_Pair, 0);
+        dat.pairId = 1 + ((id / 10) % 2);
+        dat.length = 2;
+        dat.nameVector = {"uid", "opcode"};
+        dat.sizeOfVector = {sizeof(uint64_t), sizeof(uint16_t)};
+        dat.valueVector = {{id, true}, {id % 3, true}};
+        dat.stringVector = {"", (id % 3) ? "add" : "sub"};
+        dat.delimVector = {sparta::PairFormatter::DECIMAL, sparta::PairFormatter::HEX};
+        return dat;
+    }
+
+    /*!
+     * \brief Write num_records records, indexing every INTERVAL ticks
+     * \param record_starts Offsets of every record written
+     * \return Seconds taken, including closing the files
+     */
+    double writeRecords(const std::string & prefix, uint64_t num_records,
+                        bool async_io, std::size_t buffer_size,
+                        std::vector<uint64_t> * record_starts = nullptr)
+    {
+        constexpr uint64_t INTERVAL = 1000;
+        const auto start = std::chrono::steady_clock::now();
+        {
+            sparta::pipeViewer::Outputter outputter(prefix, INTERVAL, async_io, buffer_size);
+            outputter.writeIndex();
+
+            uint64_t pos = 0;
+            uint64_t tick = 0;
+            for(uint64_t id = 1; id <= num_records; ++id) {
+                if(record_starts) {
+                    record_starts->emplace_back(pos);
+                }
+                if((id % 10) == 0) {
+                    annotation_t dat(transaction_t(tick, tick + 1, 0, id, BAD_DISPLAY_ID, 1, is_Annotation, 0));
+                    dat.annt = "annotation " + std::to_string(id);
+                    dat.length = dat.annt.size() + 1;
+                    outputter.writeTransaction(dat);
+                    pos += sizeof(transaction_t) + sizeof(uint16_t) + dat.length;
+                }
+                else if((id % 10) == 1) {
+                    const pair_t dat = makePair(tick, tick + 1, id);
+                    outputter.writeTransaction(dat);
+                    pos += sizeof(transaction_t) + sizeof(uint64_t) + sizeof(uint16_t);
+                }
+                else {
+                    instruction_t dat;
+                    dat.time_Start = tick;
+                    dat.time_End = tick + 1;
+                    dat.transaction_ID = id;
+                    dat.location_ID = 2;
+                    dat.flags = is_Instruction;
+                    dat.virtual_ADR = id * 4;
+                    outputter.writeTransaction(dat);
+                    pos += sizeof(instruction_t);
+                }
+
+                if((++tick % INTERVAL) == 0) {
+                    outputter.writeIndex();
+                }
+            }
+        }
+        return sparta::perf::secondsSince(start);
+    }
+}
+
+void testIdenticalOutput()
+{
+    constexpr uint64_t NUM_RECORDS = 200000;
+
+    std::vector<uint64_t> record_starts;
+    writeRecords("argos_unbuffered_", NUM_RECORDS, false, 0, &record_starts);
+    writeRecords("argos_buffered_", NUM_RECORDS, false, 4096);
+    writeRecords("argos_async_small_", NUM_RECORDS, true, 1000);
+    writeRecords("argos_async_", NUM_RECORDS, true, sparta::pipeViewer::Outputter::DEFAULT_BUFFER_SIZE);
+
+    for(const char * file : FILE_NAMES) {
+        const std::string expected = readFile(std::string("argos_unbuffered_") + file);
+        EXPECT_EQUAL(readFile(std::string("argos_buffered_") + file), expected);
+        EXPECT_EQUAL(readFile(std::string("argos_async_small_") + file), expected);
+        EXPECT_EQUAL(readFile(std::string("argos_async_") + file), expected);
+    }
+
+    // Each pair id, location and string is described once
+    EXPECT_EQUAL(readFile("argos_async_map.dat"), std::string("3:1\n4:2\n"));
+    EXPECT_EQUAL(readFile("argos_async_string_map.dat"),
+                 std::string("1:1:1:add\n2:1:2:add\n1:1:0:sub\n"
+                             "2:1:1:add\n1:1:2:add\n2:1:0:sub\n"));
+
+    // Index: header, interval, one entry per interval pointing at the
+    // first record of that interval, and the last record
+    const std::string index = readFile("argos_async_index.bin");
+    const std::string record = readFile("argos_async_record.bin");
+    const uint64_t num_entries = (index.size() - HEADER_SIZE) / sizeof(uint64_t);
+    EXPECT_EQUAL(num_entries, 1 + 1 + NUM_RECORDS / 1000 + 1);
+    std::vector<uint64_t> entries(num_entries);
+    ::memcpy(entries.data(), index.data() + HEADER_SIZE, num_entries * sizeof(uint64_t));
+    EXPECT_EQUAL(entries[0], 1000u);
+    EXPECT_EQUAL(entries[1], 0u);
+    for(uint64_t i = 1; i < NUM_RECORDS / 1000; ++i) {
+        const uint64_t pos = entries[1 + i];
+        EXPECT_EQUAL(pos, record_starts[i * 1000]);
+        transaction_t trans;
+        ::memcpy(&trans, record.data() + pos, sizeof(trans));
+        EXPECT_EQUAL(trans.time_Start, i * 1000);
+        EXPECT_EQUAL(trans.transaction_ID, i * 1000 + 1);
+    }
+    EXPECT_EQUAL(entries[num_entries - 2], record.size());
+    EXPECT_EQUAL(entries.back(), record_starts.back());
+}
+
+void testPairTablesPerOutputter()
+{
+    // A second set of files describes its pairs again
+    for(const char * prefix : {"argos_pairs_a_", "argos_pairs_b_"}) {
+        sparta::pipeViewer::Outputter outputter(prefix, 1000);
+        outputter.writeIndex();
+        outputter.writeTransaction(makePair(0, 1, 1));
+    }
+    EXPECT_EQUAL(readFile("argos_pairs_b_data.dat"), readFile("argos_pairs_a_data.dat"));
+    EXPECT_EQUAL(readFile("argos_pairs_b_data.dat"), std::string("1:2:uid:8:0:opcode:2:0\n"));
+}
+
+void testIndexFollowsRecords()
+{
+    // Records buffered when the index is written are written first, so
+    // a reader never sees an index entry past the end of the records
+    for(const bool async_io : {false, true}) {
+        const std::string prefix = async_io ? "argos_index_async_" : "argos_index_";
+        sparta::pipeViewer::Outputter outputter(prefix, 1000, async_io);
+        for(uint64_t id = 1; id <= 100; ++id) {
+            outputter.writeTransaction(makePair(id, id + 1, id));
+        }
+        outputter.writeIndex();
+
+        const std::string index = readFile(prefix + "index.bin");
+        const std::string record = readFile(prefix + "record.bin");
+        EXPECT_EQUAL(index.size(), HEADER_SIZE + 2 * sizeof(uint64_t));
+        uint64_t pos = 0;
+        ::memcpy(&pos, index.data() + HEADER_SIZE + sizeof(uint64_t), sizeof(pos));
+        EXPECT_EQUAL(pos, 100 * (sizeof(transaction_t) + sizeof(uint64_t) + sizeof(uint16_t)));
+        EXPECT_EQUAL(record.size(), pos);
+    }
+}
+
+void testFailedWrite()
+{
+    // Every write to /dev/full fails
+    std::ifstream dev_full("/dev/full");
+    if(!dev_full.is_open()) {
+        return;
+    }
+    for(const bool async_io : {false, true}) {
+        const std::string prefix = async_io ? "argos_full_async_" : "argos_full_";
+        const std::string record_path = prefix + "record.bin";
+        std::remove(record_path.c_str());
+        EXPECT_EQUAL(::symlink("/dev/full", record_path.c_str()), 0);
+        {
+            sparta::pipeViewer::Outputter outputter(prefix, 1000, async_io, 64);
+            for(uint64_t id = 1; id <= 100; ++id) {
+                outputter.writeTransaction(makePair(id, id + 1, id));
+            }
+            EXPECT_THROW(outputter.writeIndex());
+            // The failure is not forgotten once reported
+            EXPECT_THROW(outputter.flush());
+        }
+        std::remove(record_path.c_str());
+    }
+}
+
+void testThroughput()
+{
+    if(!sparta::perf::isTimingEnabled()) {
+        return;
+    }
+
+    constexpr uint64_t NUM_RECORDS = 2000000;
+    const double unbuffered = writeRecords("argos_perf_", NUM_RECORDS, false, 0);
+    const double buffered = writeRecords("argos_perf_", NUM_RECORDS, false,
+                                         sparta::pipeViewer::Outputter::DEFAULT_BUFFER_SIZE);
+    const double async = writeRecords("argos_perf_", NUM_RECORDS, true,
+                                      sparta::pipeViewer::Outputter::DEFAULT_BUFFER_SIZE);
+    std::cout << NUM_RECORDS << " records:"
+              << "\n\tunbuffered : " << unbuffered << " s"
+              << "\n\tbuffered   : " << buffered << " s"
+              << "\n\tasync      : " << async << " s" << std::endl;
+}
+
+int main()
+{
+    testIdenticalOutput();
+    testPairTablesPerOutputter();
+    testIndexFollowsRecords();
+    testFailedWrite();
+    testThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -113,6 +113,69 @@ void runEventsNegativeTests()
     rtn.enterTeardown();
 }
 
+void runProxySlabTests()
+{
+    sparta::Scheduler scheduler;
+    sparta::Clock clk("clock", &scheduler);
+    sparta::RootTreeNode rtn;
+    sparta::EventSet event_set(&rtn);
+    event_set.setClock(&clk);
+    EventHandler ev_handler;
+
+    sparta::PayloadEvent<uint32_t>
+        pld_event_a(&event_set, "pld_event_a",
+                    CREATE_SPARTA_HANDLER_WITH_DATA_WITH_OBJ(EventHandler, &ev_handler, handler, uint32_t), 1);
+    std::unique_ptr<sparta::PayloadEvent<uint32_t>> pld_event_b(
+        new sparta::PayloadEvent<uint32_t>(&event_set, "pld_event_b",
+                                           CREATE_SPARTA_HANDLER_WITH_DATA_WITH_OBJ(EventHandler, &ev_handler,
+                                                                                    handler, uint32_t), 1));
+
+    scheduler.finalize();
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+
+    // Nothing is allocated until a payload is prepared
+    EXPECT_EQUAL(pld_event_a.getProxyAllocator(), nullptr);
+    EXPECT_EQUAL(pld_event_a.getHighWaterMark(), 0);
+
+    for(uint32_t i = 0; i < 40; ++i) {
+        pld_event_a.preparePayload(i)->schedule();
+    }
+    for(uint32_t i = 0; i < 10; ++i) {
+        pld_event_b->preparePayload(i)->schedule();
+    }
+    EXPECT_EQUAL(pld_event_a.getHighWaterMark(), 40);
+    EXPECT_EQUAL(pld_event_b->getHighWaterMark(), 10);
+    EXPECT_EQUAL(pld_event_a.getNumAllocatedProxies(), 48);
+    EXPECT_EQUAL(pld_event_b->getNumAllocatedProxies(), 16);
+
+    // Both events share one slab allocator
+    const sparta::SlabAllocator * allocator = pld_event_a.getProxyAllocator();
+    EXPECT_NOTEQUAL(allocator, nullptr);
+    EXPECT_EQUAL(pld_event_b->getProxyAllocator(), allocator);
+    EXPECT_EQUAL(allocator->getNumSlabs(), 1);
+    EXPECT_EQUAL(allocator->getNumInUse(), 64);
+
+    constexpr bool exacting_run = true;
+    scheduler.run(2, exacting_run);
+    EXPECT_EQUAL(pld_event_a.getNumOutstandingEvents(), 0);
+
+    // Delivered proxies are reused; the high-water mark sticks
+    for(uint32_t i = 0; i < 20; ++i) {
+        pld_event_a.preparePayload(i)->schedule();
+    }
+    EXPECT_EQUAL(pld_event_a.getHighWaterMark(), 40);
+    EXPECT_EQUAL(pld_event_a.getNumAllocatedProxies(), 48);
+    scheduler.run(2, exacting_run);
+
+    rtn.enterTeardown();
+
+    // Destroying an event returns its proxies to the slab
+    pld_event_b.reset();
+    EXPECT_EQUAL(allocator->getNumInUse(), 48);
+    EXPECT_EQUAL(allocator->getHighWaterMark(), 64);
+}
+
 int main()
 {
     //Negative tests and other ("positive") unit tests
@@ -121,6 +184,8 @@ int main()
     //Negative tests:
     runEventsNegativeTests();
 
+    runProxySlabTests();
+
     //Positive tests:
     sparta::Scheduler scheduler;
     sparta::Clock clk("clock", &scheduler);
@@ -0,0 +1,142 @@
+#include <inttypes.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/memory/MemoryObject.hpp"
+#include "sparta/serialization/checkpoint/FastCheckpointer.hpp"
+
+#include "sparta/utils/SpartaTester.hpp"
+
+/*!
+ * \file CheckpointRestore_test.cpp
+ * \brief Test for FastCheckpointer restore modes
+ *
+ * Takes chains of delta checkpoints in which the same few lines are
+ * rewritten between every checkpoint, then restores checkpoints at
+ * random with each restore mode. Checks that both modes restore
+ * identical state and reports restore statistics for a range of
+ * snapshot thresholds.
+ */
+
+TEST_INIT
+
+using sparta::RootTreeNode;
+using sparta::memory::MemoryObject;
+using sparta::serialization::checkpoint::FastCheckpointer;
+
+//! \brief Read all of a MemoryObject, one line at a time
+void readAll(const MemoryObject & mem_obj, std::vector<uint8_t> & buf)
+{
+    for(uint64_t addr = 0; addr < buf.size(); addr += mem_obj.getBlockSize()) {
+        mem_obj.read(addr, mem_obj.getBlockSize(), buf.data() + addr);
+    }
+}
+
+void restoreTest(uint32_t snapshot_threshold)
+{
+    constexpr uint64_t MEM_SIZE        = 1024 * 1024;
+    constexpr uint64_t LINE_SIZE       = 256;
+    constexpr uint32_t NUM_CHECKPOINTS = 400;
+    constexpr uint32_t NUM_HOT_LINES   = 64;
+    constexpr uint32_t NUM_RESTORES    = 200;
+
+    sparta::Scheduler sched;
+    RootTreeNode clocks("clocks");
+    sparta::Clock clk(&clocks, "clock", &sched);
+
+    RootTreeNode root;
+    sparta::TreeNode dummy(&root, "dummy", "dummy node");
+    MemoryObject mem_obj(&dummy, LINE_SIZE, MEM_SIZE, 0xcc, 1);
+
+    FastCheckpointer fcp(root, &sched);
+    fcp.setSnapshotThreshold(snapshot_threshold);
+
+    root.enterConfiguring();
+    root.enterFinalized();
+    sched.finalize();
+
+    std::mt19937_64 rng(snapshot_threshold);
+    for(uint64_t addr = 0; addr < MEM_SIZE; addr += LINE_SIZE) {
+        const uint64_t val = rng();
+        mem_obj.write(addr, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+    }
+    fcp.createHead();
+
+    // Every checkpoint rewrites lines from the same small set
+    std::vector<FastCheckpointer::chkpt_id_t> ids;
+    std::vector<std::vector<uint8_t>> contents;
+    for(uint32_t i = 0; i < NUM_CHECKPOINTS; ++i) {
+        for(uint32_t w = 0; w < NUM_HOT_LINES / 4; ++w) {
+            const uint64_t addr = (rng() % NUM_HOT_LINES) * LINE_SIZE + (rng() % (LINE_SIZE / 8)) * 8;
+            const uint64_t val = rng();
+            mem_obj.write(addr, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+        }
+        sched.run(1, true, false);
+        ids.emplace_back(fcp.createCheckpoint());
+        contents.emplace_back(MEM_SIZE);
+        readAll(mem_obj, contents.back());
+    }
+
+    std::vector<uint8_t> restored(MEM_SIZE);
+    for(auto mode : {FastCheckpointer::RestoreMode::REPLAY_DELTAS,
+                     FastCheckpointer::RestoreMode::NEWEST_LINES})
+    {
+        fcp.setRestoreMode(mode);
+        fcp.resetRestoreStats();
+
+        std::mt19937 pick(1);
+        for(uint32_t i = 0; i < NUM_RESTORES; ++i) {
+            const uint32_t idx = pick() % ids.size();
+            fcp.loadCheckpoint(ids[idx]);
+            readAll(mem_obj, restored);
+            EXPECT_TRUE(restored == contents[idx]);
+            EXPECT_EQUAL(sched.getCurrentTick(), fcp.getCurrentTick());
+        }
+
+        const FastCheckpointer::RestoreStats & stats = fcp.getRestoreStats();
+        EXPECT_EQUAL(stats.num_restores, NUM_RESTORES);
+        EXPECT_TRUE(stats.max_chain_length <= std::max(snapshot_threshold, 1u) + 1);
+        if(mode == FastCheckpointer::RestoreMode::NEWEST_LINES) {
+            EXPECT_TRUE(stats.lines_restored > 0);
+            EXPECT_EQUAL(stats.bytes_restored, stats.lines_restored * LINE_SIZE);
+            if(snapshot_threshold > 1) {
+                EXPECT_TRUE(stats.lines_skipped > 0);
+            }
+        }
+
+        std::cout << "Snapshot threshold " << snapshot_threshold << ": ";
+        fcp.dumpRestoreStats(std::cout);
+    }
+
+    // Continue from a restored checkpoint in the middle of a chain: the
+    // next delta must only hold lines changed after the restore
+    fcp.loadCheckpoint(ids[ids.size() / 2]);
+    const uint64_t val = 0x1234;
+    mem_obj.write(MEM_SIZE - LINE_SIZE, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+    sched.run(1, true, false);
+    const auto branch = fcp.createCheckpoint();
+    fcp.loadCheckpoint(ids.back());
+    fcp.loadCheckpoint(branch);
+    readAll(mem_obj, restored);
+    std::vector<uint8_t> expected = contents[ids.size() / 2];
+    ::memcpy(expected.data() + MEM_SIZE - LINE_SIZE, &val, sizeof(val));
+    EXPECT_TRUE(restored == expected);
+
+    root.enterTeardown();
+    clocks.enterTeardown();
+}
+
+int main()
+{
+    for(uint32_t threshold : {1u, 5u, 20u, 100u}) {
+        restoreTest(threshold);
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,282 @@
+#include <inttypes.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "sparta/sparta.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/memory/MemoryObject.hpp"
+#include "sparta/serialization/checkpoint/FastCheckpointer.hpp"
+#include "sparta/serialization/checkpoint/CheckpointCompression.hpp"
+#include "sparta/serialization/checkpoint/CompressedStorage.hpp"
+
+#include "sparta/utils/SpartaTester.hpp"
+
+/*!
+ * \file CompressedCheckpoint_test.cpp
+ * \brief Test for compressed and spilled FastCheckpointer storage
+ *
+ * Round-trips the in-tree codecs and serialized storage, then takes a long series of
+ * checkpoints of a mostly-zero memory in which a few lines change
+ * between checkpoints (like a sampling run) with each compression
+ * setting. Reports memory use and timing for each, and checks that
+ * restored state matches what was checkpointed.
+ */
+
+TEST_INIT
+
+using sparta::RootTreeNode;
+using sparta::memory::MemoryObject;
+using sparta::serialization::checkpoint::FastCheckpointer;
+using sparta::serialization::checkpoint::storage::CompressedStorage;
+namespace compression = sparta::serialization::checkpoint::compression;
+
+//! \brief Read all of a MemoryObject, one line at a time
+void readAll(const MemoryObject & mem_obj, std::vector<uint8_t> & buf)
+{
+    for(uint64_t addr = 0; addr < buf.size(); addr += mem_obj.getBlockSize()) {
+        mem_obj.read(addr, mem_obj.getBlockSize(), buf.data() + addr);
+    }
+}
+
+//! \brief Encode and decode a buffer with every codec
+void roundTrip(const std::vector<char> & data)
+{
+    std::vector<char> encoded;
+    std::vector<char> decoded(data.size());
+
+    compression::rleEncode(data.data(), data.size(), encoded);
+    EXPECT_TRUE(encoded.size() <= data.size() + data.size() / 128 + 1);
+    compression::rleDecode(encoded.data(), encoded.size(), decoded.data(), decoded.size());
+    EXPECT_TRUE(decoded == data);
+
+    encoded.clear();
+    std::fill(decoded.begin(), decoded.end(), 0x5a);
+    compression::lzCompress(data.data(), data.size(), encoded);
+    compression::lzDecompress(encoded.data(), encoded.size(), decoded.data(), decoded.size());
+    EXPECT_TRUE(decoded == data);
+}
+
+void codecTest()
+{
+    std::mt19937 rng(1);
+
+    roundTrip({});
+    roundTrip({1});
+    roundTrip({1, 1, 1});
+    roundTrip(std::vector<char>(100000, 0));
+
+    // Random bytes (incompressible)
+    std::vector<char> data(70000);
+    for(auto & b : data) {
+        b = static_cast<char>(rng());
+    }
+    roundTrip(data);
+
+    // Random bytes from a small alphabet with runs and repeats,
+    // including matches further than the maximum offset
+    for(uint32_t i = 0; i < data.size();) {
+        const uint32_t len = rng() % 300;
+        const char val = static_cast<char>(rng() % 4);
+        for(uint32_t j = 0; j < len && i < data.size(); ++j, ++i) {
+            data[i] = (rng() % 3) ? val : static_cast<char>(rng() % 4);
+        }
+    }
+    roundTrip(data);
+
+    // Zero lines compress to (almost) nothing
+    std::vector<char> encoded;
+    compression::rleEncode(std::vector<char>(512, 0).data(), 512, encoded);
+    EXPECT_EQUAL(encoded.size(), 8u);
+    encoded.clear();
+    compression::lzCompress(std::vector<char>(4096, 0).data(), 4096, encoded);
+    EXPECT_TRUE(encoded.size() < 32);
+
+    // Corrupt data is detected
+    encoded.clear();
+    compression::lzCompress(data.data(), data.size(), encoded);
+    std::vector<char> decoded(data.size());
+    EXPECT_THROW(compression::lzDecompress(encoded.data(), encoded.size() / 2,
+                                           decoded.data(), decoded.size()));
+}
+
+/*!
+ * \brief Take NUM_CHECKPOINTS checkpoints, modifying a few lines of a
+ * mostly-zero memory in between. Verify a sample of them by loading
+ */
+void samplingTest(FastCheckpointer::Compression comp, bool spill)
+{
+    constexpr uint64_t MEM_SIZE        = 4 * 1024 * 1024;
+    constexpr uint64_t LINE_SIZE       = 512;
+    constexpr uint32_t NUM_CHECKPOINTS = 2000;
+    constexpr uint32_t WRITES_PER_CHKPT = 16;
+    constexpr uint32_t VERIFY_EVERY    = 97;
+
+    sparta::Scheduler sched;
+    RootTreeNode clocks("clocks");
+    sparta::Clock clk(&clocks, "clock", &sched);
+
+    RootTreeNode root;
+    sparta::TreeNode dummy(&root, "dummy", "dummy node");
+    MemoryObject mem_obj(&dummy, LINE_SIZE, MEM_SIZE, 0, 1);
+
+    FastCheckpointer fcp(root, &sched);
+    fcp.setSnapshotThreshold(20);
+    fcp.setCompression(comp);
+    fcp.setNumHotCheckpoints(4);
+    if(spill) {
+        fcp.setSpillFile("compressed_checkpoint_test.spill");
+    }
+
+    root.enterConfiguring();
+    root.enterFinalized();
+    sched.finalize();
+
+    // Touch every other line so that snapshots hold a lot of
+    // (mostly zero) lines
+    std::mt19937_64 rng(42);
+    for(uint64_t addr = 0; addr < MEM_SIZE; addr += 2 * LINE_SIZE) {
+        const uint64_t val = rng() & 0xffff;
+        mem_obj.write(addr, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+    }
+    fcp.createHead();
+
+    std::vector<std::pair<FastCheckpointer::chkpt_id_t, std::vector<uint8_t>>> expected;
+    std::vector<uint8_t> contents(MEM_SIZE);
+
+    double create_time = 0;
+    for(uint32_t i = 0; i < NUM_CHECKPOINTS; ++i) {
+        // A hot region with small values plus a few scattered writes
+        for(uint32_t w = 0; w < WRITES_PER_CHKPT; ++w) {
+            const uint64_t region = (w < WRITES_PER_CHKPT / 2) ? (64 * 1024) : MEM_SIZE;
+            const uint64_t addr = (rng() % (region / 8)) * 8;
+            const uint64_t val = rng() % 1000;
+            mem_obj.write(addr, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+        }
+        sched.run(1, true, false);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto id = fcp.createCheckpoint();
+        create_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if((i % VERIFY_EVERY) == 0) {
+            readAll(mem_obj, contents);
+            expected.emplace_back(id, contents);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for(auto it = expected.rbegin(); it != expected.rend(); ++it) {
+        fcp.loadCheckpoint(it->first);
+        readAll(mem_obj, contents);
+        EXPECT_TRUE(contents == it->second);
+    }
+    const double load_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    static const char * COMP_NAMES[] = {"none", "rle", "lz"};
+    std::cout << "Compression: " << COMP_NAMES[static_cast<uint32_t>(comp)]
+              << (spill ? " + spill" : "")
+              << "\n\tcheckpoints           : " << fcp.getNumCheckpoints()
+              << "\n\tcontent memory        : " << fcp.getContentMemoryUse() / 1000.0 << " kB"
+              << "\n\ttotal memory          : " << fcp.getTotalMemoryUse() / 1000.0 << " kB"
+              << "\n\tspilled               : " << fcp.getSpilledBytes() / 1000.0 << " kB"
+              << "\n\tcreate time           : " << create_time << " s"
+              << "\n\tload time (" << expected.size() << " loads) : " << load_time << " s"
+              << std::endl;
+
+    if(spill) {
+        EXPECT_TRUE(fcp.getSpilledBytes() > 0);
+    }
+
+    root.enterTeardown();
+    clocks.enterTeardown();
+}
+
+//! \brief Restore every line of a storage, in order
+std::vector<std::vector<char>> restoreLines(CompressedStorage & storage, uint32_t line_size)
+{
+    std::vector<std::vector<char>> lines;
+    storage.prepareForLoad();
+    while(storage.getNextRestoreLine() != sparta::ArchData::INVALID_LINE_IDX) {
+        lines.emplace_back(line_size);
+        storage.copyLineBytes(lines.back().data(), line_size);
+    }
+    EXPECT_TRUE(storage.good());
+    return lines;
+}
+
+/*!
+ * \brief Save a storage to a boost archive and load it into a
+ * default-constructed storage, block compressing it first if asked
+ */
+void serializationTest(CompressedStorage::Compression comp, bool block_compress)
+{
+    constexpr uint32_t LINE_SIZE = 256;
+
+    // A zero line, a line of runs and a random line
+    std::vector<std::vector<char>> lines(3, std::vector<char>(LINE_SIZE, 0));
+    std::mt19937 rng(3);
+    for(uint32_t i = 0; i < LINE_SIZE; ++i) {
+        lines[1][i] = static_cast<char>(i / 64);
+        lines[2][i] = static_cast<char>(rng());
+    }
+
+    CompressedStorage saved(comp);
+    for(uint32_t i = 0; i < lines.size(); ++i) {
+        saved.beginLine(i);
+        saved.writeLineBytes(lines[i].data(), LINE_SIZE);
+    }
+    saved.endArchData();
+    if(block_compress) {
+        saved.compress();
+    }
+    EXPECT_EQUAL(saved.isBlockCompressed(), block_compress && comp == CompressedStorage::Compression::LZ);
+
+    std::stringstream ss;
+    {
+        boost::archive::binary_oarchive oa(ss);
+        oa << saved;
+    }
+    CompressedStorage loaded;
+    {
+        boost::archive::binary_iarchive ia(ss);
+        ia >> loaded;
+    }
+
+    EXPECT_TRUE(loaded.getCompression() == comp);
+    EXPECT_EQUAL(loaded.getUncompressedSize(), saved.getUncompressedSize());
+    EXPECT_EQUAL(loaded.getStoredSize(), saved.getStoredSize());
+    EXPECT_EQUAL(loaded.isBlockCompressed(), saved.isBlockCompressed());
+    EXPECT_TRUE(restoreLines(loaded, LINE_SIZE) == lines);
+
+    // The loaded storage compresses like the one saved
+    loaded.compress();
+    EXPECT_EQUAL(loaded.isBlockCompressed(), comp == CompressedStorage::Compression::LZ);
+    EXPECT_TRUE(restoreLines(loaded, LINE_SIZE) == lines);
+}
+
+int main()
+{
+    codecTest();
+
+    for(const auto comp : {CompressedStorage::Compression::NONE,
+                           CompressedStorage::Compression::RLE,
+                           CompressedStorage::Compression::LZ}) {
+        serializationTest(comp, false);
+        serializationTest(comp, true);
+    }
+
+    samplingTest(FastCheckpointer::Compression::NONE, false);
+    samplingTest(FastCheckpointer::Compression::RLE, false);
+    samplingTest(FastCheckpointer::Compression::LZ, false);
+    samplingTest(FastCheckpointer::Compression::LZ, true);
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,157 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/statistics/CompactHistogram.hpp"
+#include "sparta/statistics/Histogram.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file HistogramPerf.cpp
+ * \brief CompactHistogramTreeNode against HistogramTreeNode
+ *
+ * Feeds the same values to a Counter-backed histogram and to a compact
+ * histogram with many bins, then compares every bin, the underflow and
+ * overflow bins, the totals and the max counts, and the statistics both
+ * publish through the tree by name and value.  One pass over the values
+ * is enough for that; the addValue timing makes 64.
+ */
+
+TEST_INIT
+
+namespace
+{
+    constexpr uint64_t LOWER_VAL  = 16;
+    constexpr uint64_t UPPER_VAL  = 16 + 512 * 2 - 1;
+    constexpr uint32_t VALS_PER_BIN = 2;
+    constexpr uint32_t NUM_HISTOGRAMS = 64;
+    constexpr uint32_t NUM_VALUES = 1 << 16;
+
+    //! Run every value through every histogram num_passes times,
+    //! returning the wall time
+    template<typename HistogramT>
+    double fill(const std::vector<std::unique_ptr<HistogramT>> & histograms,
+                const std::vector<uint64_t> & values, uint32_t num_passes)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t pass = 0; pass < num_passes; ++pass) {
+            for(const uint64_t val : values) {
+                for(auto & h : histograms) {
+                    h->addValue(val);
+                }
+            }
+        }
+        return sparta::perf::secondsSince(start);
+    }
+}
+
+void testCompactMatchesHistogram()
+{
+    sparta::RootTreeNode root("top");
+    sparta::HistogramTreeNode hist(&root, "hist", "Counter histogram", 5, 20, 4, 3,
+                                   sparta::InstrumentationNode::VIS_NORMAL,
+                                   sparta::InstrumentationNode::VIS_NORMAL);
+    sparta::CompactHistogramTreeNode compact(&root, "compact", "Compact histogram", 5, 20, 4, 3);
+
+    EXPECT_EQUAL(compact.getNumBins(), hist.getNumBins());
+    EXPECT_EQUAL(compact.getNumBins(), 4);
+    for(uint64_t val : {5, 6, 7, 8, 9, 10, 20, 15, 18, 4, 45, 9, 0, 21}) {
+        hist.addValue(val);
+        compact.addValue(val);
+    }
+
+    EXPECT_EQUAL(compact.getUnderflowBin(), 2);
+    EXPECT_EQUAL(compact.getOverflowBin(), 2);
+    EXPECT_EQUAL(compact.getAggValues(), 14);
+    EXPECT_EQUAL(compact.getUnderflowBin(), hist.getUnderflowBin().get());
+    EXPECT_EQUAL(compact.getOverflowBin(), hist.getOverflowBin().get());
+    EXPECT_EQUAL(compact.getAggValues(), hist.getAggValues().get());
+    for(uint32_t i = 0; i < compact.getNumBins(); ++i) {
+        EXPECT_EQUAL(compact.getBinCount(i), hist.getRegularBin()[i].get());
+        EXPECT_EQUAL(compact.getRegularBin()[i].get(), compact.getBinCount(i));
+    }
+    EXPECT_EQUAL(compact.getStandardDeviation(), hist.getStandardDeviation());
+    EXPECT_EQUAL(compact.getMeanBinCount(), hist.getMeanBinCount());
+    EXPECT_EQUAL(compact.getUnderflowProbability(), hist.getUnderflowProbability());
+    EXPECT_TRUE(compact.recomputeRegularBinProbabilities() == hist.recomputeRegularBinProbabilities());
+    EXPECT_THROW(compact.getBinCount(compact.getNumBins()));
+
+    // Same stats under the same names
+    std::vector<sparta::TreeNode*> hist_stats, compact_stats;
+    hist.findChildren("stats.*", hist_stats);
+    compact.findChildren("stats.*", compact_stats);
+    EXPECT_EQUAL(compact_stats.size(), hist_stats.size());
+    for(uint32_t i = 0; i < std::min(hist_stats.size(), compact_stats.size()); ++i) {
+        EXPECT_EQUAL(compact_stats[i]->getName(), hist_stats[i]->getName());
+        auto hist_ctr = dynamic_cast<sparta::CounterBase*>(hist_stats[i]);
+        auto compact_ctr = dynamic_cast<sparta::CounterBase*>(compact_stats[i]);
+        EXPECT_EQUAL(hist_ctr == nullptr, compact_ctr == nullptr);
+        if(hist_ctr && compact_ctr) {
+            EXPECT_EQUAL(compact_ctr->get(), hist_ctr->get());
+        }
+    }
+    EXPECT_EQUAL(compact.getChildAs<sparta::CounterBase>("stats.maxval2")->get(), 45);
+    EXPECT_EQUAL(compact.getChildAs<sparta::CounterBase>("stats.bin_5_8")->get(), 4);
+
+    root.enterTeardown();
+}
+
+void testAddValueThroughput()
+{
+    sparta::RootTreeNode root("top");
+    std::vector<std::unique_ptr<sparta::HistogramTreeNode>> hists;
+    std::vector<std::unique_ptr<sparta::CompactHistogramTreeNode>> compacts;
+    for(uint32_t i = 0; i < NUM_HISTOGRAMS; ++i) {
+        hists.emplace_back(new sparta::HistogramTreeNode(&root, "hist" + std::to_string(i), "Latency",
+                                                         LOWER_VAL, UPPER_VAL, VALS_PER_BIN));
+        compacts.emplace_back(new sparta::CompactHistogramTreeNode(&root, "compact" + std::to_string(i), "Latency",
+                                                                   LOWER_VAL, UPPER_VAL, VALS_PER_BIN));
+    }
+
+    // Latency-like values: mostly short, with a long tail running into
+    // the overflow bin
+    std::mt19937_64 gen(0xb1f);
+    std::geometric_distribution<uint64_t> dist(1.0 / 200);
+    std::vector<uint64_t> values(NUM_VALUES);
+    for(auto & v : values) {
+        v = dist(gen);
+    }
+
+    const uint32_t num_passes = sparta::perf::problemSize(64u, 1u);
+    const double hist_time = fill(hists, values, num_passes);
+    const double compact_time = fill(compacts, values, num_passes);
+
+    for(uint32_t i = 0; i < NUM_HISTOGRAMS; ++i) {
+        EXPECT_EQUAL(compacts[i]->getAggValues(), hists[i]->getAggValues().get());
+        EXPECT_EQUAL(compacts[i]->getUnderflowBin(), hists[i]->getUnderflowBin().get());
+        EXPECT_EQUAL(compacts[i]->getOverflowBin(), hists[i]->getOverflowBin().get());
+    }
+    for(uint32_t b = 0; b < compacts.front()->getNumBins(); ++b) {
+        EXPECT_EQUAL(compacts.front()->getBinCount(b), hists.front()->getRegularBin()[b].get());
+    }
+    EXPECT_TRUE(compacts.front()->getOverflowBin() > 0);
+    EXPECT_TRUE(compacts.front()->getUnderflowBin() > 0);
+
+    if(sparta::perf::isTimingEnabled()) {
+        const double num_adds = double(num_passes) * NUM_VALUES * NUM_HISTOGRAMS;
+        std::cout << NUM_HISTOGRAMS << " histograms of " << hists.front()->getNumBins() << " bins"
+                  << "\naddValue throughput (" << num_adds << " values):"
+                  << "\n\tHistogramTreeNode        : " << num_adds / hist_time / 1e6 << " M/s"
+                  << "\n\tCompactHistogramTreeNode : " << num_adds / compact_time / 1e6 << " M/s"
+                  << std::endl;
+    }
+
+    root.enterTeardown();
+}
+
+int main()
+{
+    testCompactMatchesHistogram();
+    testAddValueThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,182 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "sparta/sparta.hpp"
+#include "sparta/log/AsyncWriter.hpp"
+#include "sparta/log/Destination.hpp"
+#include "sparta/log/MessageSource.hpp"
+#include "sparta/log/Tap.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file AsyncLogPerf.cpp
+ * \brief Synchronous and asynchronous log file destinations
+ *
+ * The same messages go to a destination that writes and flushes each
+ * message and to one that hands blocks to a background thread, and the
+ * two files must match, including messages straddling a block.  Buffered
+ * messages must reach the file on flush, when the destination is made
+ * synchronous and on destruction, write errors must be rethrown, and
+ * DestinationManager must create asynchronous destinations when asked to.
+ */
+
+TEST_INIT
+
+namespace
+{
+    std::string readFile(const std::string & filename) {
+        std::ifstream in(filename);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    //! Messages in a log file, without the header (which has timestamps)
+    std::string readMessages(const std::string & filename) {
+        std::ifstream in(filename);
+        std::string line, messages;
+        while(std::getline(in, line)) {
+            if(line.empty() || line[0] != '#') {
+                messages += line + "\n";
+            }
+        }
+        return messages;
+    }
+}
+
+void testAsyncWriter()
+{
+    std::ostringstream out;
+    std::string expected;
+    {
+        // Tiny blocks, so that most messages cross a block boundary
+        sparta::log::AsyncWriter writer(out, 16);
+        for(uint32_t i = 0; i < 1000; ++i) {
+            writer.getStream() << "message " << i << " of a block of messages" << std::endl;
+            writer.endMessage();
+            expected += "message " + std::to_string(i) + " of a block of messages\n";
+            if(i == 500) {
+                writer.flush();
+                EXPECT_EQUAL(out.str(), expected);
+            }
+        }
+    }
+    // Destruction writes everything
+    EXPECT_EQUAL(out.str(), expected);
+
+    // Failed writes by the I/O thread are rethrown
+    std::ofstream unwritable("no_such_directory/async_writer.log");
+    EXPECT_FALSE(unwritable.is_open());
+    {
+        sparta::log::AsyncWriter writer(unwritable, 16);
+        writer.getStream() << "message to a file which could not be opened" << std::endl;
+        writer.endMessage();
+        EXPECT_THROW(writer.flush());
+    }
+
+    // As is a failed flush of the output stream
+    std::ofstream full("/dev/full");
+    EXPECT_TRUE(full.is_open());
+    {
+        sparta::log::AsyncWriter writer(full, 1024);
+        writer.getStream() << "message to a full device" << std::endl;
+        writer.endMessage();
+        EXPECT_THROW(writer.flush());
+    }
+}
+
+void testAsyncDestination()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode a(&top, "a", "A node");
+    sparta::log::MessageSource src(&a, "async_test", "Messages for the async test");
+
+    sparta::log::Tap sync_tap(&top, "", "sync_out.log.basic");
+    sparta::log::Tap async_tap(&top, "", "async_out.log.basic");
+    sparta::log::Destination * async_dest = async_tap.getDestination();
+    EXPECT_FALSE(async_dest->isAsynchronous());
+    async_dest->setAsynchronous(true);
+    EXPECT_TRUE(async_dest->isAsynchronous());
+    EXPECT_FALSE(sync_tap.getDestination()->isAsynchronous());
+
+    const std::string header = readFile("async_out.log.basic");
+    for(uint32_t i = 0; i < 100; ++i) {
+        src << "Message " << i << " with a new\nline";
+    }
+    EXPECT_EQUAL(async_dest->getNumMessagesWritten(), 100);
+
+    // Nothing written until flushed
+    EXPECT_EQUAL(readFile("async_out.log.basic"), header);
+    async_dest->flush();
+    EXPECT_EQUAL(readMessages("async_out.log.basic"), readMessages("sync_out.log.basic"));
+
+    // Becoming synchronous writes everything
+    src << "Last asynchronous message";
+    async_dest->setAsynchronous(false);
+    EXPECT_FALSE(async_dest->isAsynchronous());
+    EXPECT_EQUAL(readMessages("async_out.log.basic"), readMessages("sync_out.log.basic"));
+    src << "Synchronous message";
+    EXPECT_EQUAL(readMessages("async_out.log.basic"), readMessages("sync_out.log.basic"));
+
+    // New destinations follow the manager
+    sparta::log::DestinationManager::setAsynchronous(true);
+    EXPECT_TRUE(async_dest->isAsynchronous());
+    EXPECT_FALSE(sparta::log::DestinationManager::getDestination(std::cout)->isAsynchronous());
+    sparta::log::Tap new_tap(&top, "", "new_out.log.basic");
+    EXPECT_TRUE(new_tap.getDestination()->isAsynchronous());
+    src << "Message to every destination";
+    sparta::log::DestinationManager::flushDestinations();
+    EXPECT_EQUAL(readMessages("async_out.log.basic"), readMessages("sync_out.log.basic"));
+    sparta::log::DestinationManager::setAsynchronous(false);
+    EXPECT_FALSE(new_tap.getDestination()->isAsynchronous());
+
+    top.enterTeardown();
+}
+
+void testThroughput()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode a(&top, "a", "A node");
+    sparta::log::MessageSource src(&a, "throughput", "Messages for the throughput test");
+
+    const uint32_t num_messages = sparta::perf::problemSize(200000u, 2000u);
+    double times[2];
+    const std::string files[2] = {"sync_perf.log", "async_perf.log"};
+    for(uint32_t async = 0; async < 2; ++async) {
+        sparta::log::Tap tap(&top, "", files[async]);
+        tap.getDestination()->setAsynchronous(async);
+
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num_messages; ++i) {
+            src << "Message number " << i << " from the throughput test";
+        }
+        tap.getDestination()->flush();
+        times[async] = sparta::perf::secondsSince(start);
+        tap.detach();
+    }
+    EXPECT_EQUAL(readMessages(files[0]), readMessages(files[1]));
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Logging " << num_messages << " messages to a file:"
+                  << "\n\tsynchronous : " << times[0] << " s"
+                  << "\n\tasynchronous: " << times[1] << " s" << std::endl;
+    }
+
+    top.enterTeardown();
+}
+
+int main()
+{
+    testAsyncWriter();
+    testAsyncDestination();
+    testThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
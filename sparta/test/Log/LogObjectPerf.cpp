@@ -0,0 +1,197 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "sparta/sparta.hpp"
+#include "sparta/log/Destination.hpp"
+#include "sparta/log/MessageSource.hpp"
+#include "sparta/log/Tap.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file LogObjectPerf.cpp
+ * \brief Formatting log messages into pooled buffers
+ *
+ * MessageSource::LogObject formats into a reused buffer.  Short messages
+ * must all land in the same buffer, while long, nested and moved messages
+ * still come out intact and exactly once, manipulators must not leak into
+ * the next message, and fmt-style "{}" fields must be substituted and
+ * "{{" escaped.  The comparison with an std::ostringstream per message is
+ * only timed with SPARTA_PERF_TESTS.
+ */
+
+TEST_INIT
+
+namespace
+{
+    //! Observes the messages of a message source
+    struct Observer
+    {
+        Observer(sparta::log::MessageSource & src, bool keep_content) :
+            node(src.getParent()),
+            category(src.getCategoryName()),
+            keep_content(keep_content)
+        {
+            node->REGISTER_FOR_NOTIFICATION(onMessage, sparta::log::Message, category);
+        }
+
+        ~Observer() {
+            node->DEREGISTER_FOR_NOTIFICATION(onMessage, sparta::log::Message, category);
+        }
+
+        void onMessage(const sparta::log::Message & msg) {
+            if(keep_content) {
+                content = msg.content;
+            }
+            num_chars += msg.content.size();
+            data = msg.content.data();
+            ++count;
+        }
+
+        sparta::TreeNode * node;
+        const std::string category;
+        const bool keep_content;
+        std::string content;
+        const char * data = nullptr;
+        uint64_t num_chars = 0;
+        uint32_t count = 0;
+    };
+
+    //! Logs a message of its own while being written to another message
+    struct Nested
+    {
+        sparta::log::MessageSource & src;
+    };
+
+    std::ostream & operator<<(std::ostream & o, const Nested & n) {
+        n.src << "nested " << 7;
+        return o << "outer";
+    }
+}
+
+void testFormatting()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode a(&top, "a", "A node");
+    sparta::log::MessageSource src(&a, "fmt_test", "Messages for the formatting test");
+    sparta::log::MessageSource other(&a, "other_test", "Messages logged while formatting");
+    Observer last(src, true);
+    Observer last_other(other, true);
+
+    src << "value " << 42 << ' ' << 1.5;
+    EXPECT_EQUAL(last.content, "value 42 1.5");
+
+    // Manipulators only apply to their own message
+    src << std::hex << std::setw(6) << std::setfill('0') << 255 << std::setprecision(2) << ' ' << 3.14159;
+    EXPECT_EQUAL(last.content, "0000ff 3.1");
+    src << 255 << ' ' << std::setw(4) << 1 << ' ' << 3.14159;
+    EXPECT_EQUAL(last.content, "255    1 3.14159");
+
+    // Longer than the message buffer
+    const std::string long_text(sparta::log::MessageBuffer::getSize() * 3 + 17, 'x');
+    src << "long " << long_text << " end";
+    EXPECT_EQUAL(last.content, "long " + long_text + " end");
+    src << "short again";
+    EXPECT_EQUAL(last.content, "short again");
+
+    // A message logged while formatting another one
+    src << "before " << Nested{other} << " after";
+    EXPECT_EQUAL(last.content, "before outer after");
+    EXPECT_EQUAL(last_other.content, "nested 7");
+
+    // Moved LogObjects emit once
+    {
+        sparta::log::MessageSource::LogObject msg(src);
+        msg << "moved";
+        const uint32_t count = last.count;
+        {
+            sparta::log::MessageSource::LogObject moved(std::move(msg));
+            moved << " message";
+        }
+        EXPECT_EQUAL(last.count, count + 1);
+        EXPECT_EQUAL(last.content, "moved message");
+    }
+
+    // fmt-style formatting
+    src.format("uid={} name={} {{literal}} {}%", 12, "add", 99.5);
+    EXPECT_EQUAL(last.content, "uid=12 name=add {literal} 99.5%");
+    src.format("no fields");
+    EXPECT_EQUAL(last.content, "no fields");
+    (src << "a=").format("{}, b={}", 1, 2);
+    EXPECT_EQUAL(last.content, "a=1, b=2");
+    EXPECT_THROW(src.format("{} {}", 1));
+    EXPECT_THROW(src.format("{}", 1, 2));
+
+    top.enterTeardown();
+}
+
+void testBufferReuse()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode a(&top, "a", "A node");
+    sparta::log::MessageSource src(&a, "reuse_test", "Messages for the buffer reuse test");
+    Observer observer(src, false);
+
+    src << "first";
+    const char * const buffer = observer.data;
+    for(uint32_t i = 0; i < 1000; ++i) {
+        src << "uid=" << i << " pc=0x" << std::hex << i * 4 << " op=" << "add r1, r2, r3";
+        EXPECT_EQUAL(observer.data, buffer);
+        src.format("uid={} retired at {}", i, 1.25 * i);
+        EXPECT_EQUAL(observer.data, buffer);
+    }
+
+    top.enterTeardown();
+}
+
+void testThroughput()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode a(&top, "a", "A node");
+    sparta::log::MessageSource src(&a, "throughput", "Messages for the throughput test");
+    Observer observer(src, false);
+    const uint32_t num_messages = sparta::perf::problemSize(500000u, 5000u);
+
+    // Each message formatted in an ostringstream first, as pevent
+    // collectors used to
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < num_messages; ++i) {
+        std::stringstream ss;
+        ss << "ev=\"RETIRE\" uid=\"" << i << "\" pc=\"" << i * 4 << "\" cyc=" << i * 3 << ";";
+        src << ss.str();
+    }
+    const double stream_time = sparta::perf::secondsSince(start);
+    const uint64_t stream_chars = observer.num_chars;
+
+    start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < num_messages; ++i) {
+        sparta::log::MessageSource::LogObject msg(src);
+        msg << "ev=\"RETIRE\" uid=\"" << i << "\" pc=\"" << i * 4 << "\" cyc=" << i * 3 << ";";
+    }
+    const double log_object_time = sparta::perf::secondsSince(start);
+    EXPECT_EQUAL(observer.num_chars - stream_chars, stream_chars);
+    EXPECT_EQUAL(observer.count, 2 * num_messages);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Formatting " << num_messages << " messages:"
+                  << "\n\tstd::stringstream per message: " << stream_time << " s"
+                  << "\n\tpooled LogObject buffer      : " << log_object_time << " s" << std::endl;
+    }
+
+    top.enterTeardown();
+}
+
+int main()
+{
+    testFormatting();
+    testBufferReuse();
+    testThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
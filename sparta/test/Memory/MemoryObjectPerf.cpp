@@ -0,0 +1,222 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/memory/MemoryObject.hpp"
+#include "sparta/serialization/checkpoint/FastCheckpointer.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file MemoryObjectPerf.cpp
+ * \brief MemoryObject page table against its sparse line map
+ *
+ * Random and strided 8 byte accesses through either path must read back
+ * the same data and realize the same blocks.  Unrealized blocks read as
+ * the fill value without being realized, spanning and out-of-range
+ * accesses are still validated, page table pages only appear on access,
+ * and a FastCheckpointer restores writes made through the page table,
+ * including writes made after a restore.
+ */
+
+TEST_INIT
+
+namespace
+{
+    using sparta::memory::addr_t;
+    using sparta::memory::MemoryObject;
+    using sparta::serialization::checkpoint::FastCheckpointer;
+
+    constexpr addr_t BLOCK_SIZE = 64;
+    constexpr addr_t MEM_SIZE = 64 * 1024 * 1024;
+    constexpr addr_t STRIDE = 8;
+
+    //! Seconds taken to write one value at each address
+    double timeWrites(MemoryObject & mem, const std::vector<addr_t> & addrs) {
+        const auto start = std::chrono::steady_clock::now();
+        for(const addr_t addr : addrs) {
+            const uint64_t val = addr * 3;
+            mem.write(addr, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+        }
+        return sparta::perf::secondsSince(start);
+    }
+
+    //! Seconds taken to read the value at each address, and the sum of the
+    //! values read
+    double timeReads(const MemoryObject & mem, const std::vector<addr_t> & addrs, uint64_t & sum) {
+        const auto start = std::chrono::steady_clock::now();
+        for(const addr_t addr : addrs) {
+            uint64_t val;
+            mem.read(addr, sizeof(val), reinterpret_cast<uint8_t*>(&val));
+            sum += val;
+        }
+        return sparta::perf::secondsSince(start);
+    }
+
+    uint64_t readValue(const MemoryObject & mem, addr_t addr) {
+        uint64_t val = 0;
+        mem.read(addr, sizeof(val), reinterpret_cast<uint8_t*>(&val));
+        return val;
+    }
+
+    void writeValue(MemoryObject & mem, addr_t addr, uint64_t val) {
+        mem.write(addr, sizeof(val), reinterpret_cast<const uint8_t*>(&val));
+    }
+}
+
+void testThroughput()
+{
+    const uint32_t num_accesses = sparta::perf::problemSize(4000000u, 20000u);
+    std::mt19937_64 rng(0x9a6e);
+    std::vector<addr_t> random_addrs(num_accesses);
+    for(auto & addr : random_addrs) {
+        addr = (rng() % MEM_SIZE) & ~(STRIDE - 1);
+    }
+    std::vector<addr_t> strided_addrs(num_accesses);
+    for(uint32_t i = 0; i < num_accesses; ++i) {
+        strided_addrs[i] = (i * STRIDE) % MEM_SIZE;
+    }
+
+    double times[2][4];
+    uint64_t sums[2] = {0, 0};
+    addr_t num_lines[2];
+    for(uint32_t paged = 0; paged < 2; ++paged) {
+        MemoryObject mem(nullptr, BLOCK_SIZE, MEM_SIZE);
+        mem.setPageTableEnabled(paged);
+        EXPECT_EQUAL(mem.isPageTableEnabled(), paged == 1);
+
+        times[paged][0] = timeWrites(mem, random_addrs);
+        times[paged][1] = timeReads(mem, random_addrs, sums[paged]);
+        times[paged][2] = timeWrites(mem, strided_addrs);
+        times[paged][3] = timeReads(mem, strided_addrs, sums[paged]);
+        num_lines[paged] = mem.getNumAllocatedLines();
+    }
+    EXPECT_EQUAL(sums[0], sums[1]);
+    EXPECT_EQUAL(num_lines[0], num_lines[1]);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << num_accesses << " 8 B accesses to " << MEM_SIZE / (1024 * 1024) << " MB of "
+                  << BLOCK_SIZE << " B blocks:"
+                  << "\n\trandom write : line map " << times[0][0] << " s, page table " << times[1][0] << " s"
+                  << "\n\trandom read  : line map " << times[0][1] << " s, page table " << times[1][1] << " s"
+                  << "\n\tstrided write: line map " << times[0][2] << " s, page table " << times[1][2] << " s"
+                  << "\n\tstrided read : line map " << times[0][3] << " s, page table " << times[1][3] << " s"
+                  << std::endl;
+    }
+}
+
+void testAccesses()
+{
+    MemoryObject mem(nullptr, BLOCK_SIZE, MEM_SIZE, 0xab, 1);
+    mem.setPageTableEnabled(true);
+    EXPECT_EQUAL(mem.getNumPageTablePages(), 0);
+
+    // Reading unrealized blocks does not realize them
+    EXPECT_EQUAL(readValue(mem, 0x1000), 0xababababababababull);
+    EXPECT_EQUAL(mem.getNumAllocatedLines(), 0);
+    EXPECT_EQUAL(mem.getNumPageTablePages(), 1);
+
+    writeValue(mem, 0x1008, 0x1122334455667788ull);
+    EXPECT_EQUAL(readValue(mem, 0x1008), 0x1122334455667788ull);
+    EXPECT_EQUAL(readValue(mem, 0x1000), 0xababababababababull);
+    EXPECT_EQUAL(mem.getNumAllocatedLines(), 1);
+
+    // Blocks at the end of the object
+    writeValue(mem, MEM_SIZE - 8, 42);
+    EXPECT_EQUAL(readValue(mem, MEM_SIZE - 8), 42);
+    EXPECT_EQUAL(mem.getNumPageTablePages(), 2);
+
+    // Spanning and out-of-range accesses take the validating path
+    EXPECT_THROW(writeValue(mem, BLOCK_SIZE - 4, 0));
+    EXPECT_THROW(readValue(mem, MEM_SIZE - 4));
+    EXPECT_THROW(writeValue(mem, MEM_SIZE, 0));
+    EXPECT_THROW(readValue(mem, MEM_SIZE + BLOCK_SIZE));
+
+    // Data stays in place when the page table is disabled
+    mem.setPageTableEnabled(false);
+    EXPECT_FALSE(mem.isPageTableEnabled());
+    EXPECT_EQUAL(mem.getNumPageTablePages(), 0);
+    EXPECT_EQUAL(readValue(mem, 0x1008), 0x1122334455667788ull);
+
+    // Cleaning frees the lines and drops the page table
+    mem.setPageTableEnabled(true);
+    writeValue(mem, 0x2000, 7);
+    mem.clean();
+    EXPECT_EQUAL(mem.getNumPageTablePages(), 0);
+    EXPECT_EQUAL(readValue(mem, 0x2000), 0xababababababababull);
+    writeValue(mem, 0x2000, 8);
+    EXPECT_EQUAL(readValue(mem, 0x2000), 8);
+
+    // Too many pages for the directory
+    MemoryObject huge(nullptr, BLOCK_SIZE, addr_t(1) << 48);
+    EXPECT_THROW(huge.setPageTableEnabled(true));
+    EXPECT_FALSE(huge.isPageTableEnabled());
+}
+
+void testCheckpoint()
+{
+    sparta::Scheduler sched;
+    sparta::RootTreeNode clocks("clocks");
+    sparta::Clock clk(&clocks, "clock", &sched);
+
+    sparta::RootTreeNode root;
+    sparta::TreeNode dummy(&root, "dummy", "dummy node");
+    MemoryObject mem(&dummy, BLOCK_SIZE, MEM_SIZE);
+    mem.setPageTableEnabled(true);
+
+    FastCheckpointer fcp(root, &sched);
+    root.enterConfiguring();
+    root.enterFinalized();
+    sched.finalize();
+
+    writeValue(mem, 0x0, 1);
+    writeValue(mem, 0x100000, 2);
+    fcp.createHead();
+
+    writeValue(mem, 0x0, 3);
+    writeValue(mem, 0x200000, 4);
+    sched.run(1, true, false);
+    const auto first = fcp.createCheckpoint();
+
+    writeValue(mem, 0x100000, 5);
+    sched.run(1, true, false);
+    const auto second = fcp.createCheckpoint();
+
+    fcp.loadCheckpoint(first);
+    EXPECT_EQUAL(readValue(mem, 0x0), 3);
+    EXPECT_EQUAL(readValue(mem, 0x100000), 2);
+    EXPECT_EQUAL(readValue(mem, 0x200000), 4);
+
+    // Writes after a restore land in the restored lines and are saved
+    writeValue(mem, 0x200000, 6);
+    sched.run(1, true, false);
+    const auto branch = fcp.createCheckpoint();
+
+    fcp.loadCheckpoint(second);
+    EXPECT_EQUAL(readValue(mem, 0x100000), 5);
+    EXPECT_EQUAL(readValue(mem, 0x200000), 4);
+
+    fcp.loadCheckpoint(branch);
+    EXPECT_EQUAL(readValue(mem, 0x0), 3);
+    EXPECT_EQUAL(readValue(mem, 0x100000), 2);
+    EXPECT_EQUAL(readValue(mem, 0x200000), 6);
+
+    root.enterTeardown();
+    clocks.enterTeardown();
+}
+
+int main()
+{
+    testThroughput();
+    testAccesses();
+    testCheckpoint();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
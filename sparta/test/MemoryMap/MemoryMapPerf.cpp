@@ -0,0 +1,217 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/memory/SimpleMemoryMapNode.hpp"
+#include "sparta/memory/MemoryObject.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file MemoryMapPerf.cpp
+ * \brief Compiled lookups of SimpleMemoryMap
+ *
+ * Random, strided and unmapped addresses are looked up through the
+ * red-black tree and through the compiled lookup, with mappings packed for
+ * a direct page table and spread over the address space, and must map to
+ * the same destination.  Also covers mappings added after compile(),
+ * verifyHasMapping on a compiled map, SimpleMemoryMapNode compiling when
+ * the tree is bound, and DMI interfaces reused within a block.
+ */
+
+TEST_INIT
+
+namespace
+{
+    using sparta::memory::addr_t;
+    using sparta::memory::SimpleMemoryMap;
+
+    constexpr addr_t BLOCK_SIZE = 64;
+    constexpr addr_t REGION_SIZE = 0x1000;
+    constexpr uint32_t NUM_REGIONS = 512;
+    constexpr addr_t STRIDE = 8;
+
+    //! Destination shared by every mapping
+    struct Memory
+    {
+        Memory() :
+            obj(nullptr, BLOCK_SIZE, 2 * REGION_SIZE),
+            memif(&root, "mem", "Mapping destination", nullptr, obj)
+        { }
+
+        ~Memory() {
+            if(!root.isTearingDown()) {
+                root.enterTeardown();
+            }
+        }
+
+        sparta::RootTreeNode root;
+        sparta::memory::MemoryObject obj;
+        sparta::memory::BlockingMemoryObjectIFNode memif;
+    };
+
+    //! Adds NUM_REGIONS mappings, one every region_stride bytes, in a
+    //! shuffled order
+    void addRegions(SimpleMemoryMap & map, Memory & mem, addr_t region_stride) {
+        std::vector<uint32_t> order(NUM_REGIONS);
+        for(uint32_t i = 0; i < NUM_REGIONS; ++i) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(0x5eed));
+        for(const uint32_t i : order) {
+            const addr_t start = region_stride * i + region_stride / 2;
+            map.addMapping(start, start + REGION_SIZE, &mem.memif, (i % 4) * BLOCK_SIZE);
+        }
+    }
+
+    //! Number of addresses for which both maps agree
+    uint32_t countMatches(const SimpleMemoryMap & tree, const SimpleMemoryMap & flat,
+                          const std::vector<addr_t> & addrs) {
+        uint32_t matches = 0;
+        for(const addr_t addr : addrs) {
+            matches += (tree.mapAddress(addr) == flat.mapAddress(addr))
+                && (tree.findMapping(addr) == nullptr) == (flat.findMapping(addr) == nullptr);
+        }
+        return matches;
+    }
+
+    //! Seconds taken to map every address, and the sum of the mapped addresses
+    double timeLookups(const SimpleMemoryMap & map, const std::vector<addr_t> & addrs, addr_t & sum) {
+        const auto start = std::chrono::steady_clock::now();
+        for(const addr_t addr : addrs) {
+            sum += map.mapAddress(addr).second;
+        }
+        return sparta::perf::secondsSince(start);
+    }
+}
+
+//! Compares the tree and compiled lookups with mappings every region_stride
+//! bytes
+void testLookups(const char * name, addr_t region_stride, bool expect_page_table)
+{
+    Memory mem;
+    SimpleMemoryMap tree(BLOCK_SIZE);
+    SimpleMemoryMap flat(BLOCK_SIZE);
+    addRegions(tree, mem, region_stride);
+    addRegions(flat, mem, region_stride);
+    EXPECT_FALSE(tree.isCompiled());
+    flat.compile();
+    EXPECT_TRUE(flat.isCompiled());
+    EXPECT_EQUAL(flat.hasDirectPageTable(), expect_page_table);
+
+    const uint32_t num_lookups = sparta::perf::problemSize(2000000u, 20000u);
+    const addr_t span = region_stride * NUM_REGIONS;
+    std::mt19937_64 rng(0xadd7);
+    std::vector<addr_t> random_addrs(num_lookups);
+    for(auto & addr : random_addrs) {
+        addr = rng() % (span + region_stride);
+    }
+    // Walks through the mapped regions only
+    std::vector<addr_t> strided_addrs(num_lookups);
+    for(uint32_t i = 0; i < num_lookups; ++i) {
+        const addr_t offset = (i * STRIDE) % (NUM_REGIONS * REGION_SIZE);
+        strided_addrs[i] = region_stride * (offset / REGION_SIZE) + region_stride / 2 + offset % REGION_SIZE;
+    }
+
+    EXPECT_EQUAL(countMatches(tree, flat, random_addrs), num_lookups);
+    EXPECT_EQUAL(countMatches(tree, flat, strided_addrs), num_lookups);
+    for(const addr_t addr : {addr_t(0), region_stride / 2 - 1, region_stride / 2,
+                             region_stride / 2 + REGION_SIZE, span - region_stride / 2 + REGION_SIZE,
+                             ~addr_t(0)}) {
+        EXPECT_TRUE(tree.mapAddress(addr) == flat.mapAddress(addr));
+    }
+
+    addr_t sums[2] = {0, 0};
+    const double tree_random = timeLookups(tree, random_addrs, sums[0]);
+    const double flat_random = timeLookups(flat, random_addrs, sums[1]);
+    const double tree_strided = timeLookups(tree, strided_addrs, sums[0]);
+    const double flat_strided = timeLookups(flat, strided_addrs, sums[1]);
+    EXPECT_EQUAL(sums[0], sums[1]);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << num_lookups << " lookups in " << NUM_REGIONS << " " << name << " mappings:"
+                  << "\n\trandom : tree " << tree_random << " s, compiled " << flat_random << " s"
+                  << "\n\tstrided: tree " << tree_strided << " s, compiled " << flat_strided << " s"
+                  << std::endl;
+    }
+}
+
+//! Mappings added after compile() and accesses checked by verifyHasMapping
+void testRecompile()
+{
+    Memory mem;
+    SimpleMemoryMap map(BLOCK_SIZE);
+    map.compile();
+    EXPECT_EQUAL(map.findMapping(0x0), nullptr);
+    EXPECT_FALSE(map.hasDirectPageTable());
+
+    map.addMapping(0x0, 0x40, &mem.memif, 0x40);
+    map.addMapping(0x1000, 0x2000, &mem.memif, 0x0);
+    map.addMapping(0x2000, 0x2040, &mem.memif, 0x80);
+    EXPECT_TRUE(map.hasDirectPageTable());
+    EXPECT_EQUAL(map.mapAddress(0x3f).second, 0x7f);
+    EXPECT_EQUAL(map.mapAddress(0x40).first, nullptr);
+    EXPECT_EQUAL(map.mapAddress(0xfff).first, nullptr);
+    EXPECT_EQUAL(map.mapAddress(0x1000).second, 0x0);
+    EXPECT_EQUAL(map.mapAddress(0x1fff).second, 0xfff);
+    EXPECT_EQUAL(map.mapAddress(0x2000).second, 0x80);
+    EXPECT_EQUAL(map.mapAddress(0x2040).first, nullptr);
+    EXPECT_NOTEQUAL(map.findMapping(0x1fff), map.findMapping(0x2000));
+
+    // Far enough away to drop the page table
+    map.addMapping(0x100000000, 0x100001000, &mem.memif, 0x0);
+    EXPECT_FALSE(map.hasDirectPageTable());
+    EXPECT_EQUAL(map.mapAddress(0x100000fff).second, 0xfff);
+    EXPECT_EQUAL(map.mapAddress(0x100001000).first, nullptr);
+    EXPECT_EQUAL(map.mapAddress(0x2000).second, 0x80);
+
+    EXPECT_NOTHROW(map.verifyHasMapping(0x1ff0, 0x10));
+    EXPECT_THROW(map.verifyHasMapping(0x1ff0, 0x20)); // Spans two mappings
+    EXPECT_THROW(map.verifyHasMapping(0x40, 0x4));    // Unmapped
+}
+
+//! SimpleMemoryMapNode compiles when the tree is bound and hands out DMI interfaces
+void testNode()
+{
+    Memory mem;
+    sparta::memory::SimpleMemoryMapNode mmap(&mem.root, "map", "Compiled map", BLOCK_SIZE, 0x10000);
+    mmap.addMapping(0x8000, 0x9000, &mem.memif, 0x0);
+    EXPECT_FALSE(mmap.isCompiled());
+
+    mem.root.enterConfiguring();
+    mem.root.enterFinalized();
+    mem.root.bindTreeEarly();
+    mem.root.bindTreeLate();
+    EXPECT_TRUE(mmap.isCompiled());
+    EXPECT_EQUAL(mmap.findInterface(0x8040), &mem.memif);
+    EXPECT_EQUAL(mmap.findInterface(0x9000), nullptr);
+
+    const uint8_t dat[4] = {1, 2, 3, 4};
+    uint8_t buf[4] = {0, 0, 0, 0};
+    mmap.write(0x8044, 4, dat);
+    mem.memif.read(0x44, 4, buf);
+    EXPECT_EQUAL(buf[3], 4);
+
+    sparta::memory::DMIBlockingMemoryIF * dmi = mmap.getDMI(0x8040, BLOCK_SIZE);
+    EXPECT_NOTEQUAL(dmi, nullptr);
+    EXPECT_EQUAL(mmap.getDMI(0x8040, 4), dmi);
+    EXPECT_NOTEQUAL(mmap.getDMI(0x8080, 4), dmi);
+    EXPECT_EQUAL(mmap.getDMI(0x9000, 4), nullptr);
+
+    mem.root.enterTeardown();
+}
+
+int main()
+{
+    testLookups("dense", 0x2000, true);
+    testLookups("sparse", 0x100000000, false);
+    testRecompile();
+    testNode();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
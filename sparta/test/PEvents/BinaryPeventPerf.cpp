@@ -0,0 +1,234 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "sparta/sparta.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/pevents/BinaryPevents.hpp"
+#include "sparta/pevents/PeventCollector.hpp"
+#include "sparta/pevents/PeventController.hpp"
+#include "sparta/pevents/PeventTrigger.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file BinaryPeventPerf.cpp
+ * \brief Binary pevent collection and conversion to text
+ *
+ * Converting a binary pevent file to each log text format must reproduce
+ * what log taps write, for collectors with and without a node clock, for
+ * hex, octal, negative, string and positional pairs, and for unique
+ * strings past the interned string limit.  The binary file must be the
+ * smaller one, and malformed files and unsupported formats are rejected.
+ */
+
+TEST_INIT
+
+namespace
+{
+    //! Lines of a pevent file, without the header (which has timestamps)
+    std::string readMessages(const std::string & filename) {
+        std::ifstream in(filename);
+        std::string line, messages;
+        while(std::getline(in, line)) {
+            if(line.empty() || line[0] != '#') {
+                messages += line + "\n";
+            }
+        }
+        return messages;
+    }
+
+    uint64_t fileSize(const std::string & filename) {
+        std::ifstream in(filename, std::ifstream::ate | std::ifstream::binary);
+        return in.tellg();
+    }
+
+    const char * const OPCODES[] = {"add", "sub", "lw", "sw", "beq", "jal", "mul", "div"};
+
+    class Inst
+    {
+    public:
+        Inst(uint64_t uid) :
+            uid_(uid),
+            pc_(0x80000000 + uid * 4),
+            opcode_(OPCODES[uid % 8]),
+            latency_(uid % 5 + 1)
+        { }
+
+        uint64_t getUid() const { return uid_; }
+        uint64_t getPC() const { return pc_; }
+        uint32_t getLatency() const { return latency_; }
+        int32_t getDelta() const { return static_cast<int32_t>(uid_ % 7) - 3; }
+        std::string getOpcode() const { return opcode_; }
+        std::string getDisasm() const { return opcode_ + " r" + std::to_string(uid_ % 32); }
+        std::string getTag() const { return "t" + std::to_string(uid_); }
+
+    private:
+        const uint64_t uid_;
+        const uint64_t pc_;
+        const std::string opcode_;
+        const uint32_t latency_;
+    };
+
+    class InstPairs : public sparta::PairDefinition<Inst>
+    {
+    public:
+        using TypeCollected = Inst;
+
+        InstPairs() : sparta::PairDefinition<Inst>()
+        {
+            addPEventsPair("uid", &Inst::getUid);
+            addPEventsPair("pc", &Inst::getPC, std::ios_base::hex);
+            addPEventsPair("lat", &Inst::getLatency, std::ios_base::oct);
+            addPEventsPair("delta", &Inst::getDelta, std::ios_base::hex);
+            addPEventsPair("op", &Inst::getOpcode);
+            addPEventsPair("dasm", &Inst::getDisasm);
+            addPEventsPair("tag", &Inst::getTag);
+        }
+    };
+
+    //! A core with RETIRE and FLUSH pevents. FLUSH is collected on a node
+    //! without a clock
+    struct Core
+    {
+        Core() :
+            root("top"),
+            core(&root, "core0", "Core"),
+            lsu(nullptr, "lsu", "LSU without a clock"),
+            clk("clk", &sched),
+            retire("RETIRE", &core, &clk),
+            flush("FLUSH", &lsu, &clk)
+        {
+            core.setClock(&clk);
+            root.addChild(&lsu);
+            flush.addPositionalPairArg<uint32_t>("reason");
+            flush.adjustSkew(-1);
+        }
+
+        ~Core() {
+            root.enterTeardown();
+        }
+
+        //! Collect everything to the given files
+        void start(const std::vector<std::string> & files) {
+            root.enterConfiguring();
+            root.enterFinalized();
+            sched.finalize();
+            sparta::pevents::PeventCollectorController controller;
+            for(const auto & file : files) {
+                controller.cacheTap(file, "ALL", false);
+            }
+            controller.finalize(&root);
+            sparta::trigger::PeventTrigger trigger(&root);
+            trigger.go();
+            sched.run(1, true, false);
+        }
+
+        //! Retire num insts, flushing every 100
+        void run(uint64_t num) {
+            for(uint64_t uid = 0; uid < num; ++uid) {
+                Inst inst(uid);
+                retire.collect(inst);
+                if(uid % 100 == 99) {
+                    flush.collect(inst, uid % 3);
+                }
+                sched.run(1, true, false);
+            }
+        }
+
+        sparta::Scheduler sched;
+        sparta::RootTreeNode root;
+        sparta::TreeNode core;
+        sparta::TreeNode lsu;
+        sparta::Clock clk;
+        sparta::pevents::PeventCollector<InstPairs> retire;
+        sparta::pevents::PeventCollector<InstPairs> flush;
+    };
+}
+
+void testConversion()
+{
+    {
+        Core core;
+        core.start({"conv_out.log", "conv_out.log.basic", "conv_out.log.raw", "conv_out.bin"});
+        core.run(1000);
+        sparta::pevents::BinaryPeventWriter * writer =
+            sparta::pevents::BinaryPeventWriter::getWriter("conv_out.bin");
+        EXPECT_EQUAL(writer->getNumEventsWritten(), 1010);
+        writer->flush();
+    }
+
+    for(const std::string file : {"conv_out.log", "conv_out.log.basic", "conv_out.log.raw"}) {
+        const std::string converted = "conv_in" + file.substr(file.find('.'));
+        sparta::pevents::BinaryPeventReader::convert("conv_out.bin", converted);
+        const std::string expected = readMessages(file);
+        EXPECT_EQUAL(readMessages(converted), expected);
+        EXPECT_NOTEQUAL(expected.find("ev=\"FLUSH\""), std::string::npos);
+    }
+
+    // The header is kept
+    std::ifstream bin("conv_out.bin", std::ifstream::binary);
+    sparta::pevents::BinaryPeventReader reader(bin);
+    EXPECT_EQUAL(reader.getHeader().substr(0, 1), "#");
+    std::stringstream raw;
+    EXPECT_EQUAL(reader.convert(raw, sparta::pevents::BinaryPeventReader::TextFormat::RAW), 1010);
+    EXPECT_EQUAL(raw.str().substr(0, reader.getHeader().size()), reader.getHeader());
+
+    // Unsupported formats and malformed files
+    EXPECT_THROW(sparta::pevents::BinaryPeventReader::convert("conv_out.bin", "conv_in.log.verbose"));
+    EXPECT_THROW(sparta::pevents::BinaryPeventReader::convert("conv_out.log", "conv_in.log"));
+    std::ifstream full("conv_out.bin", std::ifstream::binary);
+    std::string truncated((std::istreambuf_iterator<char>(full)), std::istreambuf_iterator<char>());
+    truncated.resize(truncated.size() - 3);
+    std::stringstream truncated_in(truncated);
+    sparta::pevents::BinaryPeventReader truncated_reader(truncated_in);
+    std::stringstream discard;
+    EXPECT_THROW(truncated_reader.convert(discard, sparta::pevents::BinaryPeventReader::TextFormat::DEFAULT));
+}
+
+void testThroughput()
+{
+    const uint32_t num_events = sparta::perf::problemSize(500000u, 5000u);
+    double times[2];
+    const std::string files[2] = {"perf_out.log", "perf_out.bin"};
+    for(uint32_t binary = 0; binary < 2; ++binary) {
+        Core core;
+        core.start({files[binary]});
+        const auto start = std::chrono::steady_clock::now();
+        core.run(num_events);
+        if(binary) {
+            sparta::pevents::BinaryPeventWriter::getWriter(files[binary])->flush();
+        }
+        times[binary] = sparta::perf::secondsSince(start);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    sparta::pevents::BinaryPeventReader::convert("perf_out.bin", "perf_in.log");
+    const double convert_time = sparta::perf::secondsSince(start);
+    EXPECT_EQUAL(readMessages("perf_in.log"), readMessages("perf_out.log"));
+
+    const uint64_t text_size = fileSize("perf_out.log");
+    const uint64_t binary_size = fileSize("perf_out.bin");
+    EXPECT_TRUE(binary_size < text_size);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Collecting " << num_events << " RETIRE pevents:"
+                  << "\n\ttext log tap: " << times[0] << " s, " << text_size << " bytes"
+                  << "\n\tbinary      : " << times[1] << " s, " << binary_size << " bytes"
+                  << "\n\tconversion to text: " << convert_time << " s" << std::endl;
+    }
+}
+
+int main()
+{
+    testConversion();
+    testThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
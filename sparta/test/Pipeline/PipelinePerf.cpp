@@ -0,0 +1,220 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/resources/Pipeline.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file PipelinePerf.cpp
+ * \brief Mostly empty Pipelines and the valid-stage mask
+ *
+ * Counts the stage handler calls of many sparsely filled pipelines: each
+ * valid stage with handlers must be called once per cycle, both for
+ * pipelines short enough to use the valid-stage mask and for one too long
+ * for it.  A random mix of appends, stalls, flushes and handler
+ * (de)activations is then applied to a masked and an unmasked pipeline,
+ * whose handler logs must match.
+ */
+
+TEST_INIT
+
+namespace
+{
+    constexpr uint32_t NUM_PIPELINES = 32;
+    constexpr uint32_t NUM_RANDOM_CYCLES = 20000;
+    constexpr uint32_t SHORT_PIPELINE_STAGES = 16;
+    constexpr uint32_t LONG_PIPELINE_STAGES = 80; //!< Too long for the pipe valid mask
+
+    //! A clocked tree
+    struct Top
+    {
+        Top() :
+            clk("clk", &sched)
+        {
+            root.setClock(&clk);
+        }
+
+        ~Top() {
+            root.enterTeardown();
+        }
+
+        void finalize() {
+            sched.finalize();
+            root.enterConfiguring();
+            root.enterFinalized();
+        }
+
+        //! Update every pipeline then run for one cycle
+        template<class PipelinesT>
+        void step(PipelinesT & pipelines) {
+            for(auto & p : pipelines) {
+                p->pipeline.update();
+            }
+            sched.run(1, true, false);
+        }
+
+        sparta::Scheduler sched;
+        sparta::Clock clk;
+        sparta::RootTreeNode root;
+    };
+
+    //! A pipeline counting the calls of its stage handlers
+    class Counter
+    {
+    public:
+        Counter(const sparta::Clock * clk, uint32_t num_stages, const std::vector<uint32_t> & handler_stages) :
+            pipeline("counted", num_stages, clk)
+        {
+            for(const uint32_t stage : handler_stages) {
+                pipeline.registerHandlerAtStage(stage, CREATE_SPARTA_HANDLER(Counter, count_));
+            }
+        }
+
+        sparta::Pipeline<uint64_t> pipeline;
+        uint64_t num_calls = 0;
+
+    private:
+        void count_() {
+            ++num_calls;
+        }
+    };
+
+    //! A pipeline logging the data seen by its stage handlers
+    class Recorder
+    {
+    public:
+        Recorder(const sparta::Clock * clk, uint32_t num_stages, const std::vector<uint32_t> & handler_stages) :
+            pipeline("recorded", num_stages, clk)
+        {
+            for(const uint32_t stage : handler_stages) {
+                pipeline.registerHandlerAtStage(stage, CREATE_SPARTA_HANDLER_WITH_DATA(Recorder, record_, uint64_t));
+            }
+            pipeline.setDefaultStagePrecedence(decltype(pipeline)::Precedence::FORWARD);
+        }
+
+        sparta::Pipeline<uint64_t, sparta::PhasedPayloadEvent<uint64_t>> pipeline;
+        std::vector<uint64_t> log;
+
+    private:
+        void record_(const uint64_t & data) {
+            log.push_back(data);
+        }
+    };
+}
+
+//! Times num_cycles cycles of NUM_PIPELINES pipelines with an item appended
+//! to each every 4 cycles on average
+void testThroughput(const char * name, uint32_t num_stages, const std::vector<uint32_t> & handler_stages)
+{
+    Top top;
+    std::vector<std::unique_ptr<Counter>> counters;
+    for(uint32_t i = 0; i < NUM_PIPELINES; ++i) {
+        counters.emplace_back(new Counter(&top.clk, num_stages, handler_stages));
+    }
+    top.finalize();
+    const uint32_t num_cycles = sparta::perf::problemSize(20000u, 500u);
+
+    std::mt19937 rng(num_stages);
+    std::vector<std::vector<bool>> appends(num_cycles, std::vector<bool>(NUM_PIPELINES));
+    uint64_t expected_calls = 0;
+    for(uint32_t cycle = 0; cycle < num_cycles; ++cycle) {
+        for(uint32_t i = 0; i < NUM_PIPELINES; ++i) {
+            appends[cycle][i] = (rng() % 4 == 0);
+            if(appends[cycle][i]) {
+                // Reaches stage k at the update of cycle + k
+                for(const uint32_t stage : handler_stages) {
+                    expected_calls += (cycle + stage < num_cycles);
+                }
+            }
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t cycle = 0; cycle < num_cycles; ++cycle) {
+        for(uint32_t i = 0; i < NUM_PIPELINES; ++i) {
+            if(appends[cycle][i]) {
+                counters[i]->pipeline.append(cycle);
+            }
+        }
+        top.step(counters);
+    }
+    const double seconds = sparta::perf::secondsSince(start);
+
+    uint64_t num_calls = 0;
+    for(const auto & counter : counters) {
+        num_calls += counter->num_calls;
+    }
+    EXPECT_EQUAL(num_calls, expected_calls);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << num_cycles << " cycles of " << NUM_PIPELINES << " " << num_stages << "-stage pipelines, "
+                  << name << ": " << seconds << " s, " << num_calls << " handler calls" << std::endl;
+    }
+}
+
+//! Applies the same random appends, stalls, flushes and deactivations to a
+//! pipeline using the pipe valid mask and one too long to use it
+void testStallsAndFlushes()
+{
+    Top top;
+    const std::vector<uint32_t> handler_stages = {0, 1, 3, 4, 7, 8, 9, 12, 15};
+    std::vector<std::unique_ptr<Recorder>> recorders;
+    recorders.emplace_back(new Recorder(&top.clk, SHORT_PIPELINE_STAGES, handler_stages));
+    recorders.emplace_back(new Recorder(&top.clk, LONG_PIPELINE_STAGES, handler_stages));
+    top.finalize();
+
+    std::mt19937 rng(0x57a11);
+    uint64_t next_item = 0;
+    for(uint32_t cycle = 0; cycle < NUM_RANDOM_CYCLES; ++cycle) {
+        const uint32_t op = rng() % 32;
+        const uint32_t stage = rng() % SHORT_PIPELINE_STAGES;
+        const uint32_t handler_stage = handler_stages[rng() % handler_stages.size()];
+        const bool flag = rng() % 2;
+        for(auto & r : recorders) {
+            auto & pipeline = r->pipeline;
+            if(op < 20 && !pipeline.isAppended()) {
+                pipeline.append(next_item);
+            }
+            else if(op == 20 && pipeline.isValid(stage) && !pipeline.isStalledOrStalling()) {
+                pipeline.stall(stage, 1 + stage % 3, flag);
+            }
+            else if(op == 21) {
+                pipeline.flushStage(stage);
+            }
+            else if(op == 22 && !pipeline.isStalledOrStalling()) {
+                if(flag) {
+                    pipeline.activateEventAtStage(handler_stage);
+                }
+                else {
+                    pipeline.deactivateEventAtStage(handler_stage);
+                }
+            }
+        }
+        ++next_item;
+        top.step(recorders);
+    }
+
+    EXPECT_TRUE(recorders[0]->log.size() > NUM_RANDOM_CYCLES);
+    EXPECT_EQUAL(recorders[0]->log.size(), recorders[1]->log.size());
+    EXPECT_TRUE(recorders[0]->log == recorders[1]->log);
+}
+
+int main()
+{
+    testThroughput("handlers at 3 stages", SHORT_PIPELINE_STAGES, {2, 7, 12});
+    testThroughput("handlers at every stage", SHORT_PIPELINE_STAGES,
+                   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15});
+    testThroughput("handlers at 3 stages", LONG_PIPELINE_STAGES, {2, 7, 12});
+    testStallsAndFlushes();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
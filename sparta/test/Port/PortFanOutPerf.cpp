@@ -0,0 +1,332 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/ports/DataPort.hpp"
+#include "sparta/ports/PortSet.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file PortFanOutPerf.cpp
+ * \brief DataOutPort fan-out by const reference, rvalue and shared payload
+ *
+ * Every bound DataInPort must receive the same data in order in each mode.
+ * Payload copies are counted: an rvalue send saves one copy over a const
+ * reference send, and with setSharedFanOut a const reference send copies
+ * once and an rvalue send never, whatever the fan-out.  Shared DataInPorts
+ * hand out one object and still support peekData, pullData, clearData and
+ * cancelIf, with and without delay.  Data with EnableSharedFanOut that is
+ * not shared is copied as often as data without it; with SPARTA_PERF_TESTS
+ * set, the time of both is reported to show the cost of the shared-capable
+ * payload.
+ */
+
+TEST_INIT
+
+namespace
+{
+    constexpr uint32_t NUM_CONSUMERS = 4;
+    constexpr uint32_t GROUP_SIZE = 256;
+
+    //! A group of instructions, expensive to copy, counting its copies
+    class InstGroup
+    {
+    public:
+        explicit InstGroup(uint64_t first = 0) :
+            uids_(GROUP_SIZE)
+        {
+            std::iota(uids_.begin(), uids_.end(), first);
+        }
+
+        InstGroup(const InstGroup & other) :
+            uids_(other.uids_)
+        {
+            ++num_copies;
+        }
+
+        InstGroup(InstGroup &&) = default;
+
+        InstGroup & operator=(const InstGroup & other) {
+            uids_ = other.uids_;
+            ++num_copies;
+            return *this;
+        }
+
+        InstGroup & operator=(InstGroup &&) = default;
+
+        bool operator==(const InstGroup & other) const {
+            return uids_ == other.uids_;
+        }
+
+        uint64_t getFirst() const {
+            return uids_.front();
+        }
+
+        static uint64_t num_copies;
+
+    private:
+        std::vector<uint64_t> uids_;
+    };
+
+    uint64_t InstGroup::num_copies = 0;
+
+    //! An InstGroup that DataOutPorts may share among DataInPorts
+    class SharedInstGroup : public InstGroup
+    {
+    public:
+        using InstGroup::InstGroup;
+    };
+}
+
+template<>
+struct sparta::EnableSharedFanOut<SharedInstGroup> : std::true_type {};
+
+namespace
+{
+    //! For pipeline collection of the DataInPorts
+    std::ostream & operator<<(std::ostream & os, const InstGroup & group) {
+        return os << "group " << group.getFirst();
+    }
+
+    enum class SendMode {
+        CONST_REF,
+        RVALUE,
+        SHARED
+    };
+
+    //! A clocked tree
+    struct Top
+    {
+        Top() :
+            clk("clk", &sched)
+        {
+            root.setClock(&clk);
+        }
+
+        sparta::Scheduler sched;
+        sparta::Clock clk;
+        sparta::RootTreeNode root;
+    };
+
+    //! A producer sending a new group every cycle to several consumers
+    template<class GroupT>
+    struct FanOut
+    {
+        FanOut(SendMode mode, uint32_t num_consumers) :
+            ps(&top.root, "ports"),
+            es(&top.root),
+            out(&ps, "out"),
+            ev_send(&es, "send", CREATE_SPARTA_HANDLER(FanOut, send_)),
+            mode_(mode)
+        {
+            for(uint32_t i = 0; i < num_consumers; ++i) {
+                ins.emplace_back(new sparta::DataInPort<GroupT>(&ps, "in" + std::to_string(i),
+                                                                sparta::SchedulingPhase::Tick, 0));
+                ins.back()->registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(FanOut, receive_, GroupT));
+                out.bind(*ins.back());
+            }
+            if constexpr (sparta::EnableSharedFanOut<GroupT>::value) {
+                out.setSharedFanOut(mode == SendMode::SHARED);
+            }
+            ev_send.setContinuing(false);
+            top.root.enterConfiguring();
+            top.root.enterFinalized();
+            top.sched.finalize();
+        }
+
+        ~FanOut() {
+            top.root.enterTeardown();
+        }
+
+        //! Run for one cycle
+        void step() {
+            top.sched.run(1, true, false);
+        }
+
+        //! Send num groups, one per cycle
+        void run(uint64_t num) {
+            num_to_send_ = num;
+            ev_send.schedule(sparta::Clock::Cycle(0));
+            top.sched.run(num + 2, true, false);
+        }
+
+        Top top;
+        sparta::PortSet ps;
+        sparta::EventSet es;
+        sparta::DataOutPort<GroupT> out;
+        std::vector<std::unique_ptr<sparta::DataInPort<GroupT>>> ins;
+        sparta::Event<sparta::SchedulingPhase::Tick> ev_send;
+        sparta::Clock::Cycle send_delay = 1;
+        uint64_t num_received = 0;
+        uint64_t num_out_of_order = 0;
+
+    private:
+        void send_() {
+            if(mode_ == SendMode::CONST_REF) {
+                const GroupT group(next_ * GROUP_SIZE);
+                out.send(group, send_delay);
+            }
+            else {
+                out.send(GroupT(next_ * GROUP_SIZE), send_delay);
+            }
+            if(++next_ < num_to_send_) {
+                ev_send.schedule(1);
+            }
+        }
+
+        void receive_(const GroupT & group) {
+            num_out_of_order += (group.getFirst() != (num_received / ins.size()) * GROUP_SIZE);
+            ++num_received;
+        }
+
+        const SendMode mode_;
+        uint64_t next_ = 0;
+        uint64_t num_to_send_ = 0;
+    };
+}
+
+namespace
+{
+    //! Send num_sends groups in the given mode, checking delivery
+    //! \return Seconds taken
+    template<class GroupT>
+    double timeFanOut(SendMode mode, uint64_t num_sends, uint64_t & copies)
+    {
+        FanOut<GroupT> fan_out(mode, NUM_CONSUMERS);
+        InstGroup::num_copies = 0;
+        const auto start = std::chrono::steady_clock::now();
+        fan_out.run(num_sends);
+        const double seconds = sparta::perf::secondsSince(start);
+        copies = InstGroup::num_copies;
+        EXPECT_EQUAL(fan_out.num_received, num_sends * NUM_CONSUMERS);
+        EXPECT_EQUAL(fan_out.num_out_of_order, 0);
+        return seconds;
+    }
+}
+
+void testThroughput()
+{
+    const uint64_t num_sends = sparta::perf::problemSize<uint64_t>(200000, 2000);
+    const char * const names[] = {"const ref         ", "rvalue            ",
+                                  "const ref, opt-in ", "rvalue, opt-in    ",
+                                  "shared            "};
+    double times[5];
+    uint64_t copies[5];
+    times[0] = timeFanOut<InstGroup>(SendMode::CONST_REF, num_sends, copies[0]);
+    times[1] = timeFanOut<InstGroup>(SendMode::RVALUE, num_sends, copies[1]);
+    times[2] = timeFanOut<SharedInstGroup>(SendMode::CONST_REF, num_sends, copies[2]);
+    times[3] = timeFanOut<SharedInstGroup>(SendMode::RVALUE, num_sends, copies[3]);
+    times[4] = timeFanOut<SharedInstGroup>(SendMode::SHARED, num_sends, copies[4]);
+
+    // Each DataInPort copies the data into its event and into its
+    // DataContainer. Rvalues move into the event of the last DataInPort
+    EXPECT_EQUAL(copies[0], num_sends * NUM_CONSUMERS * 2);
+    EXPECT_EQUAL(copies[1], num_sends * (NUM_CONSUMERS * 2 - 1));
+    EXPECT_EQUAL(copies[2], copies[0]);
+    EXPECT_EQUAL(copies[3], copies[1]);
+    EXPECT_EQUAL(copies[4], 0);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Sending " << num_sends << " groups of " << GROUP_SIZE << " uids to "
+                  << NUM_CONSUMERS << " DataInPorts:";
+        for(uint32_t m = 0; m < 5; ++m) {
+            std::cout << "\n\t" << names[m] << ": " << times[m] << " s, "
+                      << copies[m] << " copies";
+        }
+        std::cout << std::endl;
+    }
+}
+
+void testSharedData()
+{
+    FanOut<SharedInstGroup> fan_out(SendMode::SHARED, 3);
+    EXPECT_TRUE(fan_out.out.isSharedFanOut());
+
+    // Const reference sends copy once
+    InstGroup::num_copies = 0;
+    const SharedInstGroup group(100);
+    fan_out.out.send(group, 1);
+    EXPECT_EQUAL(InstGroup::num_copies, 1);
+    fan_out.step();
+    fan_out.step();
+    EXPECT_TRUE(fan_out.ins[0]->dataReceived());
+    EXPECT_EQUAL(&fan_out.ins[0]->peekData(), &fan_out.ins[2]->peekData());
+    EXPECT_TRUE(fan_out.ins[1]->peekData() == group);
+
+    // Pull and clear shared data
+    fan_out.out.send(SharedInstGroup(200), 1);
+    fan_out.step();
+    fan_out.step();
+    EXPECT_EQUAL(fan_out.ins[1]->peekData().getFirst(), 200);
+    EXPECT_EQUAL(fan_out.ins[1]->pullData().getFirst(), 200);
+    EXPECT_FALSE(fan_out.ins[1]->dataReceived());
+    EXPECT_TRUE(fan_out.ins[2]->dataReceived());
+    fan_out.ins[2]->clearData();
+    EXPECT_FALSE(fan_out.ins[2]->dataReceived());
+
+    // Cancel shared data in flight
+    InstGroup::num_copies = 0;
+    fan_out.out.send(SharedInstGroup(300), 1);
+    fan_out.out.send(SharedInstGroup(400), 2);
+    EXPECT_EQUAL(fan_out.out.cancelIf(SharedInstGroup(300)), 3);
+    fan_out.step();
+    fan_out.step();
+    EXPECT_EQUAL(fan_out.ins[0]->peekData().getFirst(), 200);
+    fan_out.step();
+    EXPECT_EQUAL(fan_out.ins[0]->peekData().getFirst(), 400);
+    EXPECT_EQUAL(InstGroup::num_copies, 0);
+
+    // Copies once given to a single DataInPort
+    FanOut<SharedInstGroup> single(SendMode::SHARED, 1);
+    InstGroup::num_copies = 0;
+    single.out.send(group, 1);
+    single.step();
+    single.step();
+    EXPECT_EQUAL(InstGroup::num_copies, 2);
+    EXPECT_TRUE(single.ins[0]->peekData() == group);
+}
+
+namespace
+{
+    //! Data sent from the Tick phase to zero-delay Tick DataInPorts is
+    //! received immediately
+    template<class GroupT>
+    void checkZeroDelay(SendMode mode, uint64_t expected_copies)
+    {
+        FanOut<GroupT> fan_out(mode, 2);
+        fan_out.send_delay = 0;
+        InstGroup::num_copies = 0;
+        fan_out.run(1);
+        EXPECT_EQUAL(fan_out.num_received, 2);
+        EXPECT_EQUAL(fan_out.num_out_of_order, 0);
+        EXPECT_EQUAL(fan_out.ins[1]->peekData().getFirst(), 0);
+        EXPECT_EQUAL(InstGroup::num_copies, expected_copies);
+    }
+}
+
+void testZeroDelay()
+{
+    checkZeroDelay<InstGroup>(SendMode::RVALUE, 1);
+    checkZeroDelay<SharedInstGroup>(SendMode::RVALUE, 1);
+    checkZeroDelay<SharedInstGroup>(SendMode::SHARED, 0);
+}
+
+int main()
+{
+    testThroughput();
+    testSharedData();
+    testZeroDelay();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,312 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/report/Report.hpp"
+#include "sparta/report/ReportSnapshot.hpp"
+#include "sparta/report/format/CSV.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
+#include "sparta/statistics/StatisticSet.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file ReportSnapshotPerf.cpp
+ * \brief ReportSnapshot against per-statistic evaluation of a report
+ *
+ * Snapshot values must equal StatisticInstance::getValue in the order
+ * formatters write them, and CSV rows written from a snapshot must equal
+ * rows built one statistic at a time.  Captured values stay put until
+ * released.  The plan is rebuilt when statistics or subreports are added
+ * or removed, and follows statistics reassigned in place.  The update
+ * time of both is compared only with SPARTA_PERF_TESTS.
+ */
+
+TEST_INIT
+
+namespace
+{
+    constexpr uint32_t NUM_UNITS    = 64;
+    constexpr uint32_t NUM_COUNTERS = 12;
+
+    //! A unit with counters and some derived statistics
+    struct Unit
+    {
+        Unit(sparta::TreeNode * parent, uint32_t idx) :
+            node(parent, "unit" + std::to_string(idx), "Unit"),
+            stats(&node)
+        {
+            for(uint32_t i = 0; i < NUM_COUNTERS; ++i) {
+                counters.emplace_back(new sparta::Counter(&stats, "c" + std::to_string(i), "Counter",
+                                                          sparta::Counter::COUNT_NORMAL));
+            }
+            sdefs.emplace_back(new sparta::StatisticDef(&stats, "total", "Total", &stats,
+                                                        "c0 + c1 + c2 + c3"));
+            sdefs.emplace_back(new sparta::StatisticDef(&stats, "ratio", "Ratio", &stats,
+                                                        "(c0 + c1) / (c2 + c3 + 1)"));
+            sdefs.emplace_back(new sparta::StatisticDef(&stats, "rate", "Rate", &stats,
+                                                        "total / cycles"));
+            sdefs.emplace_back(new sparta::StatisticDef(&stats, "hit_pct", "Hit rate", &stats,
+                                                        "100 * c4 / (c4 + c5 + 1)"));
+        }
+
+        sparta::TreeNode node;
+        sparta::StatisticSet stats;
+        std::vector<std::unique_ptr<sparta::Counter>> counters;
+        std::vector<std::unique_ptr<sparta::StatisticDef>> sdefs;
+    };
+
+    //! A report with one subreport per unit
+    void populate(sparta::Report & r, const std::vector<std::unique_ptr<Unit>> & units)
+    {
+        for(auto & unit : units) {
+            sparta::Report & sr = r.addSubreport(unit->node.getName());
+            for(auto & ctr : unit->counters) {
+                sr.add(ctr.get());
+            }
+            for(auto & sd : unit->sdefs) {
+                sr.add(sd.get());
+            }
+        }
+    }
+
+    //! Every statistic of a report, depth-first
+    void getStatistics(const sparta::Report & r, std::vector<const sparta::StatisticInstance*> & stats)
+    {
+        for(const auto & si : r.getStatistics()) {
+            stats.push_back(si.second.get());
+        }
+        for(const sparta::Report & sr : r.getSubreports()) {
+            getStatistics(sr, stats);
+        }
+    }
+
+    //! CSV row built from getValue
+    std::string expectedRow(const sparta::Report & r)
+    {
+        std::vector<const sparta::StatisticInstance*> stats;
+        getStatistics(r, stats);
+        std::stringstream row;
+        for(uint32_t i = 0; i < stats.size(); ++i) {
+            row << (i ? "," : "") << sparta::Report::formatNumber(stats[i]->getValue());
+        }
+        row << "\n";
+        return row.str();
+    }
+
+    void increment(const std::vector<std::unique_ptr<Unit>> & units, std::mt19937 & gen)
+    {
+        for(auto & unit : units) {
+            for(auto & ctr : unit->counters) {
+                *ctr += gen() % 8;
+            }
+        }
+    }
+}
+
+void testSnapshot()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clk", &sched);
+    sparta::RootTreeNode top("top");
+    top.setClock(&clk);
+    std::vector<std::unique_ptr<Unit>> units;
+    for(uint32_t i = 0; i < 4; ++i) {
+        units.emplace_back(new Unit(&top, i));
+    }
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+    sched.run(1, true, false);
+
+    sparta::Report r("report", &top);
+    r.add(units[0]->counters[0].get(), "first");
+    populate(r, units);
+
+    std::mt19937 gen(15);
+    increment(units, gen);
+    sched.run(10, true, false);
+
+    sparta::ReportSnapshot & snapshot = r.getSnapshot();
+    EXPECT_EQUAL(&snapshot, &r.getSnapshot());
+    std::vector<const sparta::StatisticInstance*> stats;
+    getStatistics(r, stats);
+    EXPECT_TRUE(snapshot.getStatistics() == stats);
+    EXPECT_EQUAL(stats.size(), 1 + units.size() * (NUM_COUNTERS + 4));
+
+    std::vector<double> values = snapshot.getValues();
+    EXPECT_EQUAL(values.size(), stats.size());
+    for(uint32_t i = 0; i < stats.size(); ++i) {
+        EXPECT_EQUAL(values[i], stats[i]->getValue());
+    }
+
+    // Captured values are returned until released
+    snapshot.capture();
+    EXPECT_TRUE(snapshot.isCaptured());
+    *units[0]->counters[0] += 1000;
+    EXPECT_EQUAL(snapshot.getValues()[0], values[0]);
+    snapshot.release();
+    EXPECT_FALSE(snapshot.isCaptured());
+    EXPECT_EQUAL(snapshot.getValues()[0], values[0] + 1000);
+
+    // A new window only changes the values
+    r.start();
+    EXPECT_EQUAL(snapshot.getValues()[0], 0);
+    EXPECT_TRUE(snapshot.getStatistics() == stats);
+
+    // Adding statistics rebuilds the plan
+    r.add(units[1]->sdefs[0].get(), "second_total");
+    stats.clear();
+    getStatistics(r, stats);
+    EXPECT_TRUE(snapshot.getStatistics() == stats);
+    EXPECT_EQUAL(snapshot.getValues().size(), stats.size());
+
+    // Removing a subreport discards the plan
+    increment(units, gen);
+    sched.run(5, true, false);
+    EXPECT_EQUAL(r.removeSubreport("unit2"), 1);
+    sparta::ReportSnapshot & new_snapshot = r.getSnapshot();
+    stats.clear();
+    getStatistics(r, stats);
+    EXPECT_TRUE(new_snapshot.getStatistics() == stats);
+    values = new_snapshot.getValues();
+    for(uint32_t i = 0; i < stats.size(); ++i) {
+        EXPECT_EQUAL(values[i], stats[i]->getValue());
+    }
+
+    // CSV rows come from the snapshot
+    std::stringstream csv_out;
+    sparta::report::format::CSV csv(&r, csv_out);
+    increment(units, gen);
+    sched.run(5, true, false);
+    const std::string expected = expectedRow(r);
+    csv.update();
+    EXPECT_EQUAL(csv_out.str(), expected);
+
+    top.enterTeardown();
+}
+
+//! Reassigning a statistic of a report changes what its snapshot evaluates
+void testReassignedStatistic()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clk", &sched);
+    sparta::RootTreeNode top("top");
+    top.setClock(&clk);
+    std::vector<std::unique_ptr<Unit>> units;
+    for(uint32_t i = 0; i < 2; ++i) {
+        units.emplace_back(new Unit(&top, i));
+    }
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+    sched.run(1, true, false);
+
+    sparta::Report r("report", &top);
+    r.add(units[0]->counters[0].get(), "counter");
+    r.add(units[0]->sdefs[0].get(), "expression");
+    *units[0]->counters[0] += 3;
+
+    sparta::ReportSnapshot & snapshot = r.getSnapshot();
+    EXPECT_EQUAL(snapshot.getValues()[0], 3);
+    EXPECT_EQUAL(snapshot.getValues()[1], 3);
+
+    // Different counter and expression, each with a window starting now
+    r.getStatistic(0) = sparta::StatisticInstance(units[1]->counters[5].get());
+    r.getStatistic(1) = sparta::StatisticInstance(units[1]->sdefs[0].get());
+    *units[1]->counters[5] += 7;
+    *units[1]->counters[0] += 50;
+    EXPECT_EQUAL(snapshot.getValues()[0], 7);
+    EXPECT_EQUAL(snapshot.getValues()[1], 50);
+    EXPECT_EQUAL(snapshot.getValues()[0], r.getStatistic(0).getValue());
+    EXPECT_EQUAL(snapshot.getValues()[1], r.getStatistic(1).getValue());
+
+    // Back to the first counter, with a window started before the reassignment
+    sparta::StatisticInstance first(units[0]->counters[0].get());
+    *units[0]->counters[0] += 1;
+    r.getStatistic(0) = first;
+    EXPECT_EQUAL(snapshot.getValues()[0], 1);
+
+    top.enterTeardown();
+}
+
+void testUpdateThroughput()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clk", &sched);
+    sparta::RootTreeNode top("top");
+    top.setClock(&clk);
+    std::vector<std::unique_ptr<Unit>> units;
+    for(uint32_t i = 0; i < NUM_UNITS; ++i) {
+        units.emplace_back(new Unit(&top, i));
+    }
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+    sched.run(1, true, false);
+
+    sparta::Report r("report", &top);
+    populate(r, units);
+    std::vector<const sparta::StatisticInstance*> stats;
+    getStatistics(r, stats);
+    const uint32_t num_updates = sparta::perf::problemSize(200u, 10u);
+
+    // Compile the plan up front
+    auto start = std::chrono::steady_clock::now();
+    r.getSnapshot().getValues();
+    const double plan_time = sparta::perf::secondsSince(start);
+
+    std::mt19937 gen(0xcafe);
+    double si_time = 0, snapshot_time = 0;
+    std::vector<double> si_values(stats.size());
+    for(uint32_t update = 0; update < num_updates; ++update) {
+        increment(units, gen);
+        sched.run(100, true, false);
+
+        start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < stats.size(); ++i) {
+            si_values[i] = stats[i]->getValue();
+        }
+        si_time += sparta::perf::secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        sparta::ReportSnapshot & snapshot = r.getSnapshot();
+        snapshot.capture();
+        const std::vector<double> & values = snapshot.getValues();
+        snapshot.release();
+        snapshot_time += sparta::perf::secondsSince(start);
+
+        EXPECT_TRUE(values == si_values);
+
+        // New window for the next update
+        r.start();
+    }
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Report updates (" << num_updates << " x " << stats.size() << " statistics):"
+                  << "\n\tStatisticInstance::getValue : " << si_time << " s"
+                  << "\n\tReportSnapshot              : " << snapshot_time << " s"
+                  << " (plan compiled in " << plan_time << " s)" << std::endl;
+    }
+
+    top.enterTeardown();
+}
+
+int main()
+{
+    testSnapshot();
+    testReassignedStatistic();
+    testUpdateThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
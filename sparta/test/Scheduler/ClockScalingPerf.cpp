@@ -0,0 +1,114 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/ClockManager.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file ClockScalingPerf.cpp
+ * \brief Scheduler event rate against the number of idle clocks
+ *
+ * One event reschedules itself every cycle on a single clock while the
+ * other clocks of a 1, 8 or 64 clock tree sit idle.  Clock cycles are
+ * computed lazily, so the run loop never visits the idle clocks, and every
+ * clock must still report the right current and elapsed cycles afterwards.
+ * SPARTA_PERF_TESTS raises the run from 20k to 2M events and prints the
+ * event rate.
+ */
+
+TEST_INIT
+
+class ClockScalingBench
+{
+public:
+    ClockScalingBench(uint32_t num_clocks, uint64_t num_events) :
+        num_events_(num_events),
+        clk_man_(&scheduler_)
+    {
+        root_clk_ = clk_man_.makeRoot(&rtn_, "root_clk");
+        for(uint32_t i = 0; i < num_clocks; ++i) {
+            // Clock periods 1, 2, 3, ... relative to the root
+            clocks_.emplace_back(clk_man_.makeClock("clk" + std::to_string(i), root_clk_, 1, i + 1));
+        }
+        clk_man_.normalize();
+
+        event_set_.reset(new sparta::EventSet(&rtn_));
+        event_set_->setClock(clocks_[0].get());
+        tick_event_.reset(new sparta::Event<>(event_set_.get(), "tick_event",
+                                              CREATE_SPARTA_HANDLER(ClockScalingBench, tick_), 1));
+
+        scheduler_.finalize();
+        rtn_.enterConfiguring();
+        rtn_.enterFinalized();
+    }
+
+    ~ClockScalingBench() {
+        rtn_.enterTeardown();
+    }
+
+    //! Run the benchmark, returning the number of events per second
+    double run()
+    {
+        tick_event_->schedule();
+        const auto start = std::chrono::steady_clock::now();
+        scheduler_.run();
+        return num_fired_ / sparta::perf::secondsSince(start);
+    }
+
+    void checkCycles() const
+    {
+        for(const auto & clk : clocks_) {
+            EXPECT_EQUAL(clk->currentCycle(), scheduler_.getCurrentTick() / clk->getPeriod());
+            EXPECT_EQUAL(clk->elapsedCycles(), scheduler_.getElapsedTicks() / clk->getPeriod());
+        }
+    }
+
+private:
+    void tick_()
+    {
+        ++num_fired_;
+        if(num_fired_ < num_events_) {
+            tick_event_->schedule();
+        }
+    }
+
+    const uint64_t num_events_;
+    uint64_t num_fired_ = 0;
+
+    sparta::Scheduler    scheduler_;
+    sparta::RootTreeNode rtn_;
+    sparta::ClockManager clk_man_;
+    sparta::Clock::Handle root_clk_;
+    std::vector<sparta::Clock::Handle> clocks_;
+    std::unique_ptr<sparta::EventSet>  event_set_;
+    std::unique_ptr<sparta::Event<>>   tick_event_;
+};
+
+int main()
+{
+    const uint64_t num_events = sparta::perf::problemSize<uint64_t>(2000000, 20000);
+
+    for(const uint32_t num_clocks : {1u, 8u, 64u})
+    {
+        ClockScalingBench bench(num_clocks, num_events);
+        const double events_per_sec = bench.run();
+        bench.checkCycles();
+
+        if(sparta::perf::isTimingEnabled()) {
+            std::cout << "Clocks: " << num_clocks
+                      << "\tevents/sec: " << events_per_sec << std::endl;
+        }
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,263 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "sparta/kernel/ObjectAllocator.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file ObjectAllocatorPerf.cpp
+ * \brief ObjectAllocator pool behavior and create/free cost
+ *
+ * Freed objects must come back LIFO without being reconstructed, the pool
+ * must grow a chunk at a time, clear() must destroy every object, and the
+ * thread-safe allocator must never hand the same object to two consumer
+ * threads.  The create/free loop against the std::queue free list the
+ * Scheduler used before is a pure benchmark and is skipped unless
+ * SPARTA_PERF_TESTS is set.
+ */
+
+TEST_INIT
+
+namespace
+{
+
+// The allocator the Scheduler used before: a std::queue free list
+// and individually heap-allocated objects
+template<typename ObjT>
+class QueueObjectAllocator
+{
+public:
+    template<typename... Args>
+    ObjT * create(Args&&... args)
+    {
+        ObjT * obj = nullptr;
+        if(free_obj_list_.empty()) {
+            allocated_objs_.emplace_back(new ObjT(args...));
+            obj = allocated_objs_.back().get();
+        }
+        else {
+            obj = free_obj_list_.front();
+            free_obj_list_.pop();
+        }
+        return obj;
+    }
+
+    void free(ObjT * obj) {
+        free_obj_list_.push(obj);
+    }
+
+private:
+    std::queue<ObjT*> free_obj_list_;
+    std::vector<std::unique_ptr<ObjT>> allocated_objs_;
+};
+
+// Stand-in for a Scheduler TickQuantum
+struct Quantum
+{
+    explicit Quantum(uint32_t num_groups) :
+        groups(num_groups)
+    {
+        ++num_constructed;
+    }
+
+    ~Quantum() {
+        ++num_destroyed;
+    }
+
+    uint64_t tick = 0;
+    std::vector<std::vector<void*>> groups;
+    Quantum * next = nullptr;
+
+    static uint64_t num_constructed;
+    static uint64_t num_destroyed;
+};
+uint64_t Quantum::num_constructed = 0;
+uint64_t Quantum::num_destroyed = 0;
+
+//! Keep num_outstanding quanta live, freeing the oldest and creating
+//! a new one each iteration, like a Scheduler advancing through ticks
+template<typename AllocT>
+double runCreateFree(AllocT & alloc, uint32_t num_outstanding, uint64_t num_iterations)
+{
+    std::vector<Quantum*> live(num_outstanding);
+    for(auto & q : live) {
+        q = alloc.create(4);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for(uint64_t i = 0; i < num_iterations; ++i) {
+        Quantum *& slot = live[i % num_outstanding];
+        alloc.free(slot);
+        slot = alloc.create(4);
+        slot->tick = i;
+        checksum += slot->groups.size();
+    }
+    const double seconds = sparta::perf::secondsSince(start);
+
+    for(Quantum * q : live) {
+        alloc.free(q);
+    }
+    EXPECT_EQUAL(checksum, num_iterations * 4);
+    return seconds;
+}
+
+void testSemantics()
+{
+    Quantum::num_constructed = 0;
+    Quantum::num_destroyed = 0;
+    {
+        sparta::ObjectAllocator<Quantum, false, 16> alloc;
+
+        std::vector<Quantum*> objs;
+        for(uint32_t i = 0; i < 40; ++i) {
+            objs.emplace_back(alloc.create(i));
+            EXPECT_EQUAL(objs.back()->groups.size(), i);
+        }
+        EXPECT_EQUAL(alloc.getNumChunks(), 3u);
+        EXPECT_EQUAL(alloc.getNumConstructed(), 40u);
+        EXPECT_EQUAL(Quantum::num_constructed, 40u);
+
+        // Objects within a chunk are contiguous
+        EXPECT_TRUE(reinterpret_cast<char*>(objs[1]) > reinterpret_cast<char*>(objs[0]));
+
+        // Reuse is LIFO and does not reconstruct
+        objs[7]->tick = 1234;
+        alloc.free(objs[3]);
+        alloc.free(objs[7]);
+        Quantum * reused = alloc.create(99);
+        EXPECT_EQUAL(reused, objs[7]);
+        EXPECT_EQUAL(reused->tick, 1234u);
+        EXPECT_EQUAL(reused->groups.size(), 7u);
+        EXPECT_EQUAL(alloc.create(99), objs[3]);
+        EXPECT_EQUAL(Quantum::num_constructed, 40u);
+
+        alloc.clear();
+        EXPECT_EQUAL(Quantum::num_destroyed, 40u);
+        EXPECT_EQUAL(alloc.getNumChunks(), 0u);
+
+        alloc.create(1);
+        EXPECT_EQUAL(alloc.getNumChunks(), 1u);
+    }
+    EXPECT_EQUAL(Quantum::num_destroyed, 41u);
+}
+
+void testPerformance()
+{
+    if(!sparta::perf::isTimingEnabled()) {
+        return;
+    }
+
+    constexpr uint64_t NUM_ITERATIONS = 20000000;
+
+    for(uint32_t num_outstanding : {1u, 64u, 4096u})
+    {
+        QueueObjectAllocator<Quantum> queue_alloc;
+        sparta::ObjectAllocator<Quantum> pool_alloc;
+        sparta::ObjectAllocator<Quantum, true> ts_pool_alloc;
+
+        const double queue_time   = runCreateFree(queue_alloc, num_outstanding, NUM_ITERATIONS);
+        const double pool_time    = runCreateFree(pool_alloc, num_outstanding, NUM_ITERATIONS);
+        const double ts_pool_time = runCreateFree(ts_pool_alloc, num_outstanding, NUM_ITERATIONS);
+
+        std::cout << "Outstanding objects: " << num_outstanding
+                  << " create/free pairs: " << NUM_ITERATIONS
+                  << "\n\tstd::queue free list : " << queue_time << " s"
+                  << "\n\tintrusive pool       : " << pool_time << " s"
+                  << "\n\tlock-free pool       : " << ts_pool_time << " s"
+                  << std::endl;
+    }
+}
+
+// Producers create objects and hand them to the consumer through a
+// single shared slot array; the consumer frees them.  Every object
+// carries an owner flag that must never be seen set on create.
+void testThreadSafe()
+{
+    struct Message
+    {
+        std::atomic<uint32_t> in_use{0};
+        uint64_t payload = 0;
+    };
+
+    constexpr uint32_t NUM_PRODUCERS = 3;
+    constexpr uint64_t NUM_PER_PRODUCER = 200000;
+    constexpr uint32_t RING_SIZE = 1024;
+
+    sparta::ObjectAllocator<Message, true, 32> alloc;
+    std::vector<std::atomic<Message*>> ring(RING_SIZE);
+    for(auto & entry : ring) {
+        entry.store(nullptr);
+    }
+    std::atomic<uint64_t> num_double_handouts{0};
+    std::atomic<uint64_t> num_consumed{0};
+    std::atomic<uint64_t> payload_sum{0};
+
+    auto producer = [&](uint32_t id) {
+        for(uint64_t i = 0; i < NUM_PER_PRODUCER; ++i) {
+            Message * msg = alloc.create();
+            if(msg->in_use.exchange(1) != 0) {
+                ++num_double_handouts;
+            }
+            msg->payload = i;
+
+            // Find an empty spot in the ring
+            uint32_t idx = (id * 7919 + i) % RING_SIZE;
+            Message * expected = nullptr;
+            while(!ring[idx].compare_exchange_weak(expected, msg)) {
+                expected = nullptr;
+                idx = (idx + 1) % RING_SIZE;
+            }
+        }
+    };
+
+    auto consumer = [&]() {
+        uint32_t idx = 0;
+        while(num_consumed.load() < NUM_PRODUCERS * NUM_PER_PRODUCER) {
+            Message * msg = ring[idx].exchange(nullptr);
+            if(msg != nullptr) {
+                payload_sum += msg->payload;
+                msg->in_use.store(0);
+                alloc.free(msg);
+                ++num_consumed;
+            }
+            idx = (idx + 1) % RING_SIZE;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(consumer);
+    for(uint32_t i = 0; i < NUM_PRODUCERS; ++i) {
+        threads.emplace_back(producer, i);
+    }
+    for(auto & thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQUAL(num_double_handouts.load(), 0u);
+    EXPECT_EQUAL(num_consumed.load(), NUM_PRODUCERS * NUM_PER_PRODUCER);
+    EXPECT_EQUAL(payload_sum.load(), NUM_PRODUCERS * (NUM_PER_PRODUCER * (NUM_PER_PRODUCER - 1) / 2));
+
+    // The ring bounds the number of objects in flight
+    EXPECT_TRUE(alloc.getNumConstructed() <= RING_SIZE + NUM_PRODUCERS);
+    std::cout << "Thread-safe pool: " << alloc.getNumConstructed()
+              << " objects in " << alloc.getNumChunks() << " chunks" << std::endl;
+}
+
+}
+
+int main()
+{
+    testSemantics();
+    testPerformance();
+    testThreadSafe();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
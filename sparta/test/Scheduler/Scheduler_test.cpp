@@ -16,6 +16,7 @@
 #include "sparta/sparta.hpp"
 #include <iostream>
 #include <inttypes.h>
+#include <functional>
 #include "sparta/ports/DataPort.hpp"
 #include "sparta/ports/PortSet.hpp"
 #include "sparta/kernel/Scheduler.hpp"
@@ -104,6 +105,29 @@ public:
 
 };
 
+// An event that runs a test-provided action when fired.  Used to
+// test cancellation while the Scheduler is firing
+class ActionEvent : public sparta::Scheduleable
+{
+public:
+    ActionEvent(sparta::TreeNode * rtn, sparta::SchedulingPhase phase, bool is_unique = false) :
+        Scheduleable(CREATE_SPARTA_HANDLER(ActionEvent, actionEventCB), 0, phase, is_unique)
+    {
+        setScheduleableClock(rtn->getClock());
+    }
+
+    void actionEventCB()
+    {
+        ++num_fired;
+        if(action) {
+            action();
+        }
+    }
+
+    std::function<void()> action;
+    uint32_t num_fired = 0;
+};
+
 static_assert(sparta::NUM_SCHEDULING_PHASES == 7,
               "\n\nIf you got this compile-time assert, then you need to update this test 'cause you added more phases to SchedulingPhase. \n"
               "Specifically, you need to add more TestEvent's below\n\n");
@@ -135,6 +159,17 @@ int main()
 
     BadDagEvent ev_baddag(&rtn);
 
+    ActionEvent ev_canceller(&rtn, sparta::SchedulingPhase::Trigger);
+    ActionEvent ev_victim(&rtn, sparta::SchedulingPhase::Tick);
+    ActionEvent ev_self_cancel(&rtn, sparta::SchedulingPhase::Tick);
+    ActionEvent ev_unique(&rtn, sparta::SchedulingPhase::Tick, true);
+    ActionEvent * ev_deleted = new ActionEvent(&rtn, sparta::SchedulingPhase::PostTick);
+    ActionEvent ev_deleter(&rtn, sparta::SchedulingPhase::PostTick);
+    ActionEvent * ev_deleted_before_throw = new ActionEvent(&rtn, sparta::SchedulingPhase::PostTick);
+    ActionEvent ev_thrower(&rtn, sparta::SchedulingPhase::PostTick);
+    ActionEvent ev_pending(&rtn, sparta::SchedulingPhase::PostTick);
+    ev_victim.precedes(ev_self_cancel);
+
     // Order test -- should not be allowed to schedule an event before
     // finalization
     EXPECT_THROW(sched->scheduleEvent(&ev_trigger, 0, ev_trigger.getGroupID()));
@@ -371,6 +406,114 @@ int main()
     EXPECT_EQUAL(sched->getGlobalPhasedPayloadEventPtr<sparta::SchedulingPhase::PostTick>()->getSchedulingPhase(),
                  sparta::SchedulingPhase::PostTick);
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Test cancellation while the Scheduler is firing events
+
+    // An event cancels an event scheduled later in the same tick
+    ev_canceller.action = [&]() {
+        EXPECT_TRUE(ev_victim.isScheduled());
+        ev_victim.cancel();
+        EXPECT_FALSE(ev_victim.isScheduled());
+    };
+    ev_victim.schedule(sparta::Clock::Cycle(0));
+    ev_victim.schedule(3);
+    ev_canceller.schedule(sparta::Clock::Cycle(0));
+    EXPECT_TRUE(ev_victim.isScheduled(0));
+    EXPECT_TRUE(ev_victim.isScheduled(3));
+    EXPECT_FALSE(ev_victim.isScheduled(1));
+    sched->run(5, true, false);
+    EXPECT_EQUAL(ev_canceller.num_fired, 1);
+    EXPECT_EQUAL(ev_victim.num_fired, 0);
+    EXPECT_FALSE(ev_victim.isScheduled());
+
+    // An event reschedules itself and then cancels everything,
+    // including its future schedule
+    ev_self_cancel.action = [&]() {
+        EXPECT_TRUE(ev_self_cancel.isScheduled());
+        ev_self_cancel.schedule(5);
+        EXPECT_TRUE(ev_self_cancel.isScheduled(5));
+        ev_self_cancel.cancel();
+        EXPECT_FALSE(ev_self_cancel.isScheduled(5));
+        EXPECT_FALSE(ev_self_cancel.isScheduled());
+    };
+    ev_self_cancel.schedule(sparta::Clock::Cycle(0));
+    sched->run(10, true, false);
+    EXPECT_EQUAL(ev_self_cancel.num_fired, 1);
+    EXPECT_FALSE(ev_self_cancel.isScheduled());
+
+    // An event cancels an event that has already fired this tick --
+    // this has no effect
+    ev_self_cancel.action = [&]() {
+        ev_victim.cancel();
+    };
+    ev_victim.schedule(sparta::Clock::Cycle(0));
+    ev_self_cancel.schedule(sparta::Clock::Cycle(0));
+    sched->run(1, true, false);
+    EXPECT_EQUAL(ev_self_cancel.num_fired, 2);
+    EXPECT_EQUAL(ev_victim.num_fired, 1);
+    EXPECT_FALSE(ev_victim.isScheduled());
+
+    // A unique event scheduled from its own handler in the same tick
+    // is still on the Scheduler and is not added again
+    ev_unique.action = [&]() {
+        EXPECT_TRUE(ev_unique.isScheduled(0));
+        ev_unique.schedule(sparta::Clock::Cycle(0));
+    };
+    ev_unique.schedule(sparta::Clock::Cycle(0));
+    ev_unique.schedule(sparta::Clock::Cycle(0));
+    sched->run(1, true, false);
+    EXPECT_EQUAL(ev_unique.num_fired, 1);
+    EXPECT_FALSE(ev_unique.isScheduled());
+
+    // Cancel one of several times an event is scheduled
+    ev_victim.num_fired = 0;
+    ev_victim.schedule(1);
+    ev_victim.schedule(1);
+    ev_victim.schedule(2);
+    ev_victim.cancel(1);
+    EXPECT_FALSE(ev_victim.isScheduled(1));
+    EXPECT_TRUE(ev_victim.isScheduled(2));
+    sched->run(3, true, false);
+    EXPECT_EQUAL(ev_victim.num_fired, 1);
+    EXPECT_FALSE(ev_victim.isScheduled());
+
+    // An event deletes an event that fired earlier in its firing
+    // group.  The Scheduler must not touch the deleted event again
+    EXPECT_EQUAL(ev_deleted->getGroupID(), ev_deleter.getGroupID());
+    ev_deleter.action = [&]() {
+        EXPECT_TRUE(ev_deleted->isScheduled());
+        delete ev_deleted;
+        ev_deleted = nullptr;
+    };
+    ev_deleted->schedule(1);
+    ev_deleter.schedule(1);
+    sched->run(2, true, false);
+    EXPECT_EQUAL(ev_deleter.num_fired, 1);
+    EXPECT_EQUAL(ev_deleted, nullptr);
+    EXPECT_FALSE(ev_deleter.isScheduled());
+
+    // An event deletes an event that fired earlier in its firing
+    // group and then throws.  Clearing the Scheduler afterwards (reset
+    // calls clearEvents) must not touch the deleted event, but must
+    // still remove the events that have not fired
+    ev_thrower.action = [&]() {
+        delete ev_deleted_before_throw;
+        ev_deleted_before_throw = nullptr;
+        throw sparta::SpartaException("thrown after deleting an event");
+    };
+    ev_deleted_before_throw->schedule(1);
+    ev_thrower.schedule(1);
+    ev_pending.schedule(1);
+    ev_pending.schedule(2);
+    EXPECT_THROW(sched->run(2, true, false));
+    EXPECT_EQUAL(ev_thrower.num_fired, 1);
+    EXPECT_EQUAL(ev_deleted_before_throw, nullptr);
+    EXPECT_TRUE(ev_pending.isScheduled());
+    sched->reset();
+    EXPECT_EQUAL(ev_pending.num_fired, 0);
+    EXPECT_FALSE(ev_pending.isScheduled());
+    EXPECT_FALSE(ev_thrower.isScheduled());
+
     rtn.enterTeardown();
 
     REPORT_ERROR;
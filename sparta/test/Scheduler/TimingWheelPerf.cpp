@@ -0,0 +1,148 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/PayloadEvent.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file TimingWheelPerf.cpp
+ * \brief Scheduling far-future events with and without the timing wheel
+ *
+ * A pool of PayloadEvents keeps one payload outstanding per future tick of
+ * a horizon of 10, 1k or 10k ticks and reschedules each payload a
+ * pseudo-random distance ahead as it fires.  The same seed drives a
+ * Scheduler with the timing wheel and one walking its quantum list, and
+ * both must fire the payloads in the same order.  The 100k tick horizon,
+ * where the list walk gets expensive, only runs with SPARTA_PERF_TESTS.
+ */
+
+TEST_INIT
+
+class FutureEventBench
+{
+public:
+    //! A PayloadEvent allows about a thousand outstanding payloads, so
+    //! the outstanding events are spread over several
+    static constexpr uint32_t PAYLOADS_PER_EVENT = 1000;
+
+    FutureEventBench(uint32_t num_future_ticks, uint32_t wheel_size, uint64_t num_reschedules) :
+        num_future_ticks_(num_future_ticks),
+        num_outstanding_(num_future_ticks),
+        num_reschedules_(num_reschedules),
+        clk_("clock", &scheduler_),
+        event_set_(&rtn_)
+    {
+        scheduler_.setTimingWheelSize(wheel_size);
+        event_set_.setClock(&clk_);
+        for(uint32_t i = 0; i < num_outstanding_; i += PAYLOADS_PER_EVENT) {
+            future_events_.emplace_back(new sparta::PayloadEvent<uint32_t>
+                                        (&event_set_, "future_event" + std::to_string(future_events_.size()),
+                                         CREATE_SPARTA_HANDLER_WITH_DATA(FutureEventBench, fired_, uint32_t)));
+        }
+        scheduler_.finalize();
+        rtn_.enterConfiguring();
+        rtn_.enterFinalized();
+    }
+
+    ~FutureEventBench() {
+        rtn_.enterTeardown();
+    }
+
+    //! Run the benchmark, returning the wall time in seconds
+    double run()
+    {
+        // Populate in reverse tick order so that the initial fill
+        // does not dominate the list-based Scheduler
+        for(uint32_t i = num_outstanding_; i > 0; --i) {
+            schedule_(i - 1, uint64_t(i) * num_future_ticks_ / num_outstanding_);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        scheduler_.run();
+        return sparta::perf::secondsSince(start);
+    }
+
+    const std::vector<uint32_t> & getFiringOrder() const {
+        return firing_order_;
+    }
+
+    uint32_t getNumOutstanding() const {
+        return num_outstanding_;
+    }
+
+private:
+    void schedule_(uint32_t id, uint64_t delay) {
+        future_events_[id / PAYLOADS_PER_EVENT]->preparePayload(id)->schedule(delay);
+    }
+
+    void fired_(const uint32_t & id)
+    {
+        firing_order_.emplace_back(id);
+        if(reschedules_ < num_reschedules_) {
+            ++reschedules_;
+            // Simple LCG -- reschedule 1 to 2*num_future_ticks cycles out
+            lcg_ = lcg_ * 6364136223846793005ull + 1442695040888963407ull;
+            const uint64_t delay = 1 + ((lcg_ >> 33) % (2 * num_future_ticks_));
+            schedule_(id, delay);
+        }
+    }
+
+    const uint32_t num_future_ticks_;
+    const uint32_t num_outstanding_;
+    const uint64_t num_reschedules_;
+    uint64_t reschedules_ = 0;
+    uint64_t lcg_ = 1;
+    std::vector<uint32_t> firing_order_;
+
+    sparta::Scheduler    scheduler_;
+    sparta::Clock        clk_;
+    sparta::RootTreeNode rtn_;
+    sparta::EventSet     event_set_;
+    std::vector<std::unique_ptr<sparta::PayloadEvent<uint32_t>>> future_events_;
+};
+
+int main()
+{
+    constexpr uint32_t WHEEL_SIZE = 4096;
+    const uint64_t num_reschedules = sparta::perf::problemSize<uint64_t>(20000, 2000);
+
+    for(const uint32_t num_future_ticks : {10u, 1000u, sparta::perf::problemSize(100000u, 10000u)})
+    {
+        std::vector<uint32_t> list_order;
+        uint32_t num_outstanding = 0;
+        double list_time = 0;
+        {
+            FutureEventBench list_bench(num_future_ticks, 0, num_reschedules);
+            list_time  = list_bench.run();
+            list_order = list_bench.getFiringOrder();
+            num_outstanding = list_bench.getNumOutstanding();
+        }
+
+        double wheel_time = 0;
+        {
+            FutureEventBench wheel_bench(num_future_ticks, WHEEL_SIZE, num_reschedules);
+            wheel_time = wheel_bench.run();
+            EXPECT_TRUE(list_order == wheel_bench.getFiringOrder());
+        }
+        EXPECT_EQUAL(num_outstanding, num_future_ticks);
+        EXPECT_EQUAL(list_order.size(), num_outstanding + num_reschedules);
+
+        if(sparta::perf::isTimingEnabled()) {
+            std::cout << "Outstanding events: " << num_outstanding
+                      << " over future ticks: " << num_future_ticks
+                      << "\n\tlist  : " << list_time  << " s"
+                      << "\n\twheel : " << wheel_time << " s (" << WHEEL_SIZE << " slots)"
+                      << std::endl;
+        }
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
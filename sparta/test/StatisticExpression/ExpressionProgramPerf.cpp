@@ -0,0 +1,346 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/Expression.hpp"
+#include "sparta/statistics/ExpressionProgram.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
+#include "sparta/statistics/StatisticInstance.hpp"
+#include "sparta/statistics/StatisticSet.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file ExpressionProgramPerf.cpp
+ * \brief Evaluating a report-sized set of StatisticDefs as one program
+ *
+ * Every update compares the values of a single ExpressionProgram with
+ * Expression::evaluate and StatisticInstance::getValue for each statistic.
+ * Counters and sub-expressions shared by several expressions must be read
+ * or computed once, ending a StatisticInstance must recompile the program,
+ * and restarting one must only refresh its initial values.  Statistics
+ * nested in an expression must throw for ranges in the future as they do
+ * when evaluated directly.  Timing runs
+ * 200 updates instead of 10.
+ */
+
+TEST_INIT
+
+using sparta::statistics::expression::Expression;
+using sparta::statistics::expression::ExpressionProgram;
+
+namespace
+{
+    constexpr uint32_t NUM_UNITS    = 64;
+    constexpr uint32_t NUM_COUNTERS = 8;
+
+    //! StatisticDefs of each unit. Most share counters and sub-expressions
+    const char * STAT_EXPRS[] = {
+        "c0 + c1",
+        "c1 + c0",
+        "(c0 + c1) / (c2 + 1)",
+        "(c0 + c1) / (c3 + 1)",
+        "c2 / (c0 + c1 + 1)",
+        "100 * c4 / (c4 + c5 + 1)",
+        "100 * c5 / (c4 + c5 + 1)",
+        "ifnan(c6 / c7, 0)",
+        "max(c6, c7) - min(c6, c7)",
+        "abs(c6 - c7) * 2",
+        "c0 + c1 + c2 + c3 + c4 + c5 + c6 + c7",
+        "cycles",
+        "(c0 + c1) / cycles",
+        "c3 * c3 - c2 * c2",
+        "-c4 + c5",
+        "ratio_a + ratio_b"
+    };
+
+    //! Values are identical, including NAN (e.g. per-cycle rates of an
+    //! empty window)
+    bool sameValue(double a, double b) {
+        return (std::isnan(a) && std::isnan(b)) || a == b;
+    }
+
+    //! A unit with counters and StatisticDefs derived from them
+    struct Unit
+    {
+        Unit(sparta::TreeNode * parent, uint32_t idx) :
+            node(parent, "unit" + std::to_string(idx), "Unit"),
+            stats(&node)
+        {
+            for(uint32_t i = 0; i < NUM_COUNTERS; ++i) {
+                counters.emplace_back(new sparta::Counter(&stats, "c" + std::to_string(i), "Counter",
+                                                          sparta::Counter::COUNT_NORMAL));
+            }
+            sdefs.emplace_back(new sparta::StatisticDef(&stats, "ratio_a", "Ratio", &stats,
+                                                        "c0 / (c1 + 1)"));
+            sdefs.emplace_back(new sparta::StatisticDef(&stats, "ratio_b", "Ratio", &stats,
+                                                        "c2 / (c3 + 1)"));
+            uint32_t i = 0;
+            for(const char * expr : STAT_EXPRS) {
+                sdefs.emplace_back(new sparta::StatisticDef(&stats, "s" + std::to_string(i++), "Stat",
+                                                            &stats, expr));
+            }
+        }
+
+        sparta::TreeNode node;
+        sparta::StatisticSet stats;
+        std::vector<std::unique_ptr<sparta::Counter>> counters;
+        std::vector<std::unique_ptr<sparta::StatisticDef>> sdefs;
+    };
+}
+
+void testSharing()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clk", &sched);
+    sparta::RootTreeNode top("top");
+    top.setClock(&clk);
+    sparta::StatisticSet cset(&top);
+    sparta::Counter ca(&cset, "a", "Counter A", sparta::Counter::COUNT_NORMAL);
+    sparta::Counter cb(&cset, "b", "Counter B", sparta::Counter::COUNT_NORMAL);
+    sparta::Counter cl(&cset, "l", "Counter L", sparta::Counter::COUNT_LATEST);
+    sparta::StatisticDef sab(&cset, "sab", "Stat A+B", &cset, "a + b");
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+    sched.run(1, true, false);
+
+    ca += 10;
+    cl += 7;
+    Expression ab("a + b", &cset);
+    Expression ba("b + a", &cset);
+    Expression l("l * 2 + 1", &cset);
+
+    ExpressionProgram prog;
+    EXPECT_EQUAL(prog.addRoot(ab), 0);
+    EXPECT_EQUAL(prog.addRoot(ba), 1);
+    EXPECT_EQUAL(prog.addRoot(l), 2);
+    EXPECT_EQUAL(prog.getNumRoots(), 3);
+
+    ca += 3;
+    cb += 4;
+    cl += 1;
+    sched.run(5, true, false);
+    std::vector<double> values = prog.evaluate();
+    EXPECT_EQUAL(values.size(), 3);
+    EXPECT_EQUAL(values[0], 7);
+    EXPECT_EQUAL(values[1], 7);
+    EXPECT_EQUAL(values[2], 17);
+    EXPECT_EQUAL(values[0], ab.evaluate());
+    EXPECT_EQUAL(values[2], l.evaluate());
+
+    // a, b and l (no delta for COUNT_LATEST) are gathered. One addition
+    // shared by both roots, multiply and add for l
+    EXPECT_EQUAL(prog.getNumCounters(), 3);
+    EXPECT_EQUAL(prog.getNumInstructions(), 3);
+    EXPECT_EQUAL(prog.getNumCompiles(), 1);
+
+    // Ending a window bakes its result into the program
+    ab.end();
+    ca += 100;
+    values = prog.evaluate();
+    EXPECT_EQUAL(values[0], 7);
+    EXPECT_EQUAL(values[1], 107);
+    EXPECT_EQUAL(values[0], ab.evaluate());
+    EXPECT_EQUAL(values[1], ba.evaluate());
+
+    EXPECT_EQUAL(prog.getNumCompiles(), 2);
+
+    // Restarting resets the deltas
+    ab.start();
+    ba.start();
+    cb += 2;
+    values = prog.evaluate();
+    EXPECT_EQUAL(values[0], 2);
+    EXPECT_EQUAL(values[1], 2);
+    EXPECT_EQUAL(prog.getNumCounters(), 3);
+    EXPECT_EQUAL(prog.getNumInstructions(), 3);
+    EXPECT_EQUAL(prog.getNumCompiles(), 3);
+
+    // Restarting windows which are still open only updates initial values
+    ab.start();
+    ba.start();
+    ca += 5;
+    values = prog.evaluate();
+    EXPECT_EQUAL(values[0], 5);
+    EXPECT_EQUAL(values[1], 5);
+    EXPECT_EQUAL(prog.getNumCompiles(), 3);
+
+    // Unless a shared delta no longer has a single initial value
+    ab.start();
+    ca += 1;
+    values = prog.evaluate();
+    EXPECT_EQUAL(values[0], 1);
+    EXPECT_EQUAL(values[1], 6);
+    EXPECT_EQUAL(values[1], ba.evaluate());
+    EXPECT_EQUAL(prog.getNumCounters(), 4);
+    EXPECT_EQUAL(prog.getNumCompiles(), 4);
+    EXPECT_EQUAL(prog.getResults()[1], 6);
+
+    // Expressions without content throw as they do when evaluated
+    Expression empty;
+    ExpressionProgram empty_prog;
+    empty_prog.addRoot(empty);
+    EXPECT_THROW(empty_prog.evaluate());
+
+    // Instances nested in an expression check their ranges too.  Going
+    // back in time puts the start of the nested sab in the future
+    Expression nested("sab * 2", &cset);
+    ExpressionProgram nested_prog;
+    nested_prog.addRoot(nested);
+    sched.run(5, true, false);
+    EXPECT_NOTHROW(nested_prog.evaluate());
+    sched.restartAt(1);
+    EXPECT_THROW(nested.evaluate());
+    EXPECT_THROW(nested_prog.evaluate());
+
+    top.enterTeardown();
+}
+
+void testStatisticInstances()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clk", &sched);
+    sparta::RootTreeNode top("top");
+    top.setClock(&clk);
+    std::unique_ptr<Unit> unit(new Unit(&top, 0));
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+    sched.run(1, true, false);
+
+    std::vector<std::unique_ptr<sparta::StatisticInstance>> sis;
+    for(auto & sd : unit->sdefs) {
+        sis.emplace_back(new sparta::StatisticInstance(sd.get()));
+    }
+    for(auto & ctr : unit->counters) {
+        sis.emplace_back(new sparta::StatisticInstance(ctr.get()));
+    }
+    ExpressionProgram prog;
+    for(auto & si : sis) {
+        prog.addRoot(*si);
+    }
+
+    std::mt19937 gen(14);
+    for(uint32_t step = 0; step < 20; ++step) {
+        for(auto & ctr : unit->counters) {
+            *ctr += gen() % 16;
+        }
+        sched.run(3, true, false);
+        if(step == 10) {
+            // Half of the instances end their windows, the rest restart
+            for(uint32_t i = 0; i < sis.size(); ++i) {
+                if(i % 2) {
+                    sis[i]->end();
+                } else {
+                    sis[i]->start();
+                }
+            }
+        }
+
+        const std::vector<double> & values = prog.evaluate();
+        for(uint32_t i = 0; i < sis.size(); ++i) {
+            EXPECT_TRUE(sameValue(values[i], sis[i]->getValue()));
+            if(sis[i]->getEnd() == sparta::Scheduler::INDEFINITE) {
+                EXPECT_TRUE(sameValue(values[i], sis[i]->getStatisticExpression().hasContent() ?
+                                                 sis[i]->getStatisticExpression().evaluate() :
+                                                 sis[i]->getRawLatest() - sis[i]->getInitial()));
+            }
+        }
+    }
+
+    top.enterTeardown();
+}
+
+void testEvaluationThroughput()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clk", &sched);
+    sparta::RootTreeNode top("top");
+    top.setClock(&clk);
+    std::vector<std::unique_ptr<Unit>> units;
+    for(uint32_t i = 0; i < NUM_UNITS; ++i) {
+        units.emplace_back(new Unit(&top, i));
+    }
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+    sched.run(1, true, false);
+
+    std::vector<std::unique_ptr<sparta::StatisticInstance>> sis;
+    for(auto & unit : units) {
+        for(auto & sd : unit->sdefs) {
+            sis.emplace_back(new sparta::StatisticInstance(sd.get()));
+        }
+    }
+    ExpressionProgram prog;
+    for(auto & si : sis) {
+        prog.addRoot(*si);
+    }
+    const uint32_t num_updates = sparta::perf::problemSize(200u, 10u);
+    std::mt19937 gen(0x5ad);
+    double tree_time = 0, prog_time = 0;
+    double tree_sum = 0, prog_sum = 0;
+    for(uint32_t update = 0; update < num_updates; ++update) {
+        for(auto & unit : units) {
+            for(auto & ctr : unit->counters) {
+                *ctr += gen() % 8;
+            }
+        }
+        sched.run(10, true, false);
+
+        auto start = std::chrono::steady_clock::now();
+        for(auto & si : sis) {
+            tree_sum += si->getStatisticExpression().evaluate();
+        }
+        tree_time += sparta::perf::secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        const std::vector<double> & values = prog.evaluate();
+        for(const double v : values) {
+            prog_sum += v;
+        }
+        prog_time += sparta::perf::secondsSince(start);
+
+        if(update % 50 == 0) {
+            for(uint32_t i = 0; i < sis.size(); ++i) {
+                EXPECT_EQUAL(values[i], sis[i]->getStatisticExpression().evaluate());
+            }
+        }
+
+        // New window for the next update, as periodic reports do
+        for(auto & si : sis) {
+            si->start();
+        }
+    }
+    EXPECT_EQUAL(tree_sum, prog_sum);
+    EXPECT_EQUAL(prog.getNumCompiles(), 1);
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Program of " << prog.getNumInstructions() << " instructions"
+                  << "\nEvaluation of " << sis.size() << " statistics x " << num_updates << " updates:"
+                  << "\n\texpression trees : " << tree_time << " s"
+                  << "\n\tExpressionProgram: " << prog_time << " s" << std::endl;
+    }
+
+    top.enterTeardown();
+}
+
+int main()
+{
+    testSharing();
+    testStatisticInstances();
+    testEvaluationThroughput();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,290 @@
+// This test runs a ring of "cores" connected by SyncPorts, first with
+// every core on one Scheduler and then with each core on its own
+// Scheduler partition run by a ParallelSchedulerRunner.  Each core
+// does some busy work every cycle, periodically sends its state to
+// the next core in the ring, and folds whatever it receives into its
+// state, so any reordering of cross-partition data shows up in the
+// data that follows.
+//
+// It checks for:
+// - Identical data and arrival ticks with and without partitioning
+// - Senders seeing cross-partition ports as ready without reading the
+//   receiving partition's state
+// - Lookahead equal to the smallest cross-partition port delay
+// - Rejection of zero-delay cross-partition bindings
+// - Rethrowing a partition's exception from the runner
+//
+
+#include <chrono>
+#include <cinttypes>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/kernel/ParallelSchedulerRunner.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/ports/PortSet.hpp"
+#include "sparta/ports/SyncPort.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+namespace
+{
+
+// Tick and data tuple recorded on every receive
+typedef std::pair<sparta::Scheduler::Tick, uint32_t> TickAndData;
+
+class Core
+{
+public:
+    Core(uint32_t id, sparta::Scheduler * sched, uint32_t period,
+         uint64_t num_cycles, uint32_t work_per_cycle) :
+        id_(id),
+        num_cycles_(num_cycles),
+        work_per_cycle_(work_per_cycle),
+        rtn_("core" + std::to_string(id)),
+        clk_("clk", sched),
+        ps_(&rtn_, "ports"),
+        event_set_(&rtn_)
+    {
+        clk_.setPeriod(period);
+        rtn_.setClock(&clk_);
+        out_.reset(new sparta::SyncOutPort<uint32_t>(&ps_, "out_port", &clk_));
+        in_.reset(new sparta::SyncInPort<uint32_t>(&ps_, "in_port", &clk_));
+        in_->registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(Core, receive_, uint32_t));
+        work_event_.reset(new sparta::Event<>(&event_set_, "work",
+                                              CREATE_SPARTA_HANDLER(Core, work_), 1));
+        state_ = id_ + 1;
+    }
+
+    ~Core() {
+        rtn_.enterTeardown();
+    }
+
+    void finalizeTree() {
+        rtn_.enterConfiguring();
+        rtn_.enterFinalized();
+    }
+
+    //! Bind this core's output to the next core's input
+    void connectTo(Core & next, sparta::Clock::Cycle delay) {
+        next.in_->setPortDelay(delay);
+        out_->bind(next.in_.get());
+    }
+
+    void start() {
+        work_event_->schedule(sparta::Clock::Cycle(0));
+    }
+
+    void throwOnCycle(uint64_t cycle) {
+        throw_on_cycle_ = cycle;
+    }
+
+    const std::vector<TickAndData> & getReceived() const {
+        return received_;
+    }
+
+    uint64_t getNumNotReady() const {
+        return num_not_ready_;
+    }
+
+    sparta::SyncInPort<uint32_t> & getInPort() {
+        return *in_;
+    }
+
+    sparta::SyncOutPort<uint32_t> & getOutPort() {
+        return *out_;
+    }
+
+private:
+    void work_()
+    {
+        ++cycles_;
+        sparta_assert(cycles_ != throw_on_cycle_, "Core " << id_ << " failed on purpose");
+
+        // Simple LCG standing in for the work a model does every cycle
+        for(uint32_t i = 0; i < work_per_cycle_; ++i) {
+            state_ = state_ * 1664525u + 1013904223u;
+        }
+        if((cycles_ % 3) == 0) {
+            num_not_ready_ += !out_->isReady();
+            out_->send(state_ ^ static_cast<uint32_t>(cycles_));
+        }
+        if(cycles_ < num_cycles_) {
+            work_event_->schedule();
+        }
+    }
+
+    void receive_(const uint32_t & dat)
+    {
+        received_.emplace_back(clk_.getScheduler()->getCurrentTick(), dat);
+        state_ += dat;
+    }
+
+    const uint32_t id_;
+    const uint64_t num_cycles_;
+    const uint32_t work_per_cycle_;
+    uint64_t cycles_ = 0;
+    uint64_t throw_on_cycle_ = 0;
+    uint64_t num_not_ready_ = 0;
+    uint32_t state_ = 0;
+    std::vector<TickAndData> received_;
+
+    sparta::RootTreeNode rtn_;
+    sparta::Clock        clk_;
+    sparta::PortSet      ps_;
+    sparta::EventSet     event_set_;
+    std::unique_ptr<sparta::SyncOutPort<uint32_t>> out_;
+    std::unique_ptr<sparta::SyncInPort<uint32_t>>  in_;
+    std::unique_ptr<sparta::Event<>>               work_event_;
+};
+
+//! A ring of cores; partitioned puts each core on its own Scheduler
+class Ring
+{
+public:
+    static constexpr uint32_t NUM_CORES = 4;
+
+    Ring(bool partitioned, uint64_t num_cycles, uint32_t work_per_cycle)
+    {
+        const uint32_t num_schedulers = partitioned ? NUM_CORES : 1;
+        for(uint32_t i = 0; i < num_schedulers; ++i) {
+            schedulers_.emplace_back(new sparta::Scheduler("sched" + std::to_string(i)));
+        }
+        if(partitioned) {
+            std::vector<sparta::Scheduler*> partitions;
+            for(auto & sched : schedulers_) {
+                partitions.emplace_back(sched.get());
+            }
+            runner_.reset(new sparta::ParallelSchedulerRunner(partitions));
+        }
+
+        for(uint32_t i = 0; i < NUM_CORES; ++i) {
+            // Alternate between two clock frequencies
+            cores_.emplace_back(new Core(i, schedulers_[i % num_schedulers].get(),
+                                         (i % 2) ? 3 : 2, num_cycles, work_per_cycle));
+        }
+        for(auto & core : cores_) {
+            core->finalizeTree();
+        }
+        for(uint32_t i = 0; i < NUM_CORES; ++i) {
+            // Port delays of 4, 5, 6, 7 receiver cycles
+            cores_[i]->connectTo(*cores_[(i + 1) % NUM_CORES], 4 + i);
+        }
+        for(auto & sched : schedulers_) {
+            sched->finalize();
+        }
+        for(auto & core : cores_) {
+            core->start();
+        }
+    }
+
+    //! Run to completion, returning the wall time in seconds
+    double run()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if(runner_) {
+            runner_->run();
+        }
+        else {
+            schedulers_.front()->run();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    Core & getCore(uint32_t idx) {
+        return *cores_[idx];
+    }
+
+    sparta::ParallelSchedulerRunner * getRunner() {
+        return runner_.get();
+    }
+
+private:
+    // Destroyed in reverse: ports deregister from the runner, and the
+    // runner releases the Schedulers
+    std::vector<std::unique_ptr<sparta::Scheduler>> schedulers_;
+    std::unique_ptr<sparta::ParallelSchedulerRunner> runner_;
+    std::vector<std::unique_ptr<Core>> cores_;
+};
+
+void testSameResults()
+{
+    constexpr uint64_t NUM_CYCLES     = 20000;
+    constexpr uint32_t WORK_PER_CYCLE = 200;
+
+    std::vector<std::vector<TickAndData>> expected;
+    double serial_time = 0;
+    {
+        Ring serial(false, NUM_CYCLES, WORK_PER_CYCLE);
+        serial_time = serial.run();
+        for(uint32_t i = 0; i < Ring::NUM_CORES; ++i) {
+            expected.emplace_back(serial.getCore(i).getReceived());
+            EXPECT_TRUE(expected.back().size() > 0);
+        }
+    }
+
+    double parallel_time = 0;
+    {
+        Ring parallel(true, NUM_CYCLES, WORK_PER_CYCLE);
+
+        // The smallest delay is 5 cycles of core 2's clock (period 2)
+        EXPECT_EQUAL(parallel.getRunner()->getLookahead(), 10u);
+
+        parallel_time = parallel.run();
+        for(uint32_t i = 0; i < Ring::NUM_CORES; ++i) {
+            EXPECT_TRUE(parallel.getCore(i).getReceived() == expected[i]);
+            EXPECT_EQUAL(parallel.getCore(i).getNumNotReady(), 0u);
+            EXPECT_TRUE(parallel.getCore(i).getOutPort().isReadyPS());
+        }
+        EXPECT_TRUE(parallel.getRunner()->getNumWindows() > 1);
+    }
+
+    std::cout << "Cores: " << Ring::NUM_CORES << " cycles: " << NUM_CYCLES
+              << "\n\tone scheduler : " << serial_time << " s"
+              << "\n\tpartitioned   : " << parallel_time << " s"
+              << std::endl;
+}
+
+void testZeroDelayRejected()
+{
+    sparta::Scheduler sched0("sched0");
+    sparta::Scheduler sched1("sched1");
+    sparta::ParallelSchedulerRunner runner({&sched0, &sched1});
+    {
+        Core core0(0, &sched0, 1, 1, 0);
+        Core core1(1, &sched1, 1, 1, 0);
+        core0.finalizeTree();
+        core1.finalizeTree();
+        EXPECT_THROW(core0.getOutPort().bind(&core1.getInPort()));
+    }
+    EXPECT_EQUAL(runner.getLookahead(), sparta::Scheduler::INDEFINITE);
+}
+
+void testPartitionException()
+{
+    constexpr uint64_t NUM_CYCLES = 1000;
+
+    Ring parallel(true, NUM_CYCLES, 0);
+    parallel.getCore(2).throwOnCycle(NUM_CYCLES / 2);
+    EXPECT_THROW(parallel.run());
+}
+
+}
+
+int main()
+{
+    testSameResults();
+    testZeroDelayRejected();
+    testPartitionException();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/simulation/ParameterTree.hpp"
+#include "sparta/utils/GlobPattern.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaPerfTester.hpp"
+
+/*!
+ * \file TreeSearchPerf.cpp
+ * \brief Tree-search pattern resolution on a large synthetic tree
+ *
+ * Each pattern is matched by utils::GlobPattern and by the std::regex that
+ * TreeNode::createSearchRegexPattern builds, which must agree on matches
+ * and captures.  Other regex metacharacters, which the std::regex did not
+ * escape, must match only themselves.  findChildren results are compared with a regex-based walk
+ * of the same tree, and every parameter of the tree is looked up in a
+ * ParameterTree.  The time each takes is printed with SPARTA_PERF_TESTS.
+ */
+
+TEST_INIT
+
+using sparta::TreeNode;
+using sparta::utils::GlobPattern;
+
+namespace
+{
+    constexpr uint32_t NUM_CORES      = 32;
+    constexpr uint32_t NUM_STATS      = 100;
+    constexpr uint32_t NUM_PARAMS     = 20;
+    const char * UNIT_NAMES[] = {"fetch", "decode", "rename", "dispatch", "alu0", "alu1",
+                                 "fpu", "lsu", "rob", "l1i", "l1d", "l2"};
+
+    //! Match with the regular expression TreeNode used to build for patterns
+    bool regexMatches(const std::string & pattern, const std::string & name,
+                      std::vector<std::string> & captures)
+    {
+        std::regex expr(TreeNode::createSearchRegexPattern(pattern));
+        std::smatch what;
+        if(!std::regex_match(name, what, expr)) {
+            return false;
+        }
+        for(uint32_t i = 1; i < what.size(); ++i) {
+            captures.push_back(what[i].str());
+        }
+        return true;
+    }
+
+    //! findChildren as it was done with a std::regex per pattern token
+    void regexFindChildren(TreeNode * node, const std::string & pattern, size_t pos,
+                           std::vector<TreeNode*> & results)
+    {
+        const std::string tok = TreeNode::getNextName(pattern, pos);
+        std::regex expr(TreeNode::createSearchRegexPattern(tok));
+        for(TreeNode * child : node->getChildren()) {
+            if(std::regex_match(child->getName(), expr)) {
+                if(pos == std::string::npos) {
+                    results.push_back(child);
+                } else {
+                    regexFindChildren(child, pattern, pos, results);
+                }
+            }
+        }
+    }
+}
+
+void testGlobPattern()
+{
+    // Every pattern of up to 4 characters against every name of up to 5
+    // characters, over a small alphabet
+    const std::string pat_chars = "ab*?+";
+    const std::string name_chars = "ab";
+    std::vector<std::string> patterns = {""}, names = {""};
+    for(size_t i = 0; i < patterns.size(); ++i) {
+        if(patterns[i].size() < 4) {
+            for(char c : pat_chars) { patterns.push_back(patterns[i] + c); }
+        }
+    }
+    for(size_t i = 0; i < names.size(); ++i) {
+        if(names[i].size() < 5) {
+            for(char c : name_chars) { names.push_back(names[i] + c); }
+        }
+    }
+
+    uint32_t num_matches = 0;
+    for(const auto & pattern : patterns) {
+        const GlobPattern glob(pattern);
+        for(const auto & name : names) {
+            std::vector<std::string> expected, actual;
+            const bool expected_match = regexMatches(pattern, name, expected);
+            EXPECT_EQUAL(glob.matches(name, actual), expected_match);
+            EXPECT_EQUAL(glob.matches(name), expected_match);
+            EXPECT_TRUE(actual == expected);
+            num_matches += expected_match;
+        }
+    }
+    EXPECT_TRUE(num_matches > 0);
+
+    // Names with realistic lengths
+    std::vector<std::string> captures;
+    EXPECT_TRUE(GlobPattern("core*").matches("core12", captures));
+    EXPECT_EQUAL(captures.size(), 1);
+    EXPECT_EQUAL(captures.at(0), "12");
+    EXPECT_FALSE(GlobPattern("core+").matches("core"));
+    EXPECT_TRUE(GlobPattern("core?").matches("core"));
+    EXPECT_FALSE(GlobPattern("core?").matches("core12"));
+    EXPECT_TRUE(GlobPattern("alu0").isLiteral());
+    EXPECT_FALSE(GlobPattern("alu*").isLiteral());
+
+    // Regex metacharacters other than parentheses and brackets were not
+    // escaped in the std::regex.  They now match only themselves
+    EXPECT_FALSE(TreeNode::matchesGlobLike("alu|fpu", "alu"));
+    EXPECT_TRUE(TreeNode::matchesGlobLike("alu|fpu", "alu|fpu"));
+    EXPECT_FALSE(TreeNode::matchesGlobLike("alu0{2}", "alu00"));
+    EXPECT_TRUE(TreeNode::matchesGlobLike("^alu*$", "^alu0$"));
+    EXPECT_FALSE(TreeNode::matchesGlobLike("^alu*$", "alu0"));
+    EXPECT_FALSE(TreeNode::matchesGlobLike("alu\\d", "alu0"));
+    EXPECT_TRUE(TreeNode::matchesGlobLike("alu\\d", "alu\\d"));
+
+    // Cached patterns are shared
+    EXPECT_EQUAL(GlobPattern::get("l1*").get(), GlobPattern::get("l1*").get());
+    EXPECT_EQUAL(GlobPattern::get("l1*")->getPattern(), "l1*");
+}
+
+void testLargeTree()
+{
+    sparta::RootTreeNode root("top");
+    std::vector<std::unique_ptr<TreeNode>> nodes;
+    std::vector<std::string> param_locations;
+    for(uint32_t core = 0; core < NUM_CORES; ++core) {
+        nodes.emplace_back(new TreeNode(&root, "core" + std::to_string(core), "core", core, "Core"));
+        TreeNode * core_node = nodes.back().get();
+        for(const char * unit : UNIT_NAMES) {
+            nodes.emplace_back(new TreeNode(core_node, unit, "Unit"));
+            TreeNode * unit_node = nodes.back().get();
+            nodes.emplace_back(new TreeNode(unit_node, "stats", "Statistics"));
+            TreeNode * stats_node = nodes.back().get();
+            for(uint32_t i = 0; i < NUM_STATS; ++i) {
+                nodes.emplace_back(new TreeNode(stats_node, "ctr" + std::to_string(i), "Counter"));
+            }
+            nodes.emplace_back(new TreeNode(unit_node, "params", "Parameters"));
+            TreeNode * params_node = nodes.back().get();
+            for(uint32_t i = 0; i < NUM_PARAMS; ++i) {
+                nodes.emplace_back(new TreeNode(params_node, "p" + std::to_string(i), "Parameter"));
+                param_locations.emplace_back(nodes.back()->getLocation());
+            }
+        }
+    }
+
+    // Report-like searches
+    const std::vector<std::string> report_patterns = {
+        "core*.*.stats.*",
+        "core*.lsu.stats.ctr*",
+        "core1?.rob.stats.ctr1+",
+        "core+.l1?.stats.ctr9*",
+        "core0.fetch.stats.ctr0",
+        "core31.l2.stats.*",
+        "core*.alu+.stats.ctr5",
+        "core3.*.params.p1?"
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<TreeNode*>> expected(report_patterns.size());
+    for(uint32_t i = 0; i < report_patterns.size(); ++i) {
+        regexFindChildren(&root, report_patterns[i], 0, expected[i]);
+    }
+    const double regex_time = sparta::perf::secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<TreeNode*>> found(report_patterns.size());
+    for(uint32_t i = 0; i < report_patterns.size(); ++i) {
+        root.findChildren(report_patterns[i], found[i]);
+    }
+    const double glob_time = sparta::perf::secondsSince(start);
+
+    // findChildren visits children in name order
+    uint64_t num_found = 0;
+    for(uint32_t i = 0; i < report_patterns.size(); ++i) {
+        std::sort(found[i].begin(), found[i].end());
+        std::sort(expected[i].begin(), expected[i].end());
+        EXPECT_TRUE(found[i] == expected[i]);
+        num_found += found[i].size();
+    }
+    EXPECT_EQUAL(found.at(0).size(), NUM_CORES * std::size(UNIT_NAMES) * NUM_STATS);
+    EXPECT_EQUAL(found.at(4).size(), 1);
+
+    // Config-like application: patterned and specific parameter values,
+    // then a lookup for every parameter in the tree
+    sparta::ParameterTree pt;
+    pt.set("top.core*.*.params.*", "1", false);
+    pt.set("top.core*.lsu.params.p3", "2", false);
+    for(uint32_t core = 0; core < NUM_CORES; core += 2) {
+        pt.set("top.core" + std::to_string(core) + ".l1?.params.p1+", "3", false);
+        pt.set("top.core" + std::to_string(core) + ".rob.params.p7", "4", false);
+    }
+    pt.set("top.core1?.fpu.params.p*", "5", false);
+
+    start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+    for(const auto & loc : param_locations) {
+        const sparta::ParameterTree::Node * n = pt.tryGet(loc);
+        EXPECT_TRUE(n != nullptr);
+        if(n) {
+            total += n->getAs<uint32_t>();
+        }
+    }
+    const double config_time = sparta::perf::secondsSince(start);
+
+    EXPECT_EQUAL(pt.get("top.core0.alu0.params.p0").getAs<uint32_t>(), 1);
+    EXPECT_EQUAL(pt.get("top.core5.lsu.params.p3").getAs<uint32_t>(), 2);
+    EXPECT_EQUAL(pt.get("top.core4.l1d.params.p12").getAs<uint32_t>(), 3);
+    EXPECT_EQUAL(pt.get("top.core4.l1d.params.p1").getAs<uint32_t>(), 1);
+    EXPECT_EQUAL(pt.get("top.core5.l1d.params.p12").getAs<uint32_t>(), 1);
+    EXPECT_EQUAL(pt.get("top.core6.rob.params.p7").getAs<uint32_t>(), 4);
+    EXPECT_EQUAL(pt.get("top.core12.fpu.params.p7").getAs<uint32_t>(), 5);
+    EXPECT_TRUE(total > param_locations.size());
+
+    if(sparta::perf::isTimingEnabled()) {
+        std::cout << "Tree of " << nodes.size() + 1 << " nodes"
+                  << "\nReport patterns (" << num_found << " nodes found):"
+                  << "\n\tregex walk (no captures) : " << regex_time << " s"
+                  << "\n\tfindChildren            : " << glob_time << " s"
+                  << "\nConfig lookups (" << param_locations.size() << " parameters): "
+                  << config_time << " s" << std::endl;
+    }
+
+    root.enterTeardown();
+    while(!nodes.empty()) {
+        nodes.pop_back();
+    }
+}
+
+int main()
+{
+    testGlobPattern();
+    testLargeTree();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -8,6 +8,7 @@
 #include "sparta/trigger/Triggerable.hpp"
 #include "sparta/trigger/TriggerManager.hpp"
 #include "sparta/simulation/ClockManager.hpp"
+#include <limits>
 #include <list>
 TEST_INIT
 
@@ -76,6 +77,17 @@ namespace sparta
             hit = true;
         }
     };
+
+    class FireCounter
+    {
+    public:
+
+        uint32_t fired = 0;
+
+        void onFire() {
+            ++fired;
+        }
+    };
 }
 using namespace sparta;
 
@@ -210,6 +222,79 @@ int main()
         root.enterTeardown();
     }
 
+    {
+        // Triggers on Counters are armed on the counter rather than
+        // checked every cycle. Triggers on other counters are polled
+        RootTreeNode root;
+        ClockManager cm(&sched);
+        Clock::Handle c_root = cm.makeRoot();
+        Clock::Handle c_1    = cm.makeClock("C1", c_root, 1, 1);
+        root.setClock(c_1.get());
+        StatisticSet ss(&root);
+        Counter& ctr = ss.createCounter<Counter>("armed", "Armed counter", CounterBase::COUNT_LATEST);
+        uint64_t polled_val = 0;
+        ReadOnlyCounter& ro_ctr = ss.createCounter<ReadOnlyCounter>("polled", "Polled counter",
+                                                                    CounterBase::COUNT_NORMAL,
+                                                                    &polled_val);
+
+        root.enterConfiguring();
+        root.enterFinalized();
+
+        sparta::trigger::TriggerManager & trig_mgr =
+            sparta::trigger::TriggerManager::getTriggerManager();
+
+        FireCounter armed_fires;
+        trigger::CounterTrigger armed_trig("armed trigger",
+                                           CREATE_SPARTA_HANDLER_WITH_OBJ(FireCounter, &armed_fires, onFire),
+                                           &ctr, 50);
+        EXPECT_TRUE(trig_mgr.hasTrigger(&armed_trig));
+        EXPECT_FALSE(trig_mgr.isPolling(c_1.get()));
+        EXPECT_EQUAL(ctr.getArmedThreshold(), 50ull);
+
+        // Reaching the threshold and dropping below it again before the
+        // next cycle re-arms the trigger without firing
+        ctr.set(60);
+        ctr.set(10);
+        sched.run(1, true);
+        EXPECT_EQUAL(armed_fires.fired, 0);
+        EXPECT_TRUE(armed_trig.isActive());
+        EXPECT_FALSE(trig_mgr.isPolling(c_1.get()));
+        EXPECT_EQUAL(ctr.getArmedThreshold(), 50ull);
+
+        // Fires on the first cycle after the threshold is reached
+        uint32_t cycles = 0;
+        while(armed_fires.fired == 0 && cycles < 100){
+            ++ctr;
+            sched.run(1, true);
+            ++cycles;
+        }
+        EXPECT_EQUAL(cycles, 40);
+        EXPECT_EQUAL(armed_fires.fired, 1);
+        EXPECT_FALSE(armed_trig.isActive());
+        EXPECT_FALSE(trig_mgr.hasTrigger(&armed_trig));
+        EXPECT_EQUAL(ctr.getArmedThreshold(), std::numeric_limits<uint64_t>::max());
+
+        // Deactivating disarms the counter
+        trigger::CounterTrigger disarmed_trig("disarmed trigger",
+                                              CREATE_SPARTA_HANDLER_WITH_OBJ(FireCounter, &armed_fires, onFire),
+                                              &ctr, 1000);
+        EXPECT_EQUAL(ctr.getArmedThreshold(), 1000ull);
+        disarmed_trig.deactivate();
+        EXPECT_EQUAL(ctr.getArmedThreshold(), std::numeric_limits<uint64_t>::max());
+
+        FireCounter polled_fires;
+        trigger::CounterTrigger polled_trig("polled trigger",
+                                            CREATE_SPARTA_HANDLER_WITH_OBJ(FireCounter, &polled_fires, onFire),
+                                            &ro_ctr, 5);
+        EXPECT_TRUE(trig_mgr.isPolling(c_1.get()));
+        polled_val = 5;
+        sched.run(2, true);
+        EXPECT_EQUAL(polled_fires.fired, 1);
+        EXPECT_FALSE(trig_mgr.isPolling(c_1.get()));
+
+        root.enterTeardown();
+    }
+
     ENSURE_ALL_REACHED(3);
     REPORT_ERROR;
     return ERROR_CODE;
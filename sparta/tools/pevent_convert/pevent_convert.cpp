@@ -0,0 +1,33 @@
+// <pevent_convert> -*- C++ -*-
+
+
+/**
+ * \file pevent_convert.cpp
+ * \brief Converts binary pevent files (--pevents FILE.bin) to the text
+ * format written by pevent log taps
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "sparta/pevents/BinaryPevents.hpp"
+
+int main(int argc, char** argv)
+{
+    if(argc != 3){
+        std::cerr << "Usage: " << argv[0] << " BINARY_PEVENTS TEXT_PEVENTS\n"
+                  << "Converts a binary pevent file to text. The text format is chosen by the\n"
+                  << "extension of TEXT_PEVENTS, like for --pevents (e.g. .log.basic or .log.raw)"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try{
+        sparta::pevents::BinaryPeventReader::convert(argv[1], argv[2]);
+    }catch(const std::exception& ex){
+        std::cerr << "Failed to convert " << argv[1] << ": " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}